@@ -0,0 +1,316 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "boardmanager.h"
+#include "communication/communicator.h"
+#include "communication/devicecache.h"
+#include "easyfpga.h"
+#include "utils/config/configurationfile.h"
+#include "utils/log/log.h"
+
+#include <list>
+
+double BoardManager::Statistics::getBytesPerSecond(void) const
+{
+    if (elapsedTimeus == 0) {
+        return 0.0;
+    }
+
+    return (double)(sentBytes + receivedBytes) * 1000000.0 / (double)elapsedTimeus;
+}
+
+double BoardManager::Statistics::getJobsPerSecond(void) const
+{
+    if (elapsedTimeus == 0) {
+        return 0.0;
+    }
+
+    return (double)finishedJobs * 1000000.0 / (double)elapsedTimeus;
+}
+
+double BoardManager::Statistics::getAverageParallelism(void) const
+{
+    if (elapsedTimeus == 0) {
+        return 0.0;
+    }
+
+    return (double)busyTimeus / (double)elapsedTimeus;
+}
+
+BoardManager::BoardManager(EasyFpgaFactory factory) :
+    _factory(factory),
+    _statisticsStart(std::chrono::steady_clock::now())
+{
+}
+
+BoardManager::~BoardManager()
+{
+    for (auto& board : _boards) {
+        {
+            std::lock_guard<std::mutex> lock(board->mutex);
+            board->stopRequested = true;
+        }
+        board->condition.notify_one();
+    }
+
+    for (auto& board : _boards) {
+        if (board->executor.joinable()) {
+            board->executor.join();
+        }
+    }
+}
+
+uint32_t BoardManager::connectAll(void)
+{
+    if (!_boards.empty()) {
+        EASYFPGA_LOG(WARNING) << "The board manager is already connected to " << (uint32_t)_boards.size() << " boards.";
+        return _boards.size();
+    }
+
+    std::list<std::string> devices(Communicator::findSerialDevices());
+    EASYFPGA_LOG(INFO) << "Try to connect to " << (uint32_t)devices.size() << " serial devices...";
+
+    /*
+     * The instances are created here, because the user's factory
+     * mustn't be thread safe. Only connecting takes place in parallel.
+     */
+    std::vector<std::unique_ptr<Board>> candidates;
+    for (std::string device : devices) {
+        std::unique_ptr<Board> board(new Board());
+        board->devicePath = device;
+        board->serialNumber = 0;
+        board->fpga = _factory();
+        board->stopRequested = false;
+        board->finishedJobs = 0;
+        board->failedJobs = 0;
+        board->busyTimeus = 0;
+        board->sentBytesOffset = 0;
+        board->receivedBytesOffset = 0;
+        candidates.push_back(std::move(board));
+    }
+
+    std::vector<std::thread> connectors;
+    for (auto& candidate : candidates) {
+        Board* board = candidate.get();
+        connectors.push_back(std::thread([board] {
+            if (!board->fpga->connectHardwareDevice(board->devicePath)) {
+                board->fpga = nullptr;
+            }
+            else if (!board->fpga->getCommunicator()->readSerial(&board->serialNumber)) {
+                EASYFPGA_LOG(WARNING) << "Serial of the easyFPGA at " << board->devicePath << " is not readable...";
+                board->serialNumber = 0;
+            }
+        }));
+    }
+
+    for (std::thread& connector : connectors) {
+        connector.join();
+    }
+
+    /* later searches for a single serial can use the found devices */
+    DeviceCache cache(ConfigurationFile::getInstance().getDeviceCacheFile());
+
+    for (auto& candidate : candidates) {
+        if (candidate->fpga != nullptr) {
+            if (candidate->serialNumber != 0) {
+                cache.store(candidate->serialNumber, candidate->devicePath);
+            }
+
+            EASYFPGA_LOG(INFO) << "easyFPGA 0x" << std::hex << candidate->serialNumber << " connected at " << candidate->devicePath;
+            candidate->executor = std::thread(&BoardManager::executeJobs, candidate.get());
+            _boards.push_back(std::move(candidate));
+        }
+    }
+
+    cache.save();
+
+    EASYFPGA_LOG(INFO) << "Connected to " << std::dec << (uint32_t)_boards.size() << " easyFPGA boards.";
+
+    this->resetStatistics();
+
+    return _boards.size();
+}
+
+uint32_t BoardManager::getNumberOfBoards(void)
+{
+    return _boards.size();
+}
+
+easyfpga_ptr BoardManager::getEasyFpga(uint32_t board)
+{
+    if (board < _boards.size()) {
+        return _boards[board]->fpga;
+    }
+
+    return nullptr;
+}
+
+std::string BoardManager::getDevicePath(uint32_t board)
+{
+    if (board < _boards.size()) {
+        return _boards[board]->devicePath;
+    }
+
+    return std::string();
+}
+
+uint32_t BoardManager::getSerialNumber(uint32_t board)
+{
+    if (board < _boards.size()) {
+        return _boards[board]->serialNumber;
+    }
+
+    return 0;
+}
+
+std::future<bool> BoardManager::submit(uint32_t board, Job job)
+{
+    if (board >= _boards.size()) {
+        EASYFPGA_LOG(WARNING) << "There is no board with index " << board << "!";
+        std::promise<bool> invalid;
+        invalid.set_value(false);
+        return invalid.get_future();
+    }
+
+    Board* b = _boards[board].get();
+
+    std::packaged_task<bool()> task([b, job] {
+        auto start = std::chrono::steady_clock::now();
+        bool success = job(b->fpga);
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        b->busyTimeus += duration.count();
+        if (!success) {
+            b->failedJobs++;
+        }
+        b->finishedJobs++;
+
+        return success;
+    });
+
+    std::future<bool> result(task.get_future());
+    {
+        std::lock_guard<std::mutex> lock(b->mutex);
+        b->jobs.push_back(std::move(task));
+    }
+    b->condition.notify_one();
+
+    return result;
+}
+
+bool BoardManager::runOnAllBoards(Job job)
+{
+    if (_boards.empty()) {
+        EASYFPGA_LOG(WARNING) << "No easyFPGA connected to the board manager!";
+        return false;
+    }
+
+    std::vector<std::future<bool>> results;
+    for (uint32_t i=0; i<_boards.size(); i++) {
+        results.push_back(this->submit(i, job));
+    }
+
+    bool success = true;
+    for (uint32_t i=0; i<results.size(); i++) {
+        if (!results[i].get()) {
+            EASYFPGA_LOG(WARNING) << "Job failed for the easyFPGA at " << _boards[i]->devicePath;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+bool BoardManager::uploadBinaryFile(std::string pathToBinary)
+{
+    return this->runOnAllBoards([pathToBinary] (easyfpga_ptr fpga) {
+        if (!fpga->uploadBinaryFile(pathToBinary)) {
+            return false;
+        }
+
+        fpga->instantiateCores();
+        return true;
+    });
+}
+
+BoardManager::Statistics BoardManager::getStatistics(void)
+{
+    Statistics statistics;
+    statistics.boards = _boards.size();
+    statistics.finishedJobs = 0;
+    statistics.failedJobs = 0;
+    statistics.sentBytes = 0;
+    statistics.receivedBytes = 0;
+    statistics.busyTimeus = 0;
+
+    for (auto& board : _boards) {
+        communicator_ptr com = board->fpga->getCommunicator();
+
+        statistics.finishedJobs += board->finishedJobs;
+        statistics.failedJobs += board->failedJobs;
+        statistics.sentBytes += com->getNumberOfSentBytes() - board->sentBytesOffset;
+        statistics.receivedBytes += com->getNumberOfReceivedBytes() - board->receivedBytesOffset;
+        statistics.busyTimeus += board->busyTimeus;
+    }
+
+    statistics.elapsedTimeus = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _statisticsStart).count();
+
+    return statistics;
+}
+
+void BoardManager::resetStatistics(void)
+{
+    for (auto& board : _boards) {
+        communicator_ptr com = board->fpga->getCommunicator();
+
+        board->finishedJobs = 0;
+        board->failedJobs = 0;
+        board->busyTimeus = 0;
+        board->sentBytesOffset = com->getNumberOfSentBytes();
+        board->receivedBytesOffset = com->getNumberOfReceivedBytes();
+    }
+
+    _statisticsStart = std::chrono::steady_clock::now();
+}
+
+void BoardManager::executeJobs(Board* board)
+{
+    while (true) {
+        std::packaged_task<bool()> job;
+        {
+            std::unique_lock<std::mutex> lock(board->mutex);
+            board->condition.wait(lock, [board] {
+                return (board->stopRequested || !board->jobs.empty());
+            });
+
+            /* finish all submitted jobs before stopping */
+            if (board->jobs.empty()) {
+                break;
+            }
+
+            job = std::move(board->jobs.front());
+            board->jobs.pop_front();
+        }
+
+        job();
+    }
+}
@@ -0,0 +1,258 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_BOARDMANAGER_H_
+#define SDK_BOARDMANAGER_H_
+
+#include "easyfpga_ptr.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Drives all easyFPGA boards connected to the host in parallel.
+ *
+ * EasyFpga::init() connects to exactly one board. For test rigs with
+ * many boards the BoardManager
+ * - enumerates every serial device which could be an easyFPGA (see
+ *   Communicator::findSerialDevices()),
+ * - creates one EasyFpga instance per device by a user supplied factory
+ *   and connects them concurrently, and
+ * - gives every board its own executor thread, which processes the jobs
+ *   submitted for this board one after another.
+ *
+ * Jobs for different boards therefore run in parallel, e.g. the binary
+ * upload to all boards takes about as long as the upload to a single
+ * one. Since an EasyFpga instance isn't thread safe, it must only be
+ * accessed by jobs after connectAll() returned.
+ *
+ * Example:
+ * \code
+ * BoardManager manager([] { return std::make_shared<MyFpga>(); });
+ * manager.connectAll();
+ * manager.uploadBinaryFile("myfpga.bin");
+ * manager.runOnAllBoards([] (easyfpga_ptr fpga) {
+ *     return std::static_pointer_cast<MyFpga>(fpga)->selfTest();
+ * });
+ * \endcode
+ */
+class BoardManager
+{
+    public:
+        /**
+         * \brief Creates the EasyFpga instance for one board.
+         */
+        typedef std::function<easyfpga_ptr(void)> EasyFpgaFactory;
+
+        /**
+         * \brief An operation executed by the executor thread of a board.
+         *
+         * \return true if the operation was successful,<br>
+         *         false otherwise
+         */
+        typedef std::function<bool(easyfpga_ptr)> Job;
+
+        /**
+         * \brief Aggregated statistics over all managed boards.
+         */
+        struct Statistics {
+            /** number of connected boards */
+            uint32_t boards;
+
+            /** number of finished jobs (including the failed ones) */
+            uint64_t finishedJobs;
+
+            /** number of jobs which returned false */
+            uint64_t failedJobs;
+
+            /** bytes sent to all boards */
+            uint64_t sentBytes;
+
+            /** bytes received from all boards */
+            uint64_t receivedBytes;
+
+            /** sum of the time all executor threads spent in jobs */
+            uint64_t busyTimeus;
+
+            /** wall clock time since the statistics were reset */
+            uint64_t elapsedTimeus;
+
+            /**
+             * \brief Returns the sum of sent and received bytes per
+             *        second of wall clock time.
+             */
+            double getBytesPerSecond(void) const;
+
+            /**
+             * \brief Returns the number of finished jobs per second of
+             *        wall clock time.
+             */
+            double getJobsPerSecond(void) const;
+
+            /**
+             * \brief Returns how many boards were busy on average, i.e.
+             *        the achieved parallelism.
+             */
+            double getAverageParallelism(void) const;
+        };
+
+        BoardManager(EasyFpgaFactory factory);
+
+        /**
+         * \brief Finishes all submitted jobs and stops the executor
+         *        threads.
+         */
+        ~BoardManager();
+
+        BoardManager(const BoardManager&) = delete;
+        BoardManager& operator=(const BoardManager&) = delete;
+
+        /**
+         * \brief Connects to all easyFPGA boards concurrently and starts
+         *        their executor threads.
+         *
+         * Devices which don't behave like an easyFPGA are skipped.
+         * Calling this method again has no effect if boards are already
+         * connected.
+         *
+         * \return The number of connected boards.
+         */
+        uint32_t connectAll(void);
+
+        /**
+         * \brief Returns the number of connected boards.
+         */
+        uint32_t getNumberOfBoards(void);
+
+        /**
+         * \brief Returns the EasyFpga instance of a board.
+         *
+         * \param board The board's index (0 .. getNumberOfBoards()-1).
+         *
+         * \return The instance or nullptr if the index is invalid.
+         */
+        easyfpga_ptr getEasyFpga(uint32_t board);
+
+        /**
+         * \brief Returns the serial device of a board or an empty
+         *        string if the index is invalid.
+         */
+        std::string getDevicePath(uint32_t board);
+
+        /**
+         * \brief Returns the serial number stored in a board or 0 if it
+         *        couldn't be read or the index is invalid.
+         */
+        uint32_t getSerialNumber(uint32_t board);
+
+        /**
+         * \brief Queues a job for a board without waiting for it.
+         *
+         * \param board The board's index (0 .. getNumberOfBoards()-1).
+         *
+         * \param job The operation to execute by the board's executor
+         *        thread.
+         *
+         * \return A future delivering the result of the job. For an
+         *         invalid index the result is false.
+         */
+        std::future<bool> submit(uint32_t board, Job job);
+
+        /**
+         * \brief Executes a job on all boards in parallel and waits for
+         *        its completion.
+         *
+         * \return true if the job was successful for every board,<br>
+         *         false otherwise (or if no board is connected)
+         */
+        bool runOnAllBoards(Job job);
+
+        /**
+         * \brief Uploads a binary to all boards in parallel and
+         *        instantiates their cores.
+         *
+         * See EasyFpga::uploadBinaryFile() and
+         * EasyFpga::instantiateCores().
+         *
+         * \return true if all boards could be initialized,<br>
+         *         false otherwise
+         */
+        bool uploadBinaryFile(std::string pathToBinary);
+
+        /**
+         * \brief Returns the statistics since connectAll() or the last
+         *        resetStatistics() call.
+         */
+        Statistics getStatistics(void);
+
+        /**
+         * \brief Restarts collecting the statistics.
+         */
+        void resetStatistics(void);
+
+    private:
+        /**
+         * A connected board together with its executor thread.
+         */
+        struct Board {
+            std::string devicePath;
+            uint32_t serialNumber;
+            easyfpga_ptr fpga;
+
+            std::thread executor;
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<std::packaged_task<bool()>> jobs;
+            bool stopRequested;
+
+            std::atomic<uint64_t> finishedJobs;
+            std::atomic<uint64_t> failedJobs;
+            std::atomic<uint64_t> busyTimeus;
+
+            /* counter values at the last resetStatistics() call */
+            uint64_t sentBytesOffset;
+            uint64_t receivedBytesOffset;
+        };
+
+        /**
+         * Processes the jobs of a board until stopRequested is set.
+         */
+        static void executeJobs(Board* board);
+
+        EasyFpgaFactory _factory;
+
+        std::vector<std::unique_ptr<Board>> _boards;
+
+        std::chrono::steady_clock::time_point _statisticsStart;
+};
+
+#endif  // SDK_BOARDMANAGER_H_
@@ -19,22 +19,22 @@
  *
  */
 
-#ifndef SDK_COMMUNICATION_PROTOCOL_FRAME_PTR_H_
-#define SDK_COMMUNICATION_PROTOCOL_FRAME_PTR_H_
+#ifndef SDK_BOARDMANAGER_PTR_H_
+#define SDK_BOARDMANAGER_PTR_H_
 
 /**
- * \file src/communication/protocol/frame_ptr.h
+ * \file src/boardmanager_ptr.h
  *
- * \brief Defines a shared pointer of Frame
+ * \brief Defines a shared pointer of BoardManager
  */
 
-#include "communication/protocol/frame_fwd.h"
+#include "boardmanager_fwd.h"
 
 #include <memory>
 
 /**
- * \brief Defines a shared pointer of Frame
+ * \brief Defines a shared pointer of BoardManager
  */
-typedef std::shared_ptr<Frame> frame_ptr;
+typedef std::shared_ptr<BoardManager> boardmanager_ptr;
 
-#endif  // SDK_COMMUNICATION_PROTOCOL_FRAME_PTR_H_
+#endif  // SDK_BOARDMANAGER_PTR_H_
@@ -38,7 +38,7 @@ AsyncTask::~AsyncTask()
 
 void AsyncTask::executeSend(void)
 {
-    this->send();
+    this->send(true);
 }
 
 void AsyncTask::executeReceive(void)
@@ -46,3 +46,16 @@ void AsyncTask::executeReceive(void)
     assert(_sendState == Task::SEND_STATE::SEND_SUCCESS);
     this->receive();
 }
+
+void AsyncTask::executeReceive(byte* header, uint16_t headerLength)
+{
+    assert(_sendState == Task::SEND_STATE::SEND_SUCCESS);
+    this->receive(header, headerLength);
+}
+
+void AsyncTask::markReplyAsLost(void)
+{
+    assert(_sendState == Task::SEND_STATE::SEND_SUCCESS);
+    _receiveState = Task::RECEIVE_STATE::RECEIVE_CONNECTION_ERROR;
+    this->traceReply(NULL, 0);
+}
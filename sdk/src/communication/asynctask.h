@@ -27,6 +27,7 @@
 #include "communication/task.h"
 #include "communication/types.h"
 #include "easycores/types.h"
+#include "utils/hardwaretypes.h"
 
 #include <string>
 
@@ -45,6 +46,10 @@ class AsyncTask : public Task
         /**
          * \brief Send a asynchronous request specified by the pointer to
          *        an Exchange.
+         *
+         * The request will be appended to the send buffer of the serial
+         * connection. It leaves the buffer together with the following
+         * requests, at the latest before the next reply is received.
          */
         void executeSend(void);
 
@@ -53,6 +58,26 @@ class AsyncTask : public Task
          *        to an Exchange.
          */
         void executeReceive(void);
+
+        /**
+         * \brief Receives the rest of an asynchronous reply whose
+         *        opcode and id were already fetched by the TaskExecutor.
+         *
+         * \param header Points to the already received bytes.
+         *
+         * \param headerLength Number of bytes header points to.
+         */
+        void executeReceive(byte* header, uint16_t headerLength);
+
+        /**
+         * \brief Marks the reply of this task as lost.
+         *
+         * The TaskExecutor calls this if no reply (or no reply with a
+         * matching id) arrived for this task in time. Afterwards, the
+         * task will be handled like any other task with a receive
+         * error, i.e. it will be retried.
+         */
+        void markReplyAsLost(void);
 };
 
 #endif  // SDK_COMMUNICATION_ASYNCTASK_H_
@@ -0,0 +1,84 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/utils/benchmark/benchmark.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+
+#include <string>
+#include <vector>
+
+/* size of a spartan-6 lx9 bitstream */
+static const uint32_t BINARY_SIZE = 340604;
+
+/**
+ * \brief Measures the sector write exchanges of a binary upload
+ *
+ * The whole binary is written to the simulated mcu, once without and
+ * once with the latency of a 3 Mbaud serial line.
+ */
+class BinaryUploadBenchmark : public Benchmark
+{
+    std::string benchmarkName(void) {
+        return "binary upload benchmark";
+    }
+
+    bool benchmarkMethod(void) {
+        BoardSimulator board;
+
+        Communicator com(nullptr);
+        if (!board.start() || !com.initWithDevice(board.getDevice())) {
+            EASYFPGA_LOG(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+
+        std::vector<byte> binary(BINARY_SIZE);
+        for (uint32_t i=0; i<BINARY_SIZE; i++) {
+            binary[i] = (byte)(i * 31 + (i >> 9));
+        }
+
+        this->setRepetitions(2, 20);
+        bool success = true;
+
+        success &= this->measure("upload", 1, BINARY_SIZE, [&com, &binary] {
+            return com.writeBinary(binary.data(), binary.size());
+        });
+
+        board.setLatency(0, 3000000);
+        this->setRepetitions(0, 3);
+
+        success &= this->measure("upload_3mbaud", 1, BINARY_SIZE, [&com, &binary] {
+            return com.writeBinary(binary.data(), binary.size());
+        });
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    BinaryUploadBenchmark benchmark;
+    return benchmark.runBenchmark(argc, argv);
+}
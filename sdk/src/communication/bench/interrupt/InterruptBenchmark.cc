@@ -0,0 +1,125 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/gpio/gpio8.h"
+#include "easyfpga/easycores/gpio/gpio8_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedgpio8.h"
+#include "easyfpga/utils/benchmark/benchmark.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/time_helper.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+static std::atomic<uint32_t> handledInterrupts(0);
+
+static void gpioCallback(void)
+{
+    handledInterrupts++;
+}
+
+/**
+ * \brief An easyFPGA with a single Gpio8 core
+ */
+class GpioFpga : public EasyFpga
+{
+    public:
+        GpioFpga() :
+            gpio(std::make_shared<Gpio8>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(gpio);
+        }
+
+        gpio8_ptr gpio;
+};
+
+/**
+ * \brief Measures the interrupt dispatch latency
+ *
+ * A rising edge at a simulated gpio pin triggers an interrupt. The time
+ * until EasyFpga::handleReplies() executed the gpio's callback is
+ * measured, including the re-enabling of the interrupts.
+ */
+class InterruptBenchmark : public Benchmark
+{
+    std::string benchmarkName(void) {
+        return "interrupt benchmark";
+    }
+
+    bool dispatchInterrupt(GpioFpga& fpga, SimulatedGpio8& model) {
+        model.setInputs(0x00);
+        if (!fpga.gpio->clearInterrupts() || !fpga.enableInterrupts()) {
+            return false;
+        }
+
+        uint32_t expected = handledInterrupts + 1;
+        timevalue timeout = getMonotonicTimeInNanos() + 1000000000;
+
+        model.setInputs(0x01);
+        while (handledInterrupts < expected) {
+            if (!fpga.handleReplies() || (getMonotonicTimeInNanos() > timeout)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool benchmarkMethod(void) {
+        auto model = std::make_shared<SimulatedGpio8>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        GpioFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            EASYFPGA_LOG(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        bool success = fpga.gpio->registerCallback(gpioCallback);
+        success &= fpga.gpio->makeAllPinsInput();
+        success &= fpga.gpio->enablePinInterrupt(Gpio8::PIN::GPIO0, true);
+        success &= fpga.gpio->releaseInterrupts();
+
+        success &= this->measure("gpio_interrupt", 1, 0, [this, &fpga, &model] {
+            return this->dispatchInterrupt(fpga, *model);
+        });
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    InterruptBenchmark benchmark;
+    return benchmark.runBenchmark(argc, argv);
+}
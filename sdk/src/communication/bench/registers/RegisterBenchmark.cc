@@ -0,0 +1,119 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedregisterfile.h"
+#include "easyfpga/utils/benchmark/benchmark.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+
+#include <memory>
+#include <string>
+
+/* number of async requests sent before their replies are handled */
+static const uint32_t ASYNC_BATCH = 64;
+
+static const uint8_t TRANSFER_LENGTHS[] = { 1, 4, 16, 64, 128, 255 };
+
+/**
+ * \brief Measures the register exchanges of the Communicator
+ *
+ * Single register reads and writes are measured in sync mode and as
+ * batches of async requests. Multi register and auto address increment
+ * transfers are measured for 1 to 255 bytes. The board is simulated
+ * without latency, so the results show the costs of the SDK and the
+ * pseudo terminal.
+ */
+class RegisterBenchmark : public Benchmark
+{
+    std::string benchmarkName(void) {
+        return "register benchmark";
+    }
+
+    void measureTransfers(Communicator& com, byte* buffer) {
+        for (uint8_t length : TRANSFER_LENGTHS) {
+            std::string suffix = "_" + std::to_string((uint32_t)length);
+
+            _success &= this->measure("read_multi" + suffix, 1, length, [&com, buffer, length] {
+                return com.readMultiRegister(buffer, 1, 0x00, length);
+            });
+            _success &= this->measure("read_auto_increment" + suffix, 1, length, [&com, buffer, length] {
+                return com.readAutoAdressIncrementRegister(buffer, 1, 0x00, length);
+            });
+            _success &= this->measure("write_multi" + suffix, 1, length, [&com, buffer, length] {
+                return com.writeMultiRegister(buffer, 1, 0x00, length);
+            });
+            _success &= this->measure("write_auto_increment" + suffix, 1, length, [&com, buffer, length] {
+                return com.writeAutoAdressIncrementRegister(buffer, 1, 0x00, length);
+            });
+        }
+    }
+
+    bool benchmarkMethod(void) {
+        BoardSimulator board;
+        board.addCore(1, std::make_shared<SimulatedRegisterFile>());
+        board.startSoc();
+
+        Communicator com(nullptr);
+        if (!board.start() || !com.initWithDevice(board.getDevice())) {
+            EASYFPGA_LOG(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+
+        byte buffer[256] = { 0x00 };
+        _success = true;
+
+        _success &= this->measure("read_sync", 1, 1, [&com, &buffer] {
+            return com.readRegister(buffer, 1, 0x10);
+        });
+        _success &= this->measure("write_sync", 1, 1, [&com] {
+            return com.writeRegister(0x5A, 1, 0x10);
+        });
+
+        _success &= this->measure("read_async", ASYNC_BATCH, ASYNC_BATCH, [&com, &buffer] {
+            for (uint32_t i=0; i<ASYNC_BATCH; i++) {
+                com.readRegisterAsync(buffer+i, 1, (byte)i, 0);
+            }
+            return com.handleRequestReplies();
+        });
+        _success &= this->measure("write_async", ASYNC_BATCH, ASYNC_BATCH, [&com] {
+            for (uint32_t i=0; i<ASYNC_BATCH; i++) {
+                com.writeRegisterAsync((byte)i, 1, (byte)i, 0);
+            }
+            return com.handleRequestReplies();
+        });
+
+        this->measureTransfers(com, buffer);
+
+        return _success;
+    }
+
+    bool _success;
+};
+
+int main(int argc, char** argv)
+{
+    RegisterBenchmark benchmark;
+    return benchmark.runBenchmark(argc, argv);
+}
@@ -22,6 +22,8 @@
 
 #include "configuration.h"
 #include "communication/communicator.h"
+#include "communication/devicecache.h"
+#include "communication/metrics.h"
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/specification.h"
 #include "communication/serialconnection.h"
@@ -48,26 +50,37 @@
 
 #include <unistd.h> /* usleep() */
 #include <dirent.h> /* low level c directory functions */
-#include <string.h> /* memcpy() */
+#include <string.h> /* memcpy(), memset() */
+
+#include <algorithm> /* min(2), max(2) */
+#include <chrono>
+
+#include <thread>
+#include <vector>
 
 Communicator::Communicator(easycore_map_ptr cores) :
     _target(COM_TARGET::UNDEFINED),
     _connection(std::make_shared<SerialConnection>()),
     _executor(std::make_shared<TaskExecutor>(_connection, cores)),
-    _USB_DEVICE_PATH(ConfigurationFile::getInstance().getUsbDevicesPath()),
-    _USB_DEVICE_IDENTIFIER(ConfigurationFile::getInstance().getUsbDeviceIdentifier())
+    _binaryUploadPipelineDepth(BINARY_UPLOAD_PIPELINE_DEPTH),
+    _binaryUploadStatistics()
 {
-    Log().Get(DEBUG) << "Communicator is not initialized. Connection status is undefined.";
+    EASYFPGA_LOG(DEBUG) << "Communicator is not initialized. Connection status is undefined.";
 }
 
 Communicator::~Communicator()
 {
-    Log().Get(DEBUG) << "Try closing serial connection...";
+    /* a failed init() already closed the device */
+    if (_target == COM_TARGET::UNDEFINED) {
+        return;
+    }
+
+    EASYFPGA_LOG(DEBUG) << "Try closing serial connection...";
     if (_connection->closeDevice()) {
-        Log().Get(DEBUG) << "Close serial connection successful.";
+        EASYFPGA_LOG(DEBUG) << "Close serial connection successful.";
     }
     else {
-        Log().Get(ERROR) << "Can not close serial connection... :-(";
+        EASYFPGA_LOG(ERROR) << "Can not close serial connection... :-(";
     }
 }
 
@@ -76,31 +89,86 @@ bool Communicator::init(uint32_t serial)
     std::pair<std::string, Communicator::COM_TARGET> emptyEasyFpga;
     std::pair<std::string, Communicator::COM_TARGET> device(this->findFirstMatchingEasyFpga(serial));
     if (device != emptyEasyFpga) {
-        Log().Get(DEBUG) << "Try to open " << device.first << " as serial connection...";
+        EASYFPGA_LOG(DEBUG) << "Try to open " << device.first << " as serial connection...";
         if (_connection->openDevice(device.first)) {
             _connection->flushBuffers();
 
             _target = device.second;
             if (_target == COM_TARGET::MCU) {
-                Log().Get(DEBUG) << "Communicator now connected to mcu.";
+                EASYFPGA_LOG(DEBUG) << "Communicator now connected to mcu.";
                 return true;
             }
             else if (_target == COM_TARGET::SOC) {
-                Log().Get(DEBUG) << "Communicator now connected to soc.";
+                EASYFPGA_LOG(DEBUG) << "Communicator now connected to soc.";
                 return true;
             }
             else {
-                Log().Get(ERROR) << "Could not connect to mcu or soc.";
+                EASYFPGA_LOG(ERROR) << "Could not connect to mcu or soc.";
+                _target = COM_TARGET::UNDEFINED;
+                _connection->closeDevice();
             }
         }
     }
     else {
-        Log().Get(WARNING) << "No matching easyFpga found. Communicator not connected to any easyFPGA.";
+        EASYFPGA_LOG(WARNING) << "No matching easyFpga found. Communicator not connected to any easyFPGA.";
     }
 
     return false;
 }
 
+bool Communicator::initWithDevice(std::string devicePath)
+{
+    EASYFPGA_LOG(DEBUG) << "Try to open " << devicePath << " as serial connection...";
+    if (!_connection->openDevice(devicePath)) {
+        return false;
+    }
+
+    _connection->flushBuffers();
+
+    _target = this->testDeviceResponseBehavior();
+    if (_target == COM_TARGET::MCU) {
+        EASYFPGA_LOG(DEBUG) << "Communicator now connected to mcu.";
+        return true;
+    }
+    else if (_target == COM_TARGET::SOC) {
+        EASYFPGA_LOG(DEBUG) << "Communicator now connected to soc.";
+        return true;
+    }
+
+    EASYFPGA_LOG(DEBUG) << "No mcu or soc specific bytes received. " << devicePath << " isnt a easyFPGA...";
+    _target = COM_TARGET::UNDEFINED;
+    _connection->closeDevice();
+
+    return false;
+}
+
+std::list<std::string> Communicator::findSerialDevices(void)
+{
+    std::list<std::string> devices;
+
+    std::string dir(ConfigurationFile::getInstance().getUsbDevicesPath());
+    std::string identifier(ConfigurationFile::getInstance().getUsbDeviceIdentifier());
+
+    DIR* dp = opendir(dir.c_str());
+    if (dp == NULL) {
+        EASYFPGA_LOG(ERROR) << "Error while opening " << dir;
+        return devices;
+    }
+
+    struct dirent* dirp = readdir(dp);
+    while (dirp != NULL) {
+        std::string devicename = std::string(dirp->d_name);
+        if (devicename.find(identifier) != std::string::npos) {
+            devices.push_back(dir + devicename);
+        }
+        dirp = readdir(dp);
+    }
+
+    closedir(dp);
+
+    return devices;
+}
+
 bool Communicator::configureFpga(void)
 {
     if (!this->switchTo(COM_TARGET::MCU)) {
@@ -110,54 +178,111 @@ bool Communicator::configureFpga(void)
     return _executor->doSyncTask(std::string("configureFpga"), std::make_shared<ConfigureFpga>(nullptr));
 }
 
-bool Communicator::writeBinary(byte* binary, uint64_t binaryLength)
+bool Communicator::writeBinary(const byte* binary, uint64_t binaryLength)
+{
+    return this->writeBinary(binary, binaryLength, std::vector<bool>());
+}
+
+bool Communicator::writeBinary(const byte* binary, uint64_t binaryLength, const std::vector<bool>& sectorMask)
 {
+    if (!this->switchTo(COM_TARGET::MCU)) {
+        return false;
+    }
+
     /*
      * First, we have to know whether the binary fits exactly into an
      * integer multiple of 4096 bytes. If not, we have to add an
      * additional sector which will filled with the remaining bytes and
-     * the remainder with null-bytes (see send loop below).
+     * the remainder with null-bytes.
      */
     uint32_t byteCountofLastSector = binaryLength % 4096;
-    Log().Get(DEBUG) << "Number of bytes in last sector: " << (int32_t)byteCountofLastSector;
+    EASYFPGA_LOG(DEBUG) << "Number of bytes in last sector: " << (int32_t)byteCountofLastSector;
 
     uint32_t numOf4096ByteSectors = binaryLength / 4096;
+    byte lastSector[4096];
     if (byteCountofLastSector != 0) {
+        memcpy(lastSector, binary + (uint64_t)numOf4096ByteSectors*4096, byteCountofLastSector);
+        memset(lastSector + byteCountofLastSector, 0x00, 4096 - byteCountofLastSector);
         numOf4096ByteSectors++;
     }
 
-    /* Write sector loop */
-    byte* array = binary;
-    uint32_t i;
-    for (i=0; i<numOf4096ByteSectors; i++) {
-        Log().Get(DEBUG) << "Write sector " << (int32_t)(i+1) << "/" << (int32_t)numOf4096ByteSectors;
-
-        if (i == (numOf4096ByteSectors-1)) {
-            byte rest[4096];
-            memcpy(rest, array, byteCountofLastSector);
-            uint32_t j;
-            for (j=byteCountofLastSector; j<4096; j++) {
-                rest[j] = (byte)0x00;
-            }
-            array = rest;
+    /* the sectors refer to the binary, so nothing will be copied */
+    std::vector<exchange_ptr> sectors;
+    sectors.reserve(numOf4096ByteSectors);
+    for (uint32_t i=0; i<numOf4096ByteSectors; i++) {
+        if ((i < sectorMask.size()) && !sectorMask[i]) {
+            continue;
         }
+        const byte* sector = ((byteCountofLastSector != 0) && (i == numOf4096ByteSectors-1)) ? lastSector : binary + (uint64_t)i*4096;
+        sectors.push_back(std::make_shared<Sector4096ByteWrite>(i, sector, nullptr));
+    }
 
-        if (!_executor->doSyncTask(std::string("write4096ByteSector"), std::make_shared<Sector4096ByteWrite>(i, array, nullptr))) {
-            Log().Get(WARNING) << "Aborting binary upload...";
-            return false;
-        }
+    std::vector<uint32_t> latencies;
+    auto start = std::chrono::steady_clock::now();
 
-        array += 4096;
+    if (!_executor->doSyncTaskPipeline(std::string("write4096ByteSector"), sectors, _binaryUploadPipelineDepth, &latencies)) {
+        EASYFPGA_LOG(WARNING) << "Aborting binary upload...";
+        return false;
     }
 
+    _binaryUploadStatistics.sectors = sectors.size();
+    _binaryUploadStatistics.skippedSectors = numOf4096ByteSectors - sectors.size();
+    _binaryUploadStatistics.durationus = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    _binaryUploadStatistics.minimumSectorLatencyus = 0;
+    _binaryUploadStatistics.averageSectorLatencyus = 0;
+    _binaryUploadStatistics.maximumSectorLatencyus = 0;
+
+    if (!latencies.empty()) {
+        uint64_t sum = 0;
+        _binaryUploadStatistics.minimumSectorLatencyus = latencies[0];
+        for (uint32_t latency : latencies) {
+            sum += latency;
+            _binaryUploadStatistics.minimumSectorLatencyus = std::min(_binaryUploadStatistics.minimumSectorLatencyus, latency);
+            _binaryUploadStatistics.maximumSectorLatencyus = std::max(_binaryUploadStatistics.maximumSectorLatencyus, latency);
+        }
+        _binaryUploadStatistics.averageSectorLatencyus = sum / latencies.size();
+    }
+
+    EASYFPGA_LOG(INFO) << "Binary upload: " << std::dec << _binaryUploadStatistics.sectors << " sectors ("
+        << _binaryUploadStatistics.skippedSectors << " unchanged skipped) in "
+        << _binaryUploadStatistics.durationus / 1000 << " ms ("
+        << _binaryUploadStatistics.getMegabytesPerSecond() << " MB/s, pipeline depth " << _binaryUploadPipelineDepth << ")";
+    EASYFPGA_LOG(INFO) << "Sector latency: min " << _binaryUploadStatistics.minimumSectorLatencyus
+        << " us, avg " << _binaryUploadStatistics.averageSectorLatencyus
+        << " us, max " << _binaryUploadStatistics.maximumSectorLatencyus << " us";
+
     /*
      * If the execution flow reaches this point, the binary writing was
      * succcessful.
      */
-    Log().Get(DEBUG) << "Writing binary successful.";
+    EASYFPGA_LOG(DEBUG) << "Writing binary successful.";
     return true;
 }
 
+void Communicator::setBinaryUploadPipelineDepth(uint32_t depth)
+{
+    _binaryUploadPipelineDepth = (depth < 1) ? 1 : depth;
+}
+
+uint32_t Communicator::getBinaryUploadPipelineDepth(void)
+{
+    return _binaryUploadPipelineDepth;
+}
+
+Communicator::BinaryUploadStatistics Communicator::getBinaryUploadStatistics(void)
+{
+    return _binaryUploadStatistics;
+}
+
+double Communicator::BinaryUploadStatistics::getMegabytesPerSecond(void) const
+{
+    if (durationus == 0) {
+        return 0.0;
+    }
+
+    return (double)sectors * 4096.0 / (double)durationus;
+}
+
 bool Communicator::writeSerial(uint32_t serial)
 {
     if (!this->switchTo(COM_TARGET::MCU)) {
@@ -462,37 +587,64 @@ uint32_t Communicator::getNumberOfPendingAsyncRequests(void)
     return _executor->getNumberOfPendingRequests() + _executor->getNumberOfFinishedRequests();
 }
 
+bool Communicator::flushAsyncRequests(void)
+{
+    return _executor->flushRequests();
+}
+
+void Communicator::beginRequestBatch(void)
+{
+    _executor->beginRequestBatch();
+}
+
+bool Communicator::finishRequestBatch(void)
+{
+    return _executor->finishRequestBatch();
+}
+
+uint64_t Communicator::getNumberOfSentBytes(void)
+{
+    return _connection->getNumberOfSentBytes();
+}
+
+uint64_t Communicator::getNumberOfReceivedBytes(void)
+{
+    return _connection->getNumberOfReceivedBytes();
+}
+
 bool Communicator::switchTo(COM_TARGET target)
 {
     if ((_target == COM_TARGET::SOC) && (target == COM_TARGET::MCU)) {
-        Log().Get(DEBUG) << "Switch to mcu...";
+        EASYFPGA_LOG(DEBUG) << "Switch to mcu...";
         if (_executor->doSyncTask(std::string("selectMCU"), std::make_shared<SelectMcu>(nullptr))) {
             _target = COM_TARGET::MCU;
-            Log().Get(DEBUG) << "Let the hardware " << (int32_t)WAITING_TIME_AFTER_SWITCH << "us time to do this...";
+            Metrics::getInstance().countContextSwitch();
+            EASYFPGA_LOG(DEBUG) << "Let the hardware " << (int32_t)WAITING_TIME_AFTER_SWITCH << "us time to do this...";
             usleep(WAITING_TIME_AFTER_SWITCH);
             _connection->flushBuffers();
             return true;
         }
-        Log().Get(WARNING) << "No success in switching to mcu!";
+        EASYFPGA_LOG(WARNING) << "No success in switching to mcu!";
     }
     else if ((_target == COM_TARGET::MCU) && (target == COM_TARGET::SOC)) {
-        Log().Get(DEBUG) << "Switch to soc...";
+        EASYFPGA_LOG(DEBUG) << "Switch to soc...";
         if (_executor->doSyncTask(std::string("selectSOC"), std::make_shared<SelectSoc>(nullptr))) {
             _target = COM_TARGET::SOC;
-            Log().Get(DEBUG) << "Let the hardware " << (int32_t)WAITING_TIME_AFTER_SWITCH << "us time to do this...";
+            Metrics::getInstance().countContextSwitch();
+            EASYFPGA_LOG(DEBUG) << "Let the hardware " << (int32_t)WAITING_TIME_AFTER_SWITCH << "us time to do this...";
             usleep(WAITING_TIME_AFTER_SWITCH);
             _connection->flushBuffers();
             return true;
         }
-        Log().Get(WARNING) << "No success in switching to soc!";
+        EASYFPGA_LOG(WARNING) << "No success in switching to soc!";
     }
     else if (((_target == COM_TARGET::SOC) && (target == COM_TARGET::SOC)) ||
              ((_target == COM_TARGET::MCU) && (target == COM_TARGET::MCU))) {
-        Log().Get(DEBUG) << "No context switch necessary...";
+        EASYFPGA_LOG(DEBUG) << "No context switch necessary...";
         return true;
     }
 
-    Log().Get(ERROR) << "Parameters for switching were inconsistent!";
+    EASYFPGA_LOG(ERROR) << "Parameters for switching were inconsistent!";
     return false;
 }
 
@@ -500,78 +652,109 @@ std::pair<std::string, Communicator::COM_TARGET> Communicator::findFirstMatching
 {
     std::pair<std::string, Communicator::COM_TARGET> easyFpga;
 
-    std::string dir(_USB_DEVICE_PATH);
-    DIR* dp = opendir(dir.c_str());
+    if (serialNumber > 0) {
+        EASYFPGA_LOG(DEBUG) << "Search for an easyFPGA with serial " << (uint32_t)serialNumber << "...";
+    }
+    else {
+        EASYFPGA_LOG(DEBUG) << "Search for an easyFPGA without a specific serial...";
+    }
 
-    if (dp != NULL) {
-        if (serialNumber > 0) {
-            Log().Get(DEBUG) << "Search for an easyFPGA with serial " << (uint32_t)serialNumber << "...";
-        }
-        else {
-            Log().Get(DEBUG) << "Search for an easyFPGA without a specific serial...";
+    DeviceCache cache(ConfigurationFile::getInstance().getDeviceCacheFile());
+
+    /* a known board needs only one probe */
+    std::string cachedDevice;
+    if ((serialNumber > 0) && cache.lookup(serialNumber, &cachedDevice)) {
+        ProbeResult probe;
+        probe.devicePath = cachedDevice;
+        Communicator::probeDevice(&probe, true);
+
+        if ((probe.target != COM_TARGET::UNDEFINED) && probe.serialRead && (probe.serial == serialNumber)) {
+            EASYFPGA_LOG(DEBUG) << "easyFPGA 0x" << std::hex << serialNumber << " found at cached device " << cachedDevice;
+            return std::make_pair(probe.devicePath, probe.target);
         }
 
-        bool easyFpgaFound = false;
-        uint32_t serial;
+        EASYFPGA_LOG(DEBUG) << "easyFPGA 0x" << std::hex << serialNumber << " isn't at cached device " << cachedDevice << " any more. Scan all devices...";
+        cache.remove(serialNumber);
+    }
+
+    /*
+     * Probe all devices concurrently, so that their detect timeouts
+     * and the waiting times for configuring mcus overlap.
+     */
+    std::list<std::string> devices(Communicator::findSerialDevices());
+    std::vector<ProbeResult> probes(devices.size());
+    std::vector<std::thread> probers;
+
+    uint32_t i = 0;
+    for (std::string device : devices) {
+        EASYFPGA_LOG(DEBUG) << "Try " << device << "...";
+        probes[i].devicePath = device;
+        probers.push_back(std::thread(&Communicator::probeDevice, &probes[i], (serialNumber > 0)));
+        i++;
+    }
 
-        struct dirent* dirp = readdir(dp);
-        while ((dirp != NULL) && !easyFpgaFound) {
-            std::string devicename = std::string(dirp->d_name);
-            if (devicename.find(_USB_DEVICE_IDENTIFIER) != std::string::npos) {
-                std::string filename(dir);
-                filename.append(devicename);
+    for (std::thread& prober : probers) {
+        prober.join();
+    }
 
-                Log().Get(DEBUG) << "Try " << filename << "...";
-                _connection->openDevice(filename);
-                _connection->flushBuffers();
+    /* keep the directory order for choosing the first match */
+    for (ProbeResult& probe : probes) {
+        if (probe.target == COM_TARGET::UNDEFINED) {
+            EASYFPGA_LOG(DEBUG) << "No mcu or soc specific bytes received. " << probe.devicePath << " isnt a easyFPGA...";
+            continue;
+        }
 
-                COM_TARGET t = this->testDeviceResponseBehavior();
-                switch (t) {
-                    case COM_TARGET::UNDEFINED:
-                        Log().Get(DEBUG) << "No mcu or soc specific bytes received. This device isnt a easyFPGA...";
-                        break;
+        EASYFPGA_LOG(DEBUG) << "Mcu / soc specific bytes received; an easyFPGA found at " << probe.devicePath << "!";
 
-                    case COM_TARGET::MCU:
-                    case COM_TARGET::SOC:
-                        Log().Get(DEBUG) << "Mcu / soc specific bytes received; an easyFPGA found!";
-                        if (serialNumber > 0) {
-                            if (this->readSerial(&serial)) {
-                                if (serialNumber == serial) {
-                                    Log().Get(DEBUG) << "Serial read 0x" << std::hex << (uint32_t)serial << " matches required serial!";
-                                    easyFpga = std::make_pair(filename, t);
-                                    easyFpgaFound = true;
-                                }
-                                else {
-                                    Log().Get(DEBUG) << "Serial read 0x" << std::hex << (uint32_t)serial << " doesnt match required serial...";
-                                }
-                            }
-                            else {
-                                Log().Get(WARNING) << "Serial of found easyFPGA is not readable...";
-                            }
-                        } else {
-                            easyFpga = std::make_pair(filename, t);
-                            easyFpgaFound = true;
-                        }
-                        break;
+        if (probe.serialRead) {
+            cache.store(probe.serial, probe.devicePath);
+        }
 
-                    default:
-                        Log().Get(WARNING) << "Function testDeviceResponseBehavior() returned a invalid value.";
-                        break;
-                }
-                _connection->closeDevice();
+        if (easyFpga.first.empty()) {
+            if (serialNumber == 0) {
+                easyFpga = std::make_pair(probe.devicePath, probe.target);
+            }
+            else if (!probe.serialRead) {
+                EASYFPGA_LOG(WARNING) << "Serial of found easyFPGA is not readable...";
+            }
+            else if (probe.serial == serialNumber) {
+                EASYFPGA_LOG(DEBUG) << "Serial read 0x" << std::hex << (uint32_t)probe.serial << " matches required serial!";
+                easyFpga = std::make_pair(probe.devicePath, probe.target);
+            }
+            else {
+                EASYFPGA_LOG(DEBUG) << "Serial read 0x" << std::hex << (uint32_t)probe.serial << " doesnt match required serial...";
             }
-            dirp = readdir(dp);
         }
     }
-    else {
-        Log().Get(ERROR) << "Error while opening " << dir;
-    }
 
-    closedir(dp);
+    cache.save();
 
     return easyFpga;
 }
 
+void Communicator::probeDevice(ProbeResult* result, bool readSerial)
+{
+    result->target = COM_TARGET::UNDEFINED;
+    result->serialRead = false;
+    result->serial = 0;
+
+    Communicator com(nullptr);
+    if (!com.initWithDevice(result->devicePath)) {
+        return;
+    }
+
+    /*
+     * Reading the serial of a running soc requires switching to the
+     * mcu, so it's done only if the serial matters. The returned target
+     * is the one after switching.
+     */
+    if (readSerial || (com._target == COM_TARGET::MCU)) {
+        result->serialRead = com.readSerial(&result->serial);
+    }
+
+    result->target = com._target;
+}
+
 Communicator::COM_TARGET Communicator::testDeviceResponseBehavior()
 {
     COM_TARGET target = COM_TARGET::UNDEFINED;
@@ -598,7 +781,7 @@ Communicator::COM_TARGET Communicator::testDeviceResponseBehavior()
                     case (byte)0x33:
                         target = COM_TARGET::MCU_CONF;
 
-                        Log().Get(DEBUG) << "Mcu is configuring. Wait " << (int32_t)(WAITING_TIME_BETWEEN_DETECT_REQUESTS/1000) << "ms and then test device again...";
+                        EASYFPGA_LOG(DEBUG) << "Mcu is configuring. Wait " << (int32_t)(WAITING_TIME_BETWEEN_DETECT_REQUESTS/1000) << "ms and then test device again...";
                         usleep(WAITING_TIME_BETWEEN_DETECT_REQUESTS);
                         break;
 
@@ -31,8 +31,10 @@
 #include "easycores/types.h"
 #include "utils/hardwaretypes.h"
 
+#include <list>
 #include <utility> /* pair<2> */
 #include <string>
+#include <vector>
 
 /**
  * \brief Provides an interface and implements the entire high level
@@ -62,6 +64,30 @@
 class Communicator
 {
     public:
+        /**
+         * \brief Throughput and timing of a binary upload.
+         */
+        struct BinaryUploadStatistics {
+            /** number of written 4096 byte sectors */
+            uint32_t sectors;
+
+            /** number of sectors left out because they didn't change */
+            uint32_t skippedSectors;
+
+            /** duration of the whole upload */
+            uint64_t durationus;
+
+            /** time between sending a sector and its acknowledgement */
+            uint32_t minimumSectorLatencyus;
+            uint32_t averageSectorLatencyus;
+            uint32_t maximumSectorLatencyus;
+
+            /**
+             * \brief Returns the upload speed in MB/s (10^6 bytes).
+             */
+            double getMegabytesPerSecond(void) const;
+        };
+
         /**
          * \brief Creates a Communicator instance.
          *
@@ -84,6 +110,28 @@ class Communicator
          */
         bool init(uint32_t serial);
 
+        /**
+         * \brief Connect the Communicator to the easyFPGA hardware device
+         *        at the given path without searching for it.
+         *
+         * \param devicePath The serial device, e.g. one returned by
+         *         findSerialDevices().
+         *
+         * \return true if the device behaves like an easyFPGA and the
+         *         connection could be established,\n
+         *         false otherwise
+         */
+        bool initWithDevice(std::string devicePath);
+
+        /**
+         * \brief Lists all serial devices which could be an easyFPGA,
+         *        i.e. the devices in \c USB_DEVICE_PATH whose names
+         *        contain the \c USB_DEVICE_IDENTIFIER.
+         *
+         * \return The device paths in directory order (possibly empty).
+         */
+        static std::list<std::string> findSerialDevices(void);
+
         /**
          * \brief Overrides the serial stored in the easyFPGA.
          *
@@ -115,13 +163,55 @@ class Communicator
         /**
          * \brief Uploads a binary to a non volatile memory of the mcu.
          *
+         * The sectors are pipelined: the next ones are sent while the
+         * mcu is still storing the previous one (see
+         * setBinaryUploadPipelineDepth()). The achieved throughput will
+         * be logged and is available by getBinaryUploadStatistics().
+         *
          * \param binary Points to the beginning of an byte array which contains the whole binary.
          * \param binaryLength Determines the length of the binary.
          *
          * \return true if the upload process was successful,\n
          *         false otherwise
          */
-        bool writeBinary(byte* binary, uint64_t binaryLength);
+        bool writeBinary(const byte* binary, uint64_t binaryLength);
+
+        /**
+         * \brief Uploads only selected sectors of a binary.
+         *
+         * The other sectors have to contain the same data in the mcu's
+         * memory already, e.g. because they didn't change since the
+         * last upload (see SectorManifest).
+         *
+         * \param binary Points to the beginning of an byte array which contains the whole binary.
+         * \param binaryLength Determines the length of the binary.
+         * \param sectorMask Contains a flag for every 4096 byte sector
+         *        of the binary which is true if the sector has to be
+         *        written. An empty mask writes all sectors.
+         *
+         * \return true if the upload process was successful,\n
+         *         false otherwise
+         */
+        bool writeBinary(const byte* binary, uint64_t binaryLength, const std::vector<bool>& sectorMask);
+
+        /**
+         * \brief Sets how many sectors may be sent during a binary
+         *        upload before the first of them was acknowledged.
+         *
+         * \param depth 1 uploads the sectors one after another. The
+         *        default is BINARY_UPLOAD_PIPELINE_DEPTH.
+         */
+        void setBinaryUploadPipelineDepth(uint32_t depth);
+
+        /**
+         * \brief Returns the number of sectors uploaded in a pipeline.
+         */
+        uint32_t getBinaryUploadPipelineDepth(void);
+
+        /**
+         * \brief Returns the statistics of the last writeBinary() call.
+         */
+        BinaryUploadStatistics getBinaryUploadStatistics(void);
 
         /**
          * \brief Writes a new status to the easyFPGA.
@@ -177,6 +267,53 @@ class Communicator
         bool handleRequestReplies(void);
         uint32_t getNumberOfPendingAsyncRequests(void);
 
+        /**
+         * \brief Writes all buffered asynchronous requests immediately.
+         *
+         * Asynchronous requests are collected and sent together, at the
+         * latest when their replies are handled. Call this method if the
+         * easyFPGA should process them earlier.
+         *
+         * \return true if all buffered requests could be written,\n
+         *         false otherwise
+         */
+        bool flushAsyncRequests(void);
+
+        /**
+         * \brief Starts a batch of asynchronous requests which belong to
+         *        a single synchronous operation.
+         *
+         * Used by the cores for sync methods built from several async
+         * requests. Batches may be nested, e.g. by sync methods called
+         * from a callback while another batch is in flight.
+         */
+        void beginRequestBatch(void);
+
+        /**
+         * \brief Waits for the replies of all requests started since
+         *        beginRequestBatch() and writes back their results.
+         *
+         * Unlike handleRequestReplies(), results of other outstanding
+         * requests stay pending. Their callbacks might be executed,
+         * though, if their replies arrive in between.
+         *
+         * \return true if all requests of the batch were successful,\n
+         *         false otherwise
+         */
+        bool finishRequestBatch(void);
+
+        /**
+         * \brief Returns the number of bytes sent to the easyFPGA since
+         *        the connection was established.
+         */
+        uint64_t getNumberOfSentBytes(void);
+
+        /**
+         * \brief Returns the number of bytes received from the easyFPGA
+         *        since the connection was established.
+         */
+        uint64_t getNumberOfReceivedBytes(void);
+
     private:
         /**
          * Define all possible communicating states of an easyFPGA.
@@ -219,6 +356,10 @@ class Communicator
          */
         taskexecutor_ptr _executor;
 
+        /* binary upload */
+        uint32_t _binaryUploadPipelineDepth;
+        BinaryUploadStatistics _binaryUploadStatistics;
+
         /**
          * \brief A helper function for switching to the desired context.
          *        This inline function reduces the lines of code heavily.
@@ -244,6 +385,10 @@ class Communicator
          * returned by this method with has exactly stored the given
          * serial number.
          *
+         * A serial number remembered in the DeviceCache will be validated
+         * by probing only the cached device. All other searches probe
+         * every serial device concurrently and update the cache.
+         *
          * \param serialNumber Possible values are all integers between
          *        0 and UINT32_MAX (specified in <cstdint>).
          *
@@ -272,12 +417,22 @@ class Communicator
          */
         inline COM_TARGET testDeviceResponseBehavior();
 
-        /*
-         * Two constants which will be instantiated in the constructor
-         * by parsing the configuration file.
+        /**
+         * \brief The outcome of probing one serial device.
+         */
+        struct ProbeResult {
+            std::string devicePath;
+            COM_TARGET target;
+            bool serialRead;
+            uint32_t serial;
+        };
+
+        /**
+         * \brief Checks with an own connection whether the device at
+         *        result->devicePath is an easyFPGA and reads its serial
+         *        if desired. Several probes may run concurrently.
          */
-        const std::string _USB_DEVICE_PATH;
-        const std::string _USB_DEVICE_IDENTIFIER;
+        static void probeDevice(ProbeResult* result, bool readSerial);
 };
 
 #endif  // SDK_COMMUNICATION_COMMUNICATOR_H_
@@ -0,0 +1,196 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "communication/devicecache.h"
+#include "utils/log/log.h"
+
+#include <cstdio> /* rename(2) */
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h> /* opendir(), readdir() */
+#include <limits.h> /* PATH_MAX */
+#include <stdlib.h> /* realpath() */
+#include <unistd.h> /* getpid() */
+
+/* directory of the persistent device links created by udev */
+static const std::string UDEV_DEVICE_DIRECTORY("/dev/serial/by-id/");
+
+/*
+ * Returns the canonical path of a device or an empty string if it
+ * doesn't exist.
+ */
+static std::string resolve(std::string path)
+{
+    char resolved[PATH_MAX+1];
+
+    if (realpath(path.c_str(), resolved) != NULL) {
+        return std::string(resolved);
+    }
+
+    return std::string();
+}
+
+DeviceCache::DeviceCache(std::string fileName) :
+    _fileName(fileName),
+    _modified(false)
+{
+    this->load();
+}
+
+DeviceCache::~DeviceCache()
+{
+}
+
+bool DeviceCache::lookup(uint32_t serial, std::string* devicePath)
+{
+    auto entry = _entries.find(serial);
+    if (entry == _entries.end()) {
+        return false;
+    }
+
+    if (!entry->second.udevName.empty()) {
+        std::string udevDevice(resolve(UDEV_DEVICE_DIRECTORY + entry->second.udevName));
+        if (!udevDevice.empty()) {
+            *devicePath = udevDevice;
+            return true;
+        }
+    }
+
+    *devicePath = entry->second.devicePath;
+    return true;
+}
+
+void DeviceCache::store(uint32_t serial, std::string devicePath)
+{
+    Entry entry;
+    entry.devicePath = devicePath;
+    entry.udevName = DeviceCache::findUdevName(devicePath);
+
+    auto old = _entries.find(serial);
+    if ((old != _entries.end()) && (old->second.devicePath == entry.devicePath) && (old->second.udevName == entry.udevName)) {
+        return;
+    }
+
+    _entries[serial] = entry;
+    _modified = true;
+}
+
+void DeviceCache::remove(uint32_t serial)
+{
+    if (_entries.erase(serial) > 0) {
+        _modified = true;
+    }
+}
+
+bool DeviceCache::save(void)
+{
+    if (_fileName.empty() || !_modified) {
+        return true;
+    }
+
+    std::stringstream content;
+    for (auto& entry : _entries) {
+        content << "0x" << std::hex << entry.first << " " << entry.second.devicePath << " "
+                << (entry.second.udevName.empty() ? "-" : entry.second.udevName) << std::endl;
+    }
+
+    /*
+     * Write a temporary file and rename it, so that concurrently
+     * running applications never read a partially written cache.
+     */
+    std::string temporaryName(_fileName + "." + std::to_string(getpid()));
+    std::ofstream file(temporaryName, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        EASYFPGA_LOG(WARNING) << "The device cache " << _fileName << " couldn't be written!";
+        return false;
+    }
+
+    file << content.str();
+    file.close();
+
+    if (file.fail() || (rename(temporaryName.c_str(), _fileName.c_str()) != 0)) {
+        EASYFPGA_LOG(WARNING) << "The device cache " << _fileName << " couldn't be written!";
+        std::remove(temporaryName.c_str());
+        return false;
+    }
+
+    _modified = false;
+    return true;
+}
+
+std::string DeviceCache::findUdevName(std::string devicePath)
+{
+    std::string device(resolve(devicePath));
+    if (device.empty()) {
+        return std::string();
+    }
+
+    std::string udevName;
+
+    DIR* dp = opendir(UDEV_DEVICE_DIRECTORY.c_str());
+    if (dp != NULL) {
+        struct dirent* dirp = readdir(dp);
+        while ((dirp != NULL) && udevName.empty()) {
+            std::string name(dirp->d_name);
+            if ((name != ".") && (name != "..") && (resolve(UDEV_DEVICE_DIRECTORY + name) == device)) {
+                udevName = name;
+            }
+            dirp = readdir(dp);
+        }
+        closedir(dp);
+    }
+
+    return udevName;
+}
+
+void DeviceCache::load(void)
+{
+    if (_fileName.empty()) {
+        return;
+    }
+
+    std::ifstream file(_fileName);
+    if (!file.is_open()) {
+        EASYFPGA_LOG(DEBUG) << "No device cache found at " << _fileName;
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        uint32_t serial;
+        Entry entry;
+
+        if (fields >> std::hex >> serial >> entry.devicePath >> entry.udevName) {
+            if (entry.udevName == "-") {
+                entry.udevName.clear();
+            }
+            _entries[serial] = entry;
+        }
+        else {
+            EASYFPGA_LOG(WARNING) << "Ignoring malformed line in device cache: " << line;
+        }
+    }
+
+    EASYFPGA_LOG(DEBUG) << "Device cache " << _fileName << " contains " << (uint32_t)_entries.size() << " easyFPGAs.";
+}
@@ -0,0 +1,113 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_COMMUNICATION_DEVICECACHE_H_
+#define SDK_COMMUNICATION_DEVICECACHE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * \brief Remembers at which serial device an easyFPGA with a certain
+ *        serial number was found.
+ *
+ * Searching an easyFPGA by its serial requires probing every serial
+ * device of the host. The cache allows to probe only the device
+ * remembered from a former search. Besides the device path, the cache
+ * stores the board's persistent udev name (the link in
+ * /dev/serial/by-id/) if available. So an entry remains valid even if
+ * the operating system numbers the devices differently after a reboot.
+ *
+ * The cache file contains one line per board:
+ * \code
+ * <serial in hex> <device path> <udev name or ->
+ * \endcode
+ *
+ * An entry is only a hint: the caller has to validate it by probing the
+ * device and remove it if the board isn't found there any more.
+ */
+class DeviceCache
+{
+    public:
+        /**
+         * \brief Loads the cache from a file.
+         *
+         * \param fileName The cache file or an empty string for a cache
+         *        which is neither loaded nor saved.
+         */
+        DeviceCache(std::string fileName);
+        ~DeviceCache();
+
+        /**
+         * \brief Returns the remembered device of an easyFPGA.
+         *
+         * \param serial The board's serial number.
+         *
+         * \param devicePath Receives the device path. It is resolved
+         *        by the udev name, if the entry has one.
+         *
+         * \return true if the serial is known,<br>
+         *         false otherwise
+         */
+        bool lookup(uint32_t serial, std::string* devicePath);
+
+        /**
+         * \brief Remembers the device of an easyFPGA.
+         */
+        void store(uint32_t serial, std::string devicePath);
+
+        /**
+         * \brief Forgets an easyFPGA, e.g. because it wasn't found at
+         *        the remembered device.
+         */
+        void remove(uint32_t serial);
+
+        /**
+         * \brief Writes the cache file if any entry changed.
+         *
+         * \return true if the file was written or didn't have to be
+         *         written,<br>
+         *         false otherwise
+         */
+        bool save(void);
+
+    private:
+        struct Entry {
+            std::string devicePath;
+            std::string udevName;
+        };
+
+        /**
+         * Finds the name of the link in /dev/serial/by-id/ pointing to
+         * the given device, or returns an empty string.
+         */
+        static std::string findUdevName(std::string devicePath);
+
+        void load(void);
+
+        std::string _fileName;
+        std::map<uint32_t, Entry> _entries;
+        bool _modified;
+};
+
+#endif  // SDK_COMMUNICATION_DEVICECACHE_H_
@@ -0,0 +1,399 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "configuration.h" /* EXCHANGE_TRACE_RECORDS */
+#include "communication/exchangetrace.h"
+#include "communication/protocol/frame.h"
+#include "utils/config/configurationfile.h"
+#include "utils/log/log.h"
+#include "utils/os/mappedfile.h"
+
+#include <algorithm> /* min(), sort() */
+#include <cerrno>
+#include <cstring> /* memcpy(), memcmp(), strerror() */
+
+#include <fcntl.h> /* open() */
+#include <sys/file.h> /* flock() */
+#include <sys/mman.h> /* mmap(), munmap() */
+#include <sys/stat.h> /* fstat() */
+#include <unistd.h> /* ftruncate(), close() */
+
+static const char TRACE_MAGIC[8] = "EFTRACE";
+
+static_assert(sizeof(ExchangeTraceHeader) == 64, "the trace header has to fill a cache line");
+static_assert(sizeof(ExchangeTraceRecord) == 64, "a trace record has to fill a cache line");
+
+ExchangeTrace& ExchangeTrace::getInstance(void)
+{
+    static ExchangeTrace _instance;
+
+    return _instance;
+}
+
+ExchangeTrace::ExchangeTrace() :
+    _mapping(NULL),
+    _mappingSize(0),
+    _header(NULL),
+    _records(NULL)
+{
+    std::string fileName(ConfigurationFile::getInstance().getExchangeTraceFile());
+    if (!fileName.empty()) {
+        this->open(fileName, EXCHANGE_TRACE_RECORDS);
+    }
+}
+
+ExchangeTrace::~ExchangeTrace()
+{
+    this->close();
+}
+
+bool ExchangeTrace::open(std::string fileName, uint64_t capacity)
+{
+    assert(capacity > 0);
+    this->close();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    int fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        EASYFPGA_LOG(ERROR) << "Opening the exchange trace " << fileName << " failed: " << strerror(errno);
+        return false;
+    }
+
+    /* serializes the initialization with other processes */
+    flock(fd, LOCK_EX);
+
+    uint64_t size = sizeof(ExchangeTraceHeader) + capacity * sizeof(ExchangeTraceRecord);
+    struct stat fileStat;
+    bool reuse = (fstat(fd, &fileStat) == 0) && ((uint64_t)fileStat.st_size == size);
+
+    if (!reuse && (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0)) {
+        EASYFPGA_LOG(ERROR) << "Resizing the exchange trace " << fileName << " failed: " << strerror(errno);
+        flock(fd, LOCK_UN);
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        EASYFPGA_LOG(ERROR) << "Mapping the exchange trace " << fileName << " failed: " << strerror(errno);
+        flock(fd, LOCK_UN);
+        ::close(fd);
+        return false;
+    }
+
+    ExchangeTraceHeader* header = (ExchangeTraceHeader*)mapping;
+    reuse = reuse && (memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) &&
+        (header->version == VERSION) && (header->recordSize == sizeof(ExchangeTraceRecord)) &&
+        (header->capacity == capacity);
+
+    if (!reuse) {
+        memset(mapping, 0x00, size);
+        header->version = VERSION;
+        header->recordSize = sizeof(ExchangeTraceRecord);
+        header->capacity = capacity;
+        header->nextRecord = 0;
+        memcpy(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    }
+
+    /* the mapping stays valid without the descriptor */
+    flock(fd, LOCK_UN);
+    ::close(fd);
+
+    _mapping = mapping;
+    _mappingSize = size;
+    _records = (ExchangeTraceRecord*)((byte*)mapping + sizeof(ExchangeTraceHeader));
+    _header = header;
+
+    EASYFPGA_LOG(INFO) << "Recording all exchanges into " << fileName;
+    return true;
+}
+
+void ExchangeTrace::close(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_mapping != NULL) {
+        _header = NULL;
+        _records = NULL;
+        munmap(_mapping, _mappingSize);
+        _mapping = NULL;
+        _mappingSize = 0;
+    }
+}
+
+bool ExchangeTrace::isEnabled(void)
+{
+    return (_header != NULL);
+}
+
+void ExchangeTrace::traceRequest(uint16_t connection, const Frame& request, retryval attempt)
+{
+    uint64_t index;
+    ExchangeTraceRecord* record = this->reserve(connection, &index);
+    if (record == NULL) {
+        return;
+    }
+
+    record->direction = REQUEST;
+    ExchangeTrace::describeRequest(record, request);
+    record->retry = (uint8_t)std::max(attempt-1, 0);
+    ExchangeTrace::setPayload(record, request.data(), request.size());
+
+    this->commit(record, index);
+}
+
+void ExchangeTrace::traceReply(uint16_t connection, const Frame& request, const byte* reply, uint16_t length, timevalue latency, retryval attempt, uint8_t status)
+{
+    uint64_t index;
+    ExchangeTraceRecord* record = this->reserve(connection, &index);
+    if (record == NULL) {
+        return;
+    }
+
+    record->direction = REPLY;
+    ExchangeTrace::describeRequest(record, request);
+    record->latency = (uint32_t)std::min(std::max(latency, (timevalue)0), (timevalue)UINT32_MAX);
+    record->retry = (uint8_t)std::max(attempt-1, 0);
+    record->status = status;
+    ExchangeTrace::setPayload(record, reply, length);
+
+    this->commit(record, index);
+}
+
+void ExchangeTrace::traceInterrupt(uint16_t connection, const byte* notification, uint16_t length)
+{
+    uint64_t index;
+    ExchangeTraceRecord* record = this->reserve(connection, &index);
+    if (record == NULL) {
+        return;
+    }
+
+    record->direction = INTERRUPT;
+    record->opcode = notification[0];
+    if (length > 1) {
+        record->core = notification[1];
+    }
+    ExchangeTrace::setPayload(record, notification, length);
+
+    this->commit(record, index);
+}
+
+void ExchangeTrace::traceWrite(uint16_t connection, const byte* data, uint32_t length)
+{
+    uint64_t index;
+    ExchangeTraceRecord* record = this->reserve(connection, &index);
+    if (record == NULL) {
+        return;
+    }
+
+    record->direction = WRITE;
+    record->opcode = (length > 0) ? data[0] : 0x00;
+    ExchangeTrace::setPayload(record, data, length);
+
+    this->commit(record, index);
+}
+
+void ExchangeTrace::traceTimeout(uint16_t connection, uint32_t missingBytes)
+{
+    uint64_t index;
+    ExchangeTraceRecord* record = this->reserve(connection, &index);
+    if (record == NULL) {
+        return;
+    }
+
+    record->direction = TIMEOUT;
+    record->length = (uint16_t)std::min(missingBytes, (uint32_t)UINT16_MAX);
+
+    this->commit(record, index);
+}
+
+void ExchangeTrace::traceOpen(uint16_t connection, const std::string& device)
+{
+    uint64_t index;
+    ExchangeTraceRecord* record = this->reserve(connection, &index);
+    if (record == NULL) {
+        return;
+    }
+
+    record->direction = OPEN;
+    ExchangeTrace::setPayload(record, (const byte*)device.data(), device.size());
+
+    this->commit(record, index);
+}
+
+ExchangeTraceRecord* ExchangeTrace::reserve(uint16_t connection, uint64_t* index)
+{
+    ExchangeTraceHeader* header = _header;
+    if (header == NULL) {
+        return NULL;
+    }
+
+    /* the header is shared with other processes, so std::atomic can't be used */
+    *index = __atomic_fetch_add(&header->nextRecord, 1, __ATOMIC_RELAXED);
+    ExchangeTraceRecord* record = &_records[*index % header->capacity];
+
+    /* invalid until commit(), so that a reader skips a half written record */
+    __atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    record->timestamp = getCurrentTimeInNanos();
+    record->latency = 0;
+    record->length = 0;
+    record->connection = connection;
+    record->opcode = 0x00;
+    record->id = 0;
+    record->core = 0;
+    record->address = 0;
+    record->retry = 0;
+    record->status = 0;
+    record->flags = 0;
+    record->payloadLength = 0;
+
+    return record;
+}
+
+void ExchangeTrace::commit(ExchangeTraceRecord* record, uint64_t index)
+{
+    __atomic_store_n(&record->sequence, index + 1, __ATOMIC_RELEASE);
+}
+
+void ExchangeTrace::setPayload(ExchangeTraceRecord* record, const byte* data, uint32_t length)
+{
+    record->length = (uint16_t)std::min(length, (uint32_t)UINT16_MAX);
+    record->payloadLength = (uint8_t)std::min(length, (uint32_t)sizeof(record->payload));
+    memcpy(record->payload, data, record->payloadLength);
+}
+
+void ExchangeTrace::describeRequest(ExchangeTraceRecord* record, const Frame& request)
+{
+    if (request.empty()) {
+        return;
+    }
+
+    const byte* data = request.data();
+    record->opcode = data[0];
+
+    switch (data[0]) {
+        /* opcode, id, core, address... */
+        case 0x65:
+        case 0x66:
+        case 0x69:
+        case 0x73:
+        case 0x77:
+        case 0x79:
+            if (request.size() >= 4) {
+                record->id = data[1];
+                record->core = data[2];
+                record->address = data[3];
+                record->flags = HAS_REGISTER | HAS_ID;
+            }
+            break;
+
+        /* opcode, id, parity */
+        case 0x55:
+        case 0xAA:
+            if (request.size() >= 2) {
+                record->id = data[1];
+                record->flags = HAS_ID;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool ExchangeTrace::readRecords(std::string fileName, std::vector<ExchangeTraceRecord>* records)
+{
+    MappedFile file(fileName);
+    if (!file.map()) {
+        return false;
+    }
+
+    const ExchangeTraceHeader* header = (const ExchangeTraceHeader*)file.getData();
+    if ((file.getSize() < sizeof(ExchangeTraceHeader)) || (memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) ||
+        (header->version != VERSION) || (header->recordSize != sizeof(ExchangeTraceRecord))) {
+        EASYFPGA_LOG(ERROR) << fileName << " isn't an exchange trace of version " << VERSION << "!";
+        return false;
+    }
+
+    if (file.getSize() < sizeof(ExchangeTraceHeader) + header->capacity * sizeof(ExchangeTraceRecord)) {
+        EASYFPGA_LOG(ERROR) << "The exchange trace " << fileName << " is truncated!";
+        return false;
+    }
+
+    const ExchangeTraceRecord* slots = (const ExchangeTraceRecord*)(file.getData() + sizeof(ExchangeTraceHeader));
+    records->clear();
+    records->reserve(std::min(header->nextRecord, header->capacity));
+
+    for (uint64_t i=0; i<header->capacity; i++) {
+        /* skip empty, half written and misplaced records */
+        uint64_t sequence = slots[i].sequence;
+        if ((sequence != 0) && ((sequence-1) % header->capacity == i)) {
+            records->push_back(slots[i]);
+        }
+    }
+
+    std::sort(records->begin(), records->end(), [](const ExchangeTraceRecord& a, const ExchangeTraceRecord& b) {
+        return a.sequence < b.sequence;
+    });
+
+    return true;
+}
+
+std::string ExchangeTrace::getExchangeName(byte opcode)
+{
+    switch (opcode) {
+        case 0x22: return "sector write";
+        case 0x33: return "configure fpga";
+        case 0x44: return "select soc";
+        case 0x55: return "select mcu";
+        case 0x65: return "write register multiple times";
+        case 0x66: return "write register";
+        case 0x69: return "write register auto increment";
+        case 0x73: return "read register multiple times";
+        case 0x77: return "read register";
+        case 0x79: return "read register auto increment";
+        case 0x99: return "interrupt";
+        case 0xAA: return "interrupt enable";
+        case 0xC3: return "status read";
+        case 0xCC: return "status write";
+        case 0xD3: return "serial read";
+        case 0xDD: return "serial write";
+        case 0xEE: return "detect";
+        default: return "unknown";
+    }
+}
+
+std::string ExchangeTrace::getDirectionName(uint8_t direction)
+{
+    switch (direction) {
+        case REQUEST: return "request";
+        case REPLY: return "reply";
+        case INTERRUPT: return "interrupt";
+        case WRITE: return "write";
+        case TIMEOUT: return "timeout";
+        case OPEN: return "open";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,282 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_COMMUNICATION_EXCHANGETRACE_H_
+#define SDK_COMMUNICATION_EXCHANGETRACE_H_
+
+#include "communication/types.h"
+#include "utils/hardwaretypes.h"
+#include "utils/os/time_helper.h" /* timevalue */
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Frame;
+
+/**
+ * \brief Header at the beginning of an exchange trace file
+ */
+struct ExchangeTraceHeader {
+    /** "EFTRACE" */
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+
+    /** number of records written so far (incremented atomically) */
+    uint64_t nextRecord;
+
+    byte reserved[32];
+};
+
+/**
+ * \brief A single entry of an exchange trace file
+ *
+ * The fields describing the exchange (id, core, address) are taken from
+ * the request, also for replies, so that both can be matched.
+ */
+struct ExchangeTraceRecord {
+    /**
+     * Position of the record in the whole trace plus one. It is written
+     * last, so 0 marks a record which is just being written (or was
+     * interrupted by a crash).
+     */
+    uint64_t sequence;
+
+    /** unix time in nanoseconds */
+    uint64_t timestamp;
+
+    /** nanoseconds since sending the request (replies only) */
+    uint32_t latency;
+
+    /** number of traced bytes, even if only some are stored */
+    uint16_t length;
+
+    /** SerialConnection::getConnectionId() of the connection */
+    uint16_t connection;
+
+    /** a value of ExchangeTrace::DIRECTION */
+    uint8_t direction;
+
+    /** the request's opcode */
+    uint8_t opcode;
+    uint8_t id;
+    uint8_t core;
+    uint8_t address;
+
+    /** 0 for the first attempt of an exchange, 1 for the first retry... */
+    uint8_t retry;
+
+    /** the Task::RECEIVE_STATE of a reply */
+    uint8_t status;
+
+    /** ExchangeTrace::FLAGS */
+    uint8_t flags;
+
+    /** number of bytes stored in payload */
+    uint8_t payloadLength;
+
+    /** the first bytes of the request, reply or written data */
+    byte payload[31];
+};
+
+/**
+ * \brief Records all exchanges with the easyFPGA in a binary file
+ *
+ * If the option EXCHANGE_TRACE_FILE is set in project.conf, every
+ * request, reply, interrupt notification, write() call and receive
+ * timeout is recorded with a timestamp and the id of its connection.
+ * Opening a device records its path under that id, so exchanges with
+ * several easyFPGAs can be told apart. The file is a ring buffer of
+ * fixed-size records which is mapped into memory, so recording a record
+ * is a few stores without any system call. The records survive a crash
+ * of the program because the mapping is shared with the file.
+ *
+ * Several threads and processes may record into the same file at the
+ * same time. When the ring is full, the oldest records are overwritten.
+ *
+ * The command line tool easyfpga-trace decodes a trace file and shows
+ * the latency histograms of all exchange types.
+ */
+class ExchangeTrace
+{
+    public:
+        /**
+         * \brief Defines the kinds of records.
+         */
+        enum DIRECTION : uint8_t {
+            /** A request was sent (or appended to the send buffer). */
+            REQUEST,
+
+            /** A reply was received, or receiving it failed. */
+            REPLY,
+
+            /** An interrupt notification was received. */
+            INTERRUPT,
+
+            /** The send buffer was written by a single write() call. */
+            WRITE,
+
+            /** Receiving bytes from the serial device timed out. */
+            TIMEOUT,
+
+            /** A serial device was opened, the payload holds its path. */
+            OPEN
+        };
+
+        enum FLAGS : uint8_t {
+            /** id, core and address are valid */
+            HAS_REGISTER = 0x01,
+
+            /** id is valid */
+            HAS_ID = 0x02
+        };
+
+        static const uint32_t VERSION = 2;
+
+        /**
+         * \brief Returns the trace, opening the file configured by
+         *        EXCHANGE_TRACE_FILE on the first call.
+         */
+        static ExchangeTrace& getInstance(void);
+
+        ~ExchangeTrace();
+
+        /**
+         * \brief Starts recording into a file instead of the configured
+         *        one. Call it while no exchanges are executed.
+         *
+         * An existing trace with the same capacity is continued,
+         * otherwise the file is created anew.
+         *
+         * \param capacity Maximum number of records in the file.
+         *
+         * \return true if the file could be mapped,<br>
+         *         false otherwise
+         */
+        bool open(std::string fileName, uint64_t capacity);
+
+        /**
+         * \brief Stops recording. Call it while no exchanges are
+         *        executed.
+         */
+        void close(void);
+
+        /**
+         * \brief Returns true if exchanges are recorded.
+         */
+        bool isEnabled(void);
+
+        /**
+         * \brief Records a request.
+         *
+         * \param connection The id of the connection sending it.
+         *
+         * \param attempt The task's execution attempt, beginning with 1.
+         */
+        void traceRequest(uint16_t connection, const Frame& request, retryval attempt);
+
+        /**
+         * \brief Records a reply or a failed reception (length 0).
+         *
+         * \param latency Nanoseconds since sending the request.
+         *
+         * \param status The receive state of the task.
+         */
+        void traceReply(uint16_t connection, const Frame& request, const byte* reply, uint16_t length, timevalue latency, retryval attempt, uint8_t status);
+
+        /**
+         * \brief Records an interrupt notification.
+         */
+        void traceInterrupt(uint16_t connection, const byte* notification, uint16_t length);
+
+        /**
+         * \brief Records the bytes written by a single write() call.
+         */
+        void traceWrite(uint16_t connection, const byte* data, uint32_t length);
+
+        /**
+         * \brief Records a receive timeout.
+         *
+         * \param missingBytes Number of bytes which didn't arrive.
+         */
+        void traceTimeout(uint16_t connection, uint32_t missingBytes);
+
+        /**
+         * \brief Records the opening of a serial device.
+         *
+         * \param device The path of the device.
+         */
+        void traceOpen(uint16_t connection, const std::string& device);
+
+        /**
+         * \brief Reads all complete records of a trace file, ordered from
+         *        the oldest to the newest one.
+         *
+         * \return true if the file is a valid trace file,<br>
+         *         false otherwise
+         */
+        static bool readRecords(std::string fileName, std::vector<ExchangeTraceRecord>* records);
+
+        /**
+         * \brief Returns a name for the exchange type of a request
+         *        opcode, e.g. "read register".
+         */
+        static std::string getExchangeName(byte opcode);
+
+        /**
+         * \brief Returns a name for a DIRECTION.
+         */
+        static std::string getDirectionName(uint8_t direction);
+
+    private:
+        ExchangeTrace();
+        ExchangeTrace(const ExchangeTrace&);
+        ExchangeTrace& operator=(const ExchangeTrace&);
+
+        /**
+         * Reserves the next record of a connection and invalidates it
+         * until commit(). Returns NULL if the trace is disabled.
+         */
+        ExchangeTraceRecord* reserve(uint16_t connection, uint64_t* index);
+        void commit(ExchangeTraceRecord* record, uint64_t index);
+
+        /**
+         * Copies the first bytes into the record's payload.
+         */
+        static void setPayload(ExchangeTraceRecord* record, const byte* data, uint32_t length);
+
+        /**
+         * Copies id, core and address out of the request.
+         */
+        static void describeRequest(ExchangeTraceRecord* record, const Frame& request);
+
+        std::mutex _mutex;
+        void* _mapping;
+        uint64_t _mappingSize;
+        ExchangeTraceHeader* _header;
+        ExchangeTraceRecord* _records;
+};
+
+#endif  // SDK_COMMUNICATION_EXCHANGETRACE_H_
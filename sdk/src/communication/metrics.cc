@@ -0,0 +1,375 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "configuration.h" /* assert() */
+#include "communication/exchangetrace.h"
+#include "communication/metrics.h"
+#include "communication/task.h"
+#include "utils/config/configurationfile.h"
+#include "utils/log/log.h"
+
+#include <chrono>
+#include <cstdio> /* rename(2), remove(1) */
+#include <fstream>
+#include <iomanip> /* setprecision() */
+#include <sstream>
+
+#include <unistd.h> /* getpid() */
+
+const byte Metrics::OPCODES[] = {
+    0x22, 0x33, 0x44, 0x55, 0x65, 0x66, 0x69, 0x73,
+    0x77, 0x79, 0xAA, 0xC3, 0xCC, 0xD3, 0xDD, 0xEE
+};
+
+/* latency buckets exported to Prometheus: 2^10 ns (~1 us) up to 2^35 ns (~34 s) */
+static const uint32_t PROMETHEUS_FIRST_EXPONENT = 10;
+static const uint32_t PROMETHEUS_LAST_EXPONENT = 35;
+
+Metrics& Metrics::getInstance(void)
+{
+    static Metrics _instance;
+
+    return _instance;
+}
+
+Metrics::Metrics() :
+    _dumpRunning(false),
+    _dumpInterval(0)
+{
+    this->reset();
+    _runningAsyncTasks.store(0, std::memory_order_relaxed);
+    _pendingAsyncTasks.store(0, std::memory_order_relaxed);
+
+    std::string fileName(ConfigurationFile::getInstance().getMetricsFile());
+    if (!fileName.empty()) {
+        this->startDump(fileName, ConfigurationFile::getInstance().getMetricsDumpInterval());
+    }
+}
+
+Metrics::~Metrics()
+{
+    this->stopDump();
+}
+
+uint32_t Metrics::getSlot(byte opcode)
+{
+    static_assert(sizeof(OPCODES) == SLOT_COUNT-1, "every known opcode needs a slot, plus one for unknown ones");
+
+    for (uint32_t i=0; i<SLOT_COUNT-1; i++) {
+        if (OPCODES[i] == opcode) {
+            return i;
+        }
+    }
+
+    return SLOT_COUNT-1;
+}
+
+void Metrics::countRequest(byte opcode, retryval attempt)
+{
+    ExchangeCounters& counters = _exchanges[getSlot(opcode)];
+
+    counters.requests.fetch_add(1, std::memory_order_relaxed);
+    if (attempt > 1) {
+        counters.retries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::countReply(byte opcode, uint32_t status, timevalue latency)
+{
+    ExchangeCounters& counters = _exchanges[getSlot(opcode)];
+
+    switch (status) {
+        case Task::RECEIVE_STATE::RECEIVE_SUCCESS:
+            counters.successes.fetch_add(1, std::memory_order_relaxed);
+            counters.latency.record(latency);
+            break;
+
+        case Task::RECEIVE_STATE::RECEIVE_FAILURE:
+            counters.nacks.fetch_add(1, std::memory_order_relaxed);
+            counters.latency.record(latency);
+            break;
+
+        case Task::RECEIVE_STATE::RECEIVE_CHECKSUM_ERROR:
+            counters.checksumErrors.fetch_add(1, std::memory_order_relaxed);
+            break;
+
+        case Task::RECEIVE_STATE::RECEIVE_UNEXPECTED_OPCODE_ERROR:
+            counters.unexpectedOpcodes.fetch_add(1, std::memory_order_relaxed);
+            break;
+
+        default:
+            counters.timeouts.fetch_add(1, std::memory_order_relaxed);
+            break;
+    }
+}
+
+void Metrics::countSentBytes(uint32_t bytes)
+{
+    _sentBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::countReceivedBytes(uint32_t bytes)
+{
+    _receivedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::countInterrupt(void)
+{
+    _interrupts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::countReceiveTimeout(void)
+{
+    _receiveTimeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::countContextSwitch(void)
+{
+    _contextSwitches.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::changeAsyncTasks(int64_t running, int64_t pending)
+{
+    if (running != 0) {
+        _runningAsyncTasks.fetch_add(running, std::memory_order_relaxed);
+    }
+    if (pending != 0) {
+        _pendingAsyncTasks.fetch_add(pending, std::memory_order_relaxed);
+    }
+}
+
+MetricsSnapshot Metrics::getSnapshot(void)
+{
+    MetricsSnapshot snapshot;
+    snapshot.time = getCurrentTimeInMillis();
+
+    for (uint32_t i=0; i<SLOT_COUNT; i++) {
+        ExchangeCounters& counters = _exchanges[i];
+
+        uint64_t requests = counters.requests.load(std::memory_order_relaxed);
+        if (requests == 0) {
+            continue;
+        }
+
+        ExchangeMetrics exchange;
+        exchange.opcode = (i < SLOT_COUNT-1) ? OPCODES[i] : 0x00;
+        exchange.name = ExchangeTrace::getExchangeName(exchange.opcode);
+        exchange.requests = requests;
+        exchange.retries = counters.retries.load(std::memory_order_relaxed);
+        exchange.successes = counters.successes.load(std::memory_order_relaxed);
+        exchange.nacks = counters.nacks.load(std::memory_order_relaxed);
+        exchange.checksumErrors = counters.checksumErrors.load(std::memory_order_relaxed);
+        exchange.unexpectedOpcodes = counters.unexpectedOpcodes.load(std::memory_order_relaxed);
+        exchange.timeouts = counters.timeouts.load(std::memory_order_relaxed);
+        exchange.latency = counters.latency.getSnapshot();
+
+        snapshot.exchanges.push_back(exchange);
+    }
+
+    snapshot.sentBytes = _sentBytes.load(std::memory_order_relaxed);
+    snapshot.receivedBytes = _receivedBytes.load(std::memory_order_relaxed);
+    snapshot.interrupts = _interrupts.load(std::memory_order_relaxed);
+    snapshot.receiveTimeouts = _receiveTimeouts.load(std::memory_order_relaxed);
+    snapshot.contextSwitches = _contextSwitches.load(std::memory_order_relaxed);
+
+    /* a gauge might be negative for a moment while an other thread changes it */
+    int64_t running = _runningAsyncTasks.load(std::memory_order_relaxed);
+    int64_t pending = _pendingAsyncTasks.load(std::memory_order_relaxed);
+    snapshot.runningAsyncTasks = (running > 0) ? running : 0;
+    snapshot.pendingAsyncTasks = (pending > 0) ? pending : 0;
+
+    return snapshot;
+}
+
+void Metrics::reset(void)
+{
+    for (uint32_t i=0; i<SLOT_COUNT; i++) {
+        ExchangeCounters& counters = _exchanges[i];
+        counters.requests.store(0, std::memory_order_relaxed);
+        counters.retries.store(0, std::memory_order_relaxed);
+        counters.successes.store(0, std::memory_order_relaxed);
+        counters.nacks.store(0, std::memory_order_relaxed);
+        counters.checksumErrors.store(0, std::memory_order_relaxed);
+        counters.unexpectedOpcodes.store(0, std::memory_order_relaxed);
+        counters.timeouts.store(0, std::memory_order_relaxed);
+        counters.latency.reset();
+    }
+
+    _sentBytes.store(0, std::memory_order_relaxed);
+    _receivedBytes.store(0, std::memory_order_relaxed);
+    _interrupts.store(0, std::memory_order_relaxed);
+    _receiveTimeouts.store(0, std::memory_order_relaxed);
+    _contextSwitches.store(0, std::memory_order_relaxed);
+}
+
+std::string Metrics::toPrometheus(const MetricsSnapshot& snapshot)
+{
+    std::stringstream ss;
+
+    ss << "# HELP easyfpga_requests_total Requests sent to the easyFPGA including retries." << std::endl;
+    ss << "# TYPE easyfpga_requests_total counter" << std::endl;
+    for (auto& exchange : snapshot.exchanges) {
+        ss << "easyfpga_requests_total{exchange=\"" << exchange.name << "\"} " << exchange.requests << std::endl;
+    }
+
+    ss << "# HELP easyfpga_retries_total Requests repeated because of a failed attempt." << std::endl;
+    ss << "# TYPE easyfpga_retries_total counter" << std::endl;
+    for (auto& exchange : snapshot.exchanges) {
+        ss << "easyfpga_retries_total{exchange=\"" << exchange.name << "\"} " << exchange.retries << std::endl;
+    }
+
+    ss << "# HELP easyfpga_replies_total Replies by their outcome." << std::endl;
+    ss << "# TYPE easyfpga_replies_total counter" << std::endl;
+    for (auto& exchange : snapshot.exchanges) {
+        std::string prefix("easyfpga_replies_total{exchange=\"" + exchange.name + "\",status=\"");
+        ss << prefix << "success\"} " << exchange.successes << std::endl;
+        ss << prefix << "nack\"} " << exchange.nacks << std::endl;
+        ss << prefix << "checksum_error\"} " << exchange.checksumErrors << std::endl;
+        ss << prefix << "unexpected_opcode\"} " << exchange.unexpectedOpcodes << std::endl;
+        ss << prefix << "timeout\"} " << exchange.timeouts << std::endl;
+    }
+
+    ss << "# HELP easyfpga_reply_latency_seconds Time from sending a request until its reply arrived." << std::endl;
+    ss << "# TYPE easyfpga_reply_latency_seconds histogram" << std::endl;
+    ss << std::setprecision(9);
+    for (auto& exchange : snapshot.exchanges) {
+        std::string prefix("easyfpga_reply_latency_seconds_bucket{exchange=\"" + exchange.name + "\",le=\"");
+        for (uint32_t exponent=PROMETHEUS_FIRST_EXPONENT; exponent<=PROMETHEUS_LAST_EXPONENT; exponent++) {
+            ss << prefix << (double)((uint64_t)1 << exponent) / 1e9 << "\"} "
+               << exchange.latency.countBelowPowerOfTwo(exponent) << std::endl;
+        }
+        ss << prefix << "+Inf\"} " << exchange.latency.count << std::endl;
+        ss << "easyfpga_reply_latency_seconds_sum{exchange=\"" << exchange.name << "\"} "
+           << (double)exchange.latency.sum / 1e9 << std::endl;
+        ss << "easyfpga_reply_latency_seconds_count{exchange=\"" << exchange.name << "\"} "
+           << exchange.latency.count << std::endl;
+    }
+
+    ss << "# HELP easyfpga_sent_bytes_total Bytes written to the serial devices." << std::endl;
+    ss << "# TYPE easyfpga_sent_bytes_total counter" << std::endl;
+    ss << "easyfpga_sent_bytes_total " << snapshot.sentBytes << std::endl;
+
+    ss << "# HELP easyfpga_received_bytes_total Bytes read from the serial devices." << std::endl;
+    ss << "# TYPE easyfpga_received_bytes_total counter" << std::endl;
+    ss << "easyfpga_received_bytes_total " << snapshot.receivedBytes << std::endl;
+
+    ss << "# HELP easyfpga_interrupts_total Received interrupt notifications." << std::endl;
+    ss << "# TYPE easyfpga_interrupts_total counter" << std::endl;
+    ss << "easyfpga_interrupts_total " << snapshot.interrupts << std::endl;
+
+    ss << "# HELP easyfpga_receive_timeouts_total Reads of the serial devices which timed out." << std::endl;
+    ss << "# TYPE easyfpga_receive_timeouts_total counter" << std::endl;
+    ss << "easyfpga_receive_timeouts_total " << snapshot.receiveTimeouts << std::endl;
+
+    ss << "# HELP easyfpga_context_switches_total Switches between the mcu and the soc." << std::endl;
+    ss << "# TYPE easyfpga_context_switches_total counter" << std::endl;
+    ss << "easyfpga_context_switches_total " << snapshot.contextSwitches << std::endl;
+
+    ss << "# HELP easyfpga_async_running_tasks Async requests waiting for their reply." << std::endl;
+    ss << "# TYPE easyfpga_async_running_tasks gauge" << std::endl;
+    ss << "easyfpga_async_running_tasks " << snapshot.runningAsyncTasks << std::endl;
+
+    ss << "# HELP easyfpga_async_pending_tasks Async requests retained until they can be sent." << std::endl;
+    ss << "# TYPE easyfpga_async_pending_tasks gauge" << std::endl;
+    ss << "easyfpga_async_pending_tasks " << snapshot.pendingAsyncTasks << std::endl;
+
+    return ss.str();
+}
+
+bool Metrics::writePrometheusFile(std::string fileName)
+{
+    std::string content(toPrometheus(this->getSnapshot()));
+
+    /*
+     * Write a temporary file and rename it, so that a collector never
+     * reads a partially written file.
+     */
+    std::string temporaryName(fileName + "." + std::to_string(getpid()));
+    std::ofstream file(temporaryName, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << content;
+    file.close();
+
+    if (file.fail() || (rename(temporaryName.c_str(), fileName.c_str()) != 0)) {
+        std::remove(temporaryName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void Metrics::startDump(std::string fileName, uint32_t interval)
+{
+    this->stopDump();
+
+    std::lock_guard<std::mutex> lock(_dumpMutex);
+    _dumpFile = fileName;
+    _dumpInterval = (interval > 0) ? interval : 1;
+    _dumpRunning = true;
+    _dumpThread = std::thread(&Metrics::dump, this);
+
+    EASYFPGA_LOG(INFO) << "Writing the metrics into " << fileName << " every " << _dumpInterval << " ms";
+}
+
+void Metrics::stopDump(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_dumpMutex);
+        _dumpRunning = false;
+    }
+    _dumpCondition.notify_all();
+
+    if (_dumpThread.joinable()) {
+        _dumpThread.join();
+    }
+}
+
+void Metrics::dump(void)
+{
+    std::unique_lock<std::mutex> lock(_dumpMutex);
+    std::string fileName(_dumpFile);
+    bool warned = false;
+
+    while (true) {
+        bool running = !_dumpCondition.wait_for(lock, std::chrono::milliseconds(_dumpInterval),
+            [this] { return !_dumpRunning; });
+
+        /* the file is written a last time after stopping */
+        lock.unlock();
+        bool written = this->writePrometheusFile(fileName);
+        lock.lock();
+
+        /* the logger might be gone already if the program exits */
+        if (!written && !warned && running) {
+            EASYFPGA_LOG(WARNING) << "The metrics file " << fileName << " couldn't be written!";
+            warned = true;
+        }
+
+        if (!running) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef SDK_COMMUNICATION_METRICS_H_
+#define SDK_COMMUNICATION_METRICS_H_
+
+#include "communication/types.h" /* retryval */
+#include "utils/hardwaretypes.h"
+#include "utils/latencyhistogram.h"
+#include "utils/os/time_helper.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Counters of one exchange type
+ */
+struct ExchangeMetrics {
+    /** opcode of the request, 0 for all unknown opcodes */
+    byte opcode;
+
+    /** ExchangeTrace::getExchangeName() of the opcode */
+    std::string name;
+
+    /** sent requests including the retries */
+    uint64_t requests;
+
+    /** requests which are retries of a failed attempt */
+    uint64_t retries;
+
+    /** replies by Task::RECEIVE_STATE */
+    uint64_t successes;
+    uint64_t nacks;
+    uint64_t checksumErrors;
+    uint64_t unexpectedOpcodes;
+
+    /** replies which didn't arrive (completely) */
+    uint64_t timeouts;
+
+    /** nanoseconds from sending a request until its reply was received */
+    LatencyHistogramSnapshot latency;
+};
+
+/**
+ * \brief Values of all metrics at a point in time
+ */
+struct MetricsSnapshot {
+    /** unix timestamp of the snapshot in milliseconds */
+    timevalue time;
+
+    /** all exchange types which sent at least one request */
+    std::vector<ExchangeMetrics> exchanges;
+
+    uint64_t sentBytes;
+    uint64_t receivedBytes;
+
+    /** received interrupt notifications */
+    uint64_t interrupts;
+
+    /** calls of SerialConnection::receive() which timed out */
+    uint64_t receiveTimeouts;
+
+    /** switches between the mcu and the soc */
+    uint64_t contextSwitches;
+
+    /** async requests sent but not answered yet */
+    uint64_t runningAsyncTasks;
+
+    /** async requests waiting for a task they depend on or a free slot */
+    uint64_t pendingAsyncTasks;
+};
+
+/**
+ * \brief Counts the exchanges of all easyFPGAs of the process
+ *
+ * The communication classes update the counters on their hot paths,
+ * thus every update is a relaxed atomic operation without any lock.
+ * getSnapshot() copies all counters, e.g. for EasyFpga::getMetrics().
+ *
+ * If the option METRICS_FILE is set in project.conf, a background
+ * thread writes the metrics in the Prometheus text format into this
+ * file every METRICS_DUMP_INTERVAL milliseconds, e.g. for the textfile
+ * collector of the Prometheus node exporter. The file is replaced
+ * atomically, so a reader never sees a partially written one.
+ */
+class Metrics
+{
+    public:
+        /**
+         * \brief Returns the metrics, starting the periodic dump
+         *        configured by METRICS_FILE on the first call.
+         */
+        static Metrics& getInstance(void);
+
+        ~Metrics();
+
+        /**
+         * \brief Counts a sent request.
+         *
+         * \param attempt The task's execution attempt, beginning with 1.
+         */
+        void countRequest(byte opcode, retryval attempt);
+
+        /**
+         * \brief Counts a reply or a failed reception.
+         *
+         * \param status The Task::RECEIVE_STATE of the task.
+         *
+         * \param latency Nanoseconds since sending the request.
+         */
+        void countReply(byte opcode, uint32_t status, timevalue latency);
+
+        void countSentBytes(uint32_t bytes);
+        void countReceivedBytes(uint32_t bytes);
+        void countInterrupt(void);
+        void countReceiveTimeout(void);
+        void countContextSwitch(void);
+
+        /**
+         * \brief Changes the numbers of running and pending async tasks
+         *        by the given differences.
+         */
+        void changeAsyncTasks(int64_t running, int64_t pending);
+
+        /**
+         * \brief Copies all counters.
+         */
+        MetricsSnapshot getSnapshot(void);
+
+        /**
+         * \brief Sets all counters except the async task gauges to zero.
+         *        Call it while no exchanges are executed.
+         */
+        void reset(void);
+
+        /**
+         * \brief Formats a snapshot in the Prometheus text exposition
+         *        format. The latencies are exported in seconds.
+         */
+        static std::string toPrometheus(const MetricsSnapshot& snapshot);
+
+        /**
+         * \brief Writes the current metrics in the Prometheus text format
+         *        into a file, replacing it atomically.
+         *
+         * \return true at success,<br>
+         *         false if the file couldn't be written
+         */
+        bool writePrometheusFile(std::string fileName);
+
+        /**
+         * \brief Starts writing the metrics into a file periodically,
+         *        instead of the configured one.
+         *
+         * \param interval Milliseconds between two writes.
+         */
+        void startDump(std::string fileName, uint32_t interval);
+
+        /**
+         * \brief Stops the periodic dump after writing the file a last
+         *        time.
+         */
+        void stopDump(void);
+
+    private:
+        Metrics();
+        Metrics(const Metrics&);
+        Metrics& operator=(const Metrics&);
+
+        /**
+         * Counters of an exchange type. Each one fills own cache lines,
+         * so that concurrent exchanges of different types don't share
+         * them.
+         */
+        struct alignas(64) ExchangeCounters {
+            std::atomic<uint64_t> requests;
+            std::atomic<uint64_t> retries;
+            std::atomic<uint64_t> successes;
+            std::atomic<uint64_t> nacks;
+            std::atomic<uint64_t> checksumErrors;
+            std::atomic<uint64_t> unexpectedOpcodes;
+            std::atomic<uint64_t> timeouts;
+            LatencyHistogram latency;
+        };
+
+        /**
+         * Returns the index of an opcode in OPCODES, the last index for
+         * unknown opcodes.
+         */
+        static uint32_t getSlot(byte opcode);
+
+        void dump(void);
+
+        /** the request opcodes of communication/protocol */
+        static const byte OPCODES[];
+        static const uint32_t SLOT_COUNT = 17;
+
+        ExchangeCounters _exchanges[SLOT_COUNT];
+
+        std::atomic<uint64_t> _sentBytes;
+        std::atomic<uint64_t> _receivedBytes;
+        std::atomic<uint64_t> _interrupts;
+        std::atomic<uint64_t> _receiveTimeouts;
+        std::atomic<uint64_t> _contextSwitches;
+        std::atomic<int64_t> _runningAsyncTasks;
+        std::atomic<int64_t> _pendingAsyncTasks;
+
+        /* periodic dump */
+        std::mutex _dumpMutex;
+        std::condition_variable _dumpCondition;
+        std::thread _dumpThread;
+        bool _dumpRunning;
+        std::string _dumpFile;
+        uint32_t _dumpInterval;
+};
+
+#endif  // SDK_COMMUNICATION_METRICS_H_
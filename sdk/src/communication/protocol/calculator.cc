@@ -21,29 +21,279 @@
 
 #include "communication/protocol/calculator.h"
 
-byte Calculator::calculateXorParity(byte* byteArray, uint32_t byteArrayLength)
+#include <atomic>
+#include <cstring> /* memcpy() */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CALCULATOR_X86_SIMD
+#include <immintrin.h>
+#endif
+
+static const uint32_t MOD_ADLER = 65521;
+
+/*
+ * The largest n such that 255*n*(n+1)/2 + (n+1)*(MOD_ADLER-1) still fits
+ * into 32 bits: both sums have to be reduced only once per n bytes.
+ */
+static const uint32_t ADLER32_NMAX = 5552;
+
+static uint32_t updateAdler32Scalar(uint32_t adler32hash, const byte* data, uint64_t length)
+{
+    uint32_t a = adler32hash & 0xFFFF;
+    uint32_t b = adler32hash >> 16;
+
+    while (length > 0) {
+        uint32_t n = (length < ADLER32_NMAX) ? (uint32_t)length : ADLER32_NMAX;
+        length -= n;
+
+        while (n-- > 0) {
+            a += *data++;
+            b += a;
+        }
+
+        a %= MOD_ADLER;
+        b %= MOD_ADLER;
+    }
+
+    return (b << 16) | a;
+}
+
+#ifdef CALCULATOR_X86_SIMD
+
+/*
+ * The vectorized versions process blocks of 16 (SSE2) or 32 (AVX2)
+ * bytes. For a block b[0..w-1], a grows by the sum of the bytes and b by
+ * w times the former a plus the sum of (w-i)*b[i]. The lanes collect the
+ * byte sums, the byte sums before every block and the weighted sums,
+ * which are combined with a and b at the end of a run of at most
+ * ADLER32_NMAX bytes.
+ */
+
+__attribute__((target("sse2")))
+static uint64_t sumLanes(__m128i lanes)
+{
+    uint32_t values[4];
+    _mm_storeu_si128((__m128i*)values, lanes);
+    return (uint64_t)values[0] + values[1] + values[2] + values[3];
+}
+
+__attribute__((target("sse2")))
+static uint32_t updateAdler32Sse2(uint32_t adler32hash, const byte* data, uint64_t length)
+{
+    uint32_t a = adler32hash & 0xFFFF;
+    uint32_t b = adler32hash >> 16;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightsLow = _mm_set_epi16(9, 10, 11, 12, 13, 14, 15, 16);
+    const __m128i weightsHigh = _mm_set_epi16(1, 2, 3, 4, 5, 6, 7, 8);
+
+    while (length >= 16) {
+        uint32_t n = ((length < ADLER32_NMAX) ? (uint32_t)length : ADLER32_NMAX) & ~15u;
+        length -= n;
+
+        __m128i byteSums = zero;
+        __m128i previousByteSums = zero;
+        __m128i weightedSums = zero;
+
+        for (uint32_t i=0; i<n; i+=16) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)data);
+            previousByteSums = _mm_add_epi32(previousByteSums, byteSums);
+            byteSums = _mm_add_epi32(byteSums, _mm_sad_epu8(bytes, zero));
+            weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weightsLow));
+            weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weightsHigh));
+            data += 16;
+        }
+
+        uint64_t sumB = b + (uint64_t)a * n + 16 * sumLanes(previousByteSums) + sumLanes(weightedSums);
+        uint64_t sumA = a + sumLanes(byteSums);
+        a = sumA % MOD_ADLER;
+        b = sumB % MOD_ADLER;
+    }
+
+    return updateAdler32Scalar((b << 16) | a, data, length);
+}
+
+__attribute__((target("avx2")))
+static uint64_t sumLanes(__m256i lanes)
 {
-    byte checksum = (byte)0x00;
+    uint32_t values[8];
+    _mm256_storeu_si256((__m256i*)values, lanes);
 
-    uint32_t i;
-    for (i=0; i<byteArrayLength; i++) {
-        checksum ^= *(byteArray+i);
+    uint64_t sum = 0;
+    for (uint32_t i=0; i<8; i++) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static uint32_t updateAdler32Avx2(uint32_t adler32hash, const byte* data, uint64_t length)
+{
+    uint32_t a = adler32hash & 0xFFFF;
+    uint32_t b = adler32hash >> 16;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i weightsLow = _mm256_set_epi16(17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32);
+    const __m256i weightsHigh = _mm256_set_epi16(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+
+    while (length >= 32) {
+        uint32_t n = ((length < ADLER32_NMAX) ? (uint32_t)length : ADLER32_NMAX) & ~31u;
+        length -= n;
+
+        __m256i byteSums = zero;
+        __m256i previousByteSums = zero;
+        __m256i weightedSums = zero;
+
+        for (uint32_t i=0; i<n; i+=32) {
+            __m256i bytes = _mm256_loadu_si256((const __m256i*)data);
+            __m256i low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes));
+            __m256i high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1));
+            previousByteSums = _mm256_add_epi32(previousByteSums, byteSums);
+            byteSums = _mm256_add_epi32(byteSums, _mm256_sad_epu8(bytes, zero));
+            weightedSums = _mm256_add_epi32(weightedSums, _mm256_madd_epi16(low, weightsLow));
+            weightedSums = _mm256_add_epi32(weightedSums, _mm256_madd_epi16(high, weightsHigh));
+            data += 32;
+        }
+
+        uint64_t sumB = b + (uint64_t)a * n + 32 * sumLanes(previousByteSums) + sumLanes(weightedSums);
+        uint64_t sumA = a + sumLanes(byteSums);
+        a = sumA % MOD_ADLER;
+        b = sumB % MOD_ADLER;
+    }
+
+    return updateAdler32Scalar((b << 16) | a, data, length);
+}
+
+#endif  // CALCULATOR_X86_SIMD
+
+struct Adler32Implementation {
+    const char* name;
+    uint32_t (*function)(uint32_t, const byte*, uint64_t);
+    bool (*isSupported)(void);
+};
+
+static bool alwaysSupported(void)
+{
+    return true;
+}
+
+#ifdef CALCULATOR_X86_SIMD
+static bool cpuSupportsSse2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static bool cpuSupportsAvx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/* ordered from the slowest to the fastest implementation */
+static const Adler32Implementation ADLER32_IMPLEMENTATIONS[] = {
+    { "scalar", updateAdler32Scalar, alwaysSupported },
+#ifdef CALCULATOR_X86_SIMD
+    { "sse2", updateAdler32Sse2, cpuSupportsSse2 },
+    { "avx2", updateAdler32Avx2, cpuSupportsAvx2 },
+#endif
+};
+
+/*
+ * Returns the implementation in use. It is initialized with the fastest
+ * one supported by the cpu on the first call.
+ */
+static std::atomic<const Adler32Implementation*>& selectedAdler32Implementation(void)
+{
+    static std::atomic<const Adler32Implementation*> selected([] {
+        const Adler32Implementation* fastest = &ADLER32_IMPLEMENTATIONS[0];
+        for (const Adler32Implementation& implementation : ADLER32_IMPLEMENTATIONS) {
+            if (implementation.isSupported()) {
+                fastest = &implementation;
+            }
+        }
+        return fastest;
+    }());
+
+    return selected;
+}
+
+byte Calculator::calculateXorParity(const byte* byteArray, uint32_t byteArrayLength)
+{
+    uint64_t word = 0;
+    uint32_t i = 0;
+
+#ifdef __SSE2__
+    if (byteArrayLength >= 32) {
+        __m128i fold = _mm_setzero_si128();
+        for (; i+16 <= byteArrayLength; i+=16) {
+            fold = _mm_xor_si128(fold, _mm_loadu_si128((const __m128i*)(byteArray+i)));
+        }
+
+        uint64_t words[2];
+        _mm_storeu_si128((__m128i*)words, fold);
+        word = words[0] ^ words[1];
+    }
+#endif
+
+    for (; i+8 <= byteArrayLength; i+=8) {
+        uint64_t next;
+        memcpy(&next, byteArray+i, sizeof(next));
+        word ^= next;
+    }
+
+    word ^= word >> 32;
+    word ^= word >> 16;
+    word ^= word >> 8;
+
+    byte checksum = (byte)word;
+    for (; i<byteArrayLength; i++) {
+        checksum ^= byteArray[i];
     }
 
     return checksum;
 }
 
-uint32_t Calculator::calculateAdler32Hash(byte* byteArray, uint32_t byteArrayLength)
+uint32_t Calculator::calculateAdler32Hash(const byte* byteArray, uint32_t byteArrayLength)
 {
-    uint32_t a = 1, b = 0;
-    uint32_t index;
+    return Calculator::updateAdler32Hash(ADLER32_INITIAL_VALUE, byteArray, byteArrayLength);
+}
 
-    /* Process each byte of the data in order */
-    for (index = 0; index < byteArrayLength; ++index)
-    {
-        a = (a + byteArray[index]) % _MOD_ADLER;
-        b = (b + a) % _MOD_ADLER;
+uint32_t Calculator::updateAdler32Hash(uint32_t adler32hash, const byte* byteArray, uint64_t byteArrayLength)
+{
+    return selectedAdler32Implementation().load()->function(adler32hash, byteArray, byteArrayLength);
+}
+
+bool Calculator::selectAdler32Implementation(std::string name)
+{
+    for (const Adler32Implementation& implementation : ADLER32_IMPLEMENTATIONS) {
+        if ((name == implementation.name) && implementation.isSupported()) {
+            selectedAdler32Implementation() = &implementation;
+            return true;
+        }
     }
 
-    return (b << 16) | a;
+    return false;
+}
+
+std::string Calculator::getAdler32Implementation(void)
+{
+    return std::string(selectedAdler32Implementation().load()->name);
+}
+
+uint64_t Calculator::calculateFnv1a64Hash(const byte* byteArray, uint32_t byteArrayLength)
+{
+    uint64_t hash = _FNV_OFFSET_BASIS;
+
+    for (uint32_t index = 0; index < byteArrayLength; ++index) {
+        hash ^= byteArray[index];
+        hash *= _FNV_PRIME;
+    }
+
+    return hash;
 }
@@ -25,6 +25,8 @@
 #include "communication/types.h"
 #include "utils/hardwaretypes.h"
 
+#include <string>
+
 /**
  * \brief Calculates parity bytes and hash sums
  */
@@ -34,25 +36,81 @@ class Calculator
         /**
          * \brief Calculates a parity byte by XORing all data bytes
          *
+         * The data is XORed in 64 bit words (or 128 bit with SSE2) which
+         * are folded into a byte at the end. Since XOR is associative,
+         * the parities of consecutive pieces of data can be XORed to
+         * get the parity of the whole data.
+         *
          * \param byteArray location of the data in memory
          * \param byteArrayLength length of the data (a byte count)
          */
-        static byte calculateXorParity(byte* byteArray, uint32_t byteArrayLength);
+        static byte calculateXorParity(const byte* byteArray, uint32_t byteArrayLength);
 
         /**
          * \brief Calculates a hash sum with the Adler32 algorithm
          *
-         * Implementation of this method copied from
-         * http://en.wikipedia.org/wiki/Adler-32
-         * on 2014-12-01 at 10:50 am. Look there for further information.
+         * See http://en.wikipedia.org/wiki/Adler-32 for further
+         * information. The sums are reduced modulo 65521 only once per
+         * 5552 bytes, which is the longest run that can't overflow them,
+         * and are calculated with SSE2 or AVX2 if the cpu supports it.
+         *
+         * \param byteArray location of the data in memory
+         * \param byteArrayLength length of the data (a byte count)
+         */
+        static uint32_t calculateAdler32Hash(const byte* byteArray, uint32_t byteArrayLength);
+
+        /**
+         * \brief Continues an Adler32 hash sum with further data
+         *
+         * This allows hashing data piece by piece, e.g. while it is
+         * still read or transferred:
+         * \code
+         * uint32_t hash = Calculator::ADLER32_INITIAL_VALUE;
+         * hash = Calculator::updateAdler32Hash(hash, firstPart, firstLength);
+         * hash = Calculator::updateAdler32Hash(hash, secondPart, secondLength);
+         * \endcode
+         *
+         * \param adler32hash the hash sum of the preceding data or
+         *        ADLER32_INITIAL_VALUE
+         * \param byteArray location of the data in memory
+         * \param byteArrayLength length of the data (a byte count)
+         */
+        static uint32_t updateAdler32Hash(uint32_t adler32hash, const byte* byteArray, uint64_t byteArrayLength);
+
+        /**
+         * \brief Selects the instruction set used by the Adler32
+         *        calculation instead of the fastest one supported.
+         *
+         * \param name One of "scalar", "sse2" and "avx2".
+         *
+         * \return true if the cpu supports the instruction set,\n
+         *         false otherwise
+         */
+        static bool selectAdler32Implementation(std::string name);
+
+        /**
+         * \brief Returns the name of the instruction set used by the
+         *        Adler32 calculation.
+         */
+        static std::string getAdler32Implementation(void);
+
+        /** hash sum of no data */
+        static const uint32_t ADLER32_INITIAL_VALUE = 1;
+
+        /**
+         * \brief Calculates a 64 bit hash sum with the FNV-1a algorithm
+         *
+         * Unlike Adler32, which is weak for short data, it is suitable
+         * to recognize changed sectors of a binary.
          *
          * \param byteArray location of the data in memory
          * \param byteArrayLength length of the data (a byte count)
          */
-        static uint32_t calculateAdler32Hash(byte* byteArray, uint32_t byteArrayLength);
+        static uint64_t calculateFnv1a64Hash(const byte* byteArray, uint32_t byteArrayLength);
 
     private:
-        static const int32_t _MOD_ADLER = 65521;
+        static const uint64_t _FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+        static const uint64_t _FNV_PRIME = 0x100000001b3ULL;
 };
 
 #endif  // SDK_COMMUNICATOR_PROTOCOL_CHECKSUMCALCULATOR_H_
@@ -21,6 +21,7 @@
 
 #include "configuration.h" /* assert() */
 #include "communication/protocol/exchange.h"
+#include "communication/protocol/calculator.h"
 #include "communication/protocol/frame.h"
 #include "easycores/callback.h"
 #include "utils/log/log.h"
@@ -33,14 +34,14 @@ Exchange::Exchange(
     byte expectedOpcode,
     callback_ptr callback) :
     _id(0),
-    _request(NULL),
     _REQUEST_LENGTH(requestLength),
-    _reply(NULL),
     _RECEIVING_TIMEOUT(receivingTimeout),
     _REPLY_LENGTH_AT_SUCCESS(replySuccessLength),
     _REPLY_LENGTH_AT_ERROR(replyErrorLength),
     _EXPECTED_REPLY_OPCODE(expectedOpcode),
-    _callback(callback)
+    _callback(callback),
+    _replyParity(0x00),
+    _replyParityKnown(false)
 {
 }
 
@@ -82,17 +83,33 @@ uint16_t Exchange::getReplyErrorLength(void)
     return _REPLY_LENGTH_AT_ERROR;
 }
 
-void Exchange::setSuccessReply(byte* data)
+byte* Exchange::prepareReply(uint16_t replyLength)
 {
-    _reply = std::make_shared<Frame>(data, _REPLY_LENGTH_AT_SUCCESS);
+    _replyParityKnown = false;
+    return _reply.prepare(replyLength);
 }
 
-void Exchange::setErrorReply(byte* data)
+void Exchange::setReplyParity(byte parity)
 {
-    _reply = std::make_shared<Frame>(data, _REPLY_LENGTH_AT_ERROR);
+    _replyParity = parity;
+    _replyParityKnown = true;
 }
 
-frame_ptr Exchange::getReply(void)
+bool Exchange::replyParityIsCorrect(const byte* data, uint16_t firstByte, uint16_t replyLength)
+{
+    if (_replyParityKnown) {
+        /*
+         * The parity of the covered bytes and the transmitted parity
+         * cancel each other out if it is correct. What remains is the
+         * parity of the uncovered leading bytes.
+         */
+        return (_replyParity == Calculator::calculateXorParity(data, firstByte));
+    }
+
+    return (Calculator::calculateXorParity(data+firstByte, replyLength-firstByte-1) == data[replyLength-1]);
+}
+
+const Frame& Exchange::getReply(void)
 {
     return _reply;
 }
@@ -109,17 +126,28 @@ bool Exchange::executeCallback(void)
 
     if (_callback != nullptr) {
         bool success = _callback->call();
-        Log().Get(WARNING) << "Attempt to get a new id wasn't successful!";
+        EASYFPGA_LOG(DEBUG) << "Callback executed.";
 
         return success;
     }
     else {
-        Log().Get(ERROR) << "A task callback shoul a not !";
+        EASYFPGA_LOG(ERROR) << "A task callback shoul a not !";
         return false;
     }
 }
 
+void Exchange::executeFailureCallback(void)
+{
+    /* protection */
+    assert(this->hasACallback());
+
+    if (_callback != nullptr) {
+        _callback->fail();
+        EASYFPGA_LOG(DEBUG) << "Failure callback executed.";
+    }
+}
+
 void Exchange::setRequest(byte* data)
 {
-    _request = std::make_shared<Frame>(data, _REQUEST_LENGTH);
+    _request.assign(data, _REQUEST_LENGTH);
 }
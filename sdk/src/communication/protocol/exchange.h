@@ -23,7 +23,7 @@
 #define SDK_COMMUNICATION_PROTOCOL_EXCHANGE_H_
 
 #include "communication/types.h"
-#include "communication/protocol/frame_ptr.h"
+#include "communication/protocol/frame.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 #include "utils/idmanager_fwd.h"
@@ -122,9 +122,9 @@ class Exchange
         /**
          * \brief Returns the currently set request frame.
          *
-         * \return A shared pointer to a Frame set by setRequest()
+         * \return A reference to the Frame set by setRequest()
          */
-        virtual frame_ptr getRequest(void) = 0; /* implements by inherited classes! */
+        virtual const Frame& getRequest(void) = 0; /* implements by inherited classes! */
 
         /**
          * \brief Returns the expected answer opcode to the request frame.
@@ -150,12 +150,6 @@ class Exchange
          */
         virtual bool successChecksumIsCorrect(byte* data) = 0; /* implements by inherited classes! */
 
-        /**
-         * \brief Sets the replied answer to this request and maps this
-         *        into the reply frame.
-         */
-        void setSuccessReply(byte* data);
-
         /**
          * \brief Returns the expected length of an error reply.
          */
@@ -171,10 +165,24 @@ class Exchange
         virtual bool errorChecksumIsCorrect(byte* data) = 0; /* implements by inherited classes! */
 
         /**
-         * \brief Sets the replied error to this request and maps this
-         *        into the reply frame.
+         * \brief Provides memory inside the reply frame for receiving a
+         *        reply directly into it.
+         *
+         * \param replyLength Number of bytes of the expected reply
+         *        (usually getReplySuccessLength() or getReplyErrorLength()).
+         *
+         * \return Pointer to replyLength writable bytes of the reply frame
+         */
+        byte* prepareReply(uint16_t replyLength);
+
+        /**
+         * \brief Tells the exchange the XOR parity of all bytes of the
+         *        reply, which was calculated while receiving them.
+         *
+         * The checksum checks use it instead of calculating the parity
+         * of the reply again.
          */
-        void setErrorReply(byte* data);
+        void setReplyParity(byte parity);
 
         /**
          * \brief Should write the gained information from the reply frame
@@ -185,7 +193,7 @@ class Exchange
         /**
          * \brief Returns the reply frame.
          */
-        frame_ptr getReply(void);
+        const Frame& getReply(void);
 
         /**
          * \brief Returns true if the framework registered an callback
@@ -198,12 +206,32 @@ class Exchange
          */
         bool executeCallback(void);
 
+        /**
+         * \brief Notifies a beforehand registered callback object that
+         *        this exchange failed permanently.
+         */
+        void executeFailureCallback(void);
+
     protected:
         /**
          * \brief Generates a specific request to be sent to the board.
          */
         void setRequest(byte* data);
 
+        /**
+         * \brief Checks a reply whose last byte is the XOR parity of the
+         *        preceding bytes.
+         *
+         * \param data The reply.
+         * \param firstByte Index of the first byte covered by the
+         *        parity (e.g. 1 if the opcode isn't covered).
+         * \param replyLength Length of the reply including the parity.
+         *
+         * \return true if the transmitted parity is correct,<br>
+         *         false otherwise
+         */
+        bool replyParityIsCorrect(const byte* data, uint16_t firstByte, uint16_t replyLength);
+
         /**
          * \brief Holds the exchange's id.
          */
@@ -216,7 +244,7 @@ class Exchange
         /**
          * \brief Stores the request.
          */
-        frame_ptr _request;
+        Frame _request;
 
         /**
          * \brief Stores the request's length.
@@ -226,7 +254,7 @@ class Exchange
         /**
          * \brief Stores the replied answer to the request.
          */
-        frame_ptr _reply;
+        Frame _reply;
 
         /**
          * \brief Stores the receive timeout.
@@ -252,6 +280,10 @@ class Exchange
          * \brief Stores the callback object.
          */
         callback_ptr _callback;
+
+    private:
+        byte _replyParity;
+        bool _replyParityKnown;
 };
 
 #endif  // SDK_COMMUNICATION_PROTOCOL_EXCHANGE_H_
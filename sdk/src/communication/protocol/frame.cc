@@ -24,28 +24,76 @@
 
 #include <cstring> /* memcpy() */
 
-Frame::Frame(byte* frameData, uint16_t totalFrameLength)
+Frame::Frame() :
+    _heapData(NULL),
+    _heapCapacity(0),
+    _data(_inlineData),
+    _frameLength(0)
+{
+}
+
+Frame::Frame(const byte* frameData, uint16_t totalFrameLength) :
+    _heapData(NULL),
+    _heapCapacity(0),
+    _data(_inlineData),
+    _frameLength(0)
 {
     assert(totalFrameLength >= 1);
+    this->assign(frameData, totalFrameLength);
+}
+
+Frame::~Frame()
+{
+    delete[] _heapData;
+    _heapData = NULL;
+    _data = NULL;
+}
+
+void Frame::assign(const byte* frameData, uint16_t totalFrameLength)
+{
+    memcpy(this->prepare(totalFrameLength), frameData, totalFrameLength);
+}
+
+byte* Frame::prepare(uint16_t totalFrameLength)
+{
+    if (totalFrameLength <= INLINE_CAPACITY) {
+        _data = _inlineData;
+    }
+    else {
+        if (totalFrameLength > _heapCapacity) {
+            delete[] _heapData;
+            _heapData = new byte[totalFrameLength];
+            _heapCapacity = totalFrameLength;
+        }
+        _data = _heapData;
+    }
 
-    _data = new byte[totalFrameLength];
     _frameLength = totalFrameLength;
+    return _data;
+}
+
+const byte* Frame::data(void) const
+{
+    return _data;
+}
 
-    memcpy(_data, frameData, _frameLength);
+uint16_t Frame::size(void) const
+{
+    return _frameLength;
 }
 
-Frame::~Frame()
+bool Frame::empty(void) const
 {
-    delete[] _data;
-    _data = NULL;
+    return (_frameLength == 0);
 }
 
-byte Frame::getOperationCode(void)
+byte Frame::getOperationCode(void) const
 {
+    assert(_frameLength >= 1);
     return *(_data);
 }
 
-idval Frame::getId(void)
+idval Frame::getId(void) const
 {
     if (_frameLength > 2) {
         return (idval)*(_data+1);
@@ -55,15 +103,12 @@ idval Frame::getId(void)
     }
 }
 
-uint16_t Frame::getTotalFrameLength(void)
+uint16_t Frame::getTotalFrameLength(void) const
 {
     return _frameLength;
 }
 
-void Frame::getFrameRawData(byte* destByteArray)
+void Frame::getFrameRawData(byte* destByteArray) const
 {
-    /**
-     * \todo Safety? (Copies the given data to the pointers memory)
-     */
     memcpy(destByteArray, _data, _frameLength);
 }
@@ -28,10 +28,26 @@
 /**
  * \brief Container for holding all neccessary information about one data
  *        transfer over the serial connection line.
+ *
+ * Frames up to INLINE_CAPACITY bytes (this covers all register exchanges)
+ * are stored inside the object itself. Only larger frames, e.g. a sector
+ * upload, need a heap allocation. The raw data can be accessed without
+ * copying by data() and size().
  */
 class Frame
 {
     public:
+        /**
+         * Maximum frame length which can be stored without a heap
+         * allocation. (The longest soc reply has 3+255 bytes.)
+         */
+        static const uint16_t INLINE_CAPACITY = 272;
+
+        /**
+         * \brief Creates an empty frame.
+         */
+        Frame();
+
         /**
          * \brief Creates and initializes an Frame with the specified
          *        values.
@@ -41,16 +57,58 @@ class Frame
          *
          * \param totalFrameLength Size of the turned over byte buffer
          */
-        Frame(byte* frameData, uint16_t totalFrameLength);
+        Frame(const byte* frameData, uint16_t totalFrameLength);
         ~Frame();
 
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+
+        /**
+         * \brief Replaces the frame's raw data by a copy of the given
+         *        byte buffer.
+         *
+         * \param frameData Pointer to the bytes to copy.
+         *
+         * \param totalFrameLength Number of bytes to copy.
+         */
+        void assign(const byte* frameData, uint16_t totalFrameLength);
+
+        /**
+         * \brief Resizes the frame and returns its writable raw data,
+         *        e.g. for receiving bytes directly into the frame.
+         *
+         * \param totalFrameLength New length of the frame.
+         *
+         * \return Pointer to totalFrameLength bytes of uninitialized
+         *         memory owned by this frame
+         */
+        byte* prepare(uint16_t totalFrameLength);
+
+        /**
+         * \brief Returns a read-only view of the frame's raw data.
+         *
+         * The pointer remains valid until the frame will be modified or
+         * destroyed.
+         */
+        const byte* data(void) const;
+
+        /**
+         * \brief Get the length of the frame's raw byte array.
+         */
+        uint16_t size(void) const;
+
+        /**
+         * \brief Checks whether the frame holds no data.
+         */
+        bool empty(void) const;
+
         /**
          * \brief Returns the first byte of the frame's raw data which
          *        is always defined as the operation code.
          *
          * \return An operation code
          */
-        byte getOperationCode(void);
+        byte getOperationCode(void) const;
 
         /**
          * \deprecated Ids don't have to be used.
@@ -61,23 +119,29 @@ class Frame
          * \return an 8-bit wide id if this frame has stored an id,\n
          *         0 otherwise
          */
-        idval getId(void);
+        idval getId(void) const;
 
         /**
          * \brief Get the length of the frame's raw byte array.
          *
          * \return an 16-bit wide integer
          */
-        uint16_t getTotalFrameLength(void);
+        uint16_t getTotalFrameLength(void) const;
 
         /**
          * \brief Copies the frame's raw data into a byte array.
          *
+         * Prefer data() if the bytes don't have to outlive the frame.
+         *
          * \param destByteArray Pointer to an byte array which have to
+         *        provide at least getTotalFrameLength() bytes.
          */
-        void getFrameRawData(byte* destByteArray);
+        void getFrameRawData(byte* destByteArray) const;
 
     private:
+        byte _inlineData[INLINE_CAPACITY];
+        byte* _heapData;
+        uint16_t _heapCapacity;
         byte* _data;
         uint16_t _frameLength;
 };
@@ -24,7 +24,7 @@
 
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
-#include "communication/protocol/frame_ptr.h"
+#include "communication/protocol/frame.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 
@@ -49,7 +49,7 @@ class Sector4096ByteWrite : public Exchange
          *
          * \param callback
          */
-        Sector4096ByteWrite(uint16_t sectorId, byte* sector, callback_ptr callback) :
+        Sector4096ByteWrite(uint16_t sectorId, const byte* sector, callback_ptr callback) :
             Exchange(4103, 1000000, 1, 1, Exchange::SHARED_REPLY_CODES::ACK, callback),
             _sectorId(sectorId),
             _sector(sector)
@@ -63,12 +63,13 @@ class Sector4096ByteWrite : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
-                byte requestBuffer[_REQUEST_LENGTH];
+            if (_request.empty()) {
+                /* build the request directly inside the frame */
+                byte* requestBuffer = _request.prepare(_REQUEST_LENGTH);
 
                 /* byte #1: operation code */
                 requestBuffer[0] = (byte)0x22;
@@ -89,8 +90,6 @@ class Sector4096ByteWrite : public Exchange
                 requestBuffer[4100] = (hash & 0xFF00) >> 8;
                 requestBuffer[4101] = (hash & 0xFF0000) >> 16;
                 requestBuffer[4102] = (hash & 0xFF000000) >> 24;
-
-                this->setRequest(requestBuffer);
             }
 
             return _request;
@@ -129,7 +128,7 @@ class Sector4096ByteWrite : public Exchange
 
     private:
         uint16_t _sectorId;
-        byte* _sector;
+        const byte* _sector;
 };
 
 #endif  // SDK_COMMUNICATOR_PROTOCOL_MCUEXCHANGES_SECTOR4096BYTEWRITE_H_
@@ -23,7 +23,7 @@
 #define SDK_COMMUNICATOR_PROTOCOL_MCUEXCHANGES_SELECTSOC_H_
 
 #include "communication/protocol/exchange.h"
-#include "communication/protocol/frame_ptr.h"
+#include "communication/protocol/frame.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 
@@ -58,11 +58,11 @@ class SelectSoc : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
+            if (_request.empty()) {
                 byte requestBuffer[_REQUEST_LENGTH];
                 requestBuffer[0] = (byte)0x44;
                 this->setRequest(requestBuffer);
@@ -25,7 +25,6 @@
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
 #include "communication/protocol/frame.h"
-#include "communication/protocol/frame_ptr.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 #include "utils/log/log.h"
@@ -62,11 +61,11 @@ class SerialRead : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
+            if (_request.empty()) {
                 byte requestBuffer[_REQUEST_LENGTH];
                 requestBuffer[0] = (byte)0xD3;
                 this->setRequest(requestBuffer);
@@ -84,11 +83,7 @@ class SerialRead : public Exchange
          */
         bool successChecksumIsCorrect(byte* data)
         {
-            byte calculatedParity = Calculator::calculateXorParity(data, _REPLY_LENGTH_AT_SUCCESS-1);
-            Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-            byte transmittedParity = data[_REPLY_LENGTH_AT_SUCCESS-1];
-            Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-            return (calculatedParity == transmittedParity);
+            return this->replyParityIsCorrect(data, 0, _REPLY_LENGTH_AT_SUCCESS);
         }
 
         /**
@@ -109,9 +104,7 @@ class SerialRead : public Exchange
          */
         void writeResults(void)
         {
-            uint16_t dataLength = _reply->getTotalFrameLength();
-            byte buffer[dataLength];
-            _reply->getFrameRawData(buffer);
+            const byte* buffer = _reply.data();
 
             *(_serial) = (*(buffer+4) << 24) | (*(buffer+3) << 16) | (*(buffer+2) << 8) | (*(buffer+1) << 0);
         }
@@ -24,7 +24,7 @@
 
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
-#include "communication/protocol/frame_ptr.h"
+#include "communication/protocol/frame.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 
@@ -60,11 +60,11 @@ class SerialWrite : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
+            if (_request.empty()) {
                 byte requestBuffer[_REQUEST_LENGTH];
                 requestBuffer[0] = (byte)0xDD;
                 requestBuffer[1] = (_serialNumber & 0xFF);
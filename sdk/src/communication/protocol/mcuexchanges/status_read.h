@@ -25,7 +25,6 @@
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
 #include "communication/protocol/frame.h"
-#include "communication/protocol/frame_ptr.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 #include "utils/log/log.h"
@@ -67,11 +66,11 @@ class StatusRead : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
+            if (_request.empty()) {
                 byte requestBuffer[_REQUEST_LENGTH];
                 requestBuffer[0] = (byte)0xC3;
                 this->setRequest(requestBuffer);
@@ -89,18 +88,8 @@ class StatusRead : public Exchange
          */
         bool successChecksumIsCorrect(byte* data)
         {
-            /*
-             * The parity bit is calculated without the opcode (first byte).
-             * The last byte of the transmitted reply corresponds to the
-             * transmitted parity.
-             * Thats why we have to calculate the parity with length
-             * _REPLY_LENGTH_AT_SUCCESS - 2!
-             */
-            byte calculatedParity = Calculator::calculateXorParity(data+1, (uint32_t)(_REPLY_LENGTH_AT_SUCCESS-2));
-            Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-            byte transmittedParity = data[_REPLY_LENGTH_AT_SUCCESS-1];
-            Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-            return (calculatedParity == transmittedParity);
+            /* the parity is calculated without the opcode (first byte) */
+            return this->replyParityIsCorrect(data, 1, _REPLY_LENGTH_AT_SUCCESS);
         }
 
         /**
@@ -121,9 +110,7 @@ class StatusRead : public Exchange
          */
         void writeResults(void)
         {
-            uint16_t dataLength = _reply->getTotalFrameLength();
-            byte buffer[dataLength];
-            _reply->getFrameRawData(buffer);
+            const byte* buffer = _reply.data();
 
             *(_isFpgaConfigured) = (((*(buffer+1) & 0x04) >> 2) == 1);
             *(_adler32hash) = (buffer[11] << 24) | (buffer[10] << 16) | (buffer[9] << 8) | (buffer[8] << 0);
@@ -24,7 +24,7 @@
 
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
-#include "communication/protocol/frame_ptr.h"
+#include "communication/protocol/frame.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 #include "utils/log/log.h"
@@ -61,11 +61,11 @@ class ReadRegister : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
+            if (_request.empty()) {
                 byte requestBuffer[_REQUEST_LENGTH];
                 requestBuffer[0] = (byte)0x77;
                 requestBuffer[1] = (byte)_id;
@@ -86,11 +86,7 @@ class ReadRegister : public Exchange
          *         false otherwise
          */
         bool successChecksumIsCorrect(byte* data) {
-            byte calculatedParity = Calculator::calculateXorParity(data, (uint32_t)(_REPLY_LENGTH_AT_SUCCESS-1));
-            Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-            byte transmittedParity = data[_REPLY_LENGTH_AT_SUCCESS-1];
-            Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-            return (calculatedParity == transmittedParity);
+            return this->replyParityIsCorrect(data, 0, _REPLY_LENGTH_AT_SUCCESS);
         }
 
         /**
@@ -101,11 +97,7 @@ class ReadRegister : public Exchange
          *         false otherwise
          */
         bool errorChecksumIsCorrect(byte* data) {
-            byte calculatedParity = Calculator::calculateXorParity(data, (uint32_t)(_REPLY_LENGTH_AT_ERROR-1));
-            Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-            byte transmittedParity = data[_REPLY_LENGTH_AT_ERROR-1];
-            Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-            return (calculatedParity == transmittedParity);
+            return this->replyParityIsCorrect(data, 0, _REPLY_LENGTH_AT_ERROR);
         }
 
         /**
@@ -114,9 +106,7 @@ class ReadRegister : public Exchange
          */
         void writeResults(void)
         {
-            uint16_t dataLength = _reply->getTotalFrameLength();
-            byte buffer[dataLength];
-            _reply->getFrameRawData(buffer);
+            const byte* buffer = _reply.data();
             *(_target) = buffer[2];
         }
 
@@ -24,11 +24,13 @@
 
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
-#include "communication/protocol/frame_ptr.h"
+#include "communication/protocol/frame.h"
 #include "easycores/callback_ptr.h"
 #include "utils/hardwaretypes.h"
 #include "utils/log/log.h"
 
+#include <cstring> /* memcpy(3) */
+
 /**
  * \brief Defines an soc operation for reading a single register multiple times.
  *        (An soc context is neccessary.)
@@ -65,11 +67,11 @@ class ReadMultiRegister : public Exchange
         /**
          * \brief Gets a pre-defined request frame for this exchange
          *
-         * \return A pointer to the request frame
+         * \return A reference to the request frame
          */
-        frame_ptr getRequest(void)
+        const Frame& getRequest(void)
         {
-            if (_request == NULL) {
+            if (_request.empty()) {
                 byte requestBuffer[_REQUEST_LENGTH];
                 requestBuffer[0] = (byte)0x73;
                 requestBuffer[1] = (byte)_id;
@@ -91,11 +93,7 @@ class ReadMultiRegister : public Exchange
          *         false otherwise
          */
         bool successChecksumIsCorrect(byte* data) {
-            byte calculatedParity = Calculator::calculateXorParity(data, (uint32_t)(_REPLY_LENGTH_AT_SUCCESS-1));
-            Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-            byte transmittedParity = data[_REPLY_LENGTH_AT_SUCCESS-1];
-            Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-            return (calculatedParity == transmittedParity);
+            return this->replyParityIsCorrect(data, 0, _REPLY_LENGTH_AT_SUCCESS);
         }
 
         /**
@@ -106,11 +104,7 @@ class ReadMultiRegister : public Exchange
          *         false otherwise
          */
         bool errorChecksumIsCorrect(byte* data) {
-            byte calculatedParity = Calculator::calculateXorParity(data, (uint32_t)(_REPLY_LENGTH_AT_ERROR-1));
-            Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-            byte transmittedParity = data[_REPLY_LENGTH_AT_ERROR-1];
-            Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-            return (calculatedParity == transmittedParity);
+            return this->replyParityIsCorrect(data, 0, _REPLY_LENGTH_AT_ERROR);
         }
 
         /**
@@ -119,9 +113,7 @@ class ReadMultiRegister : public Exchange
          */
         void writeResults(void)
         {
-            uint16_t dataLength = _reply->getTotalFrameLength();
-            byte buffer[dataLength];
-            _reply->getFrameRawData(buffer);
+            const byte* buffer = _reply.data();
             memcpy(_target, buffer+2, _length);
         }
 
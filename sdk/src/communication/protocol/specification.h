@@ -66,4 +66,12 @@ const timeoutval WAITING_TIME_AFTER_SWITCH = 1000; // = 1 ms
  */
 const timeoutval FLUSHING_TIMEOUT = 50000; // = 50 ms
 
+/**
+ * \brief The maximum number of bytes a single multiple times or auto
+ *        address increment register exchange can transfer.
+ *
+ * (The length is transmitted in one byte of the request.)
+ */
+const uint32_t MAX_MULTI_REGISTER_LENGTH = 255;
+
 #endif  // SDK_COMMUNICATION_PROTOCOL_SPECIFICATION_H_
@@ -0,0 +1,193 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "communication/sectormanifest.h"
+#include "communication/protocol/calculator.h"
+#include "utils/log/log.h"
+
+#include <cstdio> /* rename(2) */
+#include <cstring> /* memcpy(), memset() */
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h> /* open() */
+#include <sys/file.h> /* flock() */
+#include <unistd.h> /* getpid(), close() */
+
+SectorManifest::SectorManifest(std::string fileName) :
+    _fileName(fileName)
+{
+    SectorManifest::load(_fileName, &_entries);
+}
+
+SectorManifest::~SectorManifest()
+{
+}
+
+std::vector<uint64_t> SectorManifest::calculateSectorHashes(const byte* binary, uint64_t binaryLength)
+{
+    std::vector<uint64_t> hashes;
+    hashes.reserve((binaryLength + 4095) / 4096);
+
+    uint64_t offset;
+    for (offset = 0; offset + 4096 <= binaryLength; offset += 4096) {
+        hashes.push_back(Calculator::calculateFnv1a64Hash(binary + offset, 4096));
+    }
+
+    if (offset < binaryLength) {
+        byte lastSector[4096];
+        memcpy(lastSector, binary + offset, binaryLength - offset);
+        memset(lastSector + (binaryLength - offset), 0x00, 4096 - (binaryLength - offset));
+        hashes.push_back(Calculator::calculateFnv1a64Hash(lastSector, 4096));
+    }
+
+    return hashes;
+}
+
+bool SectorManifest::lookup(uint32_t serial, uint32_t binaryHash, std::vector<uint64_t>* sectorHashes)
+{
+    auto entry = _entries.find(serial);
+    if ((entry == _entries.end()) || (entry->second.binaryHash != binaryHash)) {
+        return false;
+    }
+
+    *sectorHashes = entry->second.sectorHashes;
+    return true;
+}
+
+void SectorManifest::store(uint32_t serial, uint32_t binaryHash, const std::vector<uint64_t>& sectorHashes)
+{
+    Entry entry;
+    entry.binaryHash = binaryHash;
+    entry.sectorHashes = sectorHashes;
+
+    _entries[serial] = entry;
+    _modifiedSerials.insert(serial);
+}
+
+void SectorManifest::remove(uint32_t serial)
+{
+    _entries.erase(serial);
+    _modifiedSerials.insert(serial);
+}
+
+bool SectorManifest::save(void)
+{
+    if (_fileName.empty() || _modifiedSerials.empty()) {
+        return true;
+    }
+
+    /*
+     * Several processes or BoardManager threads may upload to different
+     * boards at the same time. Serialize the read-modify-write of the
+     * file and apply only our own changes to its current content.
+     */
+    std::string lockName(_fileName + ".lock");
+    int lock = open(lockName.c_str(), O_RDWR | O_CREAT, 0644);
+    if ((lock < 0) || (flock(lock, LOCK_EX) != 0)) {
+        EASYFPGA_LOG(WARNING) << "The sector manifest " << _fileName << " couldn't be locked!";
+        if (lock >= 0) {
+            close(lock);
+        }
+        return false;
+    }
+
+    std::map<uint32_t, Entry> current;
+    SectorManifest::load(_fileName, &current);
+
+    for (uint32_t serial : _modifiedSerials) {
+        auto entry = _entries.find(serial);
+        if (entry != _entries.end()) {
+            current[serial] = entry->second;
+        }
+        else {
+            current.erase(serial);
+        }
+    }
+
+    std::stringstream content;
+    for (auto& entry : current) {
+        content << "0x" << std::hex << entry.first << " 0x" << entry.second.binaryHash;
+        for (uint64_t hash : entry.second.sectorHashes) {
+            content << " " << hash;
+        }
+        content << std::endl;
+    }
+
+    bool success = true;
+
+    std::string temporaryName(_fileName + "." + std::to_string(getpid()));
+    std::ofstream file(temporaryName, std::ios::out | std::ios::trunc);
+    if (file.is_open()) {
+        file << content.str();
+        file.close();
+        success = !file.fail() && (rename(temporaryName.c_str(), _fileName.c_str()) == 0);
+    }
+    else {
+        success = false;
+    }
+
+    if (success) {
+        _entries = current;
+        _modifiedSerials.clear();
+    }
+    else {
+        EASYFPGA_LOG(WARNING) << "The sector manifest " << _fileName << " couldn't be written!";
+        std::remove(temporaryName.c_str());
+    }
+
+    flock(lock, LOCK_UN);
+    close(lock);
+
+    return success;
+}
+
+void SectorManifest::load(std::string fileName, std::map<uint32_t, Entry>* entries)
+{
+    if (fileName.empty()) {
+        return;
+    }
+
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        EASYFPGA_LOG(DEBUG) << "No sector manifest found at " << fileName;
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        uint32_t serial;
+        Entry entry;
+
+        if (fields >> std::hex >> serial >> entry.binaryHash) {
+            uint64_t hash;
+            while (fields >> hash) {
+                entry.sectorHashes.push_back(hash);
+            }
+            (*entries)[serial] = entry;
+        }
+        else {
+            EASYFPGA_LOG(WARNING) << "Ignoring malformed line in sector manifest: " << line;
+        }
+    }
+}
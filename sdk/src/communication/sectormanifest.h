@@ -0,0 +1,120 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_COMMUNICATION_SECTORMANIFEST_H_
+#define SDK_COMMUNICATION_SECTORMANIFEST_H_
+
+#include "utils/hardwaretypes.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Remembers the sector hashes of the binary last uploaded to an
+ *        easyFPGA with a certain serial number.
+ *
+ * When a changed binary is uploaded, only the sectors whose hashes
+ * differ from the remembered ones have to be written. An entry is only
+ * trusted if the Adler32 hash of the whole binary, which the easyFPGA
+ * reports in its status, still matches the remembered one. Otherwise
+ * the mcu's memory might have been written by another host.
+ *
+ * The manifest file contains one line per board:
+ * \code
+ * <serial in hex> <adler32 of the binary in hex> <fnv-1a hash of every sector in hex>...
+ * \endcode
+ */
+class SectorManifest
+{
+    public:
+        /**
+         * \brief Loads the manifest from a file.
+         *
+         * \param fileName The manifest file or an empty string for a
+         *        manifest which is neither loaded nor saved.
+         */
+        SectorManifest(std::string fileName);
+        ~SectorManifest();
+
+        /**
+         * \brief Calculates the hashes of all 4096 byte sectors of a
+         *        binary. An incomplete last sector is padded with
+         *        null-bytes like during the upload.
+         */
+        static std::vector<uint64_t> calculateSectorHashes(const byte* binary, uint64_t binaryLength);
+
+        /**
+         * \brief Returns the sector hashes remembered for an easyFPGA.
+         *
+         * \param serial The board's serial number.
+         *
+         * \param binaryHash The Adler32 hash of the binary stored by the
+         *        easyFPGA, as read from its status.
+         *
+         * \param sectorHashes Receives the sector hashes.
+         *
+         * \return true if the board is known and still stores the
+         *         remembered binary,<br>
+         *         false otherwise
+         */
+        bool lookup(uint32_t serial, uint32_t binaryHash, std::vector<uint64_t>* sectorHashes);
+
+        /**
+         * \brief Remembers the binary uploaded to an easyFPGA.
+         */
+        void store(uint32_t serial, uint32_t binaryHash, const std::vector<uint64_t>& sectorHashes);
+
+        /**
+         * \brief Forgets an easyFPGA, e.g. because its memory is about
+         *        to be overwritten.
+         */
+        void remove(uint32_t serial);
+
+        /**
+         * \brief Writes the changed entries to the manifest file.
+         *
+         * Entries changed by other processes (e.g. uploading to other
+         * boards in parallel) since loading the file are preserved.
+         *
+         * \return true if the file was written or didn't have to be
+         *         written,<br>
+         *         false otherwise
+         */
+        bool save(void);
+
+    private:
+        struct Entry {
+            uint32_t binaryHash;
+            std::vector<uint64_t> sectorHashes;
+        };
+
+        static void load(std::string fileName, std::map<uint32_t, Entry>* entries);
+
+        std::string _fileName;
+        std::map<uint32_t, Entry> _entries;
+        std::set<uint32_t> _modifiedSerials;
+};
+
+#endif  // SDK_COMMUNICATION_SECTORMANIFEST_H_
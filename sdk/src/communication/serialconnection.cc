@@ -20,18 +20,28 @@
  */
 
 #include "configuration.h"
+#include "communication/exchangetrace.h"
+#include "communication/metrics.h"
 #include "communication/serialconnection.h"
+#include "protocol/calculator.h"
 #include "protocol/frame.h"
 #include "protocol/specification.h"
+#include "utils/config/configurationfile.h"
 #include "utils/log/log.h"
+#include "utils/os/eventloop.h"
 #include "utils/os/types.h"
+#include "utils/spscringbuffer.h"
 
-#include <unistd.h> /* select() */
+#include <unistd.h> /* read(), write() */
+#include <sys/select.h> /* select() */
+#include <sys/epoll.h> /* EPOLLHUP, EPOLLERR */
 #include <termios.h> /* termios, cfsetospeed(), cfsetispeed(), tcflush() */
 #include <fcntl.h> /* open(), close() */
 #include <cstring> /* memset() */
 #include <sys/ioctl.h> /* ioctl() */
 #include <errno.h> /* errno */
+#include <algorithm> /* min(2) */
+#include <chrono>
 #include <cstring> /* strerror(1) */
 
 /*
@@ -42,12 +52,32 @@
 #define NOTCONNECTED (_fd < 0)
 
 SerialConnection::SerialConnection() :
-    _fd(-1)
+    _fd(-1),
+    _bufferedFrames(0),
+    _sentFrames(0),
+    _writeCalls(0),
+    _sentBytes(0),
+    _receivedBytes(0),
+    _eventLoop(nullptr),
+    _ownsEventLoop(false),
+    _receiveRing(NULL),
+    _receiveFailed(false),
+    _receiverWaiting(false),
+    _receiveSuspended(false),
+    _useReceiveThread(ConfigurationFile::getInstance().getSerialReceiveThread())
 {
+    _sendBuffer.reserve(SEND_BUFFER_FLUSH_THRESHOLD);
+
+    /* 0 is left out after a wrap around, it marks records without a connection */
+    static std::atomic<uint16_t> nextConnectionId(1);
+    do {
+        _connectionId = nextConnectionId.fetch_add(1, std::memory_order_relaxed);
+    } while (_connectionId == 0);
 }
 
 SerialConnection::~SerialConnection()
 {
+    this->detachFromEventLoop();
 }
 
 bool SerialConnection::openDevice(std::string device)
@@ -88,14 +118,27 @@ bool SerialConnection::openDevice(std::string device)
              */
             tcsetattr(_fd, TCSANOW, &tio);
 
-            return true;
+            _sendBuffer.clear();
+            _bufferedFrames = 0;
+            _sentFrames = 0;
+            _writeCalls = 0;
+            _sentBytes = 0;
+            _receivedBytes = 0;
+
+            if (this->attachToEventLoop()) {
+                ExchangeTrace::getInstance().traceOpen(_connectionId, device);
+                return true;
+            }
+
+            close(_fd);
+            _fd = -1;
         }
         else if (_fd == -1) {
-            Log().Get(ERROR) << "Error while opening serial device '" << device << "': " << strerror(errno);
+            EASYFPGA_LOG(ERROR) << "Error while opening serial device '" << device << "': " << strerror(errno);
         }
     }
     else {
-        Log().Get(WARNING) << "Opening serial device failed. This serial connection is already opened. You have to call closeDevice() first.";
+        EASYFPGA_LOG(WARNING) << "Opening serial device failed. This serial connection is already opened. You have to call closeDevice() first.";
     }
 
     return false;
@@ -104,6 +147,7 @@ bool SerialConnection::openDevice(std::string device)
 bool SerialConnection::closeDevice(void)
 {
     this->flushBuffers();
+    this->detachFromEventLoop();
 
     if (CONNECTED) {
         returnval success = close(_fd);
@@ -113,11 +157,11 @@ bool SerialConnection::closeDevice(void)
             return true;
         }
         else if (success == -1) {
-            Log().Get(ERROR) << "Error while closing serial device: " << strerror(errno);
+            EASYFPGA_LOG(ERROR) << "Error while closing serial device: " << strerror(errno);
         }
     }
     else {
-        Log().Get(WARNING) << "Closing serial device failed. This serial connection is already closed. You have to call openDevice() first.";
+        EASYFPGA_LOG(WARNING) << "Closing serial device failed. This serial connection is already closed. You have to call openDevice() first.";
     }
 
     _fd = -1;
@@ -127,9 +171,9 @@ bool SerialConnection::closeDevice(void)
 bool SerialConnection::flushBuffers(void)
 {
     if (CONNECTED) {
-        Log().Get(DEBUG) << "Flushing buffers...";
-        Log().Get(DEBUG) << "Send queue size before flushing: " << std::dec << (int32_t)this->getSendQueueSize();
-        Log().Get(DEBUG) << "Receive queue size before flushing: " << std::dec << (int32_t)this->getReceiveQueueSize();
+        EASYFPGA_LOG(DEBUG) << "Flushing buffers...";
+        EASYFPGA_LOG(DEBUG) << "Send queue size before flushing: " << std::dec << (int32_t)this->getSendQueueSize();
+        EASYFPGA_LOG(DEBUG) << "Receive queue size before flushing: " << std::dec << (int32_t)this->getReceiveQueueSize();
 
         /*
          * The function tcflush() should be used to flush the serial in-
@@ -145,14 +189,26 @@ bool SerialConnection::flushBuffers(void)
          */
         returnval success = tcflush(_fd, TCIOFLUSH);
 
-        Log().Get(DEBUG) << "Send queue size after flushing: " << std::dec << (int32_t)this->getSendQueueSize();
-        Log().Get(DEBUG) << "Receive queue size after flushing: " << std::dec << (int32_t)this->getReceiveQueueSize();
+        /* frames which didn't leave the send buffer are dropped as well */
+        if (!_sendBuffer.empty()) {
+            EASYFPGA_LOG(DEBUG) << "Drop " << std::dec << _bufferedFrames << " buffered frames";
+            _sendBuffer.clear();
+            _bufferedFrames = 0;
+        }
+
+        /* and the bytes which already were moved into the ring */
+        if (_receiveRing != NULL) {
+            _receiveRing->clear();
+        }
+
+        EASYFPGA_LOG(DEBUG) << "Send queue size after flushing: " << std::dec << (int32_t)this->getSendQueueSize();
+        EASYFPGA_LOG(DEBUG) << "Receive queue size after flushing: " << std::dec << (int32_t)this->getReceiveQueueSize();
         if (this->getReceiveQueueSize() > 0) {
             /* fetch manually all bytes from the recieve buffer */
             byte trashByte = (byte)0x00;
-            Log().Get(WARNING) << "You can ignore the following timeout warning...";
+            EASYFPGA_LOG(WARNING) << "You can ignore the following timeout warning...";
             while (this->receive(&trashByte, 1, FLUSHING_TIMEOUT)) {
-                Log().Get(WARNING) << "A byte removed from recieve buffer while flushing: 0x" << std::hex << (int32_t)trashByte;
+                EASYFPGA_LOG(WARNING) << "A byte removed from recieve buffer while flushing: 0x" << std::hex << (int32_t)trashByte;
             }
         }
 
@@ -161,50 +217,142 @@ bool SerialConnection::flushBuffers(void)
         }
     }
     else {
-        Log().Get(WARNING) << "Flushing buffers of serial connection failed. No device opened!";
+        EASYFPGA_LOG(WARNING) << "Flushing buffers of serial connection failed. No device opened!";
     }
 
-    Log().Get(ERROR) << "Flushing buffers not successful!";
+    EASYFPGA_LOG(ERROR) << "Flushing buffers not successful!";
     return false;
 }
 
-bool SerialConnection::send(frame_ptr f)
+bool SerialConnection::send(const Frame& f)
+{
+    /* append the frame to the buffered ones for keeping their order */
+    if (this->enqueue(f)) {
+        return this->flushSendBuffer();
+    }
+
+    return false;
+}
+
+bool SerialConnection::send(byte* byteArray, uint32_t byteArrayLength)
 {
     if (CONNECTED) {
-        uint16_t dataLength = f->getTotalFrameLength();
+        if (this->flushSendBuffer()) {
+            _writeCalls++;
+            return this->writeCompletely(byteArray, byteArrayLength);
+        }
+    }
+    else {
+        EASYFPGA_LOG(WARNING) << "Send failed. No device opened!";
+    }
 
-        byte framedata[dataLength];
-        f->getFrameRawData(framedata);
+    return false;
+}
 
-        returnval bytesSend = write(_fd, framedata, dataLength);
+bool SerialConnection::enqueue(const Frame& f)
+{
+    if (CONNECTED) {
+        _sendBuffer.insert(_sendBuffer.end(), f.data(), f.data() + f.size());
+        _bufferedFrames++;
 
-        if (bytesSend == dataLength) {
-            return true;
+        if (_sendBuffer.size() >= SEND_BUFFER_FLUSH_THRESHOLD) {
+            return this->flushSendBuffer();
         }
+
+        return true;
     }
     else {
-        Log().Get(WARNING) << "Send failed. No device opened!";
+        EASYFPGA_LOG(WARNING) << "Send failed. No device opened!";
     }
 
     return false;
 }
 
-bool SerialConnection::send(byte* byteArray, uint32_t byteArrayLength)
+bool SerialConnection::flushSendBuffer(void)
 {
+    if (_sendBuffer.empty()) {
+        return true;
+    }
+
     if (CONNECTED) {
-        returnval bytesSend = write(_fd, byteArray, byteArrayLength);
+        EASYFPGA_LOG(DEBUG) << "Write " << std::dec << _bufferedFrames << " buffered frames (" << _sendBuffer.size() << " bytes)";
 
-        if ((uint32_t)bytesSend == byteArrayLength) {
-            return true;
-        }
+        _writeCalls++;
+        _sentFrames += _bufferedFrames;
+
+        bool success = this->writeCompletely(_sendBuffer.data(), _sendBuffer.size());
+
+        _sendBuffer.clear();
+        _bufferedFrames = 0;
+
+        return success;
     }
     else {
-        Log().Get(WARNING) << "Send failed. No device opened!";
+        EASYFPGA_LOG(WARNING) << "Send failed. No device opened!";
     }
 
     return false;
 }
 
+uint64_t SerialConnection::getNumberOfSentFrames(void)
+{
+    return _sentFrames;
+}
+
+uint64_t SerialConnection::getNumberOfWriteCalls(void)
+{
+    return _writeCalls;
+}
+
+double SerialConnection::getFramesPerWriteCall(void)
+{
+    if (_writeCalls == 0) {
+        return 0.0;
+    }
+
+    return (double)_sentFrames / (double)_writeCalls;
+}
+
+bool SerialConnection::writeCompletely(byte* byteArray, uint32_t byteArrayLength)
+{
+    ExchangeTrace::getInstance().traceWrite(_connectionId, byteArray, byteArrayLength);
+
+    uint32_t bytesRemaining = byteArrayLength;
+
+    while (bytesRemaining > 0) {
+        returnval bytesSend = write(_fd, byteArray+(byteArrayLength-bytesRemaining), bytesRemaining);
+
+        if (bytesSend > 0) {
+            bytesRemaining -= bytesSend;
+            _sentBytes.fetch_add(bytesSend, std::memory_order_relaxed);
+            Metrics::getInstance().countSentBytes(bytesSend);
+        }
+        else if ((bytesSend == -1) && (errno == EAGAIN)) {
+            /* the device was opened nonblocking: wait until the send queue drains */
+            fd_set writeFdSet;
+            FD_ZERO(&writeFdSet);
+            FD_SET(_fd, &writeFdSet);
+            select(_fd+1, NULL, &writeFdSet, NULL, NULL);
+        }
+        else {
+            EASYFPGA_LOG(ERROR) << "Error while write() call: " << strerror(errno);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint64_t SerialConnection::getNumberOfSentBytes(void)
+{
+    return _sentBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t SerialConnection::getNumberOfReceivedBytes(void)
+{
+    return _receivedBytes.load(std::memory_order_relaxed);
+}
+
 int32_t SerialConnection::getSendQueueSize(void)
 {
     int32_t bytes = -1;
@@ -213,7 +361,7 @@ int32_t SerialConnection::getSendQueueSize(void)
         ioctl(_fd, TIOCOUTQ, &bytes);
     }
     else {
-        Log().Get(WARNING) << "Get send buffer size failed. No device opened!";
+        EASYFPGA_LOG(WARNING) << "Get send buffer size failed. No device opened!";
     }
 
     return bytes;
@@ -221,70 +369,221 @@ int32_t SerialConnection::getSendQueueSize(void)
 
 bool SerialConnection::receive(byte* byteArray, uint32_t byteArrayLength, timeoutval timeoutus)
 {
-    if (CONNECTED) {
-        fd_set readFdSet;
+    return this->receive(byteArray, byteArrayLength, timeoutus, NULL);
+}
 
-        /* create and init buffer */
-        byte buffer[byteArrayLength];
-        for (uint32_t i=0; i<byteArrayLength; i++) {
-            *(buffer+i) = (byte)0x00;
+bool SerialConnection::receive(byte* byteArray, uint32_t byteArrayLength, timeoutval timeoutus, byte* xorParity)
+{
+    if (CONNECTED) {
+        /* a reply can only be awaited if its request left the buffer */
+        if (!this->flushSendBuffer()) {
+            return false;
         }
 
-        /* get values for timeval struct from function parameters */
-        uint32_t timeoutSeconds = timeoutus / 1000000;
-        uint32_t timeoutMicroSeconds = timeoutus % 1000000;
+        uint32_t received = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutus);
 
-        /*
-         * byteRemains contains number of bytes to receive and will be
-         * count down for every byte read
-         */
-        uint32_t byteRemains = byteArrayLength;
+        while (true) {
+            uint32_t popped = _receiveRing->pop(byteArray+received, byteArrayLength-received);
+            if (popped > 0) {
+                /* the handler stopped watching the device while the ring was full */
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (_receiveSuspended && _receiveSuspended.exchange(false)) {
+                    _eventLoop->resume(_fd);
+                }
+
+                if (xorParity != NULL) {
+                    /* the bytes are still in the cache */
+                    *xorParity ^= Calculator::calculateXorParity(byteArray+received, popped);
+                }
+                received += popped;
+                deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutus);
+            }
+
+            if (received == byteArrayLength) {
+                _receivedBytes.fetch_add(received, std::memory_order_relaxed);
+                Metrics::getInstance().countReceivedBytes(received);
+                return true;
+            }
+
+            if (_receiveFailed) {
+                EASYFPGA_LOG(ERROR) << "The serial device can't be read any more!";
+                return false;
+            }
+
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0) {
+                EASYFPGA_LOG(WARNING) << "TIMEOUT EXPIRED WHILE READING!";
+                ExchangeTrace::getInstance().traceTimeout(_connectionId, byteArrayLength-received);
+                Metrics::getInstance().countReceiveTimeout();
+                return false;
+            }
+
+            /* the ring is empty: drive the event loop if nobody else does it */
+            if (_eventLoop->runOnce(remaining.count()) >= 0) {
+                continue;
+            }
 
-        while (byteRemains > 0) {
             /*
-             * set timeout for the select() function (creating a new
-             * timeout struct is necessary every time before to call select)
+             * An other thread drives the loop. Sleep until it appends new
+             * bytes, but check regularly whether the loop became free.
+             * The handler only notifies us if _receiverWaiting is set, so
+             * that setting the flag and checking the ring again has to
+             * happen before waiting.
              */
-            timeval timeout;
-            timeout.tv_sec = timeoutSeconds;
-            timeout.tv_usec = timeoutMicroSeconds;
+            std::unique_lock<std::mutex> lock(_receiveMutex);
+            _receiverWaiting = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
 
-            /* reset fd_set and associate it to file descriptor */
-            FD_ZERO(&readFdSet);
-            FD_SET(_fd, &readFdSet);
+            _receiveCondition.wait_for(lock, std::min(remaining, std::chrono::microseconds(1000)), [this] {
+                return (!_receiveRing->isEmpty() || _receiveFailed);
+            });
 
-            /* synchronous function call! */
-            returnval available = select(_fd+1, &readFdSet, NULL, NULL, &timeout);
+            _receiverWaiting = false;
+        }
+    }
+    else {
+        EASYFPGA_LOG(WARNING) << "Receive failed. No device opened!";
+    }
 
-            if (available > 0) {
-                returnval bytesRead = read(_fd, buffer+(byteArrayLength-byteRemains), byteRemains);
+    return false;
+}
 
-                if (bytesRead > 0) {
-                    byteRemains -= bytesRead;
-                }
-            }
-            else if (available == 0) {
-                Log().Get(WARNING) << "TIMEOUT EXPIRED WHILE READING!";
+void SerialConnection::setReceiveThreadEnabled(bool enabled)
+{
+    _useReceiveThread = enabled;
+}
+
+bool SerialConnection::isReceiveThreadEnabled(void)
+{
+    return _useReceiveThread;
+}
+
+void SerialConnection::setEventLoop(eventloop_ptr loop)
+{
+    if (CONNECTED) {
+        EASYFPGA_LOG(WARNING) << "The event loop can't be changed while the device is opened!";
+        return;
+    }
+
+    _eventLoop = loop;
+    _ownsEventLoop = false;
+}
+
+eventloop_ptr SerialConnection::getEventLoop(void)
+{
+    return _eventLoop;
+}
+
+uint16_t SerialConnection::getConnectionId(void)
+{
+    return _connectionId;
+}
+
+bool SerialConnection::attachToEventLoop(void)
+{
+    assert(_receiveRing == NULL);
+
+    if (_eventLoop == nullptr) {
+        _eventLoop = std::make_shared<EventLoop>();
+        _ownsEventLoop = true;
+    }
+
+    if (!_eventLoop->isValid()) {
+        return false;
+    }
+
+    _receiveRing = new SpscRingBuffer<byte>(SERIAL_RECEIVE_RING_SIZE);
+    _receiveFailed = false;
+    _receiveSuspended = false;
+
+    if (!_eventLoop->add(_fd, [this](uint32_t events) { this->handleReadableDevice(events); })) {
+        delete _receiveRing;
+        _receiveRing = NULL;
+        return false;
+    }
+
+    if (_useReceiveThread && _ownsEventLoop) {
+        _receiveThread = std::thread(&EventLoop::run, _eventLoop.get());
+        EASYFPGA_LOG(DEBUG) << "Receive thread started.";
+    }
+
+    return true;
+}
+
+void SerialConnection::detachFromEventLoop(void)
+{
+    if (_receiveThread.joinable()) {
+        _eventLoop->stop();
+        _receiveThread.join();
+        EASYFPGA_LOG(DEBUG) << "Receive thread stopped.";
+    }
+
+    if (_receiveRing != NULL) {
+        _eventLoop->remove(_fd);
+        delete _receiveRing;
+        _receiveRing = NULL;
+    }
+}
+
+void SerialConnection::handleReadableDevice(uint32_t events)
+{
+    bool appended = false;
+
+    while (true) {
+        uint32_t freeBytes = 0;
+        byte* target = _receiveRing->getWriteRegion(&freeBytes);
+
+        if (freeBytes == 0) {
+            /*
+             * The ring is full: the remaining bytes stay in the tty queue.
+             * Stop watching the device until receive() frees some space,
+             * otherwise the level-triggered descriptor would be reported
+             * as readable again immediately. receive() might have freed
+             * space before the flag was set, so check the ring again.
+             */
+            _eventLoop->suspend(_fd);
+            _receiveSuspended = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            _receiveRing->getWriteRegion(&freeBytes);
+            if (freeBytes == 0) {
                 break;
             }
-            else {
-                Log().Get(ERROR) << "Error while select() call: " << strerror(errno);
-                break;
+            if (_receiveSuspended.exchange(false)) {
+                _eventLoop->resume(_fd);
             }
+            continue;
         }
 
-        FD_CLR(_fd, &readFdSet);
+        returnval bytesRead = read(_fd, target, freeBytes);
 
-        if (byteRemains == 0) {
-            memcpy(byteArray, buffer, byteArrayLength);
-            return true;
+        if (bytesRead > 0) {
+            _receiveRing->commitWrite(bytesRead);
+            appended = true;
+        }
+        else if ((bytesRead < 0) && ((errno == EAGAIN) || (errno == EINTR))) {
+            break;
+        }
+        else if ((bytesRead == 0) && !(events & (EPOLLHUP | EPOLLERR))) {
+            /* VMIN = 0: an empty read just means "no more bytes" */
+            break;
+        }
+        else {
+            EASYFPGA_LOG(ERROR) << "Error while reading the serial device: " << ((bytesRead == 0) ? "hang up" : strerror(errno));
+
+            /* stop watching it, otherwise the loop would be woken up continuously */
+            _eventLoop->remove(_fd);
+            _receiveFailed = true;
+            appended = true;
+            break;
         }
-    }
-    else {
-        Log().Get(WARNING) << "Receive failed. No device opened!";
     }
 
-    return false;
+    if (appended && _receiverWaiting) {
+        std::lock_guard<std::mutex> lock(_receiveMutex);
+        _receiveCondition.notify_one();
+    }
 }
 
 int32_t SerialConnection::getReceiveQueueSize(void)
@@ -293,9 +592,14 @@ int32_t SerialConnection::getReceiveQueueSize(void)
 
     if (CONNECTED) {
         ioctl(_fd, TIOCINQ, &bytes);
+
+        /* bytes which already were moved into the ring */
+        if (_receiveRing != NULL) {
+            bytes += _receiveRing->getSize();
+        }
     }
     else {
-        Log().Get(WARNING) << "Get receive buffer size failed. No device opened!";
+        EASYFPGA_LOG(WARNING) << "Get receive buffer size failed. No device opened!";
     }
 
     return bytes;
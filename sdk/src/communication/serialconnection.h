@@ -23,15 +23,41 @@
 #define SDK_COMMUNICATION_SERIALCONNECTION_H_
 
 #include "communication/types.h"
-#include "protocol/frame_ptr.h"
+#include "protocol/frame_fwd.h"
 #include "utils/hardwaretypes.h"
+#include "utils/os/eventloop_ptr.h"
 #include "utils/os/types.h"
+#include "utils/spscringbuffer_fwd.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 /**
  * \brief Connection to the virtual com port. Provides low
  *        level functions for a serial device.
+ *
+ * Frames handed over by enqueue() are collected in a send buffer and
+ * written together with a single write() call. The buffer will be
+ * written if it exceeds SEND_BUFFER_FLUSH_THRESHOLD bytes, if the user
+ * calls flushSendBuffer(), and before every send() or receive() call.
+ * So the order of all requests is kept and no reply can be awaited
+ * whose request still remains in the buffer.
+ *
+ * Incoming bytes are read readiness-driven: the device is registered
+ * with an EventLoop, whose handler moves all available bytes into a
+ * lock-free ring buffer. receive() copies the bytes out of the ring. If
+ * the ring is empty, receive() drives the event loop itself or, if
+ * another thread already does it, waits until that thread delivers new
+ * bytes. While the ring is full, the device isn't watched by the loop;
+ * receive() resumes it as soon as it freed some space.
+ *
+ * Every connection owns a private event loop unless setEventLoop() was
+ * called before opening the device. Optionally a background thread
+ * drives the private loop (option SERIAL_RECEIVE_THREAD in project.conf).
  */
 class SerialConnection
 {
@@ -73,12 +99,12 @@ class SerialConnection
         /**
          * \brief Sends a frame's raw data.
          *
-         * \param f Pointer to a before instantiated Frame.
+         * \param f A before instantiated Frame.
          *
          * \return true if the data could send successfully,\n
          *         false otherwise
          */
-        bool send(frame_ptr f);
+        bool send(const Frame& f);
 
         /**
          * \brief Sends a specific byte array.
@@ -92,6 +118,59 @@ class SerialConnection
          */
         bool send(byte* byteArray, uint32_t byteArrayLength);
 
+        /**
+         * \brief Appends a frame's raw data to the send buffer without
+         *        writing it immediately.
+         *
+         * \param f A before instantiated Frame.
+         *
+         * \return true if the frame could be buffered (and the buffer
+         *         could be written if the threshold was exceeded),\n
+         *         false otherwise
+         */
+        bool enqueue(const Frame& f);
+
+        /**
+         * \brief Writes all buffered frames with a single write() call.
+         *
+         * \return true if the send buffer was empty or could be written
+         *         completely,\n
+         *         false otherwise
+         */
+        bool flushSendBuffer(void);
+
+        /**
+         * \brief Returns the number of frames written since opening the
+         *        device.
+         */
+        uint64_t getNumberOfSentFrames(void);
+
+        /**
+         * \brief Returns the number of write() calls needed for sending
+         *        all frames since opening the device.
+         */
+        uint64_t getNumberOfWriteCalls(void);
+
+        /**
+         * \brief Returns the average number of frames per write() call.
+         *
+         * \return a value greater or equal to 1.0 if any frame was sent,\n
+         *         0.0 otherwise
+         */
+        double getFramesPerWriteCall(void);
+
+        /**
+         * \brief Returns the number of bytes written since opening the
+         *        device. (May be called by any thread.)
+         */
+        uint64_t getNumberOfSentBytes(void);
+
+        /**
+         * \brief Returns the number of bytes handed out by receive()
+         *        since opening the device. (May be called by any thread.)
+         */
+        uint64_t getNumberOfReceivedBytes(void);
+
         /**
          * \brief Returns the currently number of bytes existing in the
          *        send queue.
@@ -118,6 +197,14 @@ class SerialConnection
          */
         bool receive(byte* byteArray, uint32_t byteArrayLength, timeoutval timeoutus);
 
+        /**
+         * \brief Receives like receive() and folds the XOR parity of the
+         *        received bytes into xorParity while they are copied.
+         *
+         * \param xorParity Every received byte is XORed into it.
+         */
+        bool receive(byte* byteArray, uint32_t byteArrayLength, timeoutval timeoutus, byte* xorParity);
+
         /**
          * \brief Returns the currently number of bytes available in the
          *        receive queue.
@@ -128,11 +215,108 @@ class SerialConnection
          */
         int32_t getReceiveQueueSize(void);
 
+        /**
+         * \brief Decides whether a background thread receives all
+         *        incoming bytes. Takes effect at the next openDevice().
+         *
+         * The default value is set by SERIAL_RECEIVE_THREAD in the
+         * configuration file.
+         */
+        void setReceiveThreadEnabled(bool enabled);
+
+        /**
+         * \brief Returns true if a background thread will receive the
+         *        incoming bytes.
+         */
+        bool isReceiveThreadEnabled(void);
+
+        /**
+         * \brief Registers this connection with a shared event loop
+         *        instead of a private one. Takes effect at the next
+         *        openDevice().
+         *
+         * The owner of a shared loop is responsible for driving it,
+         * that's why no receive thread will be started in this case.
+         * Nevertheless receive() will drive the loop by itself as long
+         * as no other thread does it.
+         *
+         * \param loop The loop to use or nullptr for a private one.
+         */
+        void setEventLoop(eventloop_ptr loop);
+
+        /**
+         * \brief Returns the event loop this connection is registered
+         *        with, e.g. for integrating it into an own poll loop by
+         *        EventLoop::getFileDescriptor().
+         */
+        eventloop_ptr getEventLoop(void);
+
+        /**
+         * \brief Returns an id, which is unique within the process and
+         *        identifies the records of this connection in the
+         *        exchange trace.
+         */
+        uint16_t getConnectionId(void);
+
     private:
         /**
          * linux file descriptor for writing and reading data
          */
         returnval _fd;
+
+        uint16_t _connectionId;
+
+        /**
+         * Writes the given bytes completely, even if the operating
+         * system accepts them only partially.
+         */
+        bool writeCompletely(byte* byteArray, uint32_t byteArrayLength);
+
+        /**
+         * raw data of all enqueued but not yet written frames
+         */
+        std::vector<byte> _sendBuffer;
+
+        /**
+         * number of frames currently stored in _sendBuffer
+         */
+        uint32_t _bufferedFrames;
+
+        /* statistics */
+        uint64_t _sentFrames;
+        uint64_t _writeCalls;
+        std::atomic<uint64_t> _sentBytes;
+        std::atomic<uint64_t> _receivedBytes;
+
+        /**
+         * Registers the opened device with the event loop and starts
+         * the receive thread if desired.
+         */
+        bool attachToEventLoop(void);
+
+        /**
+         * Stops the receive thread and unregisters the device.
+         */
+        void detachFromEventLoop(void);
+
+        /**
+         * event handler: moves all incoming bytes into _receiveRing
+         */
+        void handleReadableDevice(uint32_t events);
+
+        /* readiness-driven receiving */
+        eventloop_ptr _eventLoop;
+        bool _ownsEventLoop;
+        SpscRingBuffer<byte>* _receiveRing;
+        std::atomic<bool> _receiveFailed;
+        std::atomic<bool> _receiverWaiting;
+        std::atomic<bool> _receiveSuspended;
+
+        /* optional thread driving a private event loop */
+        bool _useReceiveThread;
+        std::thread _receiveThread;
+        std::mutex _receiveMutex;
+        std::condition_variable _receiveCondition;
 };
 
 #endif  // SDK_COMMUNICATION_SERIALCONNECTION_H_
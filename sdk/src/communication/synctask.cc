@@ -37,7 +37,18 @@ SyncTask::~SyncTask()
 
 void SyncTask::execute(void)
 {
-    if (this->send()) {
+    if (this->send(false)) {
         this->receive();
     }
 }
+
+void SyncTask::executeSend(void)
+{
+    _receiveState = Task::RECEIVE_STATE::RECEIVE_NOT_EXECUTED;
+    this->send(false);
+}
+
+void SyncTask::executeReceive(void)
+{
+    this->receive();
+}
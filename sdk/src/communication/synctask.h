@@ -49,6 +49,17 @@ class SyncTask : public Task
          * This method sends a request and receives the corresponding reply.
          */
         void execute(void);
+
+        /**
+         * \brief Only sends the request, e.g. for sending further
+         *        requests before receiving this task's reply.
+         */
+        void executeSend(void);
+
+        /**
+         * \brief Only receives the reply of an already sent request.
+         */
+        void executeReceive(void);
 };
 
 #endif  // SDK_COMMUNICATION_SYNCTASK_H_
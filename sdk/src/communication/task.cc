@@ -20,6 +20,8 @@
  */
 
 #include "configuration.h" /* assert(1) */
+#include "communication/exchangetrace.h"
+#include "communication/metrics.h"
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
 #include "communication/protocol/frame.h"
@@ -28,7 +30,7 @@
 #include "utils/log/log.h"
 #include "utils/hardwaretypes.h"
 
-#include <algorithm> /* max(2) */
+#include <cstring> /* memcpy(3) */
 
 Task::Task(std::string name, serialconnection_ptr sc, exchange_ptr ex, CoreIndex* interruptTriggeringCore, tasknumberval number) :
     _sendState(Task::SEND_STATE::SEND_NOT_EXECUTED),
@@ -38,7 +40,8 @@ Task::Task(std::string name, serialconnection_ptr sc, exchange_ptr ex, CoreIndex
     _exchange(ex),
     _executionAttempt(1),
     _taskNumber(number),
-    _interruptTriggeringCore(interruptTriggeringCore)
+    _interruptTriggeringCore(interruptTriggeringCore),
+    _sendTime(0)
 {
 }
 
@@ -50,7 +53,8 @@ Task::Task(const Task& task) :
     _exchange(task._exchange),
     _executionAttempt(task._executionAttempt),
     _taskNumber(task._taskNumber),
-    _interruptTriggeringCore(task._interruptTriggeringCore)
+    _interruptTriggeringCore(task._interruptTriggeringCore),
+    _sendTime(task._sendTime)
 {
 }
 
@@ -95,18 +99,26 @@ Task::RECEIVE_STATE Task::getReceiveState(void)
     return _receiveState;
 }
 
-bool Task::send(void)
+bool Task::send(bool batch)
 {
     /* Increment execution counter */
     _executionAttempt++;
 
     /* Actual sending procedure */
-    frame_ptr request = _exchange->getRequest();
-    byte buffer[request->getTotalFrameLength()];
-    request->getFrameRawData(buffer);
-    Log().Get(DEBUG) << "Send: " << std::hex << (int32_t)buffer[0];
+    const Frame& request = _exchange->getRequest();
+    EASYFPGA_LOG(DEBUG) << "Send: " << std::hex << (int32_t)request.getOperationCode();
 
-    if (_serialConnection->send(request)) {
+    _sendTime = getMonotonicTimeInNanos();
+    Metrics::getInstance().countRequest(request.getOperationCode(), _executionAttempt-1);
+
+    ExchangeTrace& trace = ExchangeTrace::getInstance();
+    if (trace.isEnabled()) {
+        trace.traceRequest(_serialConnection->getConnectionId(), request, _executionAttempt-1);
+    }
+
+    bool success = batch ? _serialConnection->enqueue(request) : _serialConnection->send(request);
+
+    if (success) {
         _sendState = Task::SEND_STATE::SEND_SUCCESS;
         return true;
     }
@@ -120,62 +132,20 @@ bool Task::receive(void) {
     return this->receive(0);
 }
 
-bool Task::receive(uint8_t recursiveDepth)
+bool Task::receive(byte* header, uint16_t headerLength)
 {
-    /*
-     * While receiving the correct bytes from the queue, we determine at
-     * first which opcode was responsed from the device. Depending on
-     * that opcode, maybe we have to fetch a varying number of bytes.
-     * So that every byte fits into the local buffer, we calculate the
-     * maximum byte count of all possibilities.
-     */
-    uint16_t maxByteCount = std::max(_exchange->getReplySuccessLength(), std::max(_exchange->getReplyErrorLength(), (uint16_t)3));
-    assert(maxByteCount > 1);
+    assert(headerLength >= 1);
+    return this->receiveRemainder(header, headerLength);
+}
 
-    byte reply[maxByteCount];
+bool Task::receive(uint8_t recursiveDepth)
+{
+    byte reply[3];
 
     if (_serialConnection->receive(reply, 1, _exchange->getReceiveTimeout())) {
-        Log().Get(DEBUG) << "Received opcode: 0x" << std::hex << (int32_t)reply[0];
-        uint16_t rest = 0;
-        Log().Get(DEBUG) << "Expected opcode: 0x" << std::hex << (int32_t)_exchange->getExpectedOpcode();
-
-        if (reply[0] == _exchange->getExpectedOpcode()) {
-            /* -1 because we already fetched the first byte (opcode) */
-            rest = _exchange->getReplySuccessLength() - 1;
-            if (rest > 0) {
-                Log().Get(DEBUG) << "Fetch the remaining " << (int32_t)rest << " byte(s)...";
-                _serialConnection->receive(reply+1, rest, _exchange->getReceiveTimeout());
-            }
+        EASYFPGA_LOG(DEBUG) << "Received opcode: 0x" << std::hex << (int32_t)reply[0];
 
-            if (_exchange->successChecksumIsCorrect(reply)) {
-                _exchange->setSuccessReply(reply);
-                _receiveState = Task::RECEIVE_STATE::RECEIVE_SUCCESS;
-                return true;
-            }
-            else {
-                _receiveState = Task::RECEIVE_STATE::RECEIVE_CHECKSUM_ERROR;
-                return false;
-            }
-        }
-        else if (reply[0] == Exchange::SHARED_REPLY_CODES::NACK) {
-            /* -1 because we already fetched the first byte (opcode) */
-            rest = _exchange->getReplyErrorLength() - 1;
-            if (rest > 0) {
-                Log().Get(DEBUG) << "Fetch the remaining " << (int32_t)rest << " byte(s)...";
-                _serialConnection->receive(reply+1, rest, _exchange->getReceiveTimeout());
-            }
-
-            if (_exchange->errorChecksumIsCorrect(reply)) {
-                _exchange->setErrorReply(reply);
-                _receiveState = Task::RECEIVE_STATE::RECEIVE_FAILURE;
-                return false;
-            }
-            else {
-                _receiveState = Task::RECEIVE_STATE::RECEIVE_CHECKSUM_ERROR;
-                return false;
-            }
-        }
-        else if (reply[0] == Exchange::SHARED_REPLY_CODES::INTERRUPT) {
+        if (reply[0] == Exchange::SHARED_REPLY_CODES::INTERRUPT) {
             /*
              * Interrupts can't occur right after an other. The user or
              * the framework have to enable the interrupts agian before
@@ -185,34 +155,111 @@ bool Task::receive(uint8_t recursiveDepth)
              */
             assert(recursiveDepth < 1);
 
-            Log().Get(DEBUG) << "Fetch the remaining 2 bytes...";
+            EASYFPGA_LOG(DEBUG) << "Fetch the remaining 2 bytes...";
             if (_serialConnection->receive(reply+1, 2, _exchange->getReceiveTimeout())) {
+                ExchangeTrace::getInstance().traceInterrupt(_serialConnection->getConnectionId(), reply, 3);
+                Metrics::getInstance().countInterrupt();
                 byte calculatedParity = reply[1];
-                Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
+                EASYFPGA_LOG(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
                 byte transmittedParity = reply[2];
-                Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
+                EASYFPGA_LOG(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
                 if (calculatedParity == transmittedParity) {
                     *(_interruptTriggeringCore) = (CoreIndex)reply[1];
-                    Log().Get(DEBUG) << "The corresponding interrupt routine will be executed after next call of fetchAsyncReplies().";
+                    EASYFPGA_LOG(DEBUG) << "The corresponding interrupt routine will be executed after next call of fetchAsyncReplies().";
                 }
                 else {
-                    Log().Get(WARNING) << "Interrupt request recognized. Parity check failed. Because of that won't be executed the corresponding interrupt routine!";
+                    EASYFPGA_LOG(WARNING) << "Interrupt request recognized. Parity check failed. Because of that won't be executed the corresponding interrupt routine!";
                 }
             }
             else {
-                Log().Get(WARNING) << "Interrupt request recognized. Serial connection refused to get the triggering core! Because of that won't be executed the corresponding interrupt routine!";
+                EASYFPGA_LOG(WARNING) << "Interrupt request recognized. Serial connection refused to get the triggering core! Because of that won't be executed the corresponding interrupt routine!";
             }
 
             /* Get the actual bytes assigned to this task in the receive queue. */
             return this->receive(++recursiveDepth);
         }
-        else {
-            _receiveState = Task::RECEIVE_STATE::RECEIVE_UNEXPECTED_OPCODE_ERROR;
-            return false;
-        }
+
+        return this->receiveRemainder(reply, 1);
     }
     else {
         _receiveState = Task::RECEIVE_STATE::RECEIVE_CONNECTION_ERROR;
+        this->traceReply(NULL, 0);
+        return false;
+    }
+}
+
+bool Task::receiveRemainder(byte* header, uint16_t headerLength)
+{
+    /*
+     * While receiving the correct bytes from the queue, we determine at
+     * first which opcode was responsed from the device. Depending on
+     * that opcode, maybe we have to fetch a varying number of bytes.
+     * The remaining bytes will be received directly into the exchange's
+     * reply frame.
+     */
+    EASYFPGA_LOG(DEBUG) << "Expected opcode: 0x" << std::hex << (int32_t)_exchange->getExpectedOpcode();
+
+    uint16_t replyLength = 0;
+    if (header[0] == _exchange->getExpectedOpcode()) {
+        replyLength = _exchange->getReplySuccessLength();
+    }
+    else if (header[0] == Exchange::SHARED_REPLY_CODES::NACK) {
+        replyLength = _exchange->getReplyErrorLength();
+    }
+    else {
+        _receiveState = Task::RECEIVE_STATE::RECEIVE_UNEXPECTED_OPCODE_ERROR;
+        this->traceReply(header, headerLength);
         return false;
     }
+
+    assert(headerLength <= replyLength);
+
+    byte* reply = _exchange->prepareReply(replyLength);
+    memcpy(reply, header, headerLength);
+
+    /* the parity of the reply is folded while receiving it */
+    byte parity = Calculator::calculateXorParity(header, headerLength);
+
+    if (replyLength > headerLength) {
+        uint16_t rest = replyLength - headerLength;
+        EASYFPGA_LOG(DEBUG) << "Fetch the remaining " << (int32_t)rest << " byte(s)...";
+        if (!_serialConnection->receive(reply+headerLength, rest, _exchange->getReceiveTimeout(), &parity)) {
+            _receiveState = Task::RECEIVE_STATE::RECEIVE_CONNECTION_ERROR;
+            this->traceReply(reply, headerLength);
+            return false;
+        }
+    }
+
+    _exchange->setReplyParity(parity);
+
+    if (reply[0] == _exchange->getExpectedOpcode()) {
+        if (_exchange->successChecksumIsCorrect(reply)) {
+            _receiveState = Task::RECEIVE_STATE::RECEIVE_SUCCESS;
+            this->traceReply(reply, replyLength);
+            return true;
+        }
+    }
+    else {
+        if (_exchange->errorChecksumIsCorrect(reply)) {
+            _receiveState = Task::RECEIVE_STATE::RECEIVE_FAILURE;
+            this->traceReply(reply, replyLength);
+            return false;
+        }
+    }
+
+    _receiveState = Task::RECEIVE_STATE::RECEIVE_CHECKSUM_ERROR;
+    this->traceReply(reply, replyLength);
+    return false;
+}
+
+void Task::traceReply(const byte* reply, uint16_t length)
+{
+    timevalue latency = getMonotonicTimeInNanos() - _sendTime;
+    Metrics::getInstance().countReply(_exchange->getRequest().getOperationCode(), _receiveState, latency);
+
+    ExchangeTrace& trace = ExchangeTrace::getInstance();
+    if (trace.isEnabled()) {
+        trace.traceReply(_serialConnection->getConnectionId(), _exchange->getRequest(), reply, length, latency,
+            _executionAttempt-1, (uint8_t)_receiveState);
+    }
 }
@@ -26,6 +26,8 @@
 #include "communication/serialconnection_ptr.h"
 #include "communication/types.h"
 #include "easycores/types.h"
+#include "utils/hardwaretypes.h"
+#include "utils/os/time_helper.h" /* timevalue */
 
 #include <string>
 
@@ -222,11 +224,16 @@ class Task
         /**
          * \brief Sends a request.
          *
+         * \param batch If true, the request will be only appended to the
+         *        send buffer of the serial connection. It will be
+         *        written together with other requests later on (at the
+         *        latest before receiving any reply).
+         *
          * \return true if the request could sent successfully to the
-         *         easyFPGA board,\n
+         *         easyFPGA board (or could be buffered),\n
          *         false otherwise
          */
-        bool send(void);
+        bool send(bool batch);
 
         /**
          * \brief Receives a reply.
@@ -237,6 +244,33 @@ class Task
          */
         bool receive(void);
 
+        /**
+         * \brief Receives the rest of a reply whose first bytes were
+         *        already fetched from the receive queue by someone else.
+         *
+         * This is used by the TaskExecutor for matching replies to
+         * their requests by the exchange's id: it reads the opcode and
+         * the id of the next reply itself and hands them over to the
+         * task which owns this id.
+         *
+         * \param header Points to the already received bytes (starting
+         *        with the opcode).
+         *
+         * \param headerLength Number of bytes header points to.
+         *
+         * \return true if the reception was successful and no error
+         *         occured,\n
+         *         false otherwise
+         */
+        bool receive(byte* header, uint16_t headerLength);
+
+        /**
+         * \brief Counts the reply (or the failed reception) in the
+         *        Metrics and records it in the ExchangeTrace if it is
+         *        enabled.
+         */
+        void traceReply(const byte* reply, uint16_t length);
+
         /**
          * \brief Holds the send state of this task.
          *
@@ -292,6 +326,12 @@ class Task
 
     private:
         bool receive(uint8_t recursiveDepth);
+        bool receiveRemainder(byte* header, uint16_t headerLength);
+
+        /**
+         * Time of the last send() for the reply latency
+         */
+        timevalue _sendTime;
 };
 
 #endif  // SDK_COMMUNICATION_TASK_H_
@@ -20,6 +20,8 @@
  */
 
 #include "configuration.h" /* assert(), USE_IDS_FOR_ASYNC_OPS */
+#include "communication/exchangetrace.h"
+#include "communication/metrics.h"
 #include "communication/protocol/calculator.h"
 #include "communication/protocol/exchange.h"
 #include "communication/serialconnection.h"
@@ -29,21 +31,36 @@
 #include "utils/config/configurationfile.h"
 #include "utils/log/log.h"
 
+#include <chrono>
+#include <iterator> /* std::prev() */
+
 TaskExecutor::TaskExecutor(serialconnection_ptr sc, easycore_map_ptr coreMap) :
     _connection(sc),
     _easyCoreMapPointer(coreMap),
     _triggeringCore(SPECIAL_CORE_INDICES::NO_FPGA_ASSOCIATION),
     _syncOperationCounter(0),
     _asyncOperationCounter(0),
+    _maxRequestsInFlight(1),
+    _asyncTaskFailed(false),
+    _batchedTaskFailures(0),
     _MAX_RETRIES_ALLOWED(ConfigurationFile::getInstance().getMaximumRetriesAllowed())
 {
     #ifdef USE_IDS_FOR_ASYNC_OPS
     _idManager = new IdManager<idval>();
     #endif
+
+    this->setMaxRequestsInFlight(ConfigurationFile::getInstance().getMaximumRequestsInFlight());
 }
 
 TaskExecutor::~TaskExecutor()
 {
+    /* the tasks left behind don't count any more */
+    uint32_t pendingNumber = _readyAsyncTasks.size();
+    for (auto it=_pendingAsyncTasks.begin(); it!=_pendingAsyncTasks.end(); ++it) {
+        pendingNumber += it->second.size();
+    }
+    Metrics::getInstance().changeAsyncTasks(-(int64_t)_runningAsyncTasks.size(), -(int64_t)pendingNumber);
+
     #ifdef USE_IDS_FOR_ASYNC_OPS
     delete _idManager;
     _idManager = NULL;
@@ -92,16 +109,16 @@ bool TaskExecutor::doSyncTask(std::string taskName, exchange_ptr operation)
      */
     SyncTask task(taskName, _connection, operation, &_triggeringCore, _syncOperationCounter);
 
-    Log().Get(DEBUG) << "Start " << task.getName();
+    EASYFPGA_LOG(DEBUG) << "Start " << task.getName();
 
     do {
-        Log().Get(DEBUG) << "Attempt " << (int32_t)task.getExecutionCount() << "/" << (int32_t)_MAX_RETRIES_ALLOWED;
+        EASYFPGA_LOG(DEBUG) << "Attempt " << (int32_t)task.getExecutionCount() << "/" << (int32_t)_MAX_RETRIES_ALLOWED;
 
         task.execute();
 
         switch (task.getReceiveState()) {
             case Task::RECEIVE_STATE::RECEIVE_NOT_EXECUTED:
-                Log().Get(DEBUG) << "The request couldn't sent, so a receive is impossible. Try it once more...";
+                EASYFPGA_LOG(DEBUG) << "The request couldn't sent, so a receive is impossible. Try it once more...";
                 break;
 
             case Task::RECEIVE_STATE::RECEIVE_SUCCESS:
@@ -109,15 +126,15 @@ bool TaskExecutor::doSyncTask(std::string taskName, exchange_ptr operation)
                  * Write received reply if there is anything to write.
                  */
                 task.getExchange()->writeResults();
-                Log().Get(DEBUG) << "Task " << task.getName() << " successfully executed.";
+                EASYFPGA_LOG(DEBUG) << "Task " << task.getName() << " successfully executed.";
                 return true;
 
             case Task::RECEIVE_STATE::RECEIVE_FAILURE:
-                Log().Get(DEBUG) << "The fpga couldn't process or understand the request. Try it once more...";
+                EASYFPGA_LOG(DEBUG) << "The fpga couldn't process or understand the request. Try it once more...";
                 break;
 
             case Task::RECEIVE_STATE::RECEIVE_CHECKSUM_ERROR:
-                Log().Get(DEBUG) << "The checksum check failed! Retry the request...";
+                EASYFPGA_LOG(DEBUG) << "The checksum check failed! Retry the request...";
                 break;
 
             case Task::RECEIVE_STATE::RECEIVE_UNEXPECTED_OPCODE_ERROR:
@@ -139,71 +156,236 @@ bool TaskExecutor::doSyncTask(std::string taskName, exchange_ptr operation)
         }
     } while (task.getExecutionCount() <= _MAX_RETRIES_ALLOWED);
 
-    Log().Get(WARNING) << "No execution success of task " << task.getName() << " within " << (int32_t)(task.getExecutionCount()-1) << " retries.";
+    EASYFPGA_LOG(WARNING) << "No execution success of task " << task.getName() << " within " << (int32_t)(task.getExecutionCount()-1) << " retries.";
     return false;
 }
 
+bool TaskExecutor::doSyncTaskPipeline(std::string taskName, const std::vector<exchange_ptr>& operations, uint32_t depth, std::vector<uint32_t>* latencies)
+{
+    /* left bytes from async operations would disturb (see doSyncTask) */
+    this->fetchAsyncReplies();
+
+    if (depth < 1) {
+        depth = 1;
+    }
+
+    if (latencies != NULL) {
+        latencies->assign(operations.size(), 0);
+    }
+
+    typedef std::chrono::steady_clock clock;
+    struct PipelinedTask {
+        SyncTask task;
+        uint32_t index;
+        clock::time_point sent;
+    };
+    std::list<PipelinedTask> running;
+    std::vector<bool> completed(operations.size(), false);
+
+    /* writes the results of a successfully received task */
+    auto complete = [&](PipelinedTask& pipelined) {
+        pipelined.task.getExchange()->writeResults();
+        if (latencies != NULL) {
+            (*latencies)[pipelined.index] = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - pipelined.sent).count();
+        }
+        completed[pipelined.index] = true;
+    };
+
+    uint32_t next = 0;
+    uint32_t finished = 0;
+
+    while (finished < operations.size()) {
+        /* fill the pipeline, skipping operations completed while resynchronizing */
+        bool sendFailed = false;
+        while ((running.size() < depth) && !sendFailed) {
+            while ((next < operations.size()) && completed[next]) {
+                next++;
+            }
+            if (next >= operations.size()) {
+                break;
+            }
+
+            _syncOperationCounter++;
+            running.push_back(PipelinedTask{SyncTask(taskName, _connection, operations[next], &_triggeringCore, _syncOperationCounter), next, clock::now()});
+
+            SyncTask& task = running.back().task;
+            EASYFPGA_LOG(DEBUG) << "Start " << task.getName() << " " << next+1 << "/" << (uint32_t)operations.size();
+            task.executeSend();
+
+            if (task.getSendState() == Task::SEND_STATE::SEND_SUCCESS) {
+                next++;
+            }
+            else {
+                /* there is no reply to wait for */
+                running.pop_back();
+                sendFailed = true;
+                EASYFPGA_LOG(WARNING) << "Pipelined " << taskName << " " << next+1 << "/" << (uint32_t)operations.size() << " couldn't be sent. Resynchronize...";
+            }
+        }
+
+        /* receive the reply of the oldest request */
+        if (!sendFailed) {
+            PipelinedTask& oldest = running.front();
+            oldest.task.executeReceive();
+
+            if (oldest.task.getReceiveState() == Task::RECEIVE_STATE::RECEIVE_SUCCESS) {
+                complete(oldest);
+                running.pop_front();
+                while ((finished < operations.size()) && completed[finished]) {
+                    finished++;
+                }
+                continue;
+            }
+
+            EASYFPGA_LOG(WARNING) << "Pipelined " << taskName << " " << oldest.index+1 << "/" << (uint32_t)operations.size() << " failed. Resynchronize...";
+            running.pop_front();
+        }
+
+        /*
+         * Resynchronize: the replies of the requests still in flight
+         * arrive in order and are consumed first, the successful ones
+         * complete their operations. Then the first operation not
+         * completed is repeated alone (including its retries) and the
+         * pipeline restarts behind it.
+         */
+        for (auto& inFlight : running) {
+            inFlight.task.executeReceive();
+            if (inFlight.task.getReceiveState() == Task::RECEIVE_STATE::RECEIVE_SUCCESS) {
+                complete(inFlight);
+            }
+        }
+        running.clear();
+        _connection->flushBuffers();
+
+        while ((finished < operations.size()) && completed[finished]) {
+            finished++;
+        }
+        if (finished >= operations.size()) {
+            break;
+        }
+
+        clock::time_point start = clock::now();
+        if (!this->doSyncTask(taskName, operations[finished])) {
+            return false;
+        }
+        if (latencies != NULL) {
+            (*latencies)[finished] = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+        }
+        completed[finished] = true;
+
+        while ((finished < operations.size()) && completed[finished]) {
+            finished++;
+        }
+        next = finished;
+    }
+
+    return true;
+}
+
 tasknumberval TaskExecutor::startAsyncTask(std::string taskName, exchange_ptr operation, tasknumberval dependency)
 {
     _asyncOperationCounter++;
 
     AsyncTask task(taskName, _connection, operation, &_triggeringCore, _asyncOperationCounter);
 
-    Log().Get(DEBUG) << "Start " << task.getName();
-    Log().Get(DEBUG) << "Attempt " << (int32_t)task.getExecutionCount() << "/" << (int32_t)_MAX_RETRIES_ALLOWED;
+    EASYFPGA_LOG(DEBUG) << "Start " << task.getName();
+    EASYFPGA_LOG(DEBUG) << "Attempt " << (int32_t)task.getExecutionCount() << "/" << (int32_t)_MAX_RETRIES_ALLOWED;
 
     #ifdef USE_IDS_FOR_ASYNC_OPS
     idval id = 0;
     if (_idManager->getFreeId(&id)) {
-        Log().Get(DEBUG) << "This task has been assigned the id " << (int32_t)id << ".";
+        EASYFPGA_LOG(DEBUG) << "This task has been assigned the id " << (int32_t)id << ".";
         operation->setId(id);
     } else {
-        Log().Get(WARNING) << "The IdManager has no more available ids. Try to free all used ones...";
-        this->fetchAsyncReplies();
+        EASYFPGA_LOG(WARNING) << "The IdManager has no more available ids. Try to free all used ones...";
+        if (!this->fetchAsyncReplies()) {
+            _asyncTaskFailed = true;
+        }
 
         if (_idManager->getFreeId(&id)) {
-            Log().Get(DEBUG) << "Attempt to get a new id successful!";
-            Log().Get(DEBUG) << "This task has been assigned the id " << (int32_t)id << ".";
+            EASYFPGA_LOG(DEBUG) << "Attempt to get a new id successful!";
+            EASYFPGA_LOG(DEBUG) << "This task has been assigned the id " << (int32_t)id << ".";
             operation->setId(id);
         }
         else {
-            Log().Get(WARNING) << "Attempt to get a new id wasn't successful!";
-            Log().Get(WARNING) << "Task " << task.getName() << " could not be started!";
+            EASYFPGA_LOG(WARNING) << "Attempt to get a new id wasn't successful!";
+            EASYFPGA_LOG(WARNING) << "Task " << task.getName() << " could not be started!";
             return 0;
         }
     }
     #endif
 
     if ((dependency > 0) && (_dependendTaskNumbers.find(dependency) != _dependendTaskNumbers.end())) {
-        Log().Get(DEBUG) << "This task have to be retained! [Dependency to ongoing task " << (int32_t)dependency << " found]";
+        EASYFPGA_LOG(DEBUG) << "This task have to be retained! [Dependency to ongoing task " << (int32_t)dependency << " found]";
         _pendingAsyncTasks[dependency].push(task);
-        return _asyncOperationCounter;
+        Metrics::getInstance().changeAsyncTasks(0, 1);
+
+        /* Tasks which depend on this retained one have to wait as well. */
+        _dependendTaskNumbers.insert(task.getNumber());
+        this->addToRequestBatch(task.getNumber());
+        return task.getNumber();
     }
     else {
         if (dependency > 0) {
-            Log().Get(DEBUG) << "This task can be executed. [Task " << (int32_t)dependency << " to which it depends already completed]";
+            EASYFPGA_LOG(DEBUG) << "This task can be executed. [Task " << (int32_t)dependency << " to which it depends already completed]";
         }
         else {
-            Log().Get(DEBUG) << "This task can be executed. [No Dependencies]";
+            EASYFPGA_LOG(DEBUG) << "This task can be executed. [No Dependencies]";
+        }
+
+        /*
+         * Keep at most _maxRequestsInFlight requests on the line. If the
+         * window is full, process replies until a slot becomes free.
+         * Retained tasks released in the meantime are sent first. The
+         * callbacks executed here may start tasks of their own, so the
+         * operation counter mustn't be used for this task any more.
+         */
+        if (!this->dispatchReadyAsyncTasks()) {
+            _asyncTaskFailed = true;
+        }
+        while (_runningAsyncTasks.size() >= _maxRequestsInFlight) {
+            EASYFPGA_LOG(DEBUG) << "In-flight window full (" << (int32_t)_runningAsyncTasks.size() << " requests). Fetch a reply first...";
+            if (!this->handleNextAsyncReply()) {
+                _asyncTaskFailed = true;
+            }
+
+            /*
+             * Process all further replies which already arrived. The
+             * freed slots will be refilled together, so that the
+             * following requests leave the send buffer in one write().
+             */
+            while ((_runningAsyncTasks.size() > 0) && (_connection->getReceiveQueueSize() > 0)) {
+                if (!this->handleNextAsyncReply()) {
+                    _asyncTaskFailed = true;
+                }
+            }
+            if (!this->dispatchReadyAsyncTasks()) {
+                _asyncTaskFailed = true;
+            }
         }
 
         task.executeSend();
 
         switch (task.getSendState()) {
             case Task::SEND_STATE::SEND_SUCCESS:
-                _dependendTaskNumbers.insert(_asyncOperationCounter);
-                _runningAsyncTasks.push(task);
-                Log().Get(DEBUG) << "Request of task " << task.getName() << " successfully sent.";
-                return _asyncOperationCounter;
+                _dependendTaskNumbers.insert(task.getNumber());
+                this->addToRequestBatch(task.getNumber());
+                _runningAsyncTasks.push_back(task);
+                Metrics::getInstance().changeAsyncTasks(1, 0);
+                EASYFPGA_LOG(DEBUG) << "Request of task " << task.getName() << " successfully sent.";
+                return task.getNumber();
 
             case Task::SEND_STATE::SEND_FAILURE:
-                Log().Get(ERROR) << "Request of task " << task.getName() << " not successfully sent!";
-                Log().Get(ERROR) << "There might be problems with the serial connection...";
+                #ifdef USE_IDS_FOR_ASYNC_OPS
+                _idManager->releaseId(operation->getId());
+                #endif
+                EASYFPGA_LOG(ERROR) << "Request of task " << task.getName() << " not successfully sent!";
+                EASYFPGA_LOG(ERROR) << "There might be problems with the serial connection...";
                 return 0;
 
             default:
                 /* This case must not occur! */
-                Log().Get(DEBUG) << "An internal error occured!";
+                EASYFPGA_LOG(DEBUG) << "An internal error occured!";
                 assert(false);
                 return 0;
         }
@@ -212,104 +394,27 @@ tasknumberval TaskExecutor::startAsyncTask(std::string taskName, exchange_ptr op
 
 bool TaskExecutor::fetchAsyncReplies(void)
 {
-    bool success = true;
+    bool success = !_asyncTaskFailed;
+    _asyncTaskFailed = false;
 
     /*
      * Check whether a task was executed and we didn't fetch a reply yet.
-     * For this case we remembered all executed tasks in the queue
+     * For this case we remembered all executed tasks in the list
      * _runningAsyncTasks.
      *
-     * If there will be no running tasks, we don't regard the other task
-     * buffer _pendingAsyncTasks. This buffer will only hold at least one
-     * element if there were executed tasks.
+     * Retained tasks of the buffer _pendingAsyncTasks will be moved to
+     * _readyAsyncTasks as soon as the task they depend on is completed.
+     * So if there are neither running nor ready tasks, there is nothing
+     * left which could be sent.
      */
-    while (_runningAsyncTasks.size() > 0) {
-        assert(!_runningAsyncTasks.empty());
-
-        /* Get the first sent but not yet processed task. */
-        AsyncTask task(_runningAsyncTasks.front());
-        _runningAsyncTasks.pop();
-
-        /* Try to receive a reply. (Here can occur an interrupt!) */
-        task.executeReceive();
-
-        if (task.getReceiveState() == Task::RECEIVE_STATE::RECEIVE_SUCCESS) {
-            #ifdef USE_IDS_FOR_ASYNC_OPS
-            idval id = task.getExchange()->getId();
-            _idManager->releaseId(id);
-            Log().Get(DEBUG) << "The id " << (int32_t)id << " was released.";
-            #endif
-
-            auto it = _dependendTaskNumbers.find(task.getNumber());
-            if (it != _dependendTaskNumbers.end()) {
-                _dependendTaskNumbers.erase(it);
-                auto q(_pendingAsyncTasks[task.getNumber()]);
-                _pendingAsyncTasks.erase(task.getNumber());
-
-                if (task.getExchange()->hasACallback()) {
-                    task.getExchange()->writeResults();
-                    task.getExchange()->executeCallback();
-                }
-                else {
-                    _finishedAsyncTasks.push(task);
-                }
-
-                while (q.size() > 0) {
-                    AsyncTask task2(q.front());
-                    q.pop();
-
-                    task2.executeSend();
-
-                    if (task2.getSendState() == Task::SEND_STATE::SEND_SUCCESS) {
-                        _dependendTaskNumbers.insert(task2.getNumber());
-                        _runningAsyncTasks.push(task2);
-                        Log().Get(DEBUG) << "Request of task " << task2.getName() << " successfully sent.";
-                    }
-                    else {
-                        Log().Get(ERROR) << "Request of task " << task2.getName() << " not successfully sent!";
-                    }
-                }
-            }
-            else {
-                if (task.getExchange()->hasACallback()) {
-                    /*
-                     * Write back the reply of this task. We might need
-                     * that step because the callback could be process
-                     * some received data.
-                     */
-                    task.getExchange()->writeResults();
-
-                    /* Execute the associated callback. */
-                    task.getExchange()->executeCallback();
-
-                    /*
-                     * So, at this point the task is finished. We don't
-                     * have to put it into the buffer _finishedAsyncTasks
-                     * as we do with all other tasks without a callback.
-                     * (Because of the task's results are already written.)
-                     */
-                }
-                else {
-                    _finishedAsyncTasks.push(task);
-                }
-            }
+    while ((_runningAsyncTasks.size() > 0) || (_readyAsyncTasks.size() > 0)) {
+        if (!this->dispatchReadyAsyncTasks()) {
+            success = false;
         }
-        else {
-            if (task.getExecutionCount() <= _MAX_RETRIES_ALLOWED) {
-                Log().Get(DEBUG) << "Async task " << task.getName() << " not successfully executed. Start this task once again.";
-                Log().Get(DEBUG) << "Attempt " << (int32_t)task.getExecutionCount() << "/" << (int32_t)_MAX_RETRIES_ALLOWED;
-                task.executeSend();
-                if (task.getSendState() == Task::SEND_STATE::SEND_SUCCESS) {
-                    Log().Get(DEBUG) << "Request of task " << task.getName() << " successfully sent.";
-                    _runningAsyncTasks.push(task);
-                }
-                else {
-                    Log().Get(ERROR) << "Request of task " << task.getName() << " not successfully sent!";
-                    success = false;
-                }
-            }
-            else {
-                Log().Get(ERROR) << "Max execution retries for async task " << task.getName() << " reached. This operation will be aborted now.";
+
+        if (_runningAsyncTasks.size() > 0) {
+            /* Here can occur an interrupt! */
+            if (!this->handleNextAsyncReply()) {
                 success = false;
             }
         }
@@ -317,11 +422,11 @@ bool TaskExecutor::fetchAsyncReplies(void)
 
     int32_t remainingBytes = _connection->getReceiveQueueSize();
     if (remainingBytes > 0) {
-        Log().Get(DEBUG) << "Method fetchAsyncReplies() executed, but there are still bytes in the receive queue!";
-        Log().Get(DEBUG) << "Bytes in the receive queue: " << remainingBytes;
-        Log().Get(DEBUG) << "Pending ops: " << _pendingAsyncTasks.size();
-        Log().Get(DEBUG) << "Running ops: " << _runningAsyncTasks.size();
-        Log().Get(DEBUG) << "Finished ops: " << _finishedAsyncTasks.size();
+        EASYFPGA_LOG(DEBUG) << "Method fetchAsyncReplies() executed, but there are still bytes in the receive queue!";
+        EASYFPGA_LOG(DEBUG) << "Bytes in the receive queue: " << remainingBytes;
+        EASYFPGA_LOG(DEBUG) << "Pending ops: " << _pendingAsyncTasks.size();
+        EASYFPGA_LOG(DEBUG) << "Running ops: " << _runningAsyncTasks.size();
+        EASYFPGA_LOG(DEBUG) << "Finished ops: " << _finishedAsyncTasks.size();
 
         if (remainingBytes < 3) {
             /**
@@ -339,7 +444,7 @@ bool TaskExecutor::fetchAsyncReplies(void)
             }
 
             for (int32_t i=1; i<=remainingBytes; i++) {
-                Log().Get(DEBUG) << "Bytes in the receive queue: " << std::hex << (uint32_t)reply[i];
+                EASYFPGA_LOG(DEBUG) << "Bytes in the receive queue: " << std::hex << (uint32_t)reply[i];
             }
 
             assert(false);
@@ -347,25 +452,13 @@ bool TaskExecutor::fetchAsyncReplies(void)
         else {
             /* Here can hide an interrupt! */
 
-            byte reply[3];
+            byte reply[1];
             if (!_connection->receive(reply, 1, 1000000)) {
                 assert(false);
             }
 
             if (reply[0] == Exchange::SHARED_REPLY_CODES::INTERRUPT) {
-                if (_connection->receive(reply+1, 2, 1000000)) {
-                    byte calculatedParity = reply[1];
-                    Log().Get(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
-                    byte transmittedParity = reply[2];
-                    Log().Get(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
-                    if (calculatedParity == transmittedParity) {
-                        _triggeringCore = (CoreIndex)reply[1];
-                    }
-                    else {
-                        assert(false);
-                    }
-                }
-                else {
+                if (!this->receiveInterruptNotification(1000000)) {
                     assert(false);
                 }
             }
@@ -377,16 +470,16 @@ bool TaskExecutor::fetchAsyncReplies(void)
 
     if (this->interruptOccured() && (_easyCoreMapPointer != NULL)) {
         CoreIndex i = this->getTriggeringCore();
-        Log().Get(DEBUG) << "Core " << (int32_t)i << " has triggered an interrupt!";
+        EASYFPGA_LOG(DEBUG) << "Core " << (int32_t)i << " has triggered an interrupt!";
 
         auto it = _easyCoreMapPointer->find(i);
         assert(it != _easyCoreMapPointer->end());
         if (it != _easyCoreMapPointer->end()) {
             if (it->second->executeCallback()) {
-                Log().Get(DEBUG) << "Callback routine successfully executed.";
+                EASYFPGA_LOG(DEBUG) << "Callback routine successfully executed.";
             }
             else {
-                Log().Get(WARNING) << "For this interrupt was no callback registered!";
+                EASYFPGA_LOG(WARNING) << "For this interrupt was no callback registered!";
             }
         }
     }
@@ -400,17 +493,19 @@ uint32_t TaskExecutor::getNumberOfPendingRequests(void)
     for (auto it=_pendingAsyncTasks.begin(); it!=_pendingAsyncTasks.end(); ++it) {
         pendingNumber += it->second.size();
     }
-    Log().Get(DEBUG) << "Pending requests: " << pendingNumber;
+
+    pendingNumber += _readyAsyncTasks.size();
+    EASYFPGA_LOG(DEBUG) << "Pending requests: " << pendingNumber;
 
     uint32_t runningNumber = _runningAsyncTasks.size();
-    Log().Get(DEBUG) << "Running requests: " << runningNumber;
+    EASYFPGA_LOG(DEBUG) << "Running requests: " << runningNumber;
 
     return pendingNumber + runningNumber;
 }
 
 uint32_t TaskExecutor::getNumberOfFinishedRequests(void)
 {
-    Log().Get(DEBUG) << "Finished requests: " << _finishedAsyncTasks.size();
+    EASYFPGA_LOG(DEBUG) << "Finished requests: " << _finishedAsyncTasks.size();
     return _finishedAsyncTasks.size();
 }
 
@@ -420,12 +515,319 @@ void TaskExecutor::writeReplies(void)
         AsyncTask task(_finishedAsyncTasks.front());
 
         task.getExchange()->writeResults();
-        Log().Get(DEBUG) << "Task " << task.getName() << " successfully executed.";
+        EASYFPGA_LOG(DEBUG) << "Task " << task.getName() << " successfully executed.";
 
         _finishedAsyncTasks.pop();
     }
 }
 
+void TaskExecutor::setMaxRequestsInFlight(uint32_t maxRequests)
+{
+    /*
+     * At least one request must be allowed. The upper limit results
+     * from the 8-bit wide exchange ids handed out by the IdManager.
+     */
+    if (maxRequests < 1) {
+        maxRequests = 1;
+    }
+    else if (maxRequests > UINT8_MAX) {
+        maxRequests = UINT8_MAX;
+    }
+
+    _maxRequestsInFlight = maxRequests;
+    EASYFPGA_LOG(DEBUG) << "Allow " << (int32_t)_maxRequestsInFlight << " async requests in flight.";
+}
+
+uint32_t TaskExecutor::getMaxRequestsInFlight(void)
+{
+    return _maxRequestsInFlight;
+}
+
+bool TaskExecutor::flushRequests(void)
+{
+    return _connection->flushSendBuffer();
+}
+
+void TaskExecutor::beginRequestBatch(void)
+{
+    RequestBatch batch;
+    batch.open = true;
+    batch.failed = false;
+    _requestBatches.push_back(batch);
+}
+
+bool TaskExecutor::finishRequestBatch(void)
+{
+    assert(!_requestBatches.empty() && _requestBatches.back().open);
+
+    /*
+     * Callbacks executed while waiting may start and finish batches of
+     * their own. Those are always completed before the callback returns,
+     * so this batch stays valid.
+     */
+    auto batch = std::prev(_requestBatches.end());
+    batch->open = false;
+
+    /*
+     * Tasks of the batch may be retained behind older requests, so
+     * those are processed as well until the whole batch is completed.
+     * Failures of requests outside any batch are reported by the next
+     * fetchAsyncReplies().
+     */
+    while ((batch->taskNumbers.size() > 0)
+            && ((_runningAsyncTasks.size() > 0) || (_readyAsyncTasks.size() > 0))) {
+        uint32_t batchedTaskFailures = _batchedTaskFailures;
+        if (!this->dispatchReadyAsyncTasks() && (_batchedTaskFailures == batchedTaskFailures)) {
+            _asyncTaskFailed = true;
+        }
+
+        if (_runningAsyncTasks.size() > 0) {
+            batchedTaskFailures = _batchedTaskFailures;
+            if (!this->handleNextAsyncReply() && (_batchedTaskFailures == batchedTaskFailures)) {
+                _asyncTaskFailed = true;
+            }
+        }
+    }
+
+    /* Requests still left here were never sent. */
+    bool success = !batch->failed && batch->taskNumbers.empty();
+    _requestBatches.erase(batch);
+
+    return success;
+}
+
+void TaskExecutor::addToRequestBatch(tasknumberval number)
+{
+    if (!_requestBatches.empty() && _requestBatches.back().open) {
+        _requestBatches.back().taskNumbers.insert(number);
+    }
+}
+
+bool TaskExecutor::completeBatchedTask(tasknumberval number, bool success)
+{
+    for (auto it=_requestBatches.begin(); it!=_requestBatches.end(); ++it) {
+        if (it->taskNumbers.erase(number) > 0) {
+            if (!success) {
+                it->failed = true;
+                _batchedTaskFailures++;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TaskExecutor::dispatchReadyAsyncTasks(void)
+{
+    bool success = true;
+
+    while ((_readyAsyncTasks.size() > 0) && (_runningAsyncTasks.size() < _maxRequestsInFlight)) {
+        AsyncTask task(_readyAsyncTasks.front());
+        _readyAsyncTasks.pop();
+        Metrics::getInstance().changeAsyncTasks(0, -1);
+
+        task.executeSend();
+
+        if (task.getSendState() == Task::SEND_STATE::SEND_SUCCESS) {
+            _runningAsyncTasks.push_back(task);
+            Metrics::getInstance().changeAsyncTasks(1, 0);
+            EASYFPGA_LOG(DEBUG) << "Request of task " << task.getName() << " successfully sent.";
+        }
+        else {
+            #ifdef USE_IDS_FOR_ASYNC_OPS
+            _idManager->releaseId(task.getExchange()->getId());
+            #endif
+            _dependendTaskNumbers.erase(task.getNumber());
+            this->completeBatchedTask(task.getNumber(), false);
+            EASYFPGA_LOG(ERROR) << "Request of task " << task.getName() << " not successfully sent!";
+            if (task.getExchange()->hasACallback()) {
+                task.getExchange()->executeFailureCallback();
+            }
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+bool TaskExecutor::handleNextAsyncReply(void)
+{
+    assert(!_runningAsyncTasks.empty());
+
+    /* Get the sent but not yet processed task the next reply belongs to. */
+    auto it = this->receiveNextAsyncReply();
+    AsyncTask task(*it);
+    _runningAsyncTasks.erase(it);
+    Metrics::getInstance().changeAsyncTasks(-1, 0);
+
+    if (task.getReceiveState() == Task::RECEIVE_STATE::RECEIVE_SUCCESS) {
+        #ifdef USE_IDS_FOR_ASYNC_OPS
+        idval id = task.getExchange()->getId();
+        _idManager->releaseId(id);
+        EASYFPGA_LOG(DEBUG) << "The id " << (int32_t)id << " was released.";
+        #endif
+
+        auto dependency = _dependendTaskNumbers.find(task.getNumber());
+        if (dependency != _dependendTaskNumbers.end()) {
+            _dependendTaskNumbers.erase(dependency);
+
+            /*
+             * Release all tasks retained because of this one. They will
+             * be sent as soon as the in-flight window allows it.
+             */
+            auto retained = _pendingAsyncTasks.find(task.getNumber());
+            if (retained != _pendingAsyncTasks.end()) {
+                while (retained->second.size() > 0) {
+                    _readyAsyncTasks.push(retained->second.front());
+                    retained->second.pop();
+                }
+                _pendingAsyncTasks.erase(retained);
+            }
+        }
+
+        if (task.getExchange()->hasACallback()) {
+            /*
+             * Write back the reply of this task. We might need
+             * that step because the callback could be process
+             * some received data.
+             */
+            task.getExchange()->writeResults();
+
+            /* Execute the associated callback. */
+            task.getExchange()->executeCallback();
+
+            /*
+             * So, at this point the task is finished. We don't
+             * have to put it into the buffer _finishedAsyncTasks
+             * as we do with all other tasks without a callback.
+             * (Because of the task's results are already written.)
+             */
+        }
+        else if (this->completeBatchedTask(task.getNumber(), true)) {
+            /* The caller of finishRequestBatch() waits for this result. */
+            task.getExchange()->writeResults();
+            EASYFPGA_LOG(DEBUG) << "Task " << task.getName() << " successfully executed.";
+        }
+        else {
+            _finishedAsyncTasks.push(task);
+        }
+
+        return true;
+    }
+
+    if (task.getExecutionCount() <= _MAX_RETRIES_ALLOWED) {
+        EASYFPGA_LOG(DEBUG) << "Async task " << task.getName() << " not successfully executed. Start this task once again.";
+        EASYFPGA_LOG(DEBUG) << "Attempt " << (int32_t)task.getExecutionCount() << "/" << (int32_t)_MAX_RETRIES_ALLOWED;
+        task.executeSend();
+        if (task.getSendState() == Task::SEND_STATE::SEND_SUCCESS) {
+            EASYFPGA_LOG(DEBUG) << "Request of task " << task.getName() << " successfully sent.";
+            _runningAsyncTasks.push_back(task);
+            Metrics::getInstance().changeAsyncTasks(1, 0);
+            return true;
+        }
+        else {
+            EASYFPGA_LOG(ERROR) << "Request of task " << task.getName() << " not successfully sent!";
+        }
+    }
+    else {
+        EASYFPGA_LOG(ERROR) << "Max execution retries for async task " << task.getName() << " reached. This operation will be aborted now.";
+    }
+
+    #ifdef USE_IDS_FOR_ASYNC_OPS
+    _idManager->releaseId(task.getExchange()->getId());
+    #endif
+    _dependendTaskNumbers.erase(task.getNumber());
+    this->completeBatchedTask(task.getNumber(), false);
+
+    if (task.getExchange()->hasACallback()) {
+        task.getExchange()->executeFailureCallback();
+    }
+
+    return false;
+}
+
+std::list<AsyncTask>::iterator TaskExecutor::receiveNextAsyncReply(void)
+{
+    /*
+     * The easyFPGA usually replies in the order of the requests. Thats
+     * why the oldest running task is the default candidate for the next
+     * reply.
+     */
+    auto oldest = _runningAsyncTasks.begin();
+
+    #ifdef USE_IDS_FOR_ASYNC_OPS
+    timeoutval timeout = oldest->getExchange()->getReceiveTimeout();
+
+    /* opcode and id of a reply */
+    byte header[2];
+
+    while (_connection->receive(header, 1, timeout)) {
+        if (header[0] == Exchange::SHARED_REPLY_CODES::INTERRUPT) {
+            this->receiveInterruptNotification(timeout);
+            continue;
+        }
+
+        if (!_connection->receive(header+1, 1, timeout)) {
+            break;
+        }
+
+        for (auto it=_runningAsyncTasks.begin(); it!=_runningAsyncTasks.end(); ++it) {
+            if (it->getExchange()->getId() == (idval)header[1]) {
+                if (it != oldest) {
+                    EASYFPGA_LOG(DEBUG) << "Reply of task " << it->getName() << " overtook the reply of task " << oldest->getName() << ".";
+                }
+                it->executeReceive(header, 2);
+                return it;
+            }
+        }
+
+        /*
+         * We can't know how many bytes belong to a reply with an unknown
+         * id. So the only way to get in sync again is to throw away the
+         * receive queue. All affected tasks will be retried.
+         */
+        EASYFPGA_LOG(WARNING) << "Received a reply with the unknown id " << (int32_t)header[1] << ". Flush the receive queue...";
+        _connection->flushBuffers();
+        break;
+    }
+
+    EASYFPGA_LOG(DEBUG) << "No matching reply received. Task " << oldest->getName() << " failed.";
+    oldest->markReplyAsLost();
+    #else
+    oldest->executeReceive();
+    #endif
+
+    return oldest;
+}
+
+bool TaskExecutor::receiveInterruptNotification(timeoutval timeout)
+{
+    byte notification[2];
+
+    if (_connection->receive(notification, 2, timeout)) {
+        byte traced[3] = { Exchange::SHARED_REPLY_CODES::INTERRUPT, notification[0], notification[1] };
+        ExchangeTrace::getInstance().traceInterrupt(_connection->getConnectionId(), traced, 3);
+        Metrics::getInstance().countInterrupt();
+
+        byte calculatedParity = notification[0];
+        EASYFPGA_LOG(DEBUG) << "Calculated parity byte: 0x" << std::hex << (uint32_t)calculatedParity;
+        byte transmittedParity = notification[1];
+        EASYFPGA_LOG(DEBUG) << "Transmitted parity byte: 0x" << std::hex << (uint32_t)transmittedParity;
+        if (calculatedParity == transmittedParity) {
+            _triggeringCore = (CoreIndex)notification[0];
+            return true;
+        }
+
+        EASYFPGA_LOG(WARNING) << "Interrupt request recognized. Parity check failed. Because of that won't be executed the corresponding interrupt routine!";
+    }
+    else {
+        EASYFPGA_LOG(WARNING) << "Interrupt request recognized. Serial connection refused to get the triggering core! Because of that won't be executed the corresponding interrupt routine!";
+    }
+
+    return false;
+}
+
 bool TaskExecutor::interruptOccured(void)
 {
     if (_triggeringCore > 0) {
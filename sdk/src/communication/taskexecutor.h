@@ -22,6 +22,7 @@
 #ifndef SDK_COMMUNICATION_TASKEXECUTOR_H_
 #define SDK_COMMUNICATION_TASKEXECUTOR_H_
 
+#include "configuration.h" /* USE_IDS_FOR_ASYNC_OPS */
 #include "communication/asynctask.h"
 #include "communication/protocol/exchange_ptr.h"
 #include "communication/serialconnection_ptr.h"
@@ -33,9 +34,11 @@
 #endif
 
 #include <string>
+#include <list>
 #include <map>
 #include <set>
 #include <queue>
+#include <vector>
 
 /**
  * \brief Execution environment for tasks
@@ -46,6 +49,12 @@
  *
  * With the symbol USE_IDS_FOR_ASYNC_OPS can be decided whether this
  * class should use ids for asynchrounous communication or not.
+ *
+ * Asynchronous requests are sent through a sliding window: at most
+ * getMaxRequestsInFlight() requests may wait for their replies at the
+ * same time. If the window is full, startAsyncTask() processes replies
+ * until a slot becomes free. If ids are used, every reply is matched
+ * to its request by the id, thus replies may also arrive out of order.
  */
 class TaskExecutor
 {
@@ -83,6 +92,34 @@ class TaskExecutor
          */
         bool doSyncTask(std::string taskName, exchange_ptr operation);
 
+        /**
+         * \brief Executes a sequence of synchronous requests, whose
+         *        replies contain no id, in a pipeline.
+         *
+         * Up to depth requests are sent before the reply of the oldest
+         * one is received. The replies have to arrive in order. If one
+         * of them is missing or faulty, or a request can't be sent, the
+         * replies of the requests already sent are received first, so
+         * that their successful operations are completed. Then the
+         * failed request is repeated with doSyncTask() and the pipeline
+         * restarts behind it. Hence the requests must be idempotent.
+         *
+         * \param taskName A name of the operations (for logging purposes)
+         *
+         * \param operations The exchanges to be executed in this order
+         *
+         * \param depth The maximum number of requests awaiting their
+         *        reply. 1 executes them one after another.
+         *
+         * \param latencies If not NULL, receives for every operation
+         *        the time between sending the request and receiving its
+         *        successful reply in us.
+         *
+         * \return true if all operations were successful,<br>
+         *         false otherwise
+         */
+        bool doSyncTaskPipeline(std::string taskName, const std::vector<exchange_ptr>& operations, uint32_t depth, std::vector<uint32_t>* latencies);
+
         /* ASYNC */
         /**
          * \brief Sends a asynchronous request.
@@ -146,10 +183,101 @@ class TaskExecutor
          */
         void writeReplies(void);
 
+        /**
+         * \brief Sets the size of the in-flight window for asynchronous
+         *        requests.
+         *
+         * \param maxRequests The maximum number of sent requests whose
+         *        replies weren't received yet. Values are limited to the
+         *        range [1, 255].
+         */
+        void setMaxRequestsInFlight(uint32_t maxRequests);
+
+        /**
+         * \brief Gets the size of the in-flight window for asynchronous
+         *        requests.
+         *
+         * \return A positive integer in [1, 255]
+         */
+        uint32_t getMaxRequestsInFlight(void);
+
+        /**
+         * \brief Writes all buffered asynchronous requests to the
+         *        easyFPGA without waiting for their replies.
+         *
+         * \return true if all buffered requests could be written,\n
+         *         false otherwise
+         */
+        bool flushRequests(void);
+
+        /**
+         * \brief Starts collecting the asynchronous requests issued from
+         *        now on into a batch, which finishRequestBatch() waits
+         *        for.
+         *
+         * Batches may be nested, e.g. by a callback executed while an
+         * outer batch is sent or awaited. Requests always belong to the
+         * innermost batch which isn't awaited yet.
+         */
+        void beginRequestBatch(void);
+
+        /**
+         * \brief Waits only for the replies of the requests started
+         *        since the last beginRequestBatch() and writes back their
+         *        results.
+         *
+         * Replies of older requests arriving in between are processed as
+         * fetchAsyncReplies() does (callbacks are executed), but results
+         * of requests without a callback stay queued for writeReplies().
+         *
+         * \return true if all requests of the batch were successful,\n
+         *         false otherwise
+         */
+        bool finishRequestBatch(void);
+
     private:
         bool interruptOccured(void);
         CoreIndex getTriggeringCore(void);
 
+        /**
+         * \brief Sends retained tasks whose dependencies are resolved
+         *        as long as the in-flight window has free slots.
+         */
+        bool dispatchReadyAsyncTasks(void);
+
+        /**
+         * \brief Receives and processes exactly one reply of the running
+         *        tasks (including a possible retry of the task).
+         */
+        bool handleNextAsyncReply(void);
+
+        /**
+         * \brief Receives the next reply and returns the running task
+         *        it belongs to. If nothing matching arrives in time, the
+         *        oldest running task will be returned as failed.
+         */
+        std::list<AsyncTask>::iterator receiveNextAsyncReply(void);
+
+        /**
+         * \brief Receives the two bytes following an interrupt opcode
+         *        and remembers the triggering core.
+         */
+        bool receiveInterruptNotification(timeoutval timeout);
+
+        /**
+         * \brief Adds a started task to the innermost batch which isn't
+         *        awaited yet, if there is one.
+         */
+        void addToRequestBatch(tasknumberval number);
+
+        /**
+         * \brief Removes a completed or failed task from its batch.
+         *
+         * \return true if the task belonged to a batch,\n
+         *         false otherwise
+         */
+        bool completeBatchedTask(tasknumberval number, bool success);
+
         serialconnection_ptr _connection;
 
         easycore_map_ptr _easyCoreMapPointer;
@@ -162,9 +290,10 @@ class TaskExecutor
 
         /* buffer 1 */
         std::map<tasknumberval, std::queue<AsyncTask>> _pendingAsyncTasks;
+        std::queue<AsyncTask> _readyAsyncTasks;
 
-        /* buffer 2 */
-        std::queue<AsyncTask> _runningAsyncTasks;
+        /* buffer 2 (in order of sending) */
+        std::list<AsyncTask> _runningAsyncTasks;
         std::set<tasknumberval> _dependendTaskNumbers;
 
         /* buffer 3 */
@@ -174,6 +303,19 @@ class TaskExecutor
         tasknumberval _syncOperationCounter;
         tasknumberval _asyncOperationCounter;
 
+        /* sliding window of async requests */
+        uint32_t _maxRequestsInFlight;
+        bool _asyncTaskFailed;
+
+        /* requests collected by beginRequestBatch(), innermost last */
+        struct RequestBatch {
+            std::set<tasknumberval> taskNumbers;
+            bool open;
+            bool failed;
+        };
+        std::list<RequestBatch> _requestBatches;
+        uint32_t _batchedTaskFailures;
+
         const retryval _MAX_RETRIES_ALLOWED;
 };
 
@@ -0,0 +1,161 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/protocol/calculator.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* size of the data hashed by the benchmark */
+static const uint32_t BENCHMARK_SIZE = 16*1024*1024;
+
+/**
+ * \brief Tests and benchmarks the Adler32 implementations of Calculator
+ *
+ * Every implementation supported by the cpu has to produce the hash
+ * sums of the straightforward algorithm for unaligned data of any
+ * length, for data maximizing the sums and when hashing piece by piece.
+ * The throughput of every implementation is measured over multiple
+ * megabytes.
+ */
+class Adler32Test : public Tester
+{
+    std::string testName(void) {
+        return "adler32 test";
+    }
+
+    /* the formulation reducing both sums after every byte */
+    static uint32_t referenceHash(const byte* data, uint64_t length) {
+        uint32_t a = 1, b = 0;
+        for (uint64_t i=0; i<length; i++) {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    static double measureMegabytesPerSecond(const std::vector<byte>& data, bool reference, uint32_t* hash) {
+        auto start = std::chrono::steady_clock::now();
+        if (reference) {
+            *hash = referenceHash(data.data(), data.size());
+        }
+        else {
+            *hash = Calculator::updateAdler32Hash(Calculator::ADLER32_INITIAL_VALUE, data.data(), data.size());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return (seconds > 0.0) ? (data.size() / seconds / 1000000.0) : 0.0;
+    }
+
+    bool verify(const std::vector<byte>& random, const std::vector<byte>& ones) {
+        for (uint32_t offset=0; offset<32; offset++) {
+            for (uint32_t length=0; length<300; length+=7) {
+                if (Calculator::calculateAdler32Hash(random.data()+offset, length) != referenceHash(random.data()+offset, length)) {
+                    Log().Get(ERROR) << "Wrong hash of " << length << " bytes at offset " << offset << "!";
+                    return false;
+                }
+            }
+        }
+
+        if (Calculator::calculateAdler32Hash(ones.data(), ones.size()) != referenceHash(ones.data(), ones.size())) {
+            Log().Get(ERROR) << "Wrong hash of bytes maximizing the sums!";
+            return false;
+        }
+
+        uint32_t whole = referenceHash(random.data(), random.size());
+        const uint64_t pieceLengths[] = { 1, 15, 4096, 5551, 5553, 100000 };
+        for (uint64_t pieceLength : pieceLengths) {
+            uint32_t hash = Calculator::ADLER32_INITIAL_VALUE;
+            for (uint64_t position=0; position<random.size(); position+=pieceLength) {
+                uint64_t length = std::min(pieceLength, (uint64_t)random.size() - position);
+                hash = Calculator::updateAdler32Hash(hash, random.data()+position, length);
+            }
+            if (hash != whole) {
+                Log().Get(ERROR) << "Wrong hash when hashing pieces of " << pieceLength << " bytes!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        std::vector<byte> random(BENCHMARK_SIZE);
+        uint32_t state = 0x12345678;
+        for (uint32_t i=0; i<random.size(); i++) {
+            state = state * 1103515245 + 12345;
+            random[i] = (byte)(state >> 16);
+        }
+        std::vector<byte> ones(1024*1024, 0xFF);
+
+        uint32_t referenceResult = 0;
+        double referenceSpeed = measureMegabytesPerSecond(random, true, &referenceResult);
+        Log().Get(INFO) << "reference: " << referenceSpeed << " MB/s";
+
+        std::string fastest(Calculator::getAdler32Implementation());
+        double fastestSpeed = 0.0;
+
+        const char* implementations[] = { "scalar", "sse2", "avx2" };
+        for (const char* implementation : implementations) {
+            if (!Calculator::selectAdler32Implementation(implementation)) {
+                Log().Get(INFO) << implementation << ": not supported by the cpu";
+                continue;
+            }
+
+            if (!this->verify(random, ones)) {
+                Log().Get(ERROR) << "The " << implementation << " implementation is faulty!";
+                return false;
+            }
+
+            uint32_t result = 0;
+            double speed = measureMegabytesPerSecond(random, false, &result);
+            Log().Get(INFO) << implementation << ": " << speed << " MB/s";
+
+            if (result != referenceResult) {
+                Log().Get(ERROR) << "The " << implementation << " implementation is faulty!";
+                return false;
+            }
+
+            if (fastest == implementation) {
+                fastestSpeed = speed;
+            }
+        }
+
+        Calculator::selectAdler32Implementation(fastest);
+
+        if (fastestSpeed <= referenceSpeed) {
+            Log().Get(ERROR) << "The selected implementation " << fastest << " isn't faster than the reference!";
+            return false;
+        }
+
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    Adler32Test test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,381 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/serialconnection.h"
+#include "easyfpga/communication/taskexecutor.h"
+#include "easyfpga/communication/protocol/frame.h"
+#include "easyfpga/communication/protocol/socexchanges/read_register.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring> /* memset(3) */
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h> /* posix_openpt() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <termios.h>
+#include <unistd.h> /* read(), write(), close() */
+
+/**
+ * \brief Answers soc register exchanges on a pseudo terminal
+ *
+ * This stand-in for an easyFPGA in soc context lets the TaskExecutor
+ * tests run without hardware. Each register request is answered after
+ * a fixed latency. Replies which become due at the same time can be
+ * sent in reverse order to check the id based reply matching.
+ */
+class PseudoBoard
+{
+    public:
+        PseudoBoard();
+        ~PseudoBoard();
+
+        /**
+         * \brief Creates the pseudo terminal and starts answering requests.
+         *
+         * \return true if the pseudo terminal could be created,<br>
+         *         false otherwise
+         */
+        bool start(void);
+
+        /**
+         * \brief Stops answering requests and closes the pseudo terminal.
+         */
+        void stop(void);
+
+        /**
+         * \brief Path of the slave device a SerialConnection can open.
+         */
+        std::string getDevicePath(void);
+
+        /**
+         * \brief Time between receiving a request and sending its reply.
+         */
+        void setReplyLatency(uint32_t latencyus);
+
+        /**
+         * \brief Sends simultaneously due replies in reverse order if enabled.
+         */
+        void setReorderReplies(bool reorder);
+
+        void setRegister(byte core, byte address, byte value);
+        byte getRegister(byte core, byte address);
+
+    private:
+        void run(void);
+
+        int _master;
+        std::string _devicePath;
+        std::thread _thread;
+        std::atomic<bool> _running;
+        std::atomic<uint32_t> _latencyus;
+        std::atomic<bool> _reorder;
+        byte _registers[256][256];
+};
+
+namespace {
+    typedef std::chrono::steady_clock clock_type;
+
+    struct PendingReply {
+        clock_type::time_point due;
+        std::vector<byte> data;
+    };
+
+    byte xorParity(const byte* data, uint32_t length)
+    {
+        byte parity = 0;
+        for (uint32_t i=0; i<length; i++) {
+            parity ^= data[i];
+        }
+        return parity;
+    }
+}
+
+PseudoBoard::PseudoBoard() :
+    _master(-1),
+    _running(false),
+    _latencyus(0),
+    _reorder(false)
+{
+    std::memset(_registers, 0, sizeof(_registers));
+}
+
+PseudoBoard::~PseudoBoard()
+{
+    this->stop();
+}
+
+bool PseudoBoard::start(void)
+{
+    _master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((_master < 0) || (grantpt(_master) != 0) || (unlockpt(_master) != 0)) {
+        return false;
+    }
+
+    struct termios tio;
+    tcgetattr(_master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(_master, TCSANOW, &tio);
+
+    _devicePath = ptsname(_master);
+    _running = true;
+    _thread = std::thread(&PseudoBoard::run, this);
+
+    return true;
+}
+
+void PseudoBoard::stop(void)
+{
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    if (_master >= 0) {
+        close(_master);
+        _master = -1;
+    }
+}
+
+std::string PseudoBoard::getDevicePath(void)
+{
+    return _devicePath;
+}
+
+void PseudoBoard::setReplyLatency(uint32_t latencyus)
+{
+    _latencyus = latencyus;
+}
+
+void PseudoBoard::setReorderReplies(bool reorder)
+{
+    _reorder = reorder;
+}
+
+void PseudoBoard::setRegister(byte core, byte address, byte value)
+{
+    _registers[core][address] = value;
+}
+
+byte PseudoBoard::getRegister(byte core, byte address)
+{
+    return _registers[core][address];
+}
+
+void PseudoBoard::run(void)
+{
+    std::vector<byte> input;
+    std::deque<PendingReply> pending;
+
+    while (_running) {
+        int timeoutms = 10;
+        if (!pending.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(pending.front().due - clock_type::now());
+            timeoutms = (wait.count() > 0) ? (int)wait.count() : 0;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = _master;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if ((poll(&pfd, 1, timeoutms) > 0) && (pfd.revents & POLLIN)) {
+            byte buffer[512];
+            ssize_t count = read(_master, buffer, sizeof(buffer));
+            if (count > 0) {
+                input.insert(input.end(), buffer, buffer + count);
+            }
+        }
+
+        /* parse all complete requests */
+        size_t offset = 0;
+        while (offset < input.size()) {
+            byte* request = input.data() + offset;
+            size_t available = input.size() - offset;
+            PendingReply reply;
+            reply.due = clock_type::now() + std::chrono::microseconds(_latencyus.load());
+
+            if (request[0] == 0x77) {
+                /* ReadRegister: opcode, id, core, address, parity */
+                if (available < 5) break;
+                reply.data = { 0x88, request[1], _registers[request[2]][request[3]] };
+                offset += 5;
+            }
+            else if (request[0] == 0x66) {
+                /* WriteRegister: opcode, id, core, address, data, parity */
+                if (available < 6) break;
+                _registers[request[2]][request[3]] = request[4];
+                reply.data = { 0x00, request[1] };
+                offset += 6;
+            }
+            else {
+                /* unknown opcode: drop a single byte */
+                offset += 1;
+                continue;
+            }
+
+            reply.data.push_back(xorParity(reply.data.data(), reply.data.size()));
+            pending.push_back(reply);
+        }
+        input.erase(input.begin(), input.begin() + offset);
+
+        /* send all due replies */
+        std::vector<PendingReply> due;
+        auto now = clock_type::now();
+        while (!pending.empty() && (pending.front().due <= now)) {
+            due.push_back(pending.front());
+            pending.pop_front();
+        }
+
+        if (_reorder) {
+            std::vector<PendingReply> reversed(due.rbegin(), due.rend());
+            due.swap(reversed);
+        }
+
+        for (auto it=due.begin(); it!=due.end(); ++it) {
+            size_t written = 0;
+            while (written < it->data.size()) {
+                ssize_t count = write(_master, it->data.data() + written, it->data.size() - written);
+                if (count > 0) {
+                    written += count;
+                }
+                else if (errno != EAGAIN) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \brief Measures the async throughput of the TaskExecutor for several
+ *        in-flight window sizes
+ *
+ * The test needs no easyFPGA. A PseudoBoard answers all register reads
+ * on a pseudo terminal after a fixed latency. For each window size a
+ * constant number of reads is started and the achieved requests per
+ * second as well as the number of write() calls will be logged. In the end a run with reordered replies checks
+ * that each reply finds its request by the exchange id.
+ */
+class TaskExecutorWindowTest : public Tester
+{
+    std::string testName(void) {
+        return "task executor window test";
+    }
+
+    bool readRegisters(TaskExecutor& executor, SerialConnection& connection, PseudoBoard& board, uint32_t window, uint32_t count) {
+        byte results[count];
+        std::memset(results, 0, count);
+
+        executor.setMaxRequestsInFlight(window);
+
+        uint64_t frames = connection.getNumberOfSentFrames();
+        uint64_t writeCalls = connection.getNumberOfWriteCalls();
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i=0; i<count; i++) {
+            exchange_ptr exchange = std::make_shared<ReadRegister>(results+i, (byte)(i>>8), (byte)i, nullptr);
+            if (executor.startAsyncTask(std::string("readRegisterAsync"), exchange, 0) == 0) {
+                Log().Get(ERROR) << "Couldn't start async task " << i << "!";
+                return false;
+            }
+        }
+
+        if (!executor.fetchAsyncReplies()) {
+            Log().Get(ERROR) << "Fetching async replies failed!";
+            return false;
+        }
+        executor.writeReplies();
+
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        for (uint32_t i=0; i<count; i++) {
+            if (results[i] != board.getRegister((byte)(i>>8), (byte)i)) {
+                Log().Get(ERROR) << "Wrong value for request " << i << " with window " << window << "!";
+                return false;
+            }
+        }
+
+        Log().Get(INFO) << "window " << window << ": " << count << " requests in "
+            << duration.count() << " us (" << (uint64_t)count * 1000000 / (duration.count() + 1) << " requests/s, "
+            << (connection.getNumberOfSentFrames() - frames) << " frames in "
+            << (connection.getNumberOfWriteCalls() - writeCalls) << " write calls)";
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        PseudoBoard board;
+        if (!board.start()) {
+            Log().Get(ERROR) << "Couldn't create a pseudo terminal!";
+            return false;
+        }
+
+        for (uint32_t core=0; core<4; core++) {
+            for (uint32_t address=0; address<256; address++) {
+                board.setRegister(core, address, (byte)(core * 31 + address * 7 + 1));
+            }
+        }
+        board.setReplyLatency(200);
+
+        serialconnection_ptr connection = std::make_shared<SerialConnection>();
+        if (!connection->openDevice(board.getDevicePath())) {
+            return false;
+        }
+
+        TaskExecutor executor(connection, nullptr);
+
+        const uint32_t windows[] = { 1, 2, 4, 8, 16, 32, 64 };
+        for (uint32_t window : windows) {
+            if (!this->readRegisters(executor, *connection, board, window, 1024)) {
+                return false;
+            }
+        }
+
+        Log().Get(INFO) << "Check id based matching of reordered replies...";
+        board.setReorderReplies(true);
+        if (!this->readRegisters(executor, *connection, board, 16, 1024)) {
+            return false;
+        }
+
+        connection->closeDevice();
+        board.stop();
+
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    TaskExecutorWindowTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,224 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/communication/protocol/specification.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio> /* remove(1) */
+#include <string>
+#include <thread>
+
+#include <fcntl.h> /* posix_openpt() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <sys/stat.h> /* mkdir() */
+#include <termios.h>
+#include <unistd.h> /* read(), write(), close(), symlink() */
+
+/* must match USB_DEVICE_PATH and DEVICE_CACHE_FILE in project.conf */
+static const std::string DEVICE_DIRECTORY("/tmp/easyfpga-discovery-test/");
+static const std::string CACHE_FILE("/tmp/easyfpga-discovery-test.cache");
+
+/* pseudo terminals answering like an mcu, followed by silent ones */
+static const uint32_t BOARD_COUNT = 3;
+static const uint32_t DEVICE_COUNT = 6;
+
+/**
+ * \brief Tests the parallel device discovery and the device cache
+ *
+ * The test needs no easyFPGA. The master sides of pseudo terminals,
+ * linked as ttyUSB<n> into the directory configured in project.conf,
+ * act as serial devices. The first ones behave like an mcu with the
+ * serial 0x1000+n, the others never answer. The test checks that
+ * - a full scan probes the devices concurrently, i.e. the silent
+ *   devices don't add up their detect timeouts,
+ * - a known serial is validated by probing only the cached device, and
+ * - a stale cache entry leads to a full scan again.
+ */
+class DeviceDiscoveryTest : public Tester
+{
+    std::string testName(void) {
+        return "device discovery test";
+    }
+
+    static void answerRequests(int master, uint32_t serial, std::atomic<uint32_t>* detects, std::atomic<bool>* running) {
+        while (*running) {
+            struct pollfd pfd;
+            pfd.fd = master;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if ((poll(&pfd, 1, 10) <= 0) || !(pfd.revents & POLLIN)) {
+                continue;
+            }
+
+            byte requests[64];
+            ssize_t count = read(master, requests, sizeof(requests));
+            for (ssize_t i=0; i<count; i++) {
+                byte reply[6];
+                ssize_t length = 0;
+
+                if (requests[i] == (byte)0xEE) {
+                    (*detects)++;
+                    reply[0] = 0xFF;
+                    reply[1] = 0x22;
+                    reply[2] = reply[0] ^ reply[1];
+                    length = 3;
+                }
+                else if (requests[i] == (byte)0xD3) {
+                    reply[0] = 0xD9;
+                    reply[5] = reply[0];
+                    for (uint32_t j=0; j<4; j++) {
+                        reply[1+j] = (byte)(serial >> (8*j));
+                        reply[5] ^= reply[1+j];
+                    }
+                    length = 6;
+                }
+
+                if ((length > 0) && (write(master, reply, length) != length)) {
+                    Log().Get(ERROR) << "Pseudo board couldn't write its reply!";
+                }
+            }
+        }
+    }
+
+    std::string linkName(uint32_t device) {
+        return DEVICE_DIRECTORY + "ttyUSB" + std::to_string(device);
+    }
+
+    /**
+     * Connects to a serial and returns the elapsed time in us or -1.
+     */
+    int64_t connect(uint32_t serial) {
+        auto start = std::chrono::steady_clock::now();
+
+        Communicator com(nullptr);
+        if (!com.init(serial)) {
+            Log().Get(ERROR) << "easyFPGA 0x" << std::hex << serial << " not found!";
+            return -1;
+        }
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    uint32_t sumOfDetects(std::atomic<uint32_t>* detects) {
+        uint32_t sum = 0;
+        for (uint32_t i=0; i<BOARD_COUNT; i++) {
+            sum += detects[i];
+        }
+        return sum;
+    }
+
+    bool testMethod(void) {
+        mkdir(DEVICE_DIRECTORY.c_str(), 0700);
+        std::remove(CACHE_FILE.c_str());
+
+        int masters[DEVICE_COUNT];
+        std::thread boards[BOARD_COUNT];
+        std::atomic<uint32_t> detects[BOARD_COUNT];
+        std::atomic<bool> running(true);
+
+        for (uint32_t i=0; i<DEVICE_COUNT; i++) {
+            masters[i] = posix_openpt(O_RDWR | O_NOCTTY);
+            if ((masters[i] < 0) || (grantpt(masters[i]) != 0) || (unlockpt(masters[i]) != 0)) {
+                Log().Get(ERROR) << "Couldn't create a pseudo terminal!";
+                return false;
+            }
+
+            struct termios tio;
+            tcgetattr(masters[i], &tio);
+            cfmakeraw(&tio);
+            tcsetattr(masters[i], TCSANOW, &tio);
+
+            unlink(this->linkName(i).c_str());
+            if (symlink(ptsname(masters[i]), this->linkName(i).c_str()) != 0) {
+                Log().Get(ERROR) << "Couldn't create " << this->linkName(i) << "!";
+                return false;
+            }
+
+            if (i < BOARD_COUNT) {
+                detects[i] = 0;
+                boards[i] = std::thread(answerRequests, masters[i], 0x1000 + i, &detects[i], &running);
+            }
+        }
+
+        bool success = true;
+
+        /* 1. full scan: the silent devices time out concurrently */
+        int64_t duration = this->connect(0x1000 + BOARD_COUNT - 1);
+        Log().Get(INFO) << "Full scan of " << DEVICE_COUNT << " devices took " << duration << " us";
+        if ((duration < 0) || (duration >= (int64_t)(2 * DETECT_TIMEOUT))) {
+            Log().Get(ERROR) << "The devices weren't probed in parallel!";
+            success = false;
+        }
+
+        /* 2. the cache knows all boards now: one detect is enough */
+        uint32_t detectsBefore = this->sumOfDetects(detects);
+        duration = this->connect(0x1000);
+        Log().Get(INFO) << "Connecting to a cached board took " << duration << " us";
+        if ((duration < 0) || (this->sumOfDetects(detects) - detectsBefore != 1)) {
+            Log().Get(ERROR) << "The cached device wasn't used!";
+            success = false;
+        }
+
+        /* 3. swap two boards: the cache entry becomes stale */
+        unlink(this->linkName(0).c_str());
+        unlink(this->linkName(1).c_str());
+        success &= (symlink(ptsname(masters[1]), this->linkName(0).c_str()) == 0);
+        success &= (symlink(ptsname(masters[0]), this->linkName(1).c_str()) == 0);
+
+        if (this->connect(0x1000) < 0) {
+            Log().Get(ERROR) << "A stale cache entry wasn't corrected by a scan!";
+            success = false;
+        }
+
+        detectsBefore = this->sumOfDetects(detects);
+        if ((this->connect(0x1000) < 0) || (this->sumOfDetects(detects) - detectsBefore != 1)) {
+            Log().Get(ERROR) << "The cache wasn't updated after the scan!";
+            success = false;
+        }
+
+        running = false;
+        for (uint32_t i=0; i<DEVICE_COUNT; i++) {
+            if (i < BOARD_COUNT) {
+                boards[i].join();
+            }
+            close(masters[i]);
+            unlink(this->linkName(i).c_str());
+        }
+        rmdir(DEVICE_DIRECTORY.c_str());
+        std::remove(CACHE_FILE.c_str());
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    DeviceDiscoveryTest test;
+    return (uint32_t)test.runTest();
+}
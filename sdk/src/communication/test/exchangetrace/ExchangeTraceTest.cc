@@ -0,0 +1,256 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/communication/exchangetrace.h"
+#include "easyfpga/communication/task.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedregisterfile.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <algorithm> /* find_if() */
+#include <chrono>
+#include <cstdio> /* remove(1) */
+#include <memory>
+#include <string>
+#include <vector>
+
+static const std::string TRACE_FILE("/tmp/easyfpga-exchange-trace-test.trace");
+
+/* small enough to be overwritten several times */
+static const uint64_t TRACE_CAPACITY = 64;
+
+static const uint32_t REGISTER_OPERATIONS = 2000;
+
+/**
+ * \brief Tests the recording of exchanges
+ *
+ * The test needs no easyFPGA. Register writes and reads are executed on
+ * a simulated soc while they are recorded. Every request and reply has to
+ * be found in the trace with the right core, address and payload. If
+ * the ring overflows, only the newest records have to remain. Opening
+ * the trace again has to continue it. The records of a second
+ * connection have to carry its own id, which an open record maps to
+ * its device.
+ */
+class ExchangeTraceTest : public Tester
+{
+    std::string testName(void) {
+        return "exchange trace test";
+    }
+
+    bool accessRegisters(Communicator& com, uint32_t operations, double* seconds) {
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i=0; i<operations; i+=2) {
+            byte value = 0x00;
+            if (!com.writeRegister((byte)i, 1, (byte)(i>>1)) || !com.readRegister(&value, 1, (byte)(i>>1)) || (value != (byte)i)) {
+                Log().Get(ERROR) << "Register access failed!";
+                return false;
+            }
+        }
+
+        *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    /*
+     * Checks that the records contain the complete exchanges of the last
+     * accessRegisters(), written in order.
+     */
+    bool checkRecords(const std::vector<ExchangeTraceRecord>& records, uint32_t operations) {
+        uint32_t requests = 0;
+        uint32_t replies = 0;
+
+        for (uint32_t i=0; i<records.size(); i++) {
+            const ExchangeTraceRecord& record = records[i];
+
+            if ((i > 0) && (record.sequence != records[i-1].sequence + 1)) {
+                Log().Get(ERROR) << "The records " << records[i-1].sequence << " and " << record.sequence << " aren't consecutive!";
+                return false;
+            }
+
+            if ((record.connection == 0) || (record.connection != records[0].connection)) {
+                Log().Get(ERROR) << "The record " << record.sequence << " has the wrong connection " << record.connection << "!";
+                return false;
+            }
+
+            if ((record.direction != ExchangeTrace::REQUEST) && (record.direction != ExchangeTrace::REPLY)) {
+                continue;
+            }
+
+            bool isWrite = (record.opcode == 0x66);
+            if ((!isWrite && (record.opcode != 0x77)) || !(record.flags & ExchangeTrace::HAS_REGISTER) ||
+                (record.core != 1) || (record.payloadLength != record.length)) {
+                Log().Get(ERROR) << "Unexpected " << ExchangeTrace::getDirectionName(record.direction) << " record of a "
+                    << ExchangeTrace::getExchangeName(record.opcode) << " exchange!";
+                return false;
+            }
+
+            if (record.direction == ExchangeTrace::REQUEST) {
+                requests++;
+                if ((record.payload[0] != record.opcode) || (record.payload[3] != record.address) || (record.retry != 0)) {
+                    Log().Get(ERROR) << "Wrong request payload!";
+                    return false;
+                }
+            }
+            else {
+                replies++;
+                if ((record.status != Task::RECEIVE_STATE::RECEIVE_SUCCESS) || (record.latency == 0) ||
+                    (record.payload[0] != (isWrite ? 0x00 : 0x88)) || (record.payload[1] != record.id)) {
+                    Log().Get(ERROR) << "Wrong reply record!";
+                    return false;
+                }
+
+                /* a read returns the value written right before */
+                if (!isWrite && (record.payload[2] != (byte)(record.address << 1))) {
+                    Log().Get(ERROR) << "Wrong register value in the reply record!";
+                    return false;
+                }
+            }
+        }
+
+        if ((requests == 0) || (replies == 0) || (requests > operations) || (replies > operations)) {
+            Log().Get(ERROR) << "The trace contains " << requests << " requests and " << replies << " replies!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testSecondConnection(uint16_t firstConnection) {
+        BoardSimulator board;
+        board.addCore(1, std::make_shared<SimulatedRegisterFile>());
+        board.startSoc();
+        if (!board.start() || !ExchangeTrace::getInstance().open(TRACE_FILE, TRACE_CAPACITY)) {
+            return false;
+        }
+
+        Communicator com(nullptr);
+        double seconds;
+        bool success = com.initWithDevice(board.getDevice()) && this->accessRegisters(com, 2, &seconds);
+        ExchangeTrace::getInstance().close();
+
+        std::vector<ExchangeTraceRecord> records;
+        success &= ExchangeTrace::readRecords(TRACE_FILE, &records);
+
+        /* the records since the device was opened */
+        auto open = std::find_if(records.begin(), records.end(), [](const ExchangeTraceRecord& record) {
+            return (record.direction == ExchangeTrace::OPEN);
+        });
+        if (!success || (open == records.end()) ||
+            (std::string((const char*)open->payload, open->payloadLength) != board.getDevice())) {
+            Log().Get(ERROR) << "Opening the device wasn't recorded!";
+            return false;
+        }
+
+        uint16_t connection = open->connection;
+        if ((connection == 0) || (connection == firstConnection)) {
+            Log().Get(ERROR) << "The second connection has the id " << connection << "!";
+            return false;
+        }
+
+        return this->checkRecords(std::vector<ExchangeTraceRecord>(open, records.end()), 100);
+    }
+
+    bool testMethod(void) {
+        std::remove(TRACE_FILE.c_str());
+
+        BoardSimulator board;
+        board.addCore(1, std::make_shared<SimulatedRegisterFile>());
+        board.startSoc();
+        if (!board.start()) {
+            return false;
+        }
+
+        Communicator com(nullptr);
+        if (!com.initWithDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated soc!";
+            return false;
+        }
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = true;
+        double untracedSeconds = 0.0;
+        double tracedSeconds = 0.0;
+        ExchangeTrace& trace = ExchangeTrace::getInstance();
+        std::vector<ExchangeTraceRecord> records;
+
+        success &= this->accessRegisters(com, REGISTER_OPERATIONS, &untracedSeconds);
+
+        Log().Get(INFO) << "Record 10 exchanges...";
+        success &= trace.open(TRACE_FILE, TRACE_CAPACITY);
+        success &= this->accessRegisters(com, 10, &tracedSeconds);
+        success &= ExchangeTrace::readRecords(TRACE_FILE, &records);
+        success &= this->checkRecords(records, 10);
+
+        /* request, write() call and reply of every exchange */
+        if (records.size() != 30) {
+            Log().Get(ERROR) << "The trace contains " << records.size() << " instead of 30 records!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Overwrite the ring several times...";
+        success &= this->accessRegisters(com, REGISTER_OPERATIONS, &tracedSeconds);
+        success &= ExchangeTrace::readRecords(TRACE_FILE, &records);
+        success &= this->checkRecords(records, REGISTER_OPERATIONS);
+
+        if ((records.size() != TRACE_CAPACITY) || (records.back().sequence != 30 + 3 * REGISTER_OPERATIONS)) {
+            Log().Get(ERROR) << "The trace doesn't contain the newest " << TRACE_CAPACITY << " records!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Continue the trace after opening it again...";
+        trace.close();
+        double seconds;
+        success &= trace.open(TRACE_FILE, TRACE_CAPACITY);
+        success &= this->accessRegisters(com, 2, &seconds);
+        trace.close();
+        success &= ExchangeTrace::readRecords(TRACE_FILE, &records);
+
+        if (records.empty() || (records.back().sequence != 36 + 3 * REGISTER_OPERATIONS)) {
+            Log().Get(ERROR) << "The trace wasn't continued!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Record the exchanges of a second connection...";
+        success &= this->testSecondConnection(records.empty() ? 0 : records.back().connection);
+
+        Log().Get(INFO) << "register operations: " << (uint32_t)(REGISTER_OPERATIONS / untracedSeconds) << " ops/s without trace, "
+            << (uint32_t)(REGISTER_OPERATIONS / tracedSeconds) << " ops/s with trace";
+
+        Log::setMinimumOutputLevel(configuredLevel);
+        std::remove(TRACE_FILE.c_str());
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    ExchangeTraceTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,97 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/protocol/frame.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstring> /* memcmp(3) */
+
+/**
+ * \brief Tests the inline and heap storage of Frame
+ */
+class FrameTest : public Tester
+{
+    std::string testName(void) {
+        return "frame test";
+    }
+
+    bool checkFrame(uint16_t length) {
+        byte buffer[length];
+        for (uint16_t i=0; i<length; i++) {
+            buffer[i] = (byte)(i * 13 + 7);
+        }
+
+        Frame frame(buffer, length);
+        if ((frame.size() != length) || (frame.getOperationCode() != buffer[0])) {
+            Log().Get(ERROR) << "Frame of " << length << " bytes has a wrong size or opcode!";
+            return false;
+        }
+
+        if (memcmp(frame.data(), buffer, length) != 0) {
+            Log().Get(ERROR) << "Frame of " << length << " bytes holds wrong data!";
+            return false;
+        }
+
+        byte copy[length];
+        frame.getFrameRawData(copy);
+        if (memcmp(copy, buffer, length) != 0) {
+            Log().Get(ERROR) << "Copy of a frame of " << length << " bytes differs!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        Frame empty;
+        if (!empty.empty()) {
+            return false;
+        }
+
+        /* inline storage, the largest inline frame and heap storage */
+        if (!this->checkFrame(4) || !this->checkFrame(Frame::INLINE_CAPACITY) || !this->checkFrame(4103)) {
+            return false;
+        }
+
+        /* a reused frame switches between both storages */
+        Frame frame;
+        byte* data = frame.prepare(4103);
+        memset(data, 0xAB, 4103);
+        data = frame.prepare(3);
+        data[0] = 0x88;
+        data[1] = 0x01;
+        data[2] = 0x89;
+        if ((frame.size() != 3) || (frame.getId() != 0x01) || (frame.data()[2] != 0x89)) {
+            Log().Get(ERROR) << "Reused frame holds wrong data!";
+            return false;
+        }
+
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    FrameTest test;
+    return (uint32_t)test.runTest();
+}
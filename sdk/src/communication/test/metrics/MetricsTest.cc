@@ -0,0 +1,245 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/communication/exchangetrace.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedregisterfile.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/latencyhistogram.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <chrono>
+#include <cstdio> /* remove(1) */
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+static const std::string METRICS_FILE("/tmp/easyfpga-metrics-test.prom");
+
+static const byte READ_REGISTER = 0x77;
+static const byte WRITE_REGISTER = 0x66;
+
+/**
+ * \brief Tests the metrics of the communication
+ *
+ * The test needs no easyFPGA. The bucket boundaries of the latency
+ * histogram have to be continuous. Then register exchanges are executed
+ * on a simulated soc which injects NACKs and corrupt replies. Requests,
+ * retries, replies by their outcome, context switches and the async
+ * queue depths have to be counted exactly, and the Prometheus dump has
+ * to contain them.
+ */
+class MetricsTest : public Tester
+{
+    std::string testName(void) {
+        return "metrics test";
+    }
+
+    bool checkHistogram(void) {
+        for (uint32_t i=0; i<LatencyHistogram::BUCKET_COUNT; i++) {
+            uint64_t lower = LatencyHistogram::getBucketLowerBound(i);
+            uint64_t upper = LatencyHistogram::getBucketUpperBound(i);
+            if ((LatencyHistogram::getBucket(lower) != i) || (LatencyHistogram::getBucket(upper-1) != i) ||
+                ((i+1 < LatencyHistogram::BUCKET_COUNT) && (LatencyHistogram::getBucket(upper) != i+1))) {
+                Log().Get(ERROR) << "The boundaries of bucket " << i << " are wrong!";
+                return false;
+            }
+        }
+
+        LatencyHistogram histogram;
+        for (int64_t value=1; value<=100000; value++) {
+            histogram.record(value);
+        }
+
+        LatencyHistogramSnapshot snapshot = histogram.getSnapshot();
+        uint64_t median = snapshot.getPercentile(50.0);
+        if ((snapshot.count != 100000) || (snapshot.max != 100000) || (snapshot.sum != 5000050000ULL) ||
+            (median < 50000) || (median > 50000 + 50000/8) || (snapshot.getPercentile(100.0) != 100000)) {
+            Log().Get(ERROR) << "Wrong histogram snapshot, median " << median << "!";
+            return false;
+        }
+
+        return true;
+    }
+
+    const ExchangeMetrics* findExchange(const MetricsSnapshot& snapshot, byte opcode) {
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return &exchange;
+            }
+        }
+        return NULL;
+    }
+
+    bool checkExchange(const MetricsSnapshot& snapshot, byte opcode, uint64_t requests, uint64_t retries,
+        uint64_t nacks, uint64_t checksumErrors) {
+        const ExchangeMetrics* exchange = this->findExchange(snapshot, opcode);
+        uint64_t successes = requests - retries;
+
+        if ((exchange == NULL) || (exchange->requests != requests) || (exchange->retries != retries) ||
+            (exchange->successes != successes) || (exchange->nacks != nacks) || (exchange->checksumErrors != checksumErrors) ||
+            (exchange->timeouts != 0) || (exchange->latency.count != successes + nacks)) {
+            Log().Get(ERROR) << "Wrong counters of the exchange " << ExchangeTrace::getExchangeName(opcode) << "!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool contains(std::string text, std::string line) {
+        return text.find(line + "\n") != std::string::npos;
+    }
+
+    bool testMethod(void) {
+        bool success = this->checkHistogram();
+
+        BoardSimulator board;
+        board.addCore(1, std::make_shared<SimulatedRegisterFile>());
+        board.startSoc();
+        if (!board.start()) {
+            return false;
+        }
+
+        Communicator com(nullptr);
+        if (!com.initWithDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated soc!";
+            return false;
+        }
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        Metrics& metrics = Metrics::getInstance();
+        metrics.reset();
+
+        Log().Get(INFO) << "Count 100 register writes and reads...";
+        for (uint32_t i=0; i<100; i++) {
+            byte value = 0x00;
+            success &= com.writeRegister((byte)i, 1, (byte)i) && com.readRegister(&value, 1, (byte)i) && (value == (byte)i);
+        }
+
+        MetricsSnapshot snapshot = metrics.getSnapshot();
+        success &= this->checkExchange(snapshot, WRITE_REGISTER, 100, 0, 0, 0);
+        success &= this->checkExchange(snapshot, READ_REGISTER, 100, 0, 0, 0);
+
+        /* every write and read exchange is 5 bytes on the line in both directions */
+        if ((snapshot.exchanges.size() != 2) || (snapshot.sentBytes < 1000) || (snapshot.receivedBytes < 600)) {
+            Log().Get(ERROR) << "Wrong byte counters!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Count retries after 2 NACKs and 2 corrupt replies...";
+        board.injectErrors(BoardSimulator::NACK, 2);
+        for (uint32_t i=0; i<10; i++) {
+            byte value = 0x00;
+            success &= com.readRegister(&value, 1, (byte)i);
+        }
+        board.injectErrors(BoardSimulator::CORRUPT_PARITY, 2);
+        for (uint32_t i=0; i<10; i++) {
+            byte value = 0x00;
+            success &= com.readRegister(&value, 1, (byte)i);
+        }
+
+        snapshot = metrics.getSnapshot();
+        success &= this->checkExchange(snapshot, READ_REGISTER, 124, 4, 2, 2);
+
+        Log().Get(INFO) << "Count context switches...";
+        uint32_t serial = 0;
+        byte value = 0x00;
+        success &= com.readSerial(&serial) && com.readRegister(&value, 1, 0);
+
+        snapshot = metrics.getSnapshot();
+        if (snapshot.contextSwitches != 2) {
+            Log().Get(ERROR) << snapshot.contextSwitches << " instead of 2 context switches counted!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Watch the async queue depths...";
+        byte values[64];
+        for (uint32_t i=0; i<64; i++) {
+            success &= com.readRegisterAsync(&values[i], 1, (byte)i, 0);
+        }
+
+        /* arrived replies are already handled while the window is full */
+        snapshot = metrics.getSnapshot();
+        if ((snapshot.runningAsyncTasks < 1) || (snapshot.runningAsyncTasks > 16) || (snapshot.pendingAsyncTasks != 0)) {
+            Log().Get(ERROR) << snapshot.runningAsyncTasks << " running async tasks counted, 1 to 16 expected!";
+            success = false;
+        }
+
+        success &= com.handleRequestReplies();
+
+        snapshot = metrics.getSnapshot();
+        if (snapshot.runningAsyncTasks != 0) {
+            Log().Get(ERROR) << "Running async tasks left after handling the replies!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Dump the metrics periodically...";
+        std::remove(METRICS_FILE.c_str());
+        metrics.startDump(METRICS_FILE, 10);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        metrics.stopDump();
+
+        std::ifstream file(METRICS_FILE);
+        std::stringstream content;
+        content << file.rdbuf();
+        std::string text(content.str());
+
+        snapshot = metrics.getSnapshot();
+        const ExchangeMetrics* reads = this->findExchange(snapshot, READ_REGISTER);
+        std::stringstream expectedCount;
+        expectedCount << "easyfpga_reply_latency_seconds_count{exchange=\"read register\"} " << (reads ? reads->latency.count : 0);
+
+        if (!this->contains(text, "easyfpga_requests_total{exchange=\"read register\"} 189") ||
+            !this->contains(text, "easyfpga_retries_total{exchange=\"read register\"} 4") ||
+            !this->contains(text, "easyfpga_replies_total{exchange=\"read register\",status=\"nack\"} 2") ||
+            !this->contains(text, "easyfpga_replies_total{exchange=\"read register\",status=\"checksum_error\"} 2") ||
+            !this->contains(text, "easyfpga_context_switches_total 2") ||
+            !this->contains(text, "easyfpga_async_running_tasks 0") ||
+            !this->contains(text, expectedCount.str())) {
+            Log().Get(ERROR) << "The metrics file lacks expected lines:" << std::endl << text;
+            success = false;
+        }
+
+        if (reads != NULL) {
+            Log().Get(INFO) << "read register latency: p50 " << reads->latency.getPercentile(50.0) / 1000
+                << " us, p99 " << reads->latency.getPercentile(99.0) / 1000 << " us";
+        }
+
+        Log::setMinimumOutputLevel(configuredLevel);
+        std::remove(METRICS_FILE.c_str());
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    MetricsTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,325 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/communication/protocol/calculator.h"
+#include "easyfpga/communication/protocol/exchange.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/mappedfile.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio> /* remove(1) */
+#include <cstring> /* memcmp() */
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h> /* posix_openpt() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <termios.h>
+#include <unistd.h> /* read(), write(), close(), usleep() */
+
+static const std::string BINARY_FILE("pipelined_upload_test.bin");
+
+/* 20 complete sectors and a partial one */
+static const uint32_t BINARY_SIZE = 20*4096 + 1000;
+
+/* the pseudo mcu needs this time for receiving and storing a sector */
+static const uint32_t TRANSFER_TIME_US = 2000;
+static const uint32_t FLASH_TIME_US = 2000;
+
+/**
+ * \brief A pseudo mcu receiving and storing binary sectors
+ *
+ * Like the real mcu it can receive the next sector while the previous
+ * one is written into the flash memory: a receiver thread parses the
+ * requests and hands complete sectors over to a flash thread by a queue
+ * holding one sector at most.
+ */
+class PseudoMcu
+{
+    public:
+        PseudoMcu() :
+            _running(true),
+            _nackSector(-1),
+            _sectorWrites(0)
+        {
+            _master = posix_openpt(O_RDWR | O_NOCTTY);
+            grantpt(_master);
+            unlockpt(_master);
+
+            struct termios tio;
+            tcgetattr(_master, &tio);
+            cfmakeraw(&tio);
+            tcsetattr(_master, TCSANOW, &tio);
+
+            _receiver = std::thread(&PseudoMcu::receive, this);
+            _flasher = std::thread(&PseudoMcu::flash, this);
+        }
+
+        ~PseudoMcu() {
+            _running = false;
+            _condition.notify_all();
+            _receiver.join();
+            _flasher.join();
+            close(_master);
+        }
+
+        std::string getDevice(void) {
+            return std::string(ptsname(_master));
+        }
+
+        /**
+         * Lets the next write of the given sector fail with a NACK.
+         */
+        void injectNack(int32_t sector) {
+            _nackSector = sector;
+        }
+
+        /**
+         * Returns the number of received sector write requests.
+         */
+        uint32_t getSectorWrites(void) {
+            return _sectorWrites;
+        }
+
+        /**
+         * Returns the stored sectors as one binary.
+         */
+        std::vector<byte> getFlash(void) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _flashMemory;
+        }
+
+    private:
+        void receive(void) {
+            std::vector<byte> request;
+
+            while (_running) {
+                struct pollfd pfd;
+                pfd.fd = _master;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+
+                if ((poll(&pfd, 1, 10) <= 0) || !(pfd.revents & POLLIN)) {
+                    continue;
+                }
+
+                byte buffer[4096];
+                ssize_t count = read(_master, buffer, sizeof(buffer));
+                for (ssize_t i=0; i<count; i++) {
+                    request.push_back(buffer[i]);
+
+                    if ((request[0] == (byte)0xEE) && (request.size() == 1)) {
+                        byte reply[3] = { 0xFF, 0x22, 0xFF ^ 0x22 };
+                        this->reply(reply, 3);
+                        request.clear();
+                    }
+                    else if ((request[0] == (byte)0x22) && (request.size() == 4103)) {
+                        /* the line speed limits the throughput */
+                        usleep(TRANSFER_TIME_US);
+
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _condition.wait(lock, [this] { return (_sectors.empty() || !_running); });
+                        _sectors.push(request);
+                        _condition.notify_all();
+                        request.clear();
+                    }
+                    else if ((request[0] != (byte)0x22) && (request[0] != (byte)0xEE)) {
+                        request.clear();
+                    }
+                }
+            }
+        }
+
+        void flash(void) {
+            while (_running) {
+                std::vector<byte> request;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _condition.wait(lock, [this] { return (!_sectors.empty() || !_running); });
+                    if (!_running) {
+                        break;
+                    }
+                    request = _sectors.front();
+                    _sectors.pop();
+                    _condition.notify_all();
+                }
+
+                usleep(FLASH_TIME_US);
+                _sectorWrites++;
+
+                uint32_t sector = request[1] | (request[2] << 8);
+                uint32_t hash = request[4099] | (request[4100] << 8) | (request[4101] << 16) | ((uint32_t)request[4102] << 24);
+
+                byte reply[1] = { Exchange::SHARED_REPLY_CODES::ACK };
+                if (((int32_t)sector == _nackSector) || (hash != Calculator::calculateAdler32Hash(request.data()+1, 4098))) {
+                    _nackSector = -1;
+                    reply[0] = Exchange::SHARED_REPLY_CODES::NACK;
+                }
+                else {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (_flashMemory.size() < (sector+1)*4096) {
+                        _flashMemory.resize((sector+1)*4096);
+                    }
+                    memcpy(_flashMemory.data() + sector*4096, request.data()+3, 4096);
+                }
+
+                this->reply(reply, 1);
+            }
+        }
+
+        void reply(byte* data, ssize_t length) {
+            if (write(_master, data, length) != length) {
+                Log().Get(ERROR) << "Pseudo mcu couldn't write its reply!";
+            }
+        }
+
+        int _master;
+        std::atomic<bool> _running;
+        std::atomic<int32_t> _nackSector;
+        std::atomic<uint32_t> _sectorWrites;
+
+        std::thread _receiver;
+        std::thread _flasher;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::queue<std::vector<byte>> _sectors;
+        std::vector<byte> _flashMemory;
+};
+
+/**
+ * \brief Tests the pipelined binary upload of Communicator
+ *
+ * The test needs no easyFPGA. A binary file is mapped into memory and
+ * uploaded to a pseudo mcu with and without pipelining. The pipelined
+ * upload has to be faster, all uploads have to store exactly the binary
+ * (padded to whole sectors), and a refused sector in the middle of the
+ * pipeline has to be recovered by repeating only this sector.
+ */
+class BinaryUploadPipelineTest : public Tester
+{
+    std::string testName(void) {
+        return "binary upload pipeline test";
+    }
+
+    bool upload(PseudoMcu& mcu, MappedFile& binary, uint32_t depth, uint64_t* durationus) {
+        Communicator com(nullptr);
+        if (!com.initWithDevice(mcu.getDevice())) {
+            return false;
+        }
+
+        com.setBinaryUploadPipelineDepth(depth);
+        if (!com.writeBinary(binary.getData(), binary.getSize())) {
+            return false;
+        }
+
+        Communicator::BinaryUploadStatistics statistics = com.getBinaryUploadStatistics();
+        *durationus = statistics.durationus;
+
+        Log().Get(INFO) << "depth " << depth << ": " << statistics.sectors << " sectors, "
+            << statistics.getMegabytesPerSecond() << " MB/s, sector latency "
+            << statistics.minimumSectorLatencyus << "/" << statistics.averageSectorLatencyus << "/"
+            << statistics.maximumSectorLatencyus << " us (min/avg/max)";
+
+        std::vector<byte> flash(mcu.getFlash());
+        if ((flash.size() != 21*4096) || (memcmp(flash.data(), binary.getData(), binary.getSize()) != 0)) {
+            Log().Get(ERROR) << "The stored binary differs from the uploaded one!";
+            return false;
+        }
+
+        for (uint32_t i=binary.getSize(); i<flash.size(); i++) {
+            if (flash[i] != 0x00) {
+                Log().Get(ERROR) << "The last sector wasn't padded with zeros!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        std::vector<char> content(BINARY_SIZE);
+        for (uint32_t i=0; i<BINARY_SIZE; i++) {
+            content[i] = (char)(i * 7 + (i >> 12));
+        }
+
+        std::ofstream file(BINARY_FILE, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), content.size());
+        file.close();
+
+        MappedFile binary(BINARY_FILE);
+        if (!binary.map() || (binary.getSize() != BINARY_SIZE)) {
+            Log().Get(ERROR) << "The binary couldn't be mapped!";
+            std::remove(BINARY_FILE.c_str());
+            return false;
+        }
+
+        bool success = true;
+        uint64_t sequential = 0;
+        uint64_t pipelined = 0;
+
+        {
+            PseudoMcu mcu;
+            success &= this->upload(mcu, binary, 1, &sequential);
+        }
+        {
+            PseudoMcu mcu;
+            success &= this->upload(mcu, binary, 2, &pipelined);
+        }
+
+        if (success && (pipelined * 10 > sequential * 8)) {
+            Log().Get(ERROR) << "The pipelined upload isn't faster!";
+            success = false;
+        }
+
+        Log().Get(INFO) << "Refuse a sector in the middle of the pipeline...";
+        {
+            uint64_t duration = 0;
+            PseudoMcu mcu;
+            mcu.injectNack(10);
+            success &= this->upload(mcu, binary, 2, &duration);
+
+            if (mcu.getSectorWrites() != 22) {
+                Log().Get(ERROR) << mcu.getSectorWrites() << " sector writes instead of 22!";
+                success = false;
+            }
+        }
+
+        std::remove(BINARY_FILE.c_str());
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    BinaryUploadPipelineTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,168 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/serialconnection.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime> /* clock() */
+#include <string>
+#include <thread>
+
+#include <fcntl.h> /* posix_openpt() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <termios.h>
+#include <unistd.h> /* read(), write(), close() */
+
+/**
+ * \brief Compares receiving with and without the receive thread of
+ *        SerialConnection
+ *
+ * The test needs no easyFPGA. The master side of a pseudo terminal
+ * answers every request byte with a 4 byte reply, like a register read
+ * of the soc. Two scenarios are measured for both receive modes:
+ * - ping-pong: one outstanding request, i.e. the reply latency, and
+ * - streaming: 64 outstanding requests, i.e. the throughput under
+ *   sustained async load.
+ * For each run the replies per second and the consumed cpu time are
+ * logged.
+ */
+class SerialReceiveThreadTest : public Tester
+{
+    std::string testName(void) {
+        return "serial receive thread test";
+    }
+
+    /**
+     * Answers each received byte b with the reply {0x88, b, b, parity}.
+     */
+    static void answerRequests(int master, std::atomic<bool>* running) {
+        byte requests[256];
+        byte replies[4*256];
+
+        while (*running) {
+            struct pollfd pfd;
+            pfd.fd = master;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if ((poll(&pfd, 1, 10) > 0) && (pfd.revents & POLLIN)) {
+                ssize_t count = read(master, requests, sizeof(requests));
+                for (ssize_t i=0; i<count; i++) {
+                    replies[4*i+0] = 0x88;
+                    replies[4*i+1] = requests[i];
+                    replies[4*i+2] = requests[i];
+                    replies[4*i+3] = 0x88;
+                }
+
+                ssize_t written = 0;
+                while (written < 4*count) {
+                    ssize_t n = write(master, replies+written, 4*count-written);
+                    if (n > 0) {
+                        written += n;
+                    }
+                }
+            }
+        }
+    }
+
+    bool measure(std::string device, bool useThread, uint32_t outstanding, uint32_t count) {
+        SerialConnection connection;
+        connection.setReceiveThreadEnabled(useThread);
+        if (!connection.openDevice(device)) {
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        clock_t cpuStart = clock();
+
+        byte request = 0;
+        uint32_t sent = 0;
+        for (uint32_t received=0; received<count; received++) {
+            while ((sent < count) && (sent - received < outstanding)) {
+                request = (byte)sent++;
+                if (!connection.send(&request, 1)) {
+                    return false;
+                }
+            }
+
+            /* receive like Task: at first the opcode, then the remainder */
+            byte reply[4];
+            if (!connection.receive(reply, 1, 1000000) || !connection.receive(reply+1, 3, 1000000)) {
+                return false;
+            }
+            if ((reply[0] != 0x88) || (reply[1] != (byte)received)) {
+                Log().Get(ERROR) << "Unexpected reply " << received << "!";
+                return false;
+            }
+        }
+
+        double cpuMs = 1000.0 * (clock() - cpuStart) / CLOCKS_PER_SEC;
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        Log().Get(INFO) << (useThread ? "receive thread" : "direct        ") << ", " << outstanding << " outstanding: "
+            << (uint64_t)count * 1000000 / (duration.count() + 1) << " replies/s, "
+            << cpuMs << " ms cpu time for " << count << " replies";
+
+        return connection.closeDevice();
+    }
+
+    bool testMethod(void) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+            Log().Get(ERROR) << "Couldn't create a pseudo terminal!";
+            return false;
+        }
+
+        struct termios tio;
+        tcgetattr(master, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(master, TCSANOW, &tio);
+
+        std::string device(ptsname(master));
+        std::atomic<bool> running(true);
+        std::thread board(answerRequests, master, &running);
+
+        bool success = true;
+        const uint32_t outstandings[] = { 1, 64 };
+        for (uint32_t outstanding : outstandings) {
+            success &= this->measure(device, false, outstanding, 20000);
+            success &= this->measure(device, true, outstanding, 20000);
+        }
+
+        running = false;
+        board.join();
+        close(master);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    SerialReceiveThreadTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,143 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/protocol/calculator.h"
+#include "easyfpga/communication/protocol/mcuexchanges/status_read.h"
+#include "easyfpga/communication/protocol/socexchanges/read_register_auto_address_increment.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <chrono>
+#include <cstring> /* memcpy() */
+#include <string>
+#include <vector>
+
+/* size of the data XORed by the benchmark */
+static const uint32_t BENCHMARK_SIZE = 16*1024*1024;
+
+/**
+ * \brief Tests the XOR parity calculation and the reply parity check
+ *
+ * The word-wide parity has to match a byte-wise calculation for
+ * unaligned data of any length. A reply has to be checked correctly
+ * with and without the parity folded while receiving it.
+ */
+class XorParityTest : public Tester
+{
+    std::string testName(void) {
+        return "xor parity test";
+    }
+
+    static byte referenceParity(const byte* data, uint32_t length) {
+        byte parity = 0x00;
+        for (uint32_t i=0; i<length; i++) {
+            parity ^= data[i];
+        }
+        return parity;
+    }
+
+    /*
+     * Fills a reply into the exchange and checks it, once with the
+     * parity known from receiving and once without.
+     */
+    static bool checkReply(Exchange& exchange, const std::vector<byte>& content, bool expected) {
+        for (uint32_t folded=0; folded<2; folded++) {
+            byte* reply = exchange.prepareReply(content.size());
+            memcpy(reply, content.data(), content.size());
+            if (folded == 1) {
+                exchange.setReplyParity(Calculator::calculateXorParity(content.data(), content.size()));
+            }
+
+            if (exchange.successChecksumIsCorrect(reply) != expected) {
+                Log().Get(ERROR) << "Reply check failed (" << (folded ? "folded" : "calculated") << " parity)!";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool testMethod(void) {
+        std::vector<byte> data(BENCHMARK_SIZE);
+        uint32_t state = 0x87654321;
+        for (uint32_t i=0; i<data.size(); i++) {
+            state = state * 1103515245 + 12345;
+            data[i] = (byte)(state >> 16);
+        }
+
+        for (uint32_t offset=0; offset<16; offset++) {
+            for (uint32_t length=0; length<300; length++) {
+                if (Calculator::calculateXorParity(data.data()+offset, length) != referenceParity(data.data()+offset, length)) {
+                    Log().Get(ERROR) << "Wrong parity of " << length << " bytes at offset " << offset << "!";
+                    return false;
+                }
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        byte reference = referenceParity(data.data(), data.size());
+        double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        byte parity = Calculator::calculateXorParity(data.data(), data.size());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Log().Get(INFO) << "byte-wise: " << data.size() / referenceSeconds / 1000000.0 << " MB/s, word-wide: "
+            << data.size() / seconds / 1000000.0 << " MB/s";
+
+        if (parity != reference) {
+            Log().Get(ERROR) << "Wrong parity of the benchmark data!";
+            return false;
+        }
+
+        /* opcode, 255 data bytes and the parity of all preceding bytes */
+        byte target[255];
+        ReadAutoAddressIncrementRegister registers(255, target, 1, 2, nullptr);
+        std::vector<byte> reply(data.begin(), data.begin()+258);
+        reply[0] = 0x90;
+        reply[257] = Calculator::calculateXorParity(reply.data(), 257);
+
+        bool success = checkReply(registers, reply, true);
+        reply[100] ^= 0x04;
+        success &= checkReply(registers, reply, false);
+
+        /* the status parity doesn't cover the opcode */
+        bool isFpgaConfigured;
+        uint32_t hash;
+        StatusRead status(&isFpgaConfigured, &hash, nullptr);
+        std::vector<byte> statusReply(data.begin(), data.begin()+13);
+        statusReply[0] = 0xC9;
+        statusReply[12] = Calculator::calculateXorParity(statusReply.data()+1, 11);
+
+        success &= checkReply(status, statusReply, true);
+        statusReply[5] ^= 0x80;
+        success &= checkReply(status, statusReply, false);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    XorParityTest test;
+    return (uint32_t)test.runTest();
+}
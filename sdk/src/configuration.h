@@ -55,6 +55,21 @@
 #define GLOBAL_CONFIGFILE_ABSOLUTE_PATH "~/.config/easyfpga-cpp.conf"
 #endif
 
+/*
+ * LOGGING
+ *
+ * Log messages written with EASYFPGA_LOG() below the following level
+ * aren't compiled into the framework at all. E.g. define it as INFO for
+ * a release build to remove the debug messages from the communication
+ * paths. The Makefile passes its LOG_LEVEL (INFO by default) when
+ * building the library. Which of the remaining messages are output is
+ * configured in project.conf.
+ */
+
+#ifndef LOG_COMPILED_MIN_LEVEL
+#define LOG_COMPILED_MIN_LEVEL DEBUG
+#endif
+
 /*
  * COMMUNICATION / SERIAL CONNECTION SETTINGS
  *
@@ -63,14 +78,94 @@
  * - #undef USE_IDS_FOR_ASYNC_OPS to disable id usage
  */
 
-#undef USE_IDS_FOR_ASYNC_OPS
+#define USE_IDS_FOR_ASYNC_OPS
 
 /*
- * Hardware specifications
+ * Asynchronous requests are collected in a send buffer and written with
+ * a single system call. The buffer will be written at the latest if it
+ * holds more than the following number of bytes.
  */
 
 #include <cstdint> /* special ints */
 
+static const uint32_t SEND_BUFFER_FLUSH_THRESHOLD = 4096;
+
+/*
+ * If the option SERIAL_RECEIVE_THREAD is set in project.conf, a thread
+ * reads all incoming bytes into a ring buffer of the following size.
+ */
+
+static const uint32_t SERIAL_RECEIVE_RING_SIZE = 65536;
+
+/*
+ * While uploading a binary, the next sectors are already sent before the
+ * mcu acknowledged the previous one. The mcu stores one sector while
+ * receiving the next one, thus more sectors in flight won't speed up the
+ * upload but only fill the usb buffers. 1 disables the pipelining.
+ */
+
+static const uint32_t BINARY_UPLOAD_PIPELINE_DEPTH = 2;
+
+/*
+ * If the option LOG_ASYNC is set in project.conf, log messages are
+ * queued for a background thread. The queue holds the following number
+ * of messages, each truncated to LOG_RECORD_TEXT_SIZE-1 characters.
+ */
+
+static const uint32_t LOG_ASYNC_QUEUE_SIZE = 4096;
+static const uint32_t LOG_RECORD_TEXT_SIZE = 232;
+
+/*
+ * Number of records of the exchange trace file (option
+ * EXCHANGE_TRACE_FILE in project.conf). Every record needs 64 bytes. If
+ * the ring is full, the oldest records are overwritten.
+ */
+
+static const uint64_t EXCHANGE_TRACE_RECORDS = 65536;
+
+/*
+ * Uart::transmit() and Uart::receive() poll the line status register
+ * until the transmitter FIFO is empty. They give up if it doesn't drain
+ * within this time in us (64 bytes need 2.2 s at 300 baud).
+ */
+
+static const uint32_t UART_FIFO_TIMEOUT = 5000000; // = 5 s
+
+/*
+ * Default size of the host buffer in bytes into which a receive stream
+ * of an Uart is drained (see Uart::startReceiveStream()).
+ */
+
+static const uint32_t UART_STREAM_BUFFER_SIZE = 65536;
+
+/*
+ * Can::transmit() polls the status register until the transmit buffer
+ * is released. It gives up after this time in us.
+ */
+
+static const uint32_t CAN_TRANSMIT_TIMEOUT = 1000000; // = 1 s
+
+/*
+ * Default number of messages the receive queue of a Can holds (see
+ * Can::startReceiveQueue()).
+ */
+
+static const uint32_t CAN_RECEIVE_QUEUE_SIZE = 256;
+
+/*
+ * Spi::transfer() sends the exchanges of all FIFO chunks without waiting
+ * for their replies, relying on the soc to read a chunk not before it is
+ * shifted out. If shifting out a chunk with the configured SPI clock
+ * takes longer than this time in us (a read request takes 20 us at
+ * 3 Mbaud), the read of every chunk is delayed by the shift time.
+ */
+
+static const uint32_t SPI_PIPELINED_CHUNK_DURATION = 20;
+
+/*
+ * Hardware specifications
+ */
+
 static const uint8_t BANK_COUNT = 3;
 static const uint8_t PIN_COUNT = 24;
 
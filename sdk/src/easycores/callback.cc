@@ -22,7 +22,8 @@
 #include "easycores/callback.h"
 
 Callback::Callback(uint32_t bufferSize) :
-    _bufferSize(bufferSize)
+    _bufferSize(bufferSize),
+    _failed(false)
 {
     _byteRead = new byte[bufferSize];
 
@@ -37,6 +38,16 @@ Callback::~Callback()
     _byteRead = NULL;
 }
 
+void Callback::fail(void)
+{
+    _failed = true;
+}
+
+bool Callback::hasFailed(void)
+{
+    return _failed;
+}
+
 uint32_t Callback::getBufferSize(void)
 {
     return _bufferSize;
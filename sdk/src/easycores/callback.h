@@ -39,6 +39,20 @@ class Callback
          */
         virtual bool call(void) = 0;
 
+        /**
+         * \brief Executed instead of call() if the exchange failed
+         *        permanently, i.e. all of its retries failed.
+         *
+         * The default implementation only remembers the failure for
+         * hasFailed().
+         */
+        virtual void fail(void);
+
+        /**
+         * \brief Returns true if fail() was executed.
+         */
+        bool hasFailed(void);
+
         /**
          * \brief Returns the size of the byte buffer in bytes.
          */
@@ -59,6 +73,11 @@ class Callback
          * \brief Stores the size of the the byte buffer associated to this callback.
          */
         uint32_t _bufferSize;
+
+        /**
+         * \brief Stores whether fail() was executed.
+         */
+        bool _failed;
 };
 
 #endif  // SDK_EASYCORES_CALLBACKS_CALLBACK_H_
@@ -0,0 +1,64 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "configuration.h" /* assert() */
+#include "easycores/callbacks/register_burst.h"
+
+RegisterBurstCallback::RegisterBurstCallback(std::shared_ptr<RegisterBurstState> state, callback_ptr callback) :
+    Callback(0),
+    _state(state),
+    _callback(callback)
+{
+}
+
+RegisterBurstCallback::~RegisterBurstCallback()
+{
+}
+
+bool RegisterBurstCallback::call(void)
+{
+    return RegisterBurstCallback::complete(_state, 1, _callback);
+}
+
+void RegisterBurstCallback::fail(void)
+{
+    Callback::fail();
+    _state->failed = true;
+    RegisterBurstCallback::complete(_state, 1, _callback);
+}
+
+bool RegisterBurstCallback::complete(std::shared_ptr<RegisterBurstState> state, uint32_t chunks, callback_ptr callback)
+{
+    assert(state->outstandingChunks >= chunks);
+
+    /* the callbacks are executed by the thread handling the replies */
+    state->outstandingChunks -= chunks;
+
+    if ((state->outstandingChunks == 0) && (callback != nullptr)) {
+        if (state->failed) {
+            callback->fail();
+        }
+        return callback->call();
+    }
+
+    return true;
+}
@@ -0,0 +1,70 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_EASYCORES_CALLBACKS_REGISTERBURST_H_
+#define SDK_EASYCORES_CALLBACKS_REGISTERBURST_H_
+
+#include "easycores/callback.h"
+#include "easycores/callback_ptr.h"
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * \brief State of a register burst shared by its exchanges
+ */
+struct RegisterBurstState {
+    uint32_t outstandingChunks;
+    bool failed;
+};
+
+/**
+ * \brief Completes a register burst which is split into several
+ *        exchanges
+ *
+ * Every exchange of the burst gets an own instance sharing the number
+ * state of the burst. The user's callback is executed when the last
+ * of them has been answered or has failed permanently, regardless of
+ * the order of the replies (e.g. if a chunk had to be retried). If any
+ * exchange failed, the user's callback is failed before it is called.
+ */
+class RegisterBurstCallback : public Callback
+{
+    public:
+        RegisterBurstCallback(std::shared_ptr<RegisterBurstState> state, callback_ptr callback);
+        ~RegisterBurstCallback();
+
+        bool call(void);
+        void fail(void);
+
+        /**
+         * \brief Completes an exchange of the burst and executes the
+         *        user's callback after the last one.
+         */
+        static bool complete(std::shared_ptr<RegisterBurstState> state, uint32_t chunks, callback_ptr callback);
+
+    private:
+        std::shared_ptr<RegisterBurstState> _state;
+        callback_ptr _callback;
+};
+
+#endif  // SDK_EASYCORES_CALLBACKS_REGISTERBURST_H_
@@ -0,0 +1,134 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/can/can.h"
+#include "easyfpga/easycores/can/can_ptr.h"
+#include "easyfpga/easycores/can/utils/canframe_extended.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedcan.h"
+#include "easyfpga/utils/benchmark/benchmark.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const uint32_t BATCH_SIZE = 16;
+
+/* extended frames with 8 data bytes take 13 bytes of the 64 byte receive fifo */
+static const uint32_t RECEIVE_BATCH_SIZE = 4;
+
+class CanFpga : public EasyFpga
+{
+    public:
+        CanFpga() :
+            can(std::make_shared<Can>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(can);
+        }
+
+        can_ptr can;
+};
+
+/**
+ * \brief Measures the frames per second of the Can core
+ *
+ * Extended frames with 8 data bytes are transmitted one by one and as
+ * batches, and received as batches. The board is simulated without
+ * latency and the simulated can core transmits immediately.
+ */
+class CanFrameBenchmark : public Benchmark
+{
+    std::string benchmarkName(void) {
+        return "can frame benchmark";
+    }
+
+    bool benchmarkMethod(void) {
+        auto model = std::make_shared<SimulatedCan>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        CanFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            EASYFPGA_LOG(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        can_ptr can = fpga.can;
+        if (!can->init(Can::BITRATE::BITRATE_1M, Can::USAGE_MODE::EXTENDEND_MODE) || !can->setAcceptanceMask(0x1FFFFFFF)) {
+            EASYFPGA_LOG(ERROR) << "Couldn't initialize the can core!";
+            return false;
+        }
+
+        byte payload[8] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+        std::vector<canframe_ptr> frames;
+        for (uint32_t i=0; i<BATCH_SIZE; i++) {
+            frames.push_back(std::make_shared<CanFrameExtended>(0x1000 + i, payload, 8));
+        }
+
+        SimulatedCanFrame simulated;
+        memset(&simulated, 0x00, sizeof(simulated));
+        simulated.identifier = 0x1000;
+        simulated.extended = true;
+        simulated.length = 8;
+        memcpy(simulated.data, payload, 8);
+
+        bool success = true;
+
+        success &= this->measure("transmit_single", 1, 13, [can, model, &frames] {
+            bool success = can->transmit(frames[0]);
+            model->takeTransmittedFrames();
+            return success;
+        });
+        success &= this->measure("transmit_batch", BATCH_SIZE, BATCH_SIZE * 13, [can, model, &frames] {
+            bool success = can->transmit(frames);
+            model->takeTransmittedFrames();
+            return success;
+        });
+
+        success &= this->measure("receive_batch", RECEIVE_BATCH_SIZE, RECEIVE_BATCH_SIZE * 13, [can, model, &simulated] {
+            for (uint32_t i=0; i<RECEIVE_BATCH_SIZE; i++) {
+                model->injectFrame(simulated);
+            }
+
+            std::vector<canframe_ptr> received;
+            return can->getReceivedFrames(received, RECEIVE_BATCH_SIZE) && (received.size() == RECEIVE_BATCH_SIZE);
+        });
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    CanFrameBenchmark benchmark;
+    return benchmark.runBenchmark(argc, argv);
+}
@@ -19,7 +19,8 @@
  *
  */
 
-#include "configuration.h" /* assert(1) */
+#include "communication/communicator.h"
+#include "configuration.h" /* assert(1), CAN_TRANSMIT_TIMEOUT */
 #include "easycores/can/can.h"
 #include "easycores/can/utils/canframe.h"
 #include "easycores/can/utils/canframe_extended.h"
@@ -27,13 +28,23 @@
 #include "easycores/pin.h"
 #include "easycores/register.h"
 #include "utils/log/log.h"
+#include "utils/os/time_helper.h"
+#include "utils/spscringbuffer.h"
 
 #include <sstream>
 #include <cstring>
 
 Can::Can() :
     EasyCore(UNIQUE_CORE_NUMBER),
-    _mode(Can::USAGE_MODE::UNDEFINED)
+    _mode(Can::USAGE_MODE::UNDEFINED),
+    _status((byte)0x00),
+    _statusKnown(false),
+    _queueing(false),
+    _receiveQueue(NULL),
+    _droppedMessages(0),
+    _filtering(false),
+    _hardwareAcceptedFrames(0),
+    _hostDroppedFrames(0)
 {
     _pinMap.insert(std::make_pair(PIN::RX, std::make_shared<Pin>("can_rx_in", &_index, PIN::RX, PIN_DIRECTION_TYPE::IN)));
     _pinMap.insert(std::make_pair(PIN::TX, std::make_shared<Pin>("can_tx_out", &_index, PIN::TX, PIN_DIRECTION_TYPE::OUT)));
@@ -119,6 +130,8 @@ Can::Can() :
 
 Can::~Can()
 {
+    delete _receiveQueue;
+    _receiveQueue = NULL;
 }
 
 std::string Can::getHdlInjections(void)
@@ -179,7 +192,7 @@ bool Can::init(BITRATE bitrate, USAGE_MODE mode)
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The birate parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The birate parameter is not valid.";
             return false;
     }
 
@@ -198,7 +211,7 @@ bool Can::init(BITRATE bitrate, USAGE_MODE mode)
 
         case USAGE_MODE::EXTENDEND_MODE:
             /* enter the specified CAN mode */
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_CLOCK_DIVIDER)->changeBitSync(7, false);
+            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_CLOCK_DIVIDER)->changeBitSync(7, true);
 
             /* set a possible default timing */
             success &= this->setBusTiming(prescaler, 2, false, 5, 2);
@@ -208,7 +221,7 @@ bool Can::init(BITRATE bitrate, USAGE_MODE mode)
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The usage mode parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The usage mode parameter is not valid.";
             return false;
     }
 
@@ -218,7 +231,7 @@ bool Can::init(BITRATE bitrate, USAGE_MODE mode)
     /* Set internal mode to UNDEFINED if initialization was not successful. */
     if (!success) {
         _mode = Can::USAGE_MODE::UNDEFINED;
-        Log().Get(WARNING) << "Init method failed! The usage mode will not set...";
+        EASYFPGA_LOG(WARNING) << "Init method failed! The usage mode will not set...";
     }
 
     return success;
@@ -247,7 +260,7 @@ bool Can::enableInterrupts(void)
             return this->getRegister(REGISTER_EXTENDEND_MODE::EM_INTERRUPT_ENABLE)->writeSync((byte)0xFF);
 
         default:
-            Log().Get(WARNING) << "You have to init this core first before you can enable the interrupts!";
+            EASYFPGA_LOG(WARNING) << "You have to init this core first before you can enable the interrupts!";
             return false;
     }
 }
@@ -290,14 +303,14 @@ bool Can::enableInterrupt(INTERRUPT interrupt)
             break;
 
         default:
-            Log().Get(WARNING) << "Unknown CAN interrupt constant!";
+            EASYFPGA_LOG(WARNING) << "Unknown CAN interrupt constant!";
             return false;
     }
 
     switch (_mode) {
         case USAGE_MODE::BASIC_MODE:
             if (4 < bitPosition) {
-                Log().Get(WARNING) << "This interrupt can be only used in the extendend mode! No interrupt will be enabled.";
+                EASYFPGA_LOG(WARNING) << "This interrupt can be only used in the extendend mode! No interrupt will be enabled.";
                 return false;
             }
             else {
@@ -309,7 +322,7 @@ bool Can::enableInterrupt(INTERRUPT interrupt)
             return this->getRegister(REGISTER_EXTENDEND_MODE::EM_INTERRUPT_ENABLE)->changeBitSync(bitPosition, true);
 
         default:
-            Log().Get(WARNING) << "You have to init this core first before you can enable the interrupts!";
+            EASYFPGA_LOG(WARNING) << "You have to init this core first before you can enable the interrupts!";
             return false;
     }
 }
@@ -332,7 +345,7 @@ bool Can::disableInterrupts(void)
             return this->getRegister(REGISTER_EXTENDEND_MODE::EM_INTERRUPT_ENABLE)->writeSync((byte)0x00);
 
         default:
-            Log().Get(WARNING) << "You have to init this core first before you can enable the interrupts!";
+            EASYFPGA_LOG(WARNING) << "You have to init this core first before you can enable the interrupts!";
             return false;
     }
 }
@@ -375,14 +388,14 @@ bool Can::disableInterrupt(INTERRUPT interrupt)
             break;
 
         default:
-            Log().Get(WARNING) << "Unknown CAN interrupt constant!";
+            EASYFPGA_LOG(WARNING) << "Unknown CAN interrupt constant!";
             return false;
     }
 
     switch (_mode) {
         case USAGE_MODE::BASIC_MODE:
             if (4 < bitPosition) {
-                Log().Get(WARNING) << "This interrupt can be only used in the extendend mode! No interrupt will be disabled.";
+                EASYFPGA_LOG(WARNING) << "This interrupt can be only used in the extendend mode! No interrupt will be disabled.";
                 return false;
             }
             else {
@@ -394,7 +407,7 @@ bool Can::disableInterrupt(INTERRUPT interrupt)
             return this->getRegister(REGISTER_EXTENDEND_MODE::EM_INTERRUPT_ENABLE)->changeBitSync(bitPosition, false);
 
         default:
-            Log().Get(WARNING) << "You have to init this core first before you can enable the interrupts!";
+            EASYFPGA_LOG(WARNING) << "You have to init this core first before you can enable the interrupts!";
             return false;
     }
 }
@@ -414,7 +427,7 @@ bool Can::identifyInterrupt(INTERRUPT* target)
             break;
 
         default:
-            Log().Get(WARNING) << "You have to call init() first before you can try to identify any interrupt!";
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you can try to identify any interrupt!";
             return false;
     }
 
@@ -444,7 +457,7 @@ bool Can::identifyInterrupt(INTERRUPT* target)
             *(target) = Can::INTERRUPT::BUS_ERROR;
         }
         else {
-            Log().Get(WARNING) << "No interrupt could be identified!";
+            EASYFPGA_LOG(WARNING) << "No interrupt could be identified!";
             return false;
         }
 
@@ -458,200 +471,195 @@ bool Can::transmit(canframe_ptr frame)
 {
     assert(frame->getDataLength() <= 8);
 
-    bool success = true;
-
-    uint8_t descriptorLength = frame->getDescriptorLength();
-    //uint8_t dataLength = frame->getDataLength();
-
     byte data[13];
-    for (uint8_t i=0; i<13; i++) {
-        data[i] = (byte)0x00;
+    uint8_t length = this->encodeFrame(frame, data);
+    if (length == 0) {
+        return false;
     }
 
-    byte status = (byte)0x00;
-
-    switch (_mode) {
-        case USAGE_MODE::BASIC_MODE:
-            assert(frame->getMessageType() != CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME);
-
-            /* wait as long as the transmit buffer locked */
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_STATUS)->readSync(&status);
-            while (success && !setBitTest(status, 2)) {
-                success &= this->getRegister(REGISTER_BASIC_MODE::BM_STATUS)->readSync(&status);
-                Log().Get(INFO) << "Transmit buffer : " << std::boolalpha << setBitTest(status, 2);
-                usleep(10);
-            }
+    return this->transmitBuffer(data, length);
+}
 
-            frame->getDescriptor(data);
-            frame->getData(data+descriptorLength);
+bool Can::transmit(const std::vector<canframe_ptr>& frames)
+{
+    for (auto& frame : frames) {
+        if (!this->transmit(frame)) {
+            return false;
+        }
+    }
 
-            //success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_IDENTIFIER_1)->writeAutoAddressIncrementSync(data, descriptorLength+dataLength);
+    return true;
+}
 
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_IDENTIFIER_1)->writeSync(data[0]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_IDENTIFIER_2)->writeSync(data[1]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_1)->writeSync(data[2]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_2)->writeSync(data[3]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_3)->writeSync(data[4]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_4)->writeSync(data[5]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_5)->writeSync(data[6]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_6)->writeSync(data[7]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_7)->writeSync(data[8]);
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_TX_DATA_8)->writeSync(data[9]);
+bool Can::transmit(const CanMessage& message)
+{
+    byte data[13];
+    uint8_t length = this->encodeMessage(message, data);
+    if (length == 0) {
+        return false;
+    }
 
-            // request transmission
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_COMMAND)->writeSync((byte)0x01);
-            break;
+    return this->transmitBuffer(data, length);
+}
 
-        case USAGE_MODE::EXTENDEND_MODE:
-            /* wait as long as the transmit buffer locked */
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_STATUS)->readSync(&status);
-            while (success && !setBitTest(status, 2)) {
-                success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_STATUS)->readSync(&status);
-                Log().Get(INFO) << "Transmit buffer : " << std::boolalpha << setBitTest(status, 2);
-                usleep(10);
-            }
+bool Can::transmit(const std::vector<CanMessage>& messages)
+{
+    for (auto& message : messages) {
+        if (!this->transmit(message)) {
+            return false;
+        }
+    }
 
-            frame->getFrameInfomationField(data);
-            frame->getDescriptor(data+1);
-            frame->getData(data+1+descriptorLength);
+    return true;
+}
 
-            //success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION)->writeAutoAddressIncrementSync(data, descriptorLength+dataLength+1);
+bool Can::getReceivedFrame(canframe_ptr& frame)
+{
+    frame = nullptr;
 
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION)->writeSync(data[0]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+1)->writeSync(data[1]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+2)->writeSync(data[2]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+3)->writeSync(data[3]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+4)->writeSync(data[4]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+5)->writeSync(data[5]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+6)->writeSync(data[6]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+7)->writeSync(data[7]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+8)->writeSync(data[8]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+9)->writeSync(data[9]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+10)->writeSync(data[10]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+11)->writeSync(data[11]);
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION+12)->writeSync(data[12]);
+    CanMessage message;
+    if (!this->receiveMessage(message)) {
+        return false;
+    }
 
+    frame = this->createFrame(message);
+    return true;
+}
 
-            // request transmission
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_COMMAND)->writeSync((byte)0x01);
-            break;
+bool Can::getReceivedFrames(std::vector<canframe_ptr>& frames, uint32_t maxCount)
+{
+    uint32_t received = 0;
+    canframe_ptr frame;
 
-        default:
-            return false;
+    while ((received < maxCount) && this->getReceivedFrame(frame)) {
+        frames.push_back(frame);
+        received++;
     }
 
+    return (received > 0);
+}
 
-    return success;
+bool Can::getReceivedFrame(CanMessage& message)
+{
+    return this->receiveMessage(message);
 }
 
-bool Can::getReceivedFrame(canframe_ptr& frame)
+bool Can::getReceivedFrames(std::vector<CanMessage>& messages, uint32_t maxCount)
 {
-    bool success = true;
+    uint32_t received = 0;
+    CanMessage message;
 
-    byte data[15];
-    for (uint8_t i=0; i<15; i++) {
-        data[i] = (byte)0x00;
+    while ((received < maxCount) && this->receiveMessage(message)) {
+        messages.push_back(message);
+        received++;
     }
 
-    byte status = 0x00;
+    return (received > 0);
+}
 
-    byte frameInformation;
-    byte identifier1;
-    byte identifier2;
-    byte identifier3;
-    byte identifier4;
-    uint32_t identifier;
-    uint8_t dataLength;
+bool Can::setFilterSet(const CanFilterSet& filters)
+{
+    uint32_t code;
+    uint32_t mask;
 
-    switch (_mode) {
-        case USAGE_MODE::BASIC_MODE:
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_STATUS)->readSync(&status);
+    if (!filters.getAcceptanceFilter(_mode == USAGE_MODE::EXTENDEND_MODE, &code, &mask)) {
+        EASYFPGA_LOG(WARNING) << "The filter set contains no identifier which can be received in the current mode!";
+        return false;
+    }
 
-            if (!setBitTest(status, 0)) {
-                frame = nullptr;
-                return false;
-            }
+    _filterSet = filters;
+    _filtering = true;
+    _hardwareAcceptedFrames = 0;
+    _hostDroppedFrames = 0;
 
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_RX_IDENTIFIER_1)->readAutoAddressIncrementSync(data, 10);
+    return this->setAcceptanceCode(code) && this->setAcceptanceMask(mask);
+}
 
-            identifier1 = data[0];
-            identifier2 = data[1];
-            identifier = (identifier1 << 3) | ((identifier2 & 0xE0) >> 5);
+bool Can::clearFilterSet(void)
+{
+    _filterSet.clear();
+    _filtering = false;
+    _hardwareAcceptedFrames = 0;
+    _hostDroppedFrames = 0;
 
-            /* determine if RTR or data transmission */
-            if (setBitTest(identifier2, 4)) {
-                frame = std::make_shared<CanFrameStandard>(identifier);
-            }
-            else {
-                /* determine data length */
-                dataLength = identifier2 & 0x0F;
-                assert(dataLength <= 8);
+    return this->setAcceptanceMask((_mode == USAGE_MODE::EXTENDEND_MODE) ? 0x1FFFFFFF : 0xFF);
+}
 
-                frame = std::make_shared<CanFrameStandard>(identifier, data+3, dataLength);
-            }
+uint64_t Can::getNumberOfHardwareAcceptedFrames(void)
+{
+    return _hardwareAcceptedFrames;
+}
 
-            // release receive buffer
-            success &= this->getRegister(REGISTER_BASIC_MODE::BM_COMMAND)->writeSync((byte)0x04);
-            break;
+uint64_t Can::getNumberOfHostDroppedFrames(void)
+{
+    return _hostDroppedFrames;
+}
+
+bool Can::startReceiveQueue(uint32_t capacity)
+{
+    /* PARAMETER CHECK */
+    if (capacity == 0) {
+        EASYFPGA_LOG(WARNING) << "The receive queue can't be empty.";
+        return false;
+    }
 
+    switch (_mode) {
+        case USAGE_MODE::BASIC_MODE:
         case USAGE_MODE::EXTENDEND_MODE:
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_STATUS)->readSync(&status);
+            break;
 
-            if (!setBitTest(status, 0)) {
-                frame = nullptr;
-                return false;
-            }
+        default:
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you can start the receive queue!";
+            return false;
+    }
 
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION)->readAutoAddressIncrementSync(data, 14);
+    delete _receiveQueue;
+    _receiveQueue = new SpscRingBuffer<CanMessage>(capacity);
+    _droppedMessages = 0;
+    _queueing = true;
 
-            frameInformation = data[0];
-            dataLength = frameInformation & 0x0F;
-            assert(dataLength <= 8);
+    return this->enableInterrupt(INTERRUPT::RECEIVE) &&
+           _communicator->enableGlobalInterrupts();
+}
 
-            /* Test if an standard or extended frame is avialable */
-            if (!setBitTest(frameInformation, 7)) {
-                identifier1 = data[1];
-                identifier2 = data[2];
+bool Can::stopReceiveQueue(void)
+{
+    _queueing = false;
+    return this->disableInterrupt(INTERRUPT::RECEIVE);
+}
 
-                identifier = (identifier1 << 3) | ((identifier2 & 0xE0) >> 5);
+uint32_t Can::getNumberOfQueuedMessages(void)
+{
+    return (_receiveQueue != NULL) ? _receiveQueue->getSize() : 0;
+}
 
-                /* determine if RTR or data transmission */
-                if (setBitTest(identifier2, 4)) {
-                    frame = std::make_shared<CanFrameExtended>(identifier);
-                }
-                else {
-                    frame = std::make_shared<CanFrameExtended>(identifier, data+3, dataLength);
-                }
-            }
-            else {
-                identifier1 = data[1];
-                identifier2 = data[2];
-                identifier3 = data[3];
-                identifier4 = data[4];
-
-                identifier = (identifier1 << 21) | (identifier2 << 13) |
-                             (identifier3 << 5)  | ((identifier4 & 0xF8) >> 3);
-
-                /* determine if RTR or data transmission */
-                if (setBitTest(frameInformation, 6)) {
-                    frame = std::make_shared<CanFrameExtended>(identifier);
-                }
-                /* if data transmission */
-                else {
-                    frame = std::make_shared<CanFrameExtended>(identifier, data+6, dataLength);
-                }
-            }
+bool Can::popReceivedMessage(CanMessage& message)
+{
+    return (this->popReceivedMessages(&message, 1) == 1);
+}
 
-            // release receive buffer
-            success &= this->getRegister(REGISTER_EXTENDEND_MODE::EM_COMMAND)->writeSync((byte)0x04);
-            break;
+uint32_t Can::popReceivedMessages(CanMessage* messages, uint32_t maxCount)
+{
+    return (_receiveQueue != NULL) ? _receiveQueue->pop(messages, maxCount) : 0;
+}
 
-        default:
-            Log().Get(WARNING) << "You have to call init() first before you can try to receive any can message!";
-            return false;
+uint64_t Can::getNumberOfDroppedMessages(void)
+{
+    return _droppedMessages;
+}
+
+bool Can::executeCallback(void)
+{
+    if (!_queueing) {
+        return EasyCore::executeCallback();
     }
 
-    return success;
+    if (!this->drainReceiveBuffer()) {
+        EASYFPGA_LOG(WARNING) << "Couldn't drain the receive buffer into the receive queue.";
+    }
+
+    EasyCore::executeCallback();
+    return true;
 }
 
 bool Can::goToSleep(void)
@@ -688,20 +696,20 @@ bool Can::setAcceptanceCode(uint32_t code)
     switch (_mode) {
         case USAGE_MODE::BASIC_MODE:
             if (code > (uint32_t)0xFF) {
-                Log().Get(WARNING) << "Illegal acceptance code used: " << code << " (In basic mode are only values between 0 and 255 possible.)";
+                EASYFPGA_LOG(WARNING) << "Illegal acceptance code used: " << code << " (In basic mode are only values between 0 and 255 possible.)";
                 return false;
             }
             break;
 
         case USAGE_MODE::EXTENDEND_MODE:
             if (code > (uint32_t)0x1FFFFFFF) {
-                Log().Get(WARNING) << "Illegal acceptance code used: " << code << " (In extendend mode are only values between 0 and 536870911 possible.)";
+                EASYFPGA_LOG(WARNING) << "Illegal acceptance code used: " << code << " (In extendend mode are only values between 0 and 536870911 possible.)";
                 return false;
             }
             break;
 
         default:
-            Log().Get(WARNING) << "You have to call init() first before you set an acceptance mask!";
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you set an acceptance mask!";
             return false;
     }
 
@@ -734,20 +742,20 @@ bool Can::setAcceptanceMask(uint32_t mask)
     switch (_mode) {
         case USAGE_MODE::BASIC_MODE:
             if (mask > (uint32_t)0xFF) {
-                Log().Get(WARNING) << "Illegal acceptance code used: " << mask << " (In basic mode are only values between 0 and 255 possible.)";
+                EASYFPGA_LOG(WARNING) << "Illegal acceptance code used: " << mask << " (In basic mode are only values between 0 and 255 possible.)";
                 return false;
             }
             break;
 
         case USAGE_MODE::EXTENDEND_MODE:
             if (mask > (uint32_t)0x1FFFFFFF) {
-                Log().Get(WARNING) << "Illegal acceptance code used: " << mask << " (In extendend mode are only values between 0 and 536870911 possible.)";
+                EASYFPGA_LOG(WARNING) << "Illegal acceptance code used: " << mask << " (In extendend mode are only values between 0 and 536870911 possible.)";
                 return false;
             }
             break;
 
         default:
-            Log().Get(WARNING) << "You have to call init() first before you set an acceptance mask!";
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you set an acceptance mask!";
             return false;
     }
 
@@ -783,21 +791,23 @@ bool Can::logStatus(void)
     }
 
     /* extract and log bits */
-    Log().Get(INFO) << "CAN CORE #" << (uint32_t)this->getIndex() << " STATUS";
-    Log().Get(INFO) << "Bus : " << std::boolalpha << setBitTest(statusRegister, 7);
-    Log().Get(INFO) << "Error : " << std::boolalpha << setBitTest(statusRegister, 6);
-    Log().Get(INFO) << "Transmit : " << std::boolalpha << setBitTest(statusRegister, 5);
-    Log().Get(INFO) << "Receive : " << std::boolalpha << setBitTest(statusRegister, 4);
-    Log().Get(INFO) << "Transmission complete : " << std::boolalpha << setBitTest(statusRegister, 3);
-    Log().Get(INFO) << "Transmit buffer : " << std::boolalpha << setBitTest(statusRegister, 2);
-    Log().Get(INFO) << "Data overrun : " << std::boolalpha << setBitTest(statusRegister, 1);
-    Log().Get(INFO) << "Receive buffer : " << std::boolalpha << setBitTest(statusRegister, 0);
+    EASYFPGA_LOG(INFO) << "CAN CORE #" << (uint32_t)this->getIndex() << " STATUS";
+    EASYFPGA_LOG(INFO) << "Bus : " << std::boolalpha << setBitTest(statusRegister, 7);
+    EASYFPGA_LOG(INFO) << "Error : " << std::boolalpha << setBitTest(statusRegister, 6);
+    EASYFPGA_LOG(INFO) << "Transmit : " << std::boolalpha << setBitTest(statusRegister, 5);
+    EASYFPGA_LOG(INFO) << "Receive : " << std::boolalpha << setBitTest(statusRegister, 4);
+    EASYFPGA_LOG(INFO) << "Transmission complete : " << std::boolalpha << setBitTest(statusRegister, 3);
+    EASYFPGA_LOG(INFO) << "Transmit buffer : " << std::boolalpha << setBitTest(statusRegister, 2);
+    EASYFPGA_LOG(INFO) << "Data overrun : " << std::boolalpha << setBitTest(statusRegister, 1);
+    EASYFPGA_LOG(INFO) << "Receive buffer : " << std::boolalpha << setBitTest(statusRegister, 0);
 
     return true;
 }
 
 bool Can::enterResetMode(void)
 {
+    _statusKnown = false;
+
     /* change reset request bit depending on mode*/
     switch (_mode) {
         case USAGE_MODE::BASIC_MODE:
@@ -807,13 +817,15 @@ bool Can::enterResetMode(void)
             return this->getRegister(REGISTER_EXTENDEND_MODE::EM_MODE)->changeBitSync(0, true);
 
         default:
-            Log().Get(LogLevel::ERROR) << "Internal error: Please call init() first!";
+            EASYFPGA_LOG(LogLevel::ERROR) << "Internal error: Please call init() first!";
             return false;
     }
 }
 
 bool Can::enterOperationMode(void)
 {
+    _statusKnown = false;
+
     /* change reset request bit depending on mode*/
     switch (_mode) {
         case USAGE_MODE::BASIC_MODE:
@@ -823,9 +835,316 @@ bool Can::enterOperationMode(void)
             return this->getRegister(REGISTER_EXTENDEND_MODE::EM_MODE)->changeBitSync(0, false);
 
         default:
-            Log().Get(LogLevel::ERROR) << "Internal error: Please call init() first!";
+            EASYFPGA_LOG(LogLevel::ERROR) << "Internal error: Please call init() first!";
+            return false;
+    }
+}
+
+register_ptr Can::getStatusRegister(void)
+{
+    if (_mode == USAGE_MODE::BASIC_MODE) {
+        return this->getRegister(REGISTER_BASIC_MODE::BM_STATUS);
+    }
+    return this->getRegister(REGISTER_EXTENDEND_MODE::EM_STATUS);
+}
+
+register_ptr Can::getCommandRegister(void)
+{
+    if (_mode == USAGE_MODE::BASIC_MODE) {
+        return this->getRegister(REGISTER_BASIC_MODE::BM_COMMAND);
+    }
+    return this->getRegister(REGISTER_EXTENDEND_MODE::EM_COMMAND);
+}
+
+register_ptr Can::getFrameBufferRegister(bool transmit)
+{
+    if (_mode == USAGE_MODE::BASIC_MODE) {
+        return this->getRegister(transmit ? REGISTER_BASIC_MODE::BM_TX_IDENTIFIER_1 : REGISTER_BASIC_MODE::BM_RX_IDENTIFIER_1);
+    }
+    /* transmit and receive buffer share their addresses */
+    return this->getRegister(REGISTER_EXTENDEND_MODE::EM_FRAME_INFORMATION);
+}
+
+uint8_t Can::encodeFrame(canframe_ptr frame, byte* target)
+{
+    uint8_t descriptorLength = frame->getDescriptorLength();
+
+    switch (_mode) {
+        case USAGE_MODE::BASIC_MODE:
+            if (frame->getMessageType() == CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME) {
+                EASYFPGA_LOG(WARNING) << "Extended frames can't be transmitted in basic mode!";
+                return 0;
+            }
+
+            frame->getDescriptor(target);
+            frame->getData(target+descriptorLength);
+            return descriptorLength + frame->getDataLength();
+
+        case USAGE_MODE::EXTENDEND_MODE:
+            frame->getFrameInfomationField(target);
+            frame->getDescriptor(target+1);
+            frame->getData(target+1+descriptorLength);
+            return 1 + descriptorLength + frame->getDataLength();
+
+        default:
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you can transmit any can message!";
+            return 0;
+    }
+}
+
+uint8_t Can::encodeMessage(const CanMessage& message, byte* target)
+{
+    /* PARAMETER CHECK */
+    if (message.length > 8) {
+        EASYFPGA_LOG(WARNING) << "Illegal data length used: " << (uint32_t)message.length << " (Only up to 8 data bytes are possible.)";
+        return 0;
+    }
+
+    if (message.identifier > ((message.getMessageType() == CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME) ? (uint32_t)0x1FFFFFFF : (uint32_t)0x7FF)) {
+        EASYFPGA_LOG(WARNING) << "Illegal identifier used: " << message.identifier << " (Standard frames have 11 bit, extended frames 29 bit identifiers.)";
+        return 0;
+    }
+
+    uint8_t offset;
+
+    switch (_mode) {
+        case USAGE_MODE::BASIC_MODE:
+            if (message.getMessageType() == CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME) {
+                EASYFPGA_LOG(WARNING) << "Extended frames can't be transmitted in basic mode!";
+                return 0;
+            }
+            offset = 0;
+            break;
+
+        case USAGE_MODE::EXTENDEND_MODE:
+            target[0] = message.getFrameInformation();
+            offset = 1;
+            break;
+
+        default:
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you can transmit any can message!";
+            return 0;
+    }
+
+    for (uint8_t i=0; i<message.getDescriptorLength(); i++) {
+        target[offset++] = message.getDescriptor(i);
+    }
+
+    /* a remote transfer request carries no data */
+    uint8_t dataLength = message.isRemoteTransferRequest() ? 0 : message.length;
+    memcpy(target+offset, message.data, dataLength);
+
+    return offset + dataLength;
+}
+
+void Can::decodeMessage(const byte* buffer, CanMessage* target)
+{
+    const byte* data;
+    target->flags = 0;
+
+    if (_mode == USAGE_MODE::BASIC_MODE) {
+        target->identifier = (buffer[0] << 3) | ((buffer[1] & 0xE0) >> 5);
+        target->length = buffer[1] & 0x0F;
+
+        /* determine if RTR or data transmission */
+        if (setBitTest(buffer[1], 4)) {
+            target->flags |= CanMessage::FLAG::REMOTE;
+        }
+        data = buffer + 2;
+    }
+    else {
+        byte frameInformation = buffer[0];
+        target->length = frameInformation & 0x0F;
+
+        if (setBitTest(frameInformation, 6)) {
+            target->flags |= CanMessage::FLAG::REMOTE;
+        }
+
+        /* Test if an standard or extended frame is avialable */
+        if (!setBitTest(frameInformation, 7)) {
+            target->identifier = (buffer[1] << 3) | ((buffer[2] & 0xE0) >> 5);
+            data = buffer + 3;
+        }
+        else {
+            target->identifier = (buffer[1] << 21) | (buffer[2] << 13) |
+                                 (buffer[3] << 5)  | ((buffer[4] & 0xF8) >> 3);
+            target->flags |= CanMessage::FLAG::EXTENDED;
+            data = buffer + 5;
+        }
+    }
+
+    assert(target->length <= 8);
+
+    if (target->flags & CanMessage::FLAG::REMOTE) {
+        /* a remote transfer request carries no data */
+        target->length = 0;
+    }
+    memcpy(target->data, data, target->length);
+}
+
+canframe_ptr Can::createFrame(CanMessage& message)
+{
+    bool extended = ((message.flags & CanMessage::FLAG::EXTENDED) != 0);
+
+    if (message.flags & CanMessage::FLAG::REMOTE) {
+        if (extended) {
+            return std::make_shared<CanFrameExtended>(message.identifier);
+        }
+        return std::make_shared<CanFrameStandard>(message.identifier);
+    }
+
+    if (extended) {
+        return std::make_shared<CanFrameExtended>(message.identifier, message.data, message.length);
+    }
+    return std::make_shared<CanFrameStandard>(message.identifier, message.data, message.length);
+}
+
+bool Can::drainReceiveBuffer(void)
+{
+    byte data[13];
+    CanMessage message;
+    uint8_t length = (_mode == USAGE_MODE::BASIC_MODE) ? 10 : 13;
+    bool success = true;
+
+    /*
+     * The interrupt means that frames arrived after the last known
+     * status. Then the status read behind each frame tells whether
+     * another one is pending.
+     */
+    if (this->getStatusRegister()->readSync(&_status)) {
+        _statusKnown = true;
+    }
+    else {
+        _statusKnown = false;
+        success = false;
+    }
+
+    while (success && setBitTest(_status, 0)) {
+        if (!this->transferFrame(data, length, false)) {
+            success = false;
+            break;
+        }
+        this->decodeMessage(data, &message);
+
+        if (!this->isWanted(message)) {
+            continue;
+        }
+
+        if (_receiveQueue->push(&message, 1) == 0) {
+            _droppedMessages++;
+            EASYFPGA_LOG(WARNING) << "Receive queue is full. A message with identifier " << message.identifier << " dropped!";
+        }
+    }
+
+    /*
+     * Enable the interrupts again in any case, otherwise a single failed
+     * exchange would stop the receive queue for good.
+     */
+    success &= _communicator->enableGlobalInterrupts();
+    return success;
+}
+
+bool Can::transmitBuffer(byte* buffer, uint8_t length)
+{
+    /* wait as long as the transmit buffer is locked */
+    timevalue timeout = getMonotonicTimeInNanos() + (timevalue)CAN_TRANSMIT_TIMEOUT * 1000;
+    while (!_statusKnown || !setBitTest(_status, 2)) {
+        if (!this->getStatusRegister()->readSync(&_status)) {
+            _statusKnown = false;
+            return false;
+        }
+        _statusKnown = true;
+
+        if (!setBitTest(_status, 2) && (getMonotonicTimeInNanos() > timeout)) {
+            EASYFPGA_LOG(WARNING) << "The transmit buffer wasn't released. Aborting ...";
+            return false;
+        }
+    }
+
+    return this->transferFrame(buffer, length, true);
+}
+
+bool Can::receiveMessage(CanMessage& message)
+{
+    byte data[13];
+
+    while (this->receiveBuffer(data)) {
+        this->decodeMessage(data, &message);
+
+        if (this->isWanted(message)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Can::isWanted(const CanMessage& message)
+{
+    _hardwareAcceptedFrames++;
+
+    if (_filtering && !_filterSet.contains(message.identifier, message.getMessageType())) {
+        _hostDroppedFrames++;
+        return false;
+    }
+
+    return true;
+}
+
+bool Can::receiveBuffer(byte* buffer)
+{
+    switch (_mode) {
+        case USAGE_MODE::BASIC_MODE:
+        case USAGE_MODE::EXTENDEND_MODE:
+            break;
+
+        default:
+            EASYFPGA_LOG(WARNING) << "You have to call init() first before you can try to receive any can message!";
             return false;
     }
+
+    /* a pending frame stays pending, otherwise ask the core */
+    if (!_statusKnown || !setBitTest(_status, 0)) {
+        if (!this->getStatusRegister()->readSync(&_status)) {
+            _statusKnown = false;
+            return false;
+        }
+        _statusKnown = true;
+
+        if (!setBitTest(_status, 0)) {
+            return false;
+        }
+    }
+
+    return this->transferFrame(buffer, (_mode == USAGE_MODE::BASIC_MODE) ? 10 : 13, false);
+}
+
+bool Can::transferFrame(byte* buffer, uint8_t length, bool transmit)
+{
+    /*
+     * The three exchanges are sent at once and processed in order by
+     * the soc: transfer the frame buffer, then request the transmission
+     * (0x01) or release the receive buffer (0x04), then read the status
+     * for the next call. Only these replies are awaited, results of
+     * other outstanding async requests stay pending.
+     */
+    bool success = true;
+    _communicator->beginRequestBatch();
+
+    if (transmit) {
+        success &= this->getFrameBufferRegister(true)->writeAutoAddressIncrementAsync(buffer, length);
+        success &= this->getCommandRegister()->writeAsync((byte)0x01);
+    }
+    else {
+        success &= this->getFrameBufferRegister(false)->readAutoAddressIncrementAsync(buffer, length);
+        success &= this->getCommandRegister()->writeAsync((byte)0x04);
+    }
+    success &= this->getStatusRegister()->readAsync(&_status);
+
+    success &= _communicator->finishRequestBatch();
+
+    _statusKnown = success;
+    return success;
 }
 
 bool Can::setBusTiming(
@@ -837,17 +1156,17 @@ bool Can::setBusTiming(
 )
 {
     if ((syncronizationJumpWidth < 0) || (syncronizationJumpWidth > 3)) {
-        Log().Get(WARNING) << "Init method fails. Invalid synchronization jump width!";
+        EASYFPGA_LOG(WARNING) << "Init method fails. Invalid synchronization jump width!";
         return false;
     }
 
     if ((timeSegment1 < 0) || (timeSegment1 > 15)) {
-        Log().Get(WARNING) << "Init method fails. Invalid time segment 1!";
+        EASYFPGA_LOG(WARNING) << "Init method fails. Invalid time segment 1!";
         return false;
     }
 
     if ((timeSegment2 < 0) || (timeSegment2 > 7)) {
-        Log().Get(WARNING) << "Init method fails. Invalid time segment 2!";
+        EASYFPGA_LOG(WARNING) << "Init method fails. Invalid time segment 2!";
         return false;
     }
 
@@ -23,12 +23,18 @@
 #ifndef SDK_EASYCORES_CAN_CAN_H_
 #define SDK_EASYCORES_CAN_CAN_H_
 
+#include "configuration.h" /* CAN_RECEIVE_QUEUE_SIZE */
+#include "easycores/can/utils/canfilterset.h"
 #include "easycores/can/utils/canframe_ptr.h"
+#include "easycores/can/utils/canmessage.h"
 #include "easycores/easycore.h"
 #include "easycores/types.h"
 #include "utils/hardwaretypes.h"
+#include "utils/spscringbuffer_fwd.h"
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 /**
  * \brief A CAN-Bus controller core with an SJA1000 compatible interface.
@@ -76,6 +82,10 @@
  * - Can::setAcceptanceCode() and
  * - Can::setAcceptanceMask().
  *
+ * Can::setFilterSet() computes both from a CanFilterSet of wanted
+ * identifiers and drops the frames passing the filter although they
+ * aren't wanted on the host.
+ *
  * The acceptance mask defines which bits of the acceptance code
  * (or identifier) should be compared to the identifier of an incoming
  * frame. The bits that are set in the mask are not used for filtering.
@@ -93,6 +103,17 @@
  * Can::transmit() method. Once the core has received a frame, it can be
  * fetched by calling the method Can::getReceivedFrame().
  *
+ * Alternatively, frames can be handled as CanMessage values, which hold
+ * their payload inline and need no heap allocation. Can::transmit(),
+ * Can::getReceivedFrame() and Can::getReceivedFrames() accept both.
+ *
+ * A frame is transferred by a single auto address increment exchange.
+ * The following command write and status read are pipelined behind it,
+ * so a frame costs one round trip as long as the transmit buffer is
+ * released (or a received frame is pending). Several frames can be
+ * transferred by a single call of the overloaded Can::transmit() and
+ * Can::getReceivedFrames() methods.
+ *
  * <b>Interrupt handling</b>
  *
  * The currently supported interrupts are shown in Can::INTERRUPT.
@@ -103,6 +124,15 @@
  * After the core has issued an interrupt, the method
  * Can::identifyInterrupt() is used to determine the type of pending
  * interrupt.
+ *
+ * <b>Receive queue</b>
+ *
+ * Instead of polling Can::getReceivedFrame(), the receive interrupt can
+ * be handled by the framework: after Can::startReceiveQueue(), every
+ * receive interrupt drains the receive buffer into a preallocated queue
+ * of CanMessage values, each frame by a single burst. The application
+ * takes them by Can::popReceivedMessage(), which never blocks and never
+ * allocates. Messages not fitting into the queue are counted as dropped.
  */
 class Can : public EasyCore
 {
@@ -1064,19 +1094,147 @@ class Can : public EasyCore
          * \brief Stores a CAN frame in send queue which will be
          *        transmitted over the bus.
          *
+         * Waits up to CAN_TRANSMIT_TIMEOUT until the transmit buffer is
+         * released.
+         *
          * \return true if the exchange could be processed successfully,<br>
          *         false otherwise
          */
         bool transmit(canframe_ptr frame);
 
+        /**
+         * \brief Transmits several CAN frames one after another.
+         *
+         * \return true if all frames could be transmitted,<br>
+         *         false otherwise (the following frames are skipped)
+         */
+        bool transmit(const std::vector<canframe_ptr>& frames);
+
+        /**
+         * \brief Transmits a message stored by value. Like transmit(),
+         *        but without allocating a CanFrame.
+         *
+         * \return true if the exchange could be processed successfully,<br>
+         *         false otherwise, e.g. if the message has more than 8
+         *         data bytes or its identifier is too wide for its format
+         */
+        bool transmit(const CanMessage& message);
+
+        /**
+         * \brief Transmits several messages one after another.
+         *
+         * \return true if all messages could be transmitted,<br>
+         *         false otherwise (the following messages are skipped)
+         */
+        bool transmit(const std::vector<CanMessage>& messages);
+
         /**
          * \brief Gets a frame that has been received.
          *
          * \return true if the exchange could be processed successfully,<br>
-         *         false otherwise
+         *         false otherwise (e.g. if no frame was received)
          */
         bool getReceivedFrame(canframe_ptr& frame);
 
+        /**
+         * \brief Gets all received frames, but not more than maxCount.
+         *
+         * \param frames The received frames are appended to this vector.
+         *
+         * \param maxCount Maximum number of frames to get.
+         *
+         * \return true if at least one frame could be received,<br>
+         *         false otherwise
+         */
+        bool getReceivedFrames(std::vector<canframe_ptr>& frames, uint32_t maxCount);
+
+        /**
+         * \brief Gets a frame that has been received as a message stored
+         *        by value.
+         *
+         * \return true if the exchange could be processed successfully,<br>
+         *         false otherwise (e.g. if no frame was received)
+         */
+        bool getReceivedFrame(CanMessage& message);
+
+        /**
+         * \brief Gets all received frames as messages stored by value,
+         *        but not more than maxCount.
+         *
+         * \param messages The received messages are appended to this
+         *        vector. Reserve its capacity to avoid reallocations.
+         *
+         * \param maxCount Maximum number of messages to get.
+         *
+         * \return true if at least one message could be received,<br>
+         *         false otherwise
+         */
+        bool getReceivedFrames(std::vector<CanMessage>& messages, uint32_t maxCount);
+
+        /**
+         * \brief Starts draining the receive buffer into the receive
+         *        queue whenever a receive interrupt occurs.
+         *
+         * Enables the receive interrupt and the global interrupts. The
+         * interrupts are handled like all other interrupts, e.g. by
+         * EasyFpga::handleReplies(). A registered callback is called
+         * after the receive buffer has been drained.
+         *
+         * \param capacity The number of messages the queue can hold.
+         *        It is allocated once here, and messages received
+         *        before are discarded.
+         *
+         * \return true if the exchanges could be processed successfully,<br>
+         *         false otherwise
+         */
+        bool startReceiveQueue(uint32_t capacity = CAN_RECEIVE_QUEUE_SIZE);
+
+        /**
+         * \brief Disables the receive interrupt. Queued messages can
+         *        still be popped.
+         *
+         * \return true if the exchange could be processed successfully,<br>
+         *         false otherwise
+         */
+        bool stopReceiveQueue(void);
+
+        /**
+         * \brief Returns the number of messages in the receive queue.
+         */
+        uint32_t getNumberOfQueuedMessages(void);
+
+        /**
+         * \brief Takes the oldest message from the receive queue without
+         *        blocking.
+         *
+         * \return true if a message was copied to the target,<br>
+         *         false if the queue is empty
+         */
+        bool popReceivedMessage(CanMessage& message);
+
+        /**
+         * \brief Takes up to maxCount messages from the receive queue
+         *        without blocking.
+         *
+         * \return The number of messages copied to the target array
+         */
+        uint32_t popReceivedMessages(CanMessage* messages, uint32_t maxCount);
+
+        /**
+         * \brief Returns the number of received messages dropped because
+         *        the receive queue was full.
+         */
+        uint64_t getNumberOfDroppedMessages(void);
+
+        /**
+         * \brief Drains the receive buffer if the receive queue is
+         *        started, then calls the registered interrupt service
+         *        routine.
+         *
+         * \return true if the interrupt was handled
+         */
+        bool executeCallback(void);
+
         /**
          * \brief Enter the sleep mode if no interrupt is pending and
          *        there is no bus activity.
@@ -1126,6 +1284,47 @@ class Can : public EasyCore
          */
         bool setAcceptanceMask(uint32_t mask);
 
+        /**
+         * \brief Receives only the frames whose identifiers are in the
+         *        filter set.
+         *
+         * The tightest acceptance code and mask covering the set (see
+         * CanFilterSet::getAcceptanceFilter()) are programmed into the
+         * core. The frames passing this filter although they aren't
+         * wanted are dropped on the host by getReceivedFrame(),
+         * getReceivedFrames() and the receive queue. Both kinds of
+         * frames are counted.
+         *
+         * \param filters The wanted identifiers. The set is copied.
+         *
+         * \return true if the exchanges could be processed successfully,<br>
+         *         false otherwise (e.g. if no identifier of the set can be
+         *         received in the current mode)
+         */
+        bool setFilterSet(const CanFilterSet& filters);
+
+        /**
+         * \brief Accepts all frames again.
+         *
+         * \return true if the exchange could be processed successfully,<br>
+         *         false otherwise
+         */
+        bool clearFilterSet(void);
+
+        /**
+         * \brief Returns the number of frames read from the core since
+         *        the filter set was changed, i.e. the frames passing the
+         *        core's acceptance filter.
+         */
+        uint64_t getNumberOfHardwareAcceptedFrames(void);
+
+        /**
+         * \brief Returns the number of frames dropped on the host since
+         *        the filter set was changed because they passed the
+         *        core's acceptance filter but aren't in the filter set.
+         */
+        uint64_t getNumberOfHostDroppedFrames(void);
+
         /**
          * \brief Reads the status register and write its content to the
          *        log.
@@ -1142,10 +1341,89 @@ class Can : public EasyCore
          */
         USAGE_MODE _mode;
 
+        /**
+         * \brief The status register read after the last transferred
+         *        frame.
+         *
+         * As only the commands of this class lock the transmit buffer
+         * or release the receive buffer, a released transmit buffer and
+         * a pending received frame stay valid until the next transfer.
+         */
+        byte _status;
+
+        /**
+         * \brief Whether _status is valid.
+         */
+        bool _statusKnown;
+
+        /**
+         * \brief Whether the receive interrupts are handled by the
+         *        framework.
+         */
+        bool _queueing;
+
+        /**
+         * \brief Host queue of received messages, NULL before the first
+         *        startReceiveQueue().
+         */
+        SpscRingBuffer<CanMessage>* _receiveQueue;
+
+        /**
+         * \brief Counts the messages which didn't fit into _receiveQueue.
+         */
+        std::atomic<uint64_t> _droppedMessages;
+
+        /**
+         * \brief The wanted identifiers, see setFilterSet().
+         */
+        CanFilterSet _filterSet;
+
+        /**
+         * \brief Whether the received frames are filtered by _filterSet.
+         */
+        bool _filtering;
+
+        /**
+         * \brief Counters of the received frames, see
+         *        getNumberOfHardwareAcceptedFrames() and
+         *        getNumberOfHostDroppedFrames().
+         */
+        std::atomic<uint64_t> _hardwareAcceptedFrames;
+        std::atomic<uint64_t> _hostDroppedFrames;
+
     private:
         bool enterResetMode(void);
         bool enterOperationMode(void);
 
+        /* status, command and frame buffer registers of the current mode */
+        register_ptr getStatusRegister(void);
+        register_ptr getCommandRegister(void);
+        register_ptr getFrameBufferRegister(bool transmit);
+
+        /* the frame in the buffer layout of the current mode, 0 if impossible */
+        uint8_t encodeFrame(canframe_ptr frame, byte* target);
+        uint8_t encodeMessage(const CanMessage& message, byte* target);
+        void decodeMessage(const byte* buffer, CanMessage* target);
+        canframe_ptr createFrame(CanMessage& message);
+
+        /* moves all pending frames into the receive queue */
+        bool drainReceiveBuffer(void);
+
+        /* waits for the transmit buffer, then transfers the frame */
+        bool transmitBuffer(byte* buffer, uint8_t length);
+
+        /* transfers a pending received frame, false if there is none */
+        bool receiveBuffer(byte* buffer);
+
+        /* receives the next wanted frame, false if there is none */
+        bool receiveMessage(CanMessage& message);
+
+        /* counts a received frame and checks it against the filter set */
+        bool isWanted(const CanMessage& message);
+
+        /* writes or reads the frame buffer, then the command and the status */
+        bool transferFrame(byte* buffer, uint8_t length, bool transmit);
+
         bool setBusTiming(
             uint8_t prescaler,
             uint8_t syncronizationJumpWidth,
@@ -0,0 +1,207 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/can/can.h"
+#include "easyfpga/easycores/can/can_ptr.h"
+#include "easyfpga/easycores/can/utils/canframe.h"
+#include "easyfpga/easycores/can/utils/canframe_extended.h"
+#include "easyfpga/easycores/can/utils/canframe_standard.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedcan.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CanFpga : public EasyFpga
+{
+    public:
+        CanFpga() :
+            can(std::make_shared<Can>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(can);
+        }
+
+        can_ptr can;
+};
+
+/**
+ * \brief Tests the frame transfers of the Can core
+ *
+ * The test needs no easyFPGA. In basic and extended mode, frames are
+ * transmitted to and received from a simulated can core. Every frame
+ * has to be transferred by a single auto address increment exchange
+ * and has to arrive unchanged.
+ */
+class CanBurstTest : public Tester
+{
+    std::string testName(void) {
+        return "can burst transfer test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool equals(canframe_ptr frame, const SimulatedCanFrame& simulated) {
+        byte data[8];
+        frame->getData(data);
+
+        return (frame->getIdentifier() == simulated.identifier) &&
+               ((frame->getMessageType() == CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME) == simulated.extended) &&
+               (frame->isRemoteTransferRequest() == simulated.remote) &&
+               (simulated.remote || ((frame->getDataLength() == simulated.length) &&
+                                     (memcmp(data, simulated.data, simulated.length) == 0)));
+    }
+
+    bool testMode(CanFpga& fpga, std::shared_ptr<SimulatedCan> model, Can::USAGE_MODE mode) {
+        bool extendedMode = (mode == Can::USAGE_MODE::EXTENDEND_MODE);
+
+        if (!fpga.can->init(Can::BITRATE::BITRATE_1M, mode) ||
+            !fpga.can->setAcceptanceMask(extendedMode ? 0x1FFFFFFF : 0xFF)) {
+            Log().Get(ERROR) << "Couldn't initialize the can core!";
+            return false;
+        }
+
+        byte payload[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+
+        std::vector<canframe_ptr> frames;
+        frames.push_back(std::make_shared<CanFrameStandard>(0x123, payload, 8));
+        frames.push_back(std::make_shared<CanFrameStandard>(0x7FF, payload, 3));
+        frames.push_back(std::make_shared<CanFrameStandard>(0x001));
+        if (extendedMode) {
+            frames.push_back(std::make_shared<CanFrameExtended>(0x1ABCDEF5, payload, 8));
+            frames.push_back(std::make_shared<CanFrameExtended>(0x00000800));
+        }
+
+        /* transmit while an unrelated async request is outstanding */
+        byte unrelated = 0xA5;
+        if (!fpga.getCommunicator()->readRegisterAsync(&unrelated, 1, 2, 0)) {
+            Log().Get(ERROR) << "Couldn't start the unrelated async request!";
+            return false;
+        }
+
+        uint64_t bursts = this->countRequests(0x69);
+        if (!fpga.can->transmit(frames) || (this->countRequests(0x69) - bursts != frames.size())) {
+            Log().Get(ERROR) << "Transmitting the frames failed!";
+            return false;
+        }
+
+        /* its result is written by handleRequestReplies() only */
+        if (unrelated != 0xA5) {
+            Log().Get(ERROR) << "The frame transfers wrote the result of an unrelated async request!";
+            return false;
+        }
+        if (!fpga.getCommunicator()->handleRequestReplies() || (unrelated == 0xA5)) {
+            Log().Get(ERROR) << "The unrelated async request failed!";
+            return false;
+        }
+
+        std::vector<SimulatedCanFrame> transmitted = model->takeTransmittedFrames();
+        if (transmitted.size() != frames.size()) {
+            Log().Get(ERROR) << transmitted.size() << " of " << frames.size() << " frames transmitted!";
+            return false;
+        }
+        for (uint32_t i=0; i<frames.size(); i++) {
+            if (!this->equals(frames[i], transmitted[i])) {
+                Log().Get(ERROR) << "Transmitted frame " << i << " is wrong!";
+                return false;
+            }
+        }
+
+        /* an empty receive buffer */
+        canframe_ptr frame;
+        if (fpga.can->getReceivedFrame(frame) || (frame != nullptr)) {
+            Log().Get(ERROR) << "A frame was received from an empty receive buffer!";
+            return false;
+        }
+
+        /* receive them again, the receive fifo holds 64 bytes */
+        for (auto& simulated : transmitted) {
+            model->injectFrame(simulated);
+        }
+
+        std::vector<canframe_ptr> received;
+        bursts = this->countRequests(0x79);
+        if (!fpga.can->getReceivedFrames(received, 100) || (received.size() != transmitted.size()) ||
+            (this->countRequests(0x79) - bursts != transmitted.size())) {
+            Log().Get(ERROR) << "Receiving the frames failed!";
+            return false;
+        }
+        for (uint32_t i=0; i<received.size(); i++) {
+            if (!this->equals(received[i], transmitted[i])) {
+                Log().Get(ERROR) << "Received frame " << i << " is wrong!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        auto model = std::make_shared<SimulatedCan>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        CanFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = this->testMode(fpga, model, Can::USAGE_MODE::BASIC_MODE);
+        success &= this->testMode(fpga, model, Can::USAGE_MODE::EXTENDEND_MODE);
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    CanBurstTest test;
+    return (uint32_t)test.runTest();
+}
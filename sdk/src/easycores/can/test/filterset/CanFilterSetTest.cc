@@ -0,0 +1,247 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/can/can.h"
+#include "easyfpga/easycores/can/can_ptr.h"
+#include "easyfpga/easycores/can/utils/canfilterset.h"
+#include "easyfpga/easycores/can/utils/canmessage.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedcan.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/time_helper.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class CanFpga : public EasyFpga
+{
+    public:
+        CanFpga() :
+            can(std::make_shared<Can>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(can);
+        }
+
+        can_ptr can;
+};
+
+/**
+ * \brief Tests the filter sets of the Can core
+ *
+ * The test needs no easyFPGA. The acceptance filter computed for a
+ * filter set has to be the tightest single pattern. Frames injected
+ * into a simulated can core have to be rejected by the core, dropped
+ * on the host or received, depending on their identifiers.
+ */
+class CanFilterSetTest : public Tester
+{
+    std::string testName(void) {
+        return "can filter set test";
+    }
+
+    bool expectFilter(const CanFilterSet& filters, bool extendedMode, uint32_t expectedCode, uint32_t expectedMask) {
+        uint32_t code;
+        uint32_t mask;
+
+        if (!filters.getAcceptanceFilter(extendedMode, &code, &mask) ||
+            (code != expectedCode) || (mask != expectedMask)) {
+            Log().Get(ERROR) << "Wrong acceptance filter: code " << std::hex << code << ", mask " << mask;
+            return false;
+        }
+        return true;
+    }
+
+    bool testCover(void) {
+        uint32_t code;
+        uint32_t mask;
+        bool success = true;
+
+        CanFilterSet filters;
+        if (filters.getAcceptanceFilter(false, &code, &mask) ||
+            filters.addIdentifier(0x800) || filters.addRange(0x10, 0x0F) ||
+            filters.addIdentifier(0x20000000, EXTENDED_FRAME)) {
+            Log().Get(ERROR) << "An empty filter set or an illegal identifier was accepted!";
+            success = false;
+        }
+
+        /* identifiers differing in two bits */
+        filters.addIdentifier(0x100);
+        filters.addIdentifier(0x101);
+        filters.addIdentifier(0x103);
+        success &= this->expectFilter(filters, false, 0x20, 0x00);
+        success &= this->expectFilter(filters, true, 0x100 << 18, (0x03 << 18) | 0x3FFFF);
+
+        if (!filters.contains(0x101, STANDARD_FRAME) || filters.contains(0x102, STANDARD_FRAME) ||
+            filters.contains(0x101, EXTENDED_FRAME)) {
+            Log().Get(ERROR) << "The filter set contains wrong identifiers!";
+            success = false;
+        }
+
+        /* ranges, extended identifiers are ignored in basic mode */
+        filters.clear();
+        filters.addRange(0x1ABC0000, 0x1ABCFFFF, EXTENDED_FRAME);
+        filters.addRange(0x1ABD0010, 0x1ABD0017, EXTENDED_FRAME);
+        success &= this->expectFilter(filters, true, 0x1ABC0000, 0x0001FFFF);
+
+        if (filters.getAcceptanceFilter(false, &code, &mask) ||
+            !filters.contains(0x1ABC8000, EXTENDED_FRAME) || !filters.contains(0x1ABD0013, EXTENDED_FRAME) ||
+            filters.contains(0x1ABD0018, EXTENDED_FRAME)) {
+            Log().Get(ERROR) << "The ranges are wrong!";
+            success = false;
+        }
+
+        return success;
+    }
+
+    SimulatedCanFrame createFrame(uint32_t identifier, bool extended) {
+        SimulatedCanFrame frame = { identifier, extended, false, 1, { 0x5A } };
+        return frame;
+    }
+
+    bool testMode(CanFpga& fpga, std::shared_ptr<SimulatedCan> model, Can::USAGE_MODE mode) {
+        bool extendedMode = (mode == Can::USAGE_MODE::EXTENDEND_MODE);
+
+        CanFilterSet filters;
+        filters.addRange(0x120, 0x12F);
+        filters.addIdentifier(0x135);
+
+        if (!fpga.can->init(Can::BITRATE::BITRATE_1M, mode) || !fpga.can->setFilterSet(filters)) {
+            Log().Get(ERROR) << "Couldn't set the filter set!";
+            return false;
+        }
+
+        /*
+         * The core accepts the standard identifiers 0x120 .. 0x13F,
+         * and in extended mode extended identifiers with the same bits
+         * 28 to 23.
+         */
+        std::vector<SimulatedCanFrame> frames;
+        frames.push_back(this->createFrame(0x121, false));
+        frames.push_back(this->createFrame(0x130, false));
+        frames.push_back(this->createFrame(0x200, false));
+        frames.push_back(this->createFrame(0x135, false));
+        if (extendedMode) {
+            frames.push_back(this->createFrame(0x04812345, true));
+            frames.push_back(this->createFrame(0x1ABCDE00, true));
+        }
+
+        uint32_t rejected = model->getNumberOfRejectedFrames();
+        for (auto& frame : frames) {
+            model->injectFrame(frame);
+        }
+
+        std::vector<CanMessage> received;
+        fpga.can->getReceivedFrames(received, 16);
+
+        uint32_t expectedRejected = extendedMode ? 2 : 1;
+        uint64_t expectedAccepted = frames.size() - expectedRejected;
+
+        if ((received.size() != 2) || (received[0].identifier != 0x121) || (received[1].identifier != 0x135) ||
+            (model->getNumberOfRejectedFrames() - rejected != expectedRejected) ||
+            (fpga.can->getNumberOfHardwareAcceptedFrames() != expectedAccepted) ||
+            (fpga.can->getNumberOfHostDroppedFrames() != expectedAccepted - 2)) {
+            Log().Get(ERROR) << "The frames were filtered wrong! Received " << received.size() << ", accepted " <<
+                fpga.can->getNumberOfHardwareAcceptedFrames() << ", dropped " << fpga.can->getNumberOfHostDroppedFrames();
+            return false;
+        }
+
+        /* the receive queue is filtered as well */
+        if (!fpga.can->startReceiveQueue(16)) {
+            return false;
+        }
+        for (auto& frame : frames) {
+            model->injectFrame(frame);
+        }
+
+        timevalue timeout = getMonotonicTimeInNanos() + 2000000000;
+        while ((fpga.can->getNumberOfHardwareAcceptedFrames() < 2 * expectedAccepted) &&
+               (getMonotonicTimeInNanos() < timeout)) {
+            fpga.handleReplies();
+        }
+
+        CanMessage queued[16];
+        if ((fpga.can->popReceivedMessages(queued, 16) != 2) || (queued[1].identifier != 0x135) ||
+            !fpga.can->stopReceiveQueue()) {
+            Log().Get(ERROR) << "The receive queue was filtered wrong!";
+            return false;
+        }
+
+        /* without a filter set, all frames are received */
+        if (!fpga.can->clearFilterSet()) {
+            return false;
+        }
+        for (auto& frame : frames) {
+            model->injectFrame(frame);
+        }
+
+        received.clear();
+        if (!fpga.can->getReceivedFrames(received, 16) || (received.size() != frames.size()) ||
+            (fpga.can->getNumberOfHostDroppedFrames() != 0)) {
+            Log().Get(ERROR) << "Not all frames were received without a filter set!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        if (!this->testCover()) {
+            return false;
+        }
+
+        auto model = std::make_shared<SimulatedCan>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        CanFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = this->testMode(fpga, model, Can::USAGE_MODE::BASIC_MODE);
+        success &= this->testMode(fpga, model, Can::USAGE_MODE::EXTENDEND_MODE);
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    CanFilterSetTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,251 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/can/can.h"
+#include "easyfpga/easycores/can/can_ptr.h"
+#include "easyfpga/easycores/can/utils/canframe.h"
+#include "easyfpga/easycores/can/utils/canframe_extended.h"
+#include "easyfpga/easycores/can/utils/canframe_standard.h"
+#include "easyfpga/easycores/can/utils/canmessage.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedcan.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* messages encoded at compile time */
+static constexpr byte PAYLOAD[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+static constexpr CanMessage STANDARD_DATA(0x123, PAYLOAD, 3, STANDARD_FRAME);
+static constexpr CanMessage EXTENDED_REMOTE(0x1ABCDEF5, EXTENDED_FRAME);
+
+static_assert(STANDARD_DATA.getFrameInformation() == 0x03, "wrong frame information");
+static_assert((STANDARD_DATA.getDescriptor(0) == 0x24) && (STANDARD_DATA.getDescriptor(1) == 0x63), "wrong descriptor");
+static_assert(STANDARD_DATA.data[2] == 0x33 && STANDARD_DATA.data[3] == 0x00, "wrong payload");
+static_assert(EXTENDED_REMOTE.getFrameInformation() == 0xC0, "wrong frame information");
+static_assert(EXTENDED_REMOTE.getDescriptorLength() == 4, "wrong descriptor length");
+static_assert(EXTENDED_REMOTE.getDescriptor(3) == 0xAC, "wrong descriptor");
+
+class CanFpga : public EasyFpga
+{
+    public:
+        CanFpga() :
+            can(std::make_shared<Can>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(can);
+        }
+
+        can_ptr can;
+};
+
+/**
+ * \brief Tests the CanMessage value type
+ *
+ * The test needs no easyFPGA. A CanMessage has to be encoded exactly
+ * like the equivalent CanFrame. In basic and extended mode, vectors of
+ * messages are transmitted to and received from a simulated can core,
+ * each by a single auto address increment exchange.
+ */
+class CanMessageTest : public Tester
+{
+    std::string testName(void) {
+        return "can message test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool encodesLike(const CanMessage& message, canframe_ptr frame) {
+        byte information;
+        byte descriptor[4];
+        frame->getFrameInfomationField(&information);
+        frame->getDescriptor(descriptor);
+
+        if ((message.getFrameInformation() != information) ||
+            (message.getDescriptorLength() != frame->getDescriptorLength())) {
+            return false;
+        }
+        for (uint8_t i=0; i<message.getDescriptorLength(); i++) {
+            if (message.getDescriptor(i) != descriptor[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool equals(const CanMessage& a, const CanMessage& b) {
+        return (a.identifier == b.identifier) && (a.flags == b.flags) &&
+               (a.length == b.length) && (memcmp(a.data, b.data, a.length) == 0);
+    }
+
+    bool testEncoding(void) {
+        byte payload[8];
+        memcpy(payload, PAYLOAD, 8);
+
+        uint32_t identifiers[] = { 0x000, 0x001, 0x123, 0x555, 0x7FF };
+        for (uint32_t identifier : identifiers) {
+            for (uint8_t length=0; length<=8; length++) {
+                if (!this->encodesLike(CanMessage(identifier, payload, length, STANDARD_FRAME),
+                                       std::make_shared<CanFrameStandard>(identifier, payload, length)) ||
+                    !this->encodesLike(CanMessage(identifier << 18 | 0x2A5A5, payload, length, EXTENDED_FRAME),
+                                       std::make_shared<CanFrameExtended>(identifier << 18 | 0x2A5A5, payload, length))) {
+                    Log().Get(ERROR) << "Data message " << identifier << " is encoded wrong!";
+                    return false;
+                }
+            }
+
+            if (!this->encodesLike(CanMessage(identifier, STANDARD_FRAME), std::make_shared<CanFrameStandard>(identifier)) ||
+                !this->encodesLike(CanMessage(identifier << 18, EXTENDED_FRAME), std::make_shared<CanFrameExtended>(identifier << 18))) {
+                Log().Get(ERROR) << "Remote message " << identifier << " is encoded wrong!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMode(CanFpga& fpga, std::shared_ptr<SimulatedCan> model, Can::USAGE_MODE mode) {
+        bool extendedMode = (mode == Can::USAGE_MODE::EXTENDEND_MODE);
+
+        if (!fpga.can->init(Can::BITRATE::BITRATE_1M, mode) ||
+            !fpga.can->setAcceptanceMask(extendedMode ? 0x1FFFFFFF : 0xFF)) {
+            Log().Get(ERROR) << "Couldn't initialize the can core!";
+            return false;
+        }
+        model->setLoopback(true);
+
+        std::vector<CanMessage> messages;
+        messages.push_back(STANDARD_DATA);
+        messages.push_back(CanMessage(0x7FF, PAYLOAD, 8, STANDARD_FRAME));
+        messages.push_back(CanMessage(0x001, STANDARD_FRAME));
+        if (extendedMode) {
+            messages.push_back(CanMessage(0x00000800, PAYLOAD, 5, EXTENDED_FRAME));
+            messages.push_back(EXTENDED_REMOTE);
+        }
+
+        /* transmitted messages are received again by the loopback */
+        uint64_t writeBursts = this->countRequests(0x69);
+        if (!fpga.can->transmit(messages) || (this->countRequests(0x69) - writeBursts != messages.size())) {
+            Log().Get(ERROR) << "Transmitting the messages failed!";
+            return false;
+        }
+        model->takeTransmittedFrames();
+
+        std::vector<CanMessage> received;
+        received.reserve(16);
+        uint64_t readBursts = this->countRequests(0x79);
+        if (!fpga.can->getReceivedFrames(received, 16) || (received.size() != messages.size()) ||
+            (this->countRequests(0x79) - readBursts != messages.size())) {
+            Log().Get(ERROR) << "Receiving the messages failed!";
+            return false;
+        }
+
+        for (uint32_t i=0; i<messages.size(); i++) {
+            if (!this->equals(received[i], messages[i])) {
+                Log().Get(ERROR) << "Received message " << i << " is wrong!";
+                return false;
+            }
+        }
+
+        /* a single message and an empty receive buffer */
+        CanMessage message;
+        if (!fpga.can->transmit(STANDARD_DATA) || !fpga.can->getReceivedFrame(message) ||
+            !this->equals(message, STANDARD_DATA) || fpga.can->getReceivedFrame(message)) {
+            Log().Get(ERROR) << "Transferring a single message failed!";
+            return false;
+        }
+
+        /* invalid messages are rejected without any exchange */
+        CanMessage tooLong(STANDARD_DATA);
+        tooLong.length = 9;
+        std::vector<CanMessage> invalid;
+        invalid.push_back(tooLong);
+        invalid.push_back(CanMessage(0x800, PAYLOAD, 8, STANDARD_FRAME));
+        invalid.push_back(CanMessage(0x20000000, EXTENDED_FRAME));
+
+        writeBursts = this->countRequests(0x69);
+        for (auto& message : invalid) {
+            if (fpga.can->transmit(message)) {
+                Log().Get(ERROR) << "An invalid message was transmitted!";
+                return false;
+            }
+        }
+        if (this->countRequests(0x69) != writeBursts) {
+            Log().Get(ERROR) << "An invalid message was written to the core!";
+            return false;
+        }
+
+        model->setLoopback(false);
+        return true;
+    }
+
+    bool testMethod(void) {
+        if (!this->testEncoding()) {
+            return false;
+        }
+
+        auto model = std::make_shared<SimulatedCan>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        CanFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = this->testMode(fpga, model, Can::USAGE_MODE::BASIC_MODE);
+        success &= this->testMode(fpga, model, Can::USAGE_MODE::EXTENDEND_MODE);
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    CanMessageTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,232 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/can/can.h"
+#include "easyfpga/easycores/can/can_ptr.h"
+#include "easyfpga/easycores/can/utils/canframe.h"
+#include "easyfpga/easycores/can/utils/canmessage.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedcan.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/time_helper.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static uint32_t userCallbacks = 0;
+
+static void canCallback(void)
+{
+    userCallbacks++;
+}
+
+class CanFpga : public EasyFpga
+{
+    public:
+        CanFpga() :
+            can(std::make_shared<Can>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(can);
+        }
+
+        can_ptr can;
+};
+
+/**
+ * \brief Tests the receive queue of the Can core
+ *
+ * The test needs no easyFPGA. Frames received by a simulated can core
+ * have to arrive in order in the receive queue, each drained by a
+ * single burst. Frames not fitting into the queue have to be counted
+ * as dropped, and a drain failed by injected NACKs mustn't stop the
+ * queue.
+ */
+class CanReceiveQueueTest : public Tester
+{
+    std::string testName(void) {
+        return "can receive queue test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool equals(const CanMessage& message, const SimulatedCanFrame& simulated) {
+        return (message.identifier == simulated.identifier) &&
+               (((message.flags & CanMessage::FLAG::EXTENDED) != 0) == simulated.extended) &&
+               (((message.flags & CanMessage::FLAG::REMOTE) != 0) == simulated.remote) &&
+               (simulated.remote || ((message.length == simulated.length) &&
+                                     (memcmp(message.data, simulated.data, simulated.length) == 0)));
+    }
+
+    /* handles replies until the expected number of messages is queued */
+    bool waitForMessages(CanFpga& fpga, uint32_t expected) {
+        timevalue timeout = getMonotonicTimeInNanos() + 2000000000;
+
+        while (fpga.can->getNumberOfQueuedMessages() < expected) {
+            if (!fpga.handleReplies() || (getMonotonicTimeInNanos() > timeout)) {
+                Log().Get(ERROR) << "Only " << fpga.can->getNumberOfQueuedMessages() << " of " << expected << " messages received!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        auto model = std::make_shared<SimulatedCan>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        CanFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        if (!fpga.can->init(Can::BITRATE::BITRATE_1M, Can::USAGE_MODE::EXTENDEND_MODE) ||
+            !fpga.can->setAcceptanceMask(0x1FFFFFFF) ||
+            !fpga.can->registerCallback(canCallback) ||
+            !fpga.can->startReceiveQueue(8)) {
+            Log().Get(ERROR) << "Couldn't start the receive queue!";
+            return false;
+        }
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        std::vector<SimulatedCanFrame> frames = {
+            { 0x123, false, false, 8, { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 } },
+            { 0x7FF, false, true, 0, { 0 } },
+            { 0x1ABCDEF5, true, false, 5, { 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 } },
+            { 0x00000800, true, true, 0, { 0 } }
+        };
+
+        bool success = true;
+        CanMessage message;
+
+        if (fpga.can->popReceivedMessage(message)) {
+            Log().Get(ERROR) << "A message was popped from an empty queue!";
+            success = false;
+        }
+
+        /* every frame is drained by a single burst */
+        uint64_t bursts = this->countRequests(0x79);
+        for (auto& frame : frames) {
+            model->injectFrame(frame);
+        }
+        success &= this->waitForMessages(fpga, frames.size());
+
+        if (this->countRequests(0x79) - bursts != frames.size()) {
+            Log().Get(ERROR) << "The frames weren't drained by single bursts!";
+            success = false;
+        }
+
+        for (uint32_t i=0; i<frames.size(); i++) {
+            if (!fpga.can->popReceivedMessage(message) || !this->equals(message, frames[i])) {
+                Log().Get(ERROR) << "Received message " << i << " is wrong!";
+                success = false;
+            }
+        }
+
+        if ((userCallbacks == 0) || fpga.can->popReceivedMessage(message)) {
+            Log().Get(ERROR) << "The registered callback wasn't invoked!";
+            success = false;
+        }
+
+        /* a full queue drops the newest messages */
+        for (uint32_t round=1; round<=2; round++) {
+            for (auto& frame : frames) {
+                model->injectFrame(frame);
+            }
+            success &= this->waitForMessages(fpga, round * frames.size());
+        }
+        model->injectFrame(frames[0]);
+        model->injectFrame(frames[2]);
+
+        timevalue until = getMonotonicTimeInNanos() + 2000000000;
+        while ((fpga.can->getNumberOfDroppedMessages() < 2) && (getMonotonicTimeInNanos() < until)) {
+            fpga.handleReplies();
+        }
+
+        CanMessage messages[16];
+        if ((fpga.can->getNumberOfDroppedMessages() != 2) ||
+            (fpga.can->popReceivedMessages(messages, 16) != 2 * frames.size()) ||
+            !this->equals(messages[7], frames[3])) {
+            Log().Get(ERROR) << "Overflowing messages weren't dropped!";
+            success = false;
+        }
+
+        /* the queue keeps receiving after a failed drain */
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 4);
+        model->injectFrame(frames[1]);
+        success &= this->waitForMessages(fpga, 1);
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 0);
+
+        if (!fpga.can->popReceivedMessage(message) || !this->equals(message, frames[1])) {
+            Log().Get(ERROR) << "The queue didn't recover from a failed drain!";
+            success = false;
+        }
+
+        /* a stopped queue leaves received frames in the receive buffer */
+        if (!fpga.can->stopReceiveQueue()) {
+            success = false;
+        }
+        model->injectFrame(frames[2]);
+        fpga.handleReplies();
+
+        canframe_ptr frame;
+        if ((fpga.can->getNumberOfQueuedMessages() != 0) ||
+            !fpga.can->getReceivedFrame(frame) || (frame->getIdentifier() != frames[2].identifier)) {
+            Log().Get(ERROR) << "The stopped queue still received frames!";
+            success = false;
+        }
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    CanReceiveQueueTest test;
+    return (uint32_t)test.runTest();
+}
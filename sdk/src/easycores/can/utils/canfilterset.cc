@@ -0,0 +1,154 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easycores/can/utils/canfilterset.h"
+#include "utils/log/log.h"
+
+const uint32_t CanFilterSet::MAX_EXPANDED_RANGE;
+
+CanFilterSet::CanFilterSet()
+{
+}
+
+CanFilterSet::~CanFilterSet()
+{
+}
+
+bool CanFilterSet::addIdentifier(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format)
+{
+    if (!CanFilterSet::isValid(identifier, format)) {
+        EASYFPGA_LOG(WARNING) << "Illegal CAN identifier: " << identifier;
+        return false;
+    }
+
+    _identifiers.insert(CanFilterSet::getKey(identifier, format));
+    return true;
+}
+
+bool CanFilterSet::addRange(uint32_t first, uint32_t last, CAN_MESSAGE_FORMAT_TYPE format)
+{
+    if ((first > last) || !CanFilterSet::isValid(last, format)) {
+        EASYFPGA_LOG(WARNING) << "Illegal CAN identifier range: " << first << " .. " << last;
+        return false;
+    }
+
+    if (last - first < MAX_EXPANDED_RANGE) {
+        for (uint32_t identifier=first; identifier<=last; identifier++) {
+            _identifiers.insert(CanFilterSet::getKey(identifier, format));
+        }
+    }
+    else {
+        Range range = { first, last, format };
+        _ranges.push_back(range);
+    }
+
+    return true;
+}
+
+void CanFilterSet::clear(void)
+{
+    _identifiers.clear();
+    _ranges.clear();
+}
+
+bool CanFilterSet::isEmpty(void) const
+{
+    return _identifiers.empty() && _ranges.empty();
+}
+
+bool CanFilterSet::contains(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format) const
+{
+    if (_identifiers.count(CanFilterSet::getKey(identifier, format)) > 0) {
+        return true;
+    }
+
+    for (auto& range : _ranges) {
+        if ((range.format == format) && (identifier >= range.first) && (identifier <= range.last)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool CanFilterSet::getAcceptanceFilter(bool extendedMode, uint32_t* code, uint32_t* mask) const
+{
+    bool covered = false;
+    *code = 0;
+    *mask = 0;
+
+    /* project an identifier range to the bits compared by the core */
+    auto project = [&](uint32_t first, uint32_t last, CAN_MESSAGE_FORMAT_TYPE format) {
+        if (!extendedMode) {
+            if (format == STANDARD_FRAME) {
+                CanFilterSet::cover(first >> 3, last >> 3, 0x00, &covered, code, mask);
+            }
+        }
+        else if (format == STANDARD_FRAME) {
+            CanFilterSet::cover(first << 18, last << 18, 0x0003FFFF, &covered, code, mask);
+        }
+        else {
+            CanFilterSet::cover(first, last, 0x00, &covered, code, mask);
+        }
+    };
+
+    for (uint32_t key : _identifiers) {
+        uint32_t identifier = key & 0x7FFFFFFF;
+        project(identifier, identifier, (key & 0x80000000) ? EXTENDED_FRAME : STANDARD_FRAME);
+    }
+
+    for (auto& range : _ranges) {
+        project(range.first, range.last, range.format);
+    }
+
+    return covered;
+}
+
+uint32_t CanFilterSet::getKey(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format)
+{
+    return (format == EXTENDED_FRAME) ? (identifier | 0x80000000) : identifier;
+}
+
+bool CanFilterSet::isValid(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format)
+{
+    return identifier <= ((format == EXTENDED_FRAME) ? (uint32_t)0x1FFFFFFF : (uint32_t)0x7FF);
+}
+
+void CanFilterSet::cover(uint32_t first, uint32_t last, uint32_t dontCare, bool* covered, uint32_t* code, uint32_t* mask)
+{
+    /* all bits below the highest one in which first and last differ vary */
+    uint32_t differing = first ^ last;
+    uint32_t varying = 0;
+    while (varying < differing) {
+        varying = (varying << 1) | 1;
+    }
+    varying |= dontCare;
+
+    if (!*covered) {
+        *mask = varying;
+        *covered = true;
+    }
+    else {
+        *mask |= varying | (*code ^ first);
+    }
+    *code = first & ~*mask;
+}
@@ -0,0 +1,130 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_EASYCORES_CAN_UTILS_CANFILTERSET_H_
+#define SDK_EASYCORES_CAN_UTILS_CANFILTERSET_H_
+
+#include "easycores/can/utils/types.h"
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * \brief A set of wanted CAN identifiers
+ *
+ * The acceptance filter of the CAN core consists of a single code and
+ * mask pair, so it can only accept identifiers matching one bit
+ * pattern. getAcceptanceFilter() computes the tightest pattern covering
+ * all wanted identifiers: a bit is only masked if two wanted
+ * identifiers differ in it. The frames accepted by the core although
+ * they aren't wanted are dropped on the host by contains(), which
+ * checks the identifiers exactly by a hash set.
+ *
+ * \see Can::setFilterSet()
+ */
+class CanFilterSet
+{
+    public:
+        /**
+         * \brief Ranges up to this number of identifiers are stored in
+         *        the hash set, longer ones are compared by their bounds.
+         */
+        static const uint32_t MAX_EXPANDED_RANGE = 256;
+
+        CanFilterSet();
+        ~CanFilterSet();
+
+        /**
+         * \brief Adds a single identifier.
+         *
+         * \return false if the identifier exceeds 11 (standard) or 29
+         *         (extended) bits
+         */
+        bool addIdentifier(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format = STANDARD_FRAME);
+
+        /**
+         * \brief Adds all identifiers from first to last (both included).
+         *
+         * \return false if the range is empty or exceeds 11 (standard)
+         *         or 29 (extended) bits
+         */
+        bool addRange(uint32_t first, uint32_t last, CAN_MESSAGE_FORMAT_TYPE format = STANDARD_FRAME);
+
+        /**
+         * \brief Removes all identifiers.
+         */
+        void clear(void);
+
+        /**
+         * \brief Returns true if no identifier was added.
+         */
+        bool isEmpty(void) const;
+
+        /**
+         * \brief Checks exactly whether an identifier is wanted.
+         */
+        bool contains(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format) const;
+
+        /**
+         * \brief Computes the tightest acceptance code and mask covering
+         *        all wanted identifiers, in the format expected by
+         *        Can::setAcceptanceCode() and Can::setAcceptanceMask().
+         *
+         * In basic mode, the eight most significant bits of standard
+         * identifiers are covered, extended identifiers are ignored. In
+         * extended mode, extended identifiers are covered by all 29 bits
+         * and standard identifiers by their position in the bits 28 to
+         * 18. As the core compares the remaining bits of standard frames
+         * with the data bytes, these are masked then.
+         *
+         * \param extendedMode Whether the core works in extended mode.
+         *
+         * \param code Location for the acceptance code.
+         *
+         * \param mask Location for the acceptance mask.
+         *
+         * \return false if there is no identifier the core can receive
+         *         in this mode
+         */
+        bool getAcceptanceFilter(bool extendedMode, uint32_t* code, uint32_t* mask) const;
+
+    private:
+        struct Range {
+            uint32_t first;
+            uint32_t last;
+            CAN_MESSAGE_FORMAT_TYPE format;
+        };
+
+        /* hash set key, the format is stored in bit 31 */
+        static uint32_t getKey(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format);
+
+        static bool isValid(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format);
+
+        /* widens code and mask so that the pattern also covers first .. last */
+        static void cover(uint32_t first, uint32_t last, uint32_t dontCare, bool* covered, uint32_t* code, uint32_t* mask);
+
+        std::unordered_set<uint32_t> _identifiers;
+        std::vector<Range> _ranges;
+};
+
+#endif  // SDK_EASYCORES_CAN_UTILS_CANFILTERSET_H_
@@ -25,7 +25,7 @@ CanFrameExtended::CanFrameExtended(uint32_t identifier) :
 }
 
 CanFrameExtended::CanFrameExtended(uint32_t identifier, byte* dataToCopy, uint8_t length) :
-    CanFrame(identifier, CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME)
+    CanFrame(identifier, dataToCopy, length, CAN_MESSAGE_FORMAT_TYPE::EXTENDED_FRAME)
 {
     /* BUILD THE FRAME INFORMATION FIELD */
     _frameInformation = _dataLength & 0x0F;
@@ -21,7 +21,7 @@ CanFrameStandard::CanFrameStandard(uint32_t identifier) :
 }
 
 CanFrameStandard::CanFrameStandard(uint32_t identifier, byte* dataToCopy, uint8_t length) :
-    CanFrame(identifier, CAN_MESSAGE_FORMAT_TYPE::STANDARD_FRAME)
+    CanFrame(identifier, dataToCopy, length, CAN_MESSAGE_FORMAT_TYPE::STANDARD_FRAME)
 {
     /* BUILD THE FRAME INFORMATION FIELD */
     _frameInformation = _dataLength & 0x0F;
@@ -0,0 +1,191 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_EASYCORES_CAN_UTILS_CANMESSAGE_H_
+#define SDK_EASYCORES_CAN_UTILS_CANMESSAGE_H_
+
+#include "easycores/can/utils/types.h"
+#include "utils/hardwaretypes.h"
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * \brief A can message stored by value.
+ *
+ * Unlike CanFrame, a message holds its payload inline and needs neither
+ * a heap allocation nor a shared pointer. It is trivially copyable, so
+ * messages can be stored contiguously, e.g. in a std::vector passed to
+ * Can::transmit() or Can::getReceivedFrames(), or be copied into
+ * preallocated queues (see Can::startReceiveQueue()).
+ *
+ * The frame information field and the descriptor bytes are computed by
+ * constexpr methods, so messages known at compile time can be encoded
+ * at compile time:
+ *
+ * \code
+ * static constexpr byte payload[2] = { 0x01, 0x00 };
+ * static constexpr CanMessage start(0x000, payload, 2, STANDARD_FRAME);
+ * static_assert(start.getDescriptor(1) == 0x02, "DLC in descriptor");
+ * \endcode
+ */
+struct CanMessage {
+    /**
+     * \brief Bits of the flags field
+     */
+    enum FLAG : byte {
+        /**
+         * The identifier has the extended (29 bit) format.
+         */
+        EXTENDED = 0x01,
+
+        /**
+         * The message is a remote transfer request.
+         */
+        REMOTE = 0x02
+    };
+
+    /**
+     * \brief Constructs an empty standard data message with identifier 0.
+     */
+    constexpr CanMessage() :
+        identifier(0),
+        flags(0),
+        length(0),
+        data{0, 0, 0, 0, 0, 0, 0, 0}
+    {
+    }
+
+    /**
+     * \brief Constructs a remote transfer request
+     */
+    constexpr CanMessage(uint32_t identifier, CAN_MESSAGE_FORMAT_TYPE format) :
+        identifier(identifier),
+        flags((byte)(FLAG::REMOTE | ((format == EXTENDED_FRAME) ? FLAG::EXTENDED : 0))),
+        length(0),
+        data{0, 0, 0, 0, 0, 0, 0, 0}
+    {
+    }
+
+    /**
+     * \brief Constructs a data message. The first length bytes (at most
+     *        8) of dataToCopy are copied.
+     */
+    constexpr CanMessage(uint32_t identifier, const byte* dataToCopy, uint8_t length, CAN_MESSAGE_FORMAT_TYPE format) :
+        identifier(identifier),
+        flags((byte)((format == EXTENDED_FRAME) ? FLAG::EXTENDED : 0)),
+        length((length > 8) ? 8 : length),
+        data{
+            byteAt(dataToCopy, length, 0), byteAt(dataToCopy, length, 1),
+            byteAt(dataToCopy, length, 2), byteAt(dataToCopy, length, 3),
+            byteAt(dataToCopy, length, 4), byteAt(dataToCopy, length, 5),
+            byteAt(dataToCopy, length, 6), byteAt(dataToCopy, length, 7)
+        }
+    {
+    }
+
+    /**
+     * \brief Returns the frame message type.
+     */
+    constexpr CAN_MESSAGE_FORMAT_TYPE getMessageType(void) const
+    {
+        return (flags & FLAG::EXTENDED) ? EXTENDED_FRAME : STANDARD_FRAME;
+    }
+
+    /**
+     * \brief Returns the request type.
+     */
+    constexpr bool isRemoteTransferRequest(void) const
+    {
+        return ((flags & FLAG::REMOTE) != 0);
+    }
+
+    /**
+     * \brief Returns the frame information field of the extended usage
+     *        mode: FF, RTR and the data length code.
+     */
+    constexpr byte getFrameInformation(void) const
+    {
+        return (byte)(((flags & FLAG::EXTENDED) ? 0x80 : 0x00) |
+                      ((flags & FLAG::REMOTE) ? 0x40 : 0x00) |
+                      (length & 0x0F));
+    }
+
+    /**
+     * \brief Returns the descriptor length, 2 for standard and 4 for
+     *        extended messages.
+     */
+    constexpr uint8_t getDescriptorLength(void) const
+    {
+        return (flags & FLAG::EXTENDED) ? 4 : 2;
+    }
+
+    /**
+     * \brief Returns a byte of the descriptor like CanFrame::getDescriptor()
+     *        does: the identifier bits, the RTR bit and for standard
+     *        messages the data length code.
+     *
+     * \param index 0 .. getDescriptorLength()-1
+     */
+    constexpr byte getDescriptor(uint8_t index) const
+    {
+        return (flags & FLAG::EXTENDED) ?
+            ((index == 0) ? (byte)((identifier & 0x1FE00000) >> 21) :
+             (index == 1) ? (byte)((identifier & 0x001FE000) >> 13) :
+             (index == 2) ? (byte)((identifier & 0x00001FE0) >> 5) :
+                            (byte)(((identifier & 0x0000001F) << 3) | ((flags & FLAG::REMOTE) ? 0x04 : 0x00))) :
+            ((index == 0) ? (byte)((identifier & 0x000007F8) >> 3) :
+                            (byte)(((identifier & 0x00000007) << 5) | ((flags & FLAG::REMOTE) ? 0x10 : 0x00) | (length & 0x0F)));
+    }
+
+    /**
+     * \brief The 11 or 29 bit identifier.
+     */
+    uint32_t identifier;
+
+    /**
+     * \brief A combination of FLAG bits.
+     */
+    byte flags;
+
+    /**
+     * \brief The number of valid bytes in data (0 .. 8), 0 for remote
+     *        transfer requests.
+     */
+    uint8_t length;
+
+    /**
+     * \brief The payload.
+     */
+    byte data[8];
+
+    private:
+        static constexpr byte byteAt(const byte* source, uint8_t length, uint8_t index)
+        {
+            return (index < length) ? source[index] : (byte)0x00;
+        }
+};
+
+static_assert(std::is_trivially_copyable<CanMessage>::value, "CanMessage has to be trivially copyable.");
+static_assert(sizeof(CanMessage) == 16, "CanMessage has to be 16 bytes large.");
+
+#endif  // SDK_EASYCORES_CAN_UTILS_CANMESSAGE_H_
@@ -182,11 +182,14 @@ class EasyCore
          * \brief Calls the interrupt service routine assigned by the
          *        registerCallback() method.
          *
+         * Cores which handle some of their interrupts themselves (e.g.
+         * Uart::startReceiveStream()) override this method.
+         *
          * \return true if interrupt service routine could be executed
          *         successfully,<br>
          *         false otherwise (e.g. if no pointer assigned before)
          */
-        bool executeCallback(void);
+        virtual bool executeCallback(void);
 
     protected:
         /**
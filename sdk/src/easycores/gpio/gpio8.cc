@@ -407,7 +407,7 @@ bool Gpio8::identifyInterruptingPins(std::list<PIN>& pins)
 
         /** \todo Support async mode */
         case OPERATION_MODE::ASYNC:
-            Log().Get(WARNING) << "Async mode not yet supported. Aborting ...";
+            EASYFPGA_LOG(WARNING) << "Async mode not yet supported. Aborting ...";
             return false;
     }
 
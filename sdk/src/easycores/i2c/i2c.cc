@@ -94,7 +94,7 @@ bool I2C::init(CLOCK_SPEED speed)
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The speed parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The speed parameter is not valid.";
             return false;
     }
 
@@ -118,7 +118,7 @@ bool I2C::transfer(byte data, bool write, uint8_t start, bool nack, byte* reply)
 {
     /* PARAMETER CHECK */
     if (write && nack) {
-        Log().Get(WARNING) << "Nack can only be asserted in read transmissions! Abort transfer...";
+        EASYFPGA_LOG(WARNING) << "Nack can only be asserted in read transmissions! Abort transfer...";
         return false;
     }
 
@@ -182,11 +182,11 @@ bool I2C::writeByte(uint8_t deviceAddress, uint8_t registerAddress, byte data)
 {
     /* PARAMETER CHECK */
     if ((deviceAddress < 0) || (deviceAddress > 127)) {
-        Log().Get(WARNING) << "Device address out of range [0, 127]. Abort write...";
+        EASYFPGA_LOG(WARNING) << "Device address out of range [0, 127]. Abort write...";
         return false;
     }
     if ((registerAddress < 0) || (registerAddress > 255)) {
-        Log().Get(WARNING) << "Register address out of range [0, 255]. Abort write...";
+        EASYFPGA_LOG(WARNING) << "Register address out of range [0, 255]. Abort write...";
         return false;
     }
 
@@ -208,7 +208,7 @@ bool I2C::writeByte(uint8_t deviceAddress, uint8_t registerAddress, byte data)
 
     /* Check if no NACK received while transmission. */
     if ((ack0 != 0x01) || (ack1 != 0x01) || (ack2 != 0x01)) {
-        Log().Get(WARNING) << "NACK during write byte operation";
+        EASYFPGA_LOG(WARNING) << "NACK during write byte operation";
         return false;
     }
 
@@ -219,11 +219,11 @@ bool I2C::readByte(uint8_t deviceAddress, uint8_t registerAddress, byte* data)
 {
     /* PARAMETER CHECK */
     if ((deviceAddress < 0) || (deviceAddress > 127)) {
-        Log().Get(WARNING) << "Device address out of range [0, 127]. Abort read...";
+        EASYFPGA_LOG(WARNING) << "Device address out of range [0, 127]. Abort read...";
         return false;
     }
     if ((registerAddress < 0) || (registerAddress > 255)) {
-        Log().Get(WARNING) << "Register address out of range [0, 255]. Abort read...";
+        EASYFPGA_LOG(WARNING) << "Register address out of range [0, 255]. Abort read...";
         return false;
     }
 
@@ -249,7 +249,7 @@ bool I2C::readByte(uint8_t deviceAddress, uint8_t registerAddress, byte* data)
 
     /* Check if no NACK received while transmission. */
     if ((ack0 != 0x01) || (ack1 != 0x01) || (ack2 != 0x01)) {
-        Log().Get(WARNING) << "NACK during read byte operation";
+        EASYFPGA_LOG(WARNING) << "NACK during read byte operation";
         return false;
     }
 
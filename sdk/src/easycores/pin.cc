@@ -98,12 +98,12 @@ bool Pin::isBackwardConnected(void)
 bool Pin::connectTo(pin_ptr pin)
 {
     if (pin == shared_from_this()) {
-        Log().Get(WARNING) << "Connecting the pin " << this->getLogName() << " with itself does not have any effect. This instruction will be ignored.";
+        EASYFPGA_LOG(WARNING) << "Connecting the pin " << this->getLogName() << " with itself does not have any effect. This instruction will be ignored.";
         return false;
     }
 
     if (this->isBackwardConnectedTo(pin) || pin->isBackwardConnectedTo(shared_from_this())) {
-        Log().Get(WARNING) << "The two pins " << this->getLogName() << " and " << pin->getLogName() << " are already connected. This line will be skipped.";
+        EASYFPGA_LOG(WARNING) << "The two pins " << this->getLogName() << " and " << pin->getLogName() << " are already connected. This line will be skipped.";
         return false;
     }
 
@@ -112,7 +112,7 @@ bool Pin::connectTo(pin_ptr pin)
             pin_ptr backwardConnection = _backwardConnection;
             while (backwardConnection->hasType(PIN_DIRECTION_TYPE::UNDEFINED) || backwardConnection->hasType(PIN_DIRECTION_TYPE::IN)) {
                 if (pin->hasType(PIN_DIRECTION_TYPE::IN)) {
-                    Log().Get(ERROR) << "The input pin " << pin->getLogName() << " from core " << (uint32_t)*(pin->getCoreIndex()) << " can't be driven from multiple GPIO pins or pins of type OUT. Maximum one is acceptable.";
+                    EASYFPGA_LOG(ERROR) << "The input pin " << pin->getLogName() << " from core " << (uint32_t)*(pin->getCoreIndex()) << " can't be driven from multiple GPIO pins or pins of type OUT. Maximum one is acceptable.";
                     exit(-1);
                 }
 
@@ -126,7 +126,7 @@ bool Pin::connectTo(pin_ptr pin)
                 }
             }
 
-            Log().Get(ERROR) << "Pin " << this->getLogName() << " is already connected to " << _backwardConnection->getLogName() << ". So we can't connect this one to pin " << pin->getLogName() << "! (We would connect 2 output pins together.)";
+            EASYFPGA_LOG(ERROR) << "Pin " << this->getLogName() << " is already connected to " << _backwardConnection->getLogName() << ". So we can't connect this one to pin " << pin->getLogName() << "! (We would connect 2 output pins together.)";
             exit(-1);
         }
         else {
@@ -136,7 +136,7 @@ bool Pin::connectTo(pin_ptr pin)
         }
     }
     else {
-        Log().Get(ERROR) << "The pin instance is invalid to which the pin " << this->getLogName() << " should be connected.";
+        EASYFPGA_LOG(ERROR) << "The pin instance is invalid to which the pin " << this->getLogName() << " should be connected.";
         exit(-1);
     }
 
@@ -125,7 +125,7 @@ bool Pwm16::getDutyCycle(uint16_t* cycle)
 
     /* PERFORM AN ACTION DEPENDING ON MODE */
     /** \todo Implement this function */
-    Log().Get(WARNING) << "getDutyCycle(uint16_t*) is not yet implemented. Aborting ...";
+    EASYFPGA_LOG(WARNING) << "getDutyCycle(uint16_t*) is not yet implemented. Aborting ...";
     return false;
 }
 
@@ -135,6 +135,6 @@ bool Pwm16::getDutyCycle(float* percentage)
 
     /* PERFORM AN ACTION DEPENDING ON MODE */
     /** \todo Implement this function */
-    Log().Get(WARNING) << "getDutyCycle(float*) is not yet implemented. Aborting ...";
+    EASYFPGA_LOG(WARNING) << "getDutyCycle(float*) is not yet implemented. Aborting ...";
     return false;
 }
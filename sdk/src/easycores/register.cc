@@ -21,10 +21,13 @@
 
 #include "configuration.h" /* assert(1) */
 #include "communication/communicator.h"
+#include "communication/protocol/specification.h" /* MAX_MULTI_REGISTER_LENGTH */
+#include "easycores/callbacks/register_burst.h"
 #include "easycores/register.h"
 #include "easycores/easycore.h"
 #include "utils/log/log.h"
 
+#include <algorithm> /* min(2) */
 #include <bitset>
 
 Register::Register(EasyCore* core, byte address, REGISTER_ACCESS_TYPE type) :
@@ -136,13 +139,12 @@ bool Register::readAsync(byte* target, callback_ptr callback)
     }
 }
 
-/*
 bool Register::readMultiTimesAsync(byte* target, uint8_t number)
 {
     assert(_core!=NULL);
     assert(_core->getCommunicator()!=nullptr);
 
-    return false;
+    return _core->getCommunicator()->readMultiRegisterAsync(target, _core->getIndex(), _address, number, _dependency);
 }
 
 bool Register::readMultiTimesAsync(byte* target, uint8_t number, callback_ptr callback)
@@ -150,7 +152,15 @@ bool Register::readMultiTimesAsync(byte* target, uint8_t number, callback_ptr ca
     assert(_core!=NULL);
     assert(_core->getCommunicator()!=nullptr);
 
-    return false;
+    auto dependency = _core->getCommunicator()->readMultiRegisterAsync(target, _core->getIndex(), _address, number, callback, _dependency);
+
+    if (dependency > 0) {
+        _dependency = dependency;
+        return true;
+    }
+    else {
+        return false;
+    }
 }
 
 bool Register::readAutoAddressIncrementAsync(byte* target, uint8_t number)
@@ -158,7 +168,7 @@ bool Register::readAutoAddressIncrementAsync(byte* target, uint8_t number)
     assert(_core!=NULL);
     assert(_core->getCommunicator()!=nullptr);
 
-    return false;
+    return _core->getCommunicator()->readAutoAdressIncrementRegisterAsync(target, _core->getIndex(), _address, number, _dependency);
 }
 
 bool Register::readAutoAddressIncrementAsync(byte* target, uint8_t number, callback_ptr callback)
@@ -166,9 +176,16 @@ bool Register::readAutoAddressIncrementAsync(byte* target, uint8_t number, callb
     assert(_core!=NULL);
     assert(_core->getCommunicator()!=nullptr);
 
-    return false;
+    auto dependency = _core->getCommunicator()->readAutoAdressIncrementRegisterAsync(target, _core->getIndex(), _address, number, callback, _dependency);
+
+    if (dependency > 0) {
+        _dependency = dependency;
+        return true;
+    }
+    else {
+        return false;
+    }
 }
-*/
 
 bool Register::writeAsync(byte content)
 {
@@ -207,15 +224,21 @@ bool Register::writeMultiTimesAsync(byte* content, uint8_t number)
     return _core->getCommunicator()->writeMultiRegisterAsync(content, _core->getIndex(), _address, number, _dependency);
 }
 
-/*
 bool Register::writeMultiTimesAsync(byte* content, uint8_t number, callback_ptr callback)
 {
     assert(_core!=NULL);
     assert(_core->getCommunicator()!=nullptr);
 
-    return _core->getCommunicator()->writeMultiRegisterAsync(content, _core->getIndex(), _address, number, callback, _dependency);
+    auto dependency = _core->getCommunicator()->writeMultiRegisterAsync(content, _core->getIndex(), _address, number, callback, _dependency);
+
+    if (dependency > 0) {
+        _dependency = dependency;
+        return true;
+    }
+    else {
+        return false;
+    }
 }
-*/
 
 bool Register::writeAutoAddressIncrementAsync(byte* content, uint8_t number)
 {
@@ -225,12 +248,105 @@ bool Register::writeAutoAddressIncrementAsync(byte* content, uint8_t number)
     return _core->getCommunicator()->writeAutoAdressIncrementRegisterAsync(content, _core->getIndex(), _address, number, _dependency);
 }
 
-/*
 bool Register::writeAutoAddressIncrementAsync(byte* content, uint8_t number, callback_ptr callback)
 {
     assert(_core!=NULL);
     assert(_core->getCommunicator()!=nullptr);
 
-    return _core->getCommunicator()->writeAutoAdressIncrementRegisterAsync(content, _core->getIndex(), _address, number, callback, callback);
+    auto dependency = _core->getCommunicator()->writeAutoAdressIncrementRegisterAsync(content, _core->getIndex(), _address, number, callback, _dependency);
+
+    if (dependency > 0) {
+        _dependency = dependency;
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+bool Register::readBurstSync(byte* target, uint32_t length)
+{
+    assert(_core!=NULL);
+    assert(_core->getCommunicator()!=nullptr);
+
+    /* the already sent chunks are awaited even if a send failed */
+    _core->getCommunicator()->beginRequestBatch();
+    bool success = this->readBurstAsync(target, length, nullptr);
+    success &= _core->getCommunicator()->finishRequestBatch();
+
+    return success;
+}
+
+bool Register::readBurstAsync(byte* target, uint32_t length, callback_ptr callback)
+{
+    return this->startBurst(target, length, false, callback);
+}
+
+bool Register::writeBurstSync(byte* content, uint32_t length)
+{
+    assert(_core!=NULL);
+    assert(_core->getCommunicator()!=nullptr);
+
+    _core->getCommunicator()->beginRequestBatch();
+    bool success = this->writeBurstAsync(content, length, nullptr);
+    success &= _core->getCommunicator()->finishRequestBatch();
+
+    return success;
+}
+
+bool Register::writeBurstAsync(byte* content, uint32_t length, callback_ptr callback)
+{
+    return this->startBurst(content, length, true, callback);
+}
+
+bool Register::startBurst(byte* data, uint32_t length, bool write, callback_ptr callback)
+{
+    assert(_core!=NULL);
+    assert(_core->getCommunicator()!=nullptr);
+
+    if (length == 0) {
+        EASYFPGA_LOG(ERROR) << "A register burst needs at least one byte!";
+        return false;
+    }
+
+    uint32_t chunks = (length + MAX_MULTI_REGISTER_LENGTH - 1) / MAX_MULTI_REGISTER_LENGTH;
+    std::shared_ptr<RegisterBurstState> state = std::make_shared<RegisterBurstState>();
+    state->outstandingChunks = chunks;
+    state->failed = false;
+
+    /*
+     * All chunks depend on the previous access of this register only,
+     * not on each other. So they are pipelined instead of waiting for
+     * the reply of the preceding chunk. If they have to be retained,
+     * they are released together in order.
+     */
+    tasknumberval dependency = _dependency;
+    communicator_ptr com = _core->getCommunicator();
+
+    for (uint32_t offset=0; offset<length; offset+=MAX_MULTI_REGISTER_LENGTH) {
+        uint8_t chunkLength = (uint8_t)std::min(length - offset, MAX_MULTI_REGISTER_LENGTH);
+        callback_ptr c = (callback != nullptr) ? std::make_shared<RegisterBurstCallback>(state, callback) : nullptr;
+
+        tasknumberval number;
+        if (write) {
+            number = com->writeMultiRegisterAsync(data+offset, _core->getIndex(), _address, chunkLength, c, dependency);
+        }
+        else {
+            number = com->readMultiRegisterAsync(data+offset, _core->getIndex(), _address, chunkLength, c, dependency);
+        }
+
+        if (number == 0) {
+            uint32_t started = offset / MAX_MULTI_REGISTER_LENGTH;
+            EASYFPGA_LOG(ERROR) << "Chunk " << started + 1 << "/" << chunks << " of a register burst couldn't be started!";
+
+            /* the chunks already started complete the burst as failed */
+            state->failed = true;
+            RegisterBurstCallback::complete(state, chunks - started, callback);
+            return false;
+        }
+
+        _dependency = number;
+    }
+
+    return true;
 }
-*/
@@ -260,7 +260,88 @@ class Register
          */
         bool writeAutoAddressIncrementAsync(byte* content, uint8_t number, callback_ptr callback);
 
+        /**
+         * \brief Reads the register length times, e.g. for draining a
+         *        FIFO.
+         *
+         * The burst is split into multiple times read exchanges of at
+         * most MAX_MULTI_REGISTER_LENGTH bytes, which are pipelined
+         * asynchronously. Returns after all of them are answered. The
+         * results of other outstanding asynchronous requests are left
+         * for EasyFpga::handleReplies().
+         *
+         * \param target Memory for length bytes.
+         *
+         * \param length Number of reads, at least 1.
+         *
+         * \return true if all exchanges could be completed successfully
+         *         and valid answers are available,<br>
+         *         false otherwise
+         */
+        bool readBurstSync(byte* target, uint32_t length);
+
+        /**
+         * \brief Reads the register length times asynchronous, e.g. for
+         *        draining a FIFO.
+         *
+         * The burst is split into multiple times read exchanges of at
+         * most MAX_MULTI_REGISTER_LENGTH bytes. All of them are sent
+         * right away (as far as the in-flight window allows it) and are
+         * executed by the easyFPGA in order.
+         *
+         * \param target Memory for length bytes. It contains the answer
+         *        when the callback is executed or after the call of
+         *        handleRequestReplies().
+         *
+         * \param length Number of reads, at least 1.
+         *
+         * \param callback Executed once after the replies to all
+         *        exchanges of the burst arrived or an exchange failed
+         *        permanently. In the latter case its fail() is executed
+         *        first, so hasFailed() returns true. May be nullptr.
+         *
+         * \return true if the requests could be successfully sent to the
+         *         easyFPGA board (not more!),<br>
+         *         false otherwise
+         */
+        bool readBurstAsync(byte* target, uint32_t length, callback_ptr callback);
+
+        /**
+         * \brief Writes the register length times, e.g. for filling a
+         *        FIFO.
+         *
+         * The burst is split like the one of readBurstSync().
+         *
+         * \return true if all exchanges could be completed successfully,<br>
+         *         false otherwise
+         */
+        bool writeBurstSync(byte* content, uint32_t length);
+
+        /**
+         * \brief Writes the register length times asynchronous, e.g. for
+         *        filling a FIFO.
+         *
+         * The burst is split like the one of readBurstAsync(). The
+         * content has to stay valid until the callback is executed or
+         * handleRequestReplies() returned.
+         *
+         * \param callback Executed once after the replies to all
+         *        exchanges of the burst arrived or an exchange failed
+         *        permanently. In the latter case its fail() is executed
+         *        first, so hasFailed() returns true. May be nullptr.
+         *
+         * \return true if the requests could be successfully sent to the
+         *         easyFPGA board (not more!),<br>
+         *         false otherwise
+         */
+        bool writeBurstAsync(byte* content, uint32_t length, callback_ptr callback);
+
     protected:
+        /**
+         * \brief Starts the chunks of a read or write burst.
+         */
+        bool startBurst(byte* data, uint32_t length, bool write, callback_ptr callback);
+
         /**
          * \brief Stores a reference to the parental easyCore.
          */
@@ -0,0 +1,121 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/spi/spi.h"
+#include "easyfpga/easycores/spi/spi_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedspi.h"
+#include "easyfpga/utils/benchmark/benchmark.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+
+#include <memory>
+#include <string>
+
+static const uint32_t TRANSFER_LENGTH = 1024;
+
+class SpiFpga : public EasyFpga
+{
+    public:
+        SpiFpga() :
+            spi(std::make_shared<Spi>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(spi);
+        }
+
+        spi_ptr spi;
+};
+
+/**
+ * \brief Measures the bytes per second of the Spi core
+ *
+ * A byte array is read like from an SPI flash, byte by byte by
+ * Spi::receive() and at once by Spi::transfer(). The board is simulated
+ * without latency and then with the serial line's delay at 3 Mbaud. The
+ * simulated spi core shifts out the bytes immediately.
+ */
+class SpiTransferBenchmark : public Benchmark
+{
+    std::string benchmarkName(void) {
+        return "spi transfer benchmark";
+    }
+
+    bool measureCases(spi_ptr spi, std::shared_ptr<SimulatedSpi> model, std::string suffix) {
+        static byte buffer[TRANSFER_LENGTH];
+
+        bool success = true;
+
+        success &= this->measure("receive_bytewise" + suffix, TRANSFER_LENGTH, TRANSFER_LENGTH, [spi, model] {
+            bool success = true;
+            for (uint32_t i=0; i<TRANSFER_LENGTH; i++) {
+                success &= spi->receive(buffer+i);
+            }
+            model->takeTransmittedBytes();
+            return success;
+        });
+        success &= this->measure("transfer" + suffix, 1, TRANSFER_LENGTH, [spi, model] {
+            bool success = spi->transfer(NULL, buffer, TRANSFER_LENGTH);
+            model->takeTransmittedBytes();
+            return success;
+        });
+
+        return success;
+    }
+
+    bool benchmarkMethod(void) {
+        auto model = std::make_shared<SimulatedSpi>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        SpiFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            EASYFPGA_LOG(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        spi_ptr spi = fpga.spi;
+        if (!spi->init(Spi::SPI_MODE::MODE_0, Spi::CLOCK_SPEED::SCK_20_MHZ)) {
+            EASYFPGA_LOG(ERROR) << "Couldn't initialize the spi core!";
+            return false;
+        }
+
+        bool success = this->measureCases(spi, model, "");
+
+        board.setLatency(0, 3000000);
+        success &= this->measureCases(spi, model, "_3mbaud");
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    SpiTransferBenchmark benchmark;
+    return benchmark.runBenchmark(argc, argv);
+}
@@ -20,15 +20,22 @@
  */
 
 #include "easycores/spi/spi.h"
+#include "communication/communicator.h"
+#include "configuration.h" /* SPI_PIPELINED_CHUNK_DURATION, WISHBONE_CLOCK_FREQUENCY */
 #include "easycores/pin.h"
 #include "easycores/register.h"
 #include "utils/log/log.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
+const uint32_t Spi::FIFO_DEPTH;
+
 Spi::Spi() :
     EasyCore(UNIQUE_CORE_NUMBER),
-    _transmittedOnly(0)
+    _transmittedOnly(0),
+    _clockSpeed(CLOCK_SPEED::SCK_40_MHZ)
 {
     _pinMap.insert(std::make_pair(PIN::SCK, std::make_shared<Pin>("sck_out", &_index, PIN::SCK, PIN_DIRECTION_TYPE::OUT)));
     _pinMap.insert(std::make_pair(PIN::MOSI, std::make_shared<Pin>("mosi_out", &_index, PIN::MOSI, PIN_DIRECTION_TYPE::OUT)));
@@ -105,7 +112,7 @@ bool Spi::init(SPI_MODE mode, CLOCK_SPEED speed)
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The mode parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The mode parameter is not valid.";
             return false;
     }
 
@@ -215,7 +222,7 @@ bool Spi::init(SPI_MODE mode, CLOCK_SPEED speed)
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The speed parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The speed parameter is not valid.";
             return false;
     }
 
@@ -240,11 +247,14 @@ bool Spi::init(SPI_MODE mode, CLOCK_SPEED speed)
             /* Enables core */
             success &= this->enableCore();
 
+            if (success) {
+                _clockSpeed = speed;
+            }
             return success;
 
         /** \todo Support async mode */
         case OPERATION_MODE::ASYNC:
-            Log().Get(WARNING) << "Async mode not yet supported. Aborting ...";
+            EASYFPGA_LOG(WARNING) << "Async mode not yet supported. Aborting ...";
             return false;
     }
 
@@ -256,54 +266,9 @@ bool Spi::transceive(byte txData, byte* rxData)
     /* PARAMETER CHECK */
 
     /* PERFORM AN ACTION DEPENDING ON MODE */
-    byte readDontCare = (byte)0x00;
-    byte spsr = (byte)0x00;
-    uint8_t dummyReads;
-
-    switch(_OPERATION_MODE) {
-        case OPERATION_MODE::SYNC:
-            /* Perform dummy reads if necessary */
-            dummyReads = _transmittedOnly%4;
-            if (dummyReads > 0) {
-                for (uint8_t i = 0; i < dummyReads; i++) {
-                    if (!this->getRegister(REGISTER::SPDR)->readSync(&readDontCare)) {
-                        return false;
-                    }
-                }
-            }
-
-            /* Receive FIFO will now be aligned */
-            _transmittedOnly = 0;
-
-            /* Transmit */
-            if (!this->getRegister(REGISTER::SPDR)->writeSync(txData)) {
-                return false;
-            }
-
-            /* Wait until read FIFO is not empty */
-            if (!this->getRegister(REGISTER::SPSR)->readSync(&spsr)) {
-                return false;
-            }
-            while (setBitTest(spsr, 0)) {
-                if (!this->getRegister(REGISTER::SPSR)->readSync(&spsr)) {
-                    return false;
-                }
-                usleep(10);
-            }
-
-            /* Read from receive FIFO */
-            if (!this->getRegister(REGISTER::SPDR)->readSync(rxData)) {
-                return false;
-            }
-            return true;
-
-        /** \todo Support async mode */
-        case OPERATION_MODE::ASYNC:
-            Log().Get(WARNING) << "Async mode not yet supported. Aborting ...";
-            return false;
-    }
-
-    return false;
+    /* A single byte is a transfer needing one round trip */
+    /** \todo Support async mode */
+    return this->transfer(&txData, rxData, 1);
 }
 
 bool Spi::transmit(byte txData)
@@ -324,7 +289,7 @@ bool Spi::transmit(byte txData)
 
         /** \todo Support async mode */
         case OPERATION_MODE::ASYNC:
-            Log().Get(WARNING) << "Async mode not yet supported. Aborting ...";
+            EASYFPGA_LOG(WARNING) << "Async mode not yet supported. Aborting ...";
             return false;
     }
 
@@ -336,33 +301,86 @@ bool Spi::transmit(byte* txData, uint8_t length)
     /* PARAMETER CHECK */
 
     /* PERFORM AN ACTION DEPENDING ON MODE */
-    uint8_t transmitted = 0;
+    /* Reading the received bytes costs no additional round trip */
+    /** \todo Support async mode */
+    return this->transfer(txData, NULL, length);
+}
+
+bool Spi::transfer(const byte* txData, byte* rxData, uint32_t length)
+{
+    /* PARAMETER CHECK */
+    if (length == 0) {
+        return true;
+    }
+
+    /* PERFORM AN ACTION DEPENDING ON MODE */
+    byte dummyBytes[FIFO_DEPTH];
+    byte discarded[FIFO_DEPTH];
+    byte spsr = (byte)0x00;
+    uint8_t dummyReads;
+    bool success = true;
 
     switch(_OPERATION_MODE) {
         case OPERATION_MODE::SYNC:
+            memset(dummyBytes, 0x00, FIFO_DEPTH);
+            _communicator->beginRequestBatch();
 
-            while(transmitted < length) {
+            /* Perform dummy reads if necessary */
+            dummyReads = _transmittedOnly%FIFO_DEPTH;
+            if (dummyReads > 0) {
+                success &= this->getRegister(REGISTER::SPDR)->readMultiTimesAsync(discarded, dummyReads);
+            }
 
-                /* Wait until write fifo is empty */
-                while (!isWriteFifoEmpty()) {
-                    usleep(10);
-                }
+            /* Receive FIFO will now be aligned */
+            _transmittedOnly = 0;
 
-                /* Transmit four bytes (FIFO length) */
-                byte packet[4];
-                std::copy(txData+transmitted, txData+transmitted+4, packet);
-                if (!this->getRegister(REGISTER::SPDR)->writeMultiTimesSync(packet, 4)) {
-                    Log().Get(WARNING) << "Failed to transmit four byte packet";
-                    return false;
+            /*
+             * Write and read chunk by chunk without waiting for replies.
+             * The soc handles the exchanges in order, thus the write
+             * FIFO is empty again when the next chunk arrives.
+             */
+            for (uint32_t offset = 0; success && (offset < length); offset += FIFO_DEPTH) {
+                uint8_t chunk = (uint8_t)std::min(length - offset, FIFO_DEPTH);
+
+                /* the exchange copies the bytes into its request */
+                byte* tx = (txData != NULL) ? const_cast<byte*>(txData + offset) : dummyBytes;
+                byte* rx = (rxData != NULL) ? rxData + offset : discarded;
+
+                success &= this->getRegister(REGISTER::SPDR)->writeMultiTimesAsync(tx, chunk);
+
+                /*
+                 * At slow clocks the write has to reach the soc before
+                 * waiting for the shift, it would stay in the send
+                 * buffer together with the read otherwise.
+                 */
+                uint32_t shiftDuration = this->getShiftDuration(chunk);
+                if (shiftDuration > SPI_PIPELINED_CHUNK_DURATION) {
+                    success &= _communicator->flushAsyncRequests();
+                    usleep(shiftDuration);
                 }
-                transmitted+=4;
-                _transmittedOnly+=4; //actually not required...
+
+                success &= this->getRegister(REGISTER::SPDR)->readMultiTimesAsync(rx, chunk);
+            }
+
+            /* An early read leaves bytes in the read FIFO */
+            success &= this->getRegister(REGISTER::SPSR)->readAsync(&spsr);
+            success &= _communicator->finishRequestBatch();
+
+            if (!success) {
+                EASYFPGA_LOG(WARNING) << "Failed to transfer " << length << " bytes";
+                return false;
+            }
+
+            if (!setBitTest(spsr, 0)) {
+                EASYFPGA_LOG(WARNING) << "Read FIFO not empty after transferring " << length << " bytes. Resetting the misaligned FIFOs ...";
+                this->resetBuffers();
+                return false;
             }
             return true;
 
         /** \todo Support async mode */
         case OPERATION_MODE::ASYNC:
-            Log().Get(WARNING) << "Async mode not yet supported. Aborting ...";
+            EASYFPGA_LOG(WARNING) << "Async mode not yet supported. Aborting ...";
             return false;
     }
 
@@ -409,7 +427,7 @@ bool Spi::isWriteFifoFull(void)
 {
     byte status = (byte)0xFF;
     if (!this->getRegister(REGISTER::SPSR)->readSync(&status)) {
-        Log().Get(WARNING) << "Failed to read status register";
+        EASYFPGA_LOG(WARNING) << "Failed to read status register";
     }
     return setBitTest(&status, 3);
 }
@@ -418,7 +436,14 @@ bool Spi::isWriteFifoEmpty(void)
 {
     byte status = (byte)0xFF;
     if (!this->getRegister(REGISTER::SPSR)->readSync(&status)) {
-        Log().Get(WARNING) << "Failed to read status register";
+        EASYFPGA_LOG(WARNING) << "Failed to read status register";
     }
     return setBitTest(&status, 2);
 }
+
+uint32_t Spi::getShiftDuration(uint32_t byteCount)
+{
+    /* SCK_40_MHZ divides the wishbone clock by 2, every slower speed by twice as much */
+    uint64_t divider = (uint64_t)2 << (CLOCK_SPEED::SCK_40_MHZ - _clockSpeed);
+    return (uint32_t)((uint64_t)byteCount * 8 * divider * 1000000 / WISHBONE_CLOCK_FREQUENCY);
+}
@@ -49,19 +49,21 @@
  * Before the core can be used, the Spi::init() method has to be called
  * to specify the SPI mode and clock frequency divider.
  *
- * There are three methods for communicating with an SPI slave:
+ * There are four methods for communicating with an SPI slave:
  * - Spi::transceive(),
  * - Spi::transmit() (this method is overloaded for transmitting one
- *   single byte or an array of bytes) and
- * - Spi::receive()
+ *   single byte or an array of bytes),
+ * - Spi::receive() and
+ * - Spi::transfer() for byte arrays of arbitrary length.
  *
  * SPI generally operates in full-duplex mode: With each clock cycle one
  * bit is transfered from master to slave over the MOSI line and one
  * from slave to master on the MISO line. In case only one direction is
  * of interrest, the method Spi::transmit() or Spi::receive() should be
  * used. In order to transmit and receive at the same time, use the
- * Spi::transceive() method. The SPI communication methods usually work
- * byte-wise.
+ * Spi::transceive() method. Whole byte arrays, e.g. the content of an
+ * SPI flash, should be transferred by Spi::transfer(), which needs one
+ * round trip only instead of one per byte.
  *
  * <b>Interrupt handling</b>
  *
@@ -195,6 +197,11 @@ class Spi : public EasyCore
             SPER = UNIQUE_CORE_NUMBER*MAX_GLOBAL_OFFSET+MAX_GLOBAL_PIN_COUNT+3
         };
 
+        /**
+         * \brief Size of the read and the write FIFO.
+         */
+        static const uint32_t FIFO_DEPTH = 4;
+
         /* CORE SETTINGS */
         /**
          * \brief Defines the possible serial clock speed modes.
@@ -337,6 +344,8 @@ class Spi : public EasyCore
          *
          * \return true if the exchange could be processed successfully,<br>
          *         false otherwise
+         *
+         * \see transfer()
          */
         bool transceive(byte txData, byte* rxData);
 
@@ -359,9 +368,47 @@ class Spi : public EasyCore
          *
          * \return true if the exchange could be processed successfully,<br>
          *         false otherwise
+         *
+         * \see transfer()
          */
         bool transmit(byte* txData, uint8_t length);
 
+        /**
+         * \brief Transmits and receives a byte array of arbitrary length.
+         *
+         * The bytes are written to and read from the FIFOs in chunks of
+         * FIFO_DEPTH bytes, each chunk by one write and one read
+         * exchange. All exchanges are sent without waiting for the
+         * replies of the previous ones, so the whole transfer takes a
+         * single round trip. At SPI clocks too slow for shifting out a
+         * chunk before its read exchange arrives (see
+         * SPI_PIPELINED_CHUNK_DURATION), each write is sent at once and
+         * its read is delayed by the shift time of the chunk.
+         *
+         * Finally the status register is checked for an empty read
+         * FIFO. Otherwise the received bytes are misaligned, hence the
+         * FIFOs are reset and the transfer fails.
+         *
+         * Only the replies of these exchanges are awaited. Results of
+         * other outstanding asynchronous requests are written back by
+         * EasyFpga::handleReplies() as usual, but their callbacks might
+         * already be executed during the transfer.
+         *
+         * \param txData The bytes to send, or<br>
+         *        NULL for sending dummy bytes (0x00)
+         *
+         * \param rxData Location of length bytes for the received
+         *        bytes, or<br>
+         *        NULL for discarding them
+         *
+         * \param length Number of bytes to transfer
+         *
+         * \return true if all exchanges could be processed
+         *         successfully,<br>
+         *         false otherwise
+         */
+        bool transfer(const byte* txData, byte* rxData, uint32_t length);
+
         /**
          * \brief Transmits a dummy byte (0x00) in order to receive a byte.
          *
@@ -370,6 +417,8 @@ class Spi : public EasyCore
          *
          * \return true if the exchange could be processed successfully,<br>
          *         false otherwise
+         *
+         * \see transfer()
          */
         bool receive(byte* rxData);
 
@@ -418,6 +467,15 @@ class Spi : public EasyCore
          * of required dummy reads prior to reading meaningful data.
          */
         uint8_t _transmittedOnly;
+
+        /**
+         * \brief The serial clock set by init().
+         */
+        CLOCK_SPEED _clockSpeed;
+
+    private:
+        /* time in us for shifting out the given number of bytes */
+        uint32_t getShiftDuration(uint32_t byteCount);
 };
 
 #endif  // SDK_EASYCORES_SPI_SPI_H_
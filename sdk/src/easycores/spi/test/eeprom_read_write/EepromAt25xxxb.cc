@@ -349,11 +349,9 @@ bool EepromAt25xxxb::read(byte* data, uint16_t length, uint16_t startAddress)
     }
 
     /* receive */
-    for (uint16_t byteNo=0; byteNo<length; byteNo++) {
-        if (!spiMaster->receive(&data[byteNo])) {
-            Log().Get(WARNING) << "Failed to receive byte #" << (uint32_t)byteNo;
-            return false;
-        }
+    if (!spiMaster->transfer(NULL, data, length)) {
+        Log().Get(WARNING) << "Failed to receive " << (uint32_t)length << " bytes";
+        return false;
     }
 
     /* disable chip select */
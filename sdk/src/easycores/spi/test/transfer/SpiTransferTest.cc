@@ -0,0 +1,294 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/callback.h"
+#include "easyfpga/easycores/register.h"
+#include "easyfpga/easycores/spi/spi.h"
+#include "easyfpga/easycores/spi/spi_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedspi.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SpiFpga : public EasyFpga
+{
+    public:
+        SpiFpga() :
+            spi(std::make_shared<Spi>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(spi);
+        }
+
+        spi_ptr spi;
+};
+
+/**
+ * \brief Transfers a few bytes synchronously from within a callback
+ */
+class NestedTransferCallback : public Callback
+{
+    public:
+        NestedTransferCallback(spi_ptr spi) :
+            Callback(1),
+            tx({ 0x10, 0x32, 0x54, 0x76, 0x98 }),
+            rx(5, 0x00),
+            called(false),
+            success(false),
+            _spi(spi)
+        {
+        }
+
+        bool call(void) {
+            called = true;
+            success = _spi->transfer(tx.data(), rx.data(), tx.size());
+            return success;
+        }
+
+        std::vector<byte> tx;
+        std::vector<byte> rx;
+        bool called;
+        bool success;
+
+    private:
+        spi_ptr _spi;
+};
+
+/**
+ * \brief Tests the transfers of byte arrays by the Spi core
+ *
+ * The test needs no easyFPGA. Byte arrays of several lengths are
+ * transferred to a simulated spi core whose slave answers the
+ * complement of every byte. Each FIFO chunk has to be written by a
+ * single write multi exchange and read by a single read multi exchange,
+ * and the received bytes have to stay aligned after transmit() calls.
+ */
+class SpiTransferTest : public Tester
+{
+    std::string testName(void) {
+        return "spi transfer test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool testTransfer(spi_ptr spi, std::shared_ptr<SimulatedSpi> model, uint32_t length) {
+        std::vector<byte> tx(length);
+        std::vector<byte> rx(length, 0x00);
+        for (uint32_t i=0; i<length; i++) {
+            tx[i] = (byte)(i * 7 + length);
+        }
+
+        uint32_t chunks = (length + Spi::FIFO_DEPTH - 1) / Spi::FIFO_DEPTH;
+        uint64_t writes = this->countRequests(0x65);
+        uint64_t reads = this->countRequests(0x73);
+
+        if (!spi->transfer(tx.data(), rx.data(), length)) {
+            Log().Get(ERROR) << "Transferring " << length << " bytes failed!";
+            return false;
+        }
+
+        if ((this->countRequests(0x65) - writes != chunks) || (this->countRequests(0x73) - reads != chunks)) {
+            Log().Get(ERROR) << "Transferring " << length << " bytes didn't take " << chunks << " write and read multi exchanges!";
+            return false;
+        }
+
+        if (model->takeTransmittedBytes() != tx) {
+            Log().Get(ERROR) << "The " << length << " transmitted bytes are wrong!";
+            return false;
+        }
+
+        for (uint32_t i=0; i<length; i++) {
+            if (rx[i] != (byte)~tx[i]) {
+                Log().Get(ERROR) << "Received byte " << i << " of " << length << " is wrong!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testAlignment(spi_ptr spi, std::shared_ptr<SimulatedSpi> model) {
+        /* leave three bytes in the read FIFO */
+        bool success = spi->transmit((byte)0x01);
+        success &= spi->transmit((byte)0x02);
+        success &= spi->transmit((byte)0x03);
+
+        byte received = 0x00;
+        success &= spi->transceive((byte)0x5A, &received);
+        if (!success || (received != (byte)0xA5)) {
+            Log().Get(ERROR) << "The read FIFO wasn't aligned after transmitting single bytes!";
+            return false;
+        }
+
+        /* the last chunk of a byte array is shorter than the FIFO */
+        byte command[5] = { 0x03, 0x00, 0x10, 0x20, 0x30 };
+        if (!spi->transmit(command, 5)) {
+            Log().Get(ERROR) << "Transmitting a byte array failed!";
+            return false;
+        }
+
+        std::vector<byte> transmitted = model->takeTransmittedBytes();
+        if ((transmitted.size() != 9) || !std::equal(command, command+5, transmitted.begin()+4)) {
+            Log().Get(ERROR) << transmitted.size() << " bytes transmitted instead of 9!";
+            return false;
+        }
+
+        /* dummy bytes are sent without transmit data */
+        byte rx[6];
+        if (!spi->transfer(NULL, rx, 6)) {
+            Log().Get(ERROR) << "Receiving a byte array failed!";
+            return false;
+        }
+        for (uint32_t i=0; i<6; i++) {
+            if (rx[i] != (byte)0xFF) {
+                Log().Get(ERROR) << "Receiving dummy byte " << i << " failed!";
+                return false;
+            }
+        }
+
+        return model->takeTransmittedBytes() == std::vector<byte>(6, 0x00);
+    }
+
+    bool testUnrelatedRequest(SpiFpga& fpga, std::shared_ptr<SimulatedSpi> model) {
+        /* an async read of SPCR stays outstanding across the transfer */
+        byte spcr = 0x00;
+        if (!fpga.getCommunicator()->readRegisterAsync(&spcr, 1, 0, 0) ||
+            !this->testTransfer(fpga.spi, model, 10)) {
+            return false;
+        }
+
+        if (spcr != 0x00) {
+            Log().Get(ERROR) << "The transfer wrote the result of an unrelated async request!";
+            return false;
+        }
+        if (!fpga.getCommunicator()->handleRequestReplies() || !setBitTest(spcr, 6)) {
+            Log().Get(ERROR) << "The unrelated async request failed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testNestedTransfer(SpiFpga& fpga, std::shared_ptr<SimulatedSpi> model, uint32_t burstLength) {
+        byte sper = 0x00;
+        if (!fpga.spi->getRegister(Spi::REGISTER::SPER)->readSync(&sper)) {
+            return false;
+        }
+
+        /*
+         * The callback's reply arrives while the burst's batch is sent
+         * (a long burst fills the in-flight window) or awaited.
+         */
+        auto callback = std::make_shared<NestedTransferCallback>(fpga.spi);
+        byte spcr = 0x00;
+        if (fpga.getCommunicator()->readRegisterAsync(&spcr, 1, 0, callback, 0) == 0) {
+            return false;
+        }
+
+        std::vector<byte> burst(burstLength, (byte)~sper);
+        if (!fpga.spi->getRegister(Spi::REGISTER::SPER)->readBurstSync(burst.data(), burstLength) ||
+            (burst != std::vector<byte>(burstLength, sper))) {
+            Log().Get(ERROR) << "The burst of " << burstLength << " reads around a nested transfer failed!";
+            return false;
+        }
+
+        if (!callback->called || !callback->success || (model->takeTransmittedBytes() != callback->tx)) {
+            Log().Get(ERROR) << "The transfer within a callback during a burst of " << burstLength << " reads failed!";
+            return false;
+        }
+        for (uint32_t i=0; i<callback->tx.size(); i++) {
+            if (callback->rx[i] != (byte)~callback->tx[i]) {
+                Log().Get(ERROR) << "Received byte " << i << " of the nested transfer is wrong!";
+                return false;
+            }
+        }
+
+        return fpga.getCommunicator()->handleRequestReplies();
+    }
+
+    bool testMethod(void) {
+        auto model = std::make_shared<SimulatedSpi>();
+        model->setSlave([](byte mosi) { return (byte)~mosi; });
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        SpiFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = fpga.spi->init(Spi::SPI_MODE::MODE_0, Spi::CLOCK_SPEED::SCK_20_MHZ);
+        for (uint32_t length=1; success && (length<=13); length++) {
+            success &= this->testTransfer(fpga.spi, model, length);
+        }
+        success = success && this->testTransfer(fpga.spi, model, 1021);
+        success = success && this->testAlignment(fpga.spi, model);
+        success = success && this->testUnrelatedRequest(fpga, model);
+        success = success && this->testNestedTransfer(fpga, model, 10);
+        success = success && this->testNestedTransfer(fpga, model, 40 * 255);
+
+        /*
+         * The reads are delayed at slow clocks. A byte takes 410 us at
+         * 19531 Hz, the model is a bit faster to tolerate the latency
+         * of the simulated connection.
+         */
+        model->setShiftDuration(350);
+        success = success && fpga.spi->init(Spi::SPI_MODE::MODE_3, Spi::CLOCK_SPEED::SCK_19531_HZ);
+        success = success && this->testTransfer(fpga.spi, model, 10);
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    SpiTransferTest test;
+    return (uint32_t)test.runTest();
+}
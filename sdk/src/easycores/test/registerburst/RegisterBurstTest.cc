@@ -0,0 +1,255 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/callback.h"
+#include "easyfpga/easycores/register.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/simulatedcore.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * \brief A core whose registers all access one FIFO: writes append a
+ *        byte, reads take the oldest one (0x00 if it is empty).
+ */
+class SimulatedFifo : public SimulatedCore
+{
+    public:
+        std::string getName(void) {
+            return "fifo";
+        }
+
+        size_t getSize(void) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _fifo.size();
+        }
+
+    protected:
+        byte read(byte address) {
+            if (_fifo.empty()) {
+                return 0x00;
+            }
+            byte value = _fifo.front();
+            _fifo.pop_front();
+            return value;
+        }
+
+        void write(byte address, byte value) {
+            _fifo.push_back(value);
+        }
+
+    private:
+        std::deque<byte> _fifo;
+};
+
+class FifoFpga : public EasyFpga
+{
+    public:
+        FifoFpga() :
+            uart(std::make_shared<Uart>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(uart);
+        }
+
+        uart_ptr uart;
+};
+
+class CountingCallback : public Callback
+{
+    public:
+        CountingCallback() :
+            Callback(0),
+            calls(0)
+        {
+        }
+
+        bool call(void) {
+            calls++;
+            return true;
+        }
+
+        uint32_t calls;
+};
+
+/**
+ * \brief Tests the register bursts of arbitrary lengths
+ *
+ * The test needs no easyFPGA. Bursts of several lengths around the
+ * exchange limit of 255 bytes are written into and read out of a
+ * simulated FIFO. The data has to arrive in order, every burst has to
+ * use the minimum number of exchanges and the callback of an async
+ * burst has to be executed exactly once, also if a chunk fails
+ * permanently because of injected NACKs.
+ */
+class RegisterBurstTest : public Tester
+{
+    std::string testName(void) {
+        return "register burst test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool testBurst(FifoFpga& fpga, std::shared_ptr<SimulatedFifo> model, uint32_t length) {
+        std::vector<byte> written(length);
+        std::vector<byte> read(length, 0x00);
+        for (uint32_t i=0; i<length; i++) {
+            written[i] = (byte)(i * 7 + length);
+        }
+
+        uint64_t expectedChunks = (length + 254) / 255;
+        uint64_t writes = this->countRequests(0x65);
+        uint64_t reads = this->countRequests(0x73);
+
+        if (!fpga.uart->getRegister(Uart::REGISTER::TX)->writeBurstSync(written.data(), length) ||
+            (model->getSize() != length) || (this->countRequests(0x65) - writes != expectedChunks)) {
+            Log().Get(ERROR) << "Sync write burst of " << length << " bytes failed!";
+            return false;
+        }
+
+        if (!fpga.uart->getRegister(Uart::REGISTER::RX)->readBurstSync(read.data(), length) ||
+            (read != written) || (this->countRequests(0x73) - reads != expectedChunks)) {
+            Log().Get(ERROR) << "Sync read burst of " << length << " bytes failed!";
+            return false;
+        }
+
+        auto writeCallback = std::make_shared<CountingCallback>();
+        auto readCallback = std::make_shared<CountingCallback>();
+        std::fill(read.begin(), read.end(), 0x00);
+
+        bool success = fpga.uart->getRegister(Uart::REGISTER::TX)->writeBurstAsync(written.data(), length, writeCallback);
+        success &= fpga.uart->getRegister(Uart::REGISTER::RX)->readBurstAsync(read.data(), length, readCallback);
+        success &= fpga.handleReplies();
+
+        if (!success || (writeCallback->calls != 1) || (readCallback->calls != 1) || (read != written)) {
+            Log().Get(ERROR) << "Async bursts of " << length << " bytes failed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testFailedBurst(FifoFpga& fpga, BoardSimulator& board) {
+        /* both chunks fail on every attempt (MAX_RETRIES_ALLOWED=3) */
+        std::vector<byte> written(510, 0x5A);
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 8);
+
+        auto callback = std::make_shared<CountingCallback>();
+        bool started = fpga.uart->getRegister(Uart::REGISTER::TX)->writeBurstAsync(written.data(), written.size(), callback);
+        bool handled = fpga.handleReplies();
+
+        if (!started || handled || (callback->calls != 1) || !callback->hasFailed()) {
+            Log().Get(ERROR) << "A failed async burst wasn't completed as failed!";
+            return false;
+        }
+
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 8);
+        bool synced = fpga.uart->getRegister(Uart::REGISTER::TX)->writeBurstSync(written.data(), written.size());
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 0);
+
+        if (synced) {
+            Log().Get(ERROR) << "A failed sync burst succeeded!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        auto model = std::make_shared<SimulatedFifo>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        FifoFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = true;
+        uint32_t lengths[] = { 1, 254, 255, 256, 510, 511, 4000 };
+        for (uint32_t length : lengths) {
+            success &= this->testBurst(fpga, model, length);
+        }
+
+        byte nothing = 0x00;
+        if (fpga.uart->getRegister(Uart::REGISTER::RX)->readBurstSync(&nothing, 0)) {
+            Log().Get(ERROR) << "An empty burst was accepted!";
+            success = false;
+        }
+
+        success &= this->testFailedBurst(fpga, board);
+
+        /* compare a burst with sync reads of the same bytes, at a usb-like latency */
+        board.setLatency(200);
+        std::vector<byte> data(4000, 0x55);
+        auto start = std::chrono::steady_clock::now();
+        success &= fpga.uart->getRegister(Uart::REGISTER::RX)->readBurstSync(data.data(), data.size());
+        double burstSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i=0; i<data.size(); i+=255) {
+            success &= fpga.uart->getRegister(Uart::REGISTER::RX)->readMultiTimesSync(data.data()+i, std::min<uint32_t>(255, data.size()-i));
+        }
+        double chunkedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Log().Get(INFO) << "4000 byte read: " << (uint32_t)(data.size() / burstSeconds) << " bytes/s as burst, "
+            << (uint32_t)(data.size() / chunkedSeconds) << " bytes/s by sync exchanges";
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    RegisterBurstTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,145 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulateduart.h"
+#include "easyfpga/utils/benchmark/benchmark.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+
+#include <memory>
+#include <string>
+
+static const uint32_t TRANSFER_LENGTH = 1024;
+
+class BulkFpga : public EasyFpga
+{
+    public:
+        BulkFpga() :
+            uart(std::make_shared<Uart>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(uart);
+        }
+
+        uart_ptr uart;
+};
+
+/**
+ * \brief Measures the bytes per second of Uart::transmit() and
+ *        Uart::receive() in the synchronous mode
+ *
+ * A byte array is transferred by the FIFO-wise bulk methods and, for
+ * comparison, byte by byte. The board is simulated without latency and
+ * the simulated uart transmits immediately.
+ */
+class UartBulkBenchmark : public Benchmark
+{
+    std::string benchmarkName(void) {
+        return "uart bulk benchmark";
+    }
+
+    bool benchmarkMethod(void) {
+        auto model = std::make_shared<SimulatedUart>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        BulkFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            EASYFPGA_LOG(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        uart_ptr uart = fpga.uart;
+        if (!uart->init(115200, Uart::WORD_LENGTH::C8, Uart::PARITY::NO_PARITY, Uart::STOP_BIT_COUNT::ONE_BIT)) {
+            EASYFPGA_LOG(ERROR) << "Couldn't initialize the uart!";
+            return false;
+        }
+
+        byte buffer[TRANSFER_LENGTH];
+        for (uint32_t i=0; i<TRANSFER_LENGTH; i++) {
+            buffer[i] = (byte)i;
+        }
+
+        bool success = true;
+
+        success &= this->measure("transmit_bytewise", TRANSFER_LENGTH, TRANSFER_LENGTH, [uart, model, &buffer] {
+            bool success = true;
+            for (uint32_t i=0; i<TRANSFER_LENGTH; i++) {
+                success &= uart->transmit(buffer[i]);
+            }
+            model->takeTransmittedBytes();
+            return success;
+        });
+        success &= this->measure("transmit_bulk", 1, TRANSFER_LENGTH, [uart, model, &buffer] {
+            bool success = uart->transmit(buffer, TRANSFER_LENGTH);
+            model->takeTransmittedBytes();
+            return success;
+        });
+
+        /*
+         * The receive FIFO holds 64 bytes, so receive FIFO by FIFO. The
+         * RX_AVAILABLE interrupt lets receive() read the trigger level
+         * at once instead of byte by byte.
+         */
+        if (!uart->setRxTriggerLevel(Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_56) ||
+            !uart->enableInterrupt(Uart::INTERRUPT::RX_AVAILABLE)) {
+            EASYFPGA_LOG(ERROR) << "Couldn't enable the RX_AVAILABLE interrupt!";
+            return false;
+        }
+
+        success &= this->measure("receive_bytewise", TRANSFER_LENGTH, TRANSFER_LENGTH, [uart, model, &buffer] {
+            bool success = true;
+            for (uint32_t offset=0; offset<TRANSFER_LENGTH; offset+=Uart::FIFO_DEPTH) {
+                model->injectReceivedBytes(buffer+offset, Uart::FIFO_DEPTH);
+                for (uint32_t i=0; i<Uart::FIFO_DEPTH; i++) {
+                    success &= uart->receive(buffer+offset+i);
+                }
+            }
+            return success;
+        });
+        success &= this->measure("receive_bulk", TRANSFER_LENGTH/Uart::FIFO_DEPTH, TRANSFER_LENGTH, [uart, model, &buffer] {
+            bool success = true;
+            for (uint32_t offset=0; offset<TRANSFER_LENGTH; offset+=Uart::FIFO_DEPTH) {
+                model->injectReceivedBytes(buffer+offset, Uart::FIFO_DEPTH);
+                success &= uart->receive(buffer+offset, Uart::FIFO_DEPTH);
+            }
+            return success;
+        });
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    UartBulkBenchmark benchmark;
+    return benchmark.runBenchmark(argc, argv);
+}
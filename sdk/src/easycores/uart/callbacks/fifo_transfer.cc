@@ -0,0 +1,96 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "configuration.h" /* UART_FIFO_TIMEOUT */
+#include "easycores/register.h"
+#include "easycores/uart/callbacks/fifo_transfer.h"
+#include "easycores/uart/uart.h"
+#include "utils/log/log.h"
+
+#include <cstring>
+#include <memory>
+
+UartFifoTransferCallback::UartFifoTransferCallback(Uart* core, byte* buffer, uint32_t remaining, uint32_t byteCount, bool transmit, timevalue start, timevalue lastChunk) :
+    Callback(transmit ? 1 : Uart::RECEIVE_STATUS_LENGTH),
+    _core(core),
+    _buffer(buffer),
+    _remaining(remaining),
+    _byteCount(byteCount),
+    _transmit(transmit),
+    _start(start),
+    _lastChunk(lastChunk)
+{
+}
+
+UartFifoTransferCallback::~UartFifoTransferCallback()
+{
+}
+
+bool UartFifoTransferCallback::call(void)
+{
+    uint32_t chunk = (_remaining < Uart::FIFO_DEPTH) ? _remaining : Uart::FIFO_DEPTH;
+    bool success = true;
+
+    if (_transmit) {
+        if ((*(_byteRead) & Uart::LINE_STATUS::TX_FIFO_EMPTY) != 0) {
+            success = _core->getRegister(Uart::REGISTER::TX)->writeMultiTimesAsync(_buffer, (uint8_t)chunk);
+            _buffer += chunk;
+            _remaining -= chunk;
+            _lastChunk = getMonotonicTimeInNanos();
+        }
+        else if (getMonotonicTimeInNanos() - _lastChunk > (timevalue)UART_FIFO_TIMEOUT * 1000) {
+            EASYFPGA_LOG(WARNING) << "Transmit FIFO didn't become empty. " << _remaining << " of " << _byteCount << " bytes aren't transmitted!";
+            return false;
+        }
+    }
+    else {
+        uint32_t available = _core->getNumberOfReadableBytes(_byteRead);
+        if (available > 0) {
+            chunk = (chunk < available) ? chunk : available;
+            success = _core->getRegister(Uart::REGISTER::RX)->readMultiTimesAsync(_buffer, (uint8_t)chunk);
+            _buffer += chunk;
+            _remaining -= chunk;
+        }
+        else {
+            memset(_buffer, 0x00, _remaining);
+            _remaining = 0;
+        }
+    }
+
+    if (!success) {
+        return false;
+    }
+
+    if (_remaining > 0) {
+        callback_ptr c = std::make_shared<UartFifoTransferCallback>(_core, _buffer, _remaining, _byteCount, _transmit, _start, _lastChunk);
+        if (!_transmit) {
+            return _core->getRegister(Uart::REGISTER::IIR)->readAutoAddressIncrementAsync(c->getBuffer(), Uart::RECEIVE_STATUS_LENGTH, c);
+        }
+        return _core->getRegister(Uart::REGISTER::LSR)->readAsync(c->getBuffer(), c);
+    }
+
+    timevalue duration = getMonotonicTimeInNanos() - _start;
+    EASYFPGA_LOG(DEBUG) << (_transmit ? "Transmitted " : "Received ") << _byteCount << " bytes with "
+                        << ((duration > 0) ? (uint64_t)_byteCount * 1000000000 / duration : 0) << " bytes/s.";
+
+    return true;
+}
@@ -0,0 +1,61 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_EASYCORES_UART_CALLBACKS_FIFOTRANSFER_H_
+#define SDK_EASYCORES_UART_CALLBACKS_FIFOTRANSFER_H_
+
+#include "easycores/callback.h"
+#include "easycores/uart/uart_fwd.h"
+#include "utils/hardwaretypes.h"
+#include "utils/os/time_helper.h"
+
+/**
+ * \brief Continues an asynchronous Uart::transmit(byte*, uint32_t) or
+ *        Uart::receive(byte*, uint32_t) after the status registers
+ *        were read.
+ *
+ * Depending on the status, the next FIFO_DEPTH bytes are transmitted,
+ * the bytes known to be in the receive FIFO are read, or the status is
+ * polled again. As long as bytes remain, the next status read is
+ * chained with a new instance of this callback.
+ */
+class UartFifoTransferCallback : public Callback
+{
+    public:
+        UartFifoTransferCallback(Uart* core, byte* buffer, uint32_t remaining, uint32_t byteCount, bool transmit, timevalue start, timevalue lastChunk);
+        ~UartFifoTransferCallback();
+
+        bool call(void);
+
+    private:
+        Uart* _core;
+        byte* _buffer;
+        uint32_t _remaining;
+        uint32_t _byteCount;
+        bool _transmit;
+        timevalue _start;
+
+        /* time of the last chunk written, for detecting a stalled FIFO */
+        timevalue _lastChunk;
+};
+
+#endif  // SDK_EASYCORES_UART_CALLBACKS_FIFOTRANSFER_H_
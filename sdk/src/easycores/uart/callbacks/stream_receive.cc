@@ -0,0 +1,81 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "communication/communicator.h"
+#include "easycores/register.h"
+#include "easycores/uart/callbacks/stream_receive.h"
+#include "easycores/uart/uart.h"
+
+#include <memory>
+
+UartStreamReceiveCallback::UartStreamReceiveCallback(Uart* core, uint32_t byteCount) :
+    Callback((byteCount > 0) ? byteCount : 1),
+    _core(core),
+    _byteCount(byteCount)
+{
+}
+
+UartStreamReceiveCallback::~UartStreamReceiveCallback()
+{
+}
+
+bool UartStreamReceiveCallback::call(void)
+{
+    if (_byteCount > 0) {
+        _core->appendToReceiveStream(_byteRead, _byteCount);
+
+        callback_ptr c = std::make_shared<UartStreamReceiveCallback>(_core, 0);
+        if (!_core->getRegister(Uart::REGISTER::IIR)->readAsync(c->getBuffer(), c)) {
+            this->fail();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t pending;
+    if ((*(_byteRead) & 0x0F) == (byte)0x04) {
+        /* RX_AVAILABLE: at least the trigger level is in the FIFO */
+        pending = (uint32_t)_core->getRxTriggerLevel();
+    }
+    else if ((*(_byteRead) & 0x0F) == (byte)0x0C) {
+        /* CHARACTER_TIMEOUT: at least one byte is in the FIFO */
+        pending = 1;
+    }
+    else {
+        return _core->getCommunicator()->enableGlobalInterruptsAsync();
+    }
+
+    callback_ptr c = std::make_shared<UartStreamReceiveCallback>(_core, pending);
+    if (!_core->getRegister(Uart::REGISTER::RX)->readMultiTimesAsync(c->getBuffer(), (uint8_t)pending, c)) {
+        this->fail();
+        return false;
+    }
+    return true;
+}
+
+void UartStreamReceiveCallback::fail(void)
+{
+    Callback::fail();
+
+    /* the stream stops unless the interrupts are enabled again */
+    _core->getCommunicator()->enableGlobalInterruptsAsync();
+}
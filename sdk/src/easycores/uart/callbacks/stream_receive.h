@@ -0,0 +1,55 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_EASYCORES_UART_CALLBACKS_STREAMRECEIVE_H_
+#define SDK_EASYCORES_UART_CALLBACKS_STREAMRECEIVE_H_
+
+#include "easycores/callback.h"
+#include "easycores/uart/uart_fwd.h"
+#include "utils/hardwaretypes.h"
+
+/**
+ * \brief Drains the receive FIFO of an Uart's receive stream in the
+ *        asynchronous mode.
+ *
+ * An instance with a byte count of 0 evaluates the interrupt
+ * identification register: If received bytes are pending, they are
+ * read by an instance with the number of bytes to append. That one
+ * appends them to the stream and reads the identification register
+ * again. Otherwise the global interrupts are enabled again, as they
+ * are if one of the reads fails.
+ */
+class UartStreamReceiveCallback : public Callback
+{
+    public:
+        UartStreamReceiveCallback(Uart* core, uint32_t byteCount);
+        ~UartStreamReceiveCallback();
+
+        bool call(void);
+        void fail(void);
+
+    private:
+        Uart* _core;
+        uint32_t _byteCount;
+};
+
+#endif  // SDK_EASYCORES_UART_CALLBACKS_STREAMRECEIVE_H_
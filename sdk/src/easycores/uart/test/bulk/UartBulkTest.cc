@@ -0,0 +1,224 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/configuration.h" /* UART_FIFO_TIMEOUT */
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/register.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulateduart.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+class BulkFpga : public EasyFpga
+{
+    public:
+        BulkFpga() :
+            uart(std::make_shared<Uart>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(uart);
+        }
+
+        uart_ptr uart;
+};
+
+/**
+ * \brief Tests Uart::transmit(byte*, uint32_t) and
+ *        Uart::receive(byte*, uint32_t) in the synchronous mode
+ *
+ * The test needs no easyFPGA. Byte arrays are transmitted to and
+ * received from a simulated uart. Every full FIFO has to be transmitted
+ * by a single exchange. A receive must read only the bytes known to be
+ * in the FIFO: one byte per DATA_READY, or the trigger level while the
+ * RX_AVAILABLE interrupt is reported. A receive of more bytes than
+ * available has to be filled up with zeros, although the simulated uart
+ * repeats its last byte like the hardware. At a slow line, a transmit
+ * taking longer than UART_FIFO_TIMEOUT has to succeed as long as the
+ * FIFO keeps draining.
+ */
+class UartBulkTest : public Tester
+{
+    std::string testName(void) {
+        return "uart bulk transfer test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool testTransfer(BulkFpga& fpga, std::shared_ptr<SimulatedUart> model, uint32_t length, uint32_t triggerLevel) {
+        std::vector<byte> data(length);
+        for (uint32_t i=0; i<length; i++) {
+            data[i] = (byte)(i * 13 + 1);
+        }
+
+        uint64_t expectedChunks = (length + Uart::FIFO_DEPTH - 1) / Uart::FIFO_DEPTH;
+        uint64_t writes = this->countRequests(0x65);
+
+        if (!fpga.uart->transmit(data.data(), length) || (model->takeTransmittedBytes() != data) ||
+            (this->countRequests(0x65) - writes != expectedChunks)) {
+            Log().Get(ERROR) << "Transmitting " << length << " bytes failed!";
+            return false;
+        }
+
+        /* the model's receive FIFO holds 64 bytes, so receive them chunkwise */
+        std::vector<byte> received(length, 0xFF);
+        uint64_t reads = this->countRequests(0x73);
+
+        for (uint32_t offset=0; offset<length; offset+=Uart::FIFO_DEPTH) {
+            uint32_t chunk = std::min(length - offset, Uart::FIFO_DEPTH);
+            model->injectReceivedBytes(data.data() + offset, chunk);
+            if (!fpga.uart->receive(received.data() + offset, chunk)) {
+                Log().Get(ERROR) << "Receiving " << length << " bytes failed!";
+                return false;
+            }
+        }
+
+        /* a FIFO chunk takes one read of the trigger level and single byte reads for the rest */
+        uint64_t expectedReads = 0;
+        for (uint32_t offset=0; offset<length; offset+=Uart::FIFO_DEPTH) {
+            uint32_t chunk = std::min(length - offset, Uart::FIFO_DEPTH);
+            expectedReads += (triggerLevel > 1) && (chunk >= triggerLevel) ? 1 + chunk - triggerLevel : chunk;
+        }
+
+        if ((received != data) || (this->countRequests(0x73) - reads != expectedReads)) {
+            Log().Get(ERROR) << "Received " << length << " bytes are wrong!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testSlowLine(BulkFpga& fpga, std::shared_ptr<SimulatedUart> model) {
+        /* about 10 kbaud, a FIFO drains in 64 ms but all bytes take longer than the timeout */
+        const uint32_t byteDuration = 1000;
+        uint32_t length = UART_FIFO_TIMEOUT / byteDuration + 2 * Uart::FIFO_DEPTH;
+
+        std::vector<byte> data(length);
+        for (uint32_t i=0; i<length; i++) {
+            data[i] = (byte)(i * 7 + 3);
+        }
+
+        model->setTransmitDuration(byteDuration);
+        bool success = fpga.uart->transmit(data.data(), length);
+        model->setTransmitDuration(0);
+
+        /* the model sends the rest of the last FIFO at the next access */
+        byte lineStatus;
+        success &= fpga.uart->getRegister(Uart::REGISTER::LSR)->readSync(&lineStatus);
+
+        if (!success || (model->takeTransmittedBytes() != data)) {
+            Log().Get(ERROR) << "Transmitting " << length << " bytes at a slow line failed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        auto model = std::make_shared<SimulatedUart>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        BulkFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        if (!fpga.uart->init(115200, Uart::WORD_LENGTH::C8, Uart::PARITY::NO_PARITY, Uart::STOP_BIT_COUNT::ONE_BIT)) {
+            Log().Get(ERROR) << "Couldn't initialize the uart!";
+            return false;
+        }
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        bool success = true;
+        uint32_t lengths[] = { 1, 63, 64, 65, 200, 1000 };
+        for (uint32_t length : lengths) {
+            success &= this->testTransfer(fpga, model, length, 1);
+        }
+
+        /* the RX_AVAILABLE interrupt reports the trigger level */
+        if (!fpga.uart->setRxTriggerLevel(Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_56) ||
+            !fpga.uart->enableInterrupt(Uart::INTERRUPT::RX_AVAILABLE)) {
+            Log().Get(ERROR) << "Couldn't enable the RX_AVAILABLE interrupt!";
+            success = false;
+        }
+        for (uint32_t length : lengths) {
+            success &= this->testTransfer(fpga, model, length, 56);
+        }
+        fpga.uart->disableInterrupt(Uart::INTERRUPT::RX_AVAILABLE);
+
+        /* more bytes requested than received */
+        byte partial[] = { 0x11, 0x22, 0x33 };
+        byte target[100];
+        memset(target, 0xFF, sizeof(target));
+        model->injectReceivedBytes(partial, sizeof(partial));
+        if (!fpga.uart->receive(target, sizeof(target)) || (memcmp(target, partial, sizeof(partial)) != 0)) {
+            Log().Get(ERROR) << "Receiving a partially filled FIFO failed!";
+            success = false;
+        }
+        for (uint32_t i=sizeof(partial); i<sizeof(target); i++) {
+            if (target[i] != 0x00) {
+                Log().Get(ERROR) << "Byte " << i << " of a partial receive isn't zero!";
+                success = false;
+                break;
+            }
+        }
+
+        success &= this->testSlowLine(fpga, model);
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    UartBulkTest test;
+    return (uint32_t)test.runTest();
+}
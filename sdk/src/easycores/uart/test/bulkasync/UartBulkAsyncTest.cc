@@ -0,0 +1,164 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/register.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulateduart.h"
+#include "easyfpga/utils/config/configurationfile.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class BulkFpga : public EasyFpga
+{
+    public:
+        BulkFpga() :
+            uart(std::make_shared<Uart>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(uart);
+        }
+
+        uart_ptr uart;
+};
+
+/**
+ * \brief Tests Uart::transmit(byte*, uint32_t) and
+ *        Uart::receive(byte*, uint32_t) in the asynchronous mode
+ *
+ * The test needs no easyFPGA. In loopback, a byte array is transmitted
+ * and received again FIFO by FIFO, all started before a single
+ * handleReplies(). Every FIFO has to be moved by a single exchange.
+ */
+class UartBulkAsyncTest : public Tester
+{
+    std::string testName(void) {
+        return "uart bulk transfer test (async)";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    bool testMethod(void) {
+        if (ConfigurationFile::getInstance().getOperationMode() != OPERATION_MODE::ASYNC) {
+            Log().Get(ERROR) << "This test has to run in the asynchronous mode!";
+            return false;
+        }
+
+        auto model = std::make_shared<SimulatedUart>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        BulkFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        /*
+         * init() doesn't support the async mode, so only enable the 64
+         * byte FIFOs (accepted while the divisor latch is accessible)
+         */
+        fpga.uart->getRegister(Uart::REGISTER::LCR)->writeAsync((byte)0x83);
+        fpga.uart->getRegister(Uart::REGISTER::FCR)->writeAsync((byte)0x21);
+        fpga.uart->getRegister(Uart::REGISTER::LCR)->writeAsync((byte)0x03);
+        if (!fpga.handleReplies()) {
+            Log().Get(ERROR) << "Couldn't enable the FIFOs!";
+            return false;
+        }
+
+        const uint32_t length = 1000;
+        std::vector<byte> data(length);
+        for (uint32_t i=0; i<length; i++) {
+            data[i] = (byte)(i * 13 + 1);
+        }
+
+        uint64_t expectedChunks = (length + Uart::FIFO_DEPTH - 1) / Uart::FIFO_DEPTH;
+        uint64_t writes = this->countRequests(0x65);
+
+        bool success = fpga.uart->transmit(data.data(), length);
+        success &= fpga.handleReplies();
+
+        if (!success || (model->takeTransmittedBytes() != data) ||
+            (this->countRequests(0x65) - writes != expectedChunks)) {
+            Log().Get(ERROR) << "Transmitting " << length << " bytes failed!";
+            return false;
+        }
+
+        /* a receive of more bytes than available is filled up with zeros */
+        model->injectReceivedBytes(data.data(), 40);
+
+        std::vector<byte> received(Uart::FIFO_DEPTH, 0xFF);
+        success = fpga.uart->receive(received.data(), Uart::FIFO_DEPTH);
+        success &= fpga.handleReplies();
+
+        std::vector<byte> expected(data.begin(), data.begin() + 40);
+        expected.resize(Uart::FIFO_DEPTH, 0x00);
+
+        if (!success || (received != expected)) {
+            Log().Get(ERROR) << "Receiving a partially filled FIFO failed!";
+            return false;
+        }
+
+        /* an empty FIFO ends the receive after the first status read */
+        uint64_t reads = this->countRequests(0x73);
+        std::fill(received.begin(), received.end(), 0xFF);
+
+        success = fpga.uart->receive(received.data(), Uart::FIFO_DEPTH);
+        success &= fpga.handleReplies();
+
+        if (!success || (received != std::vector<byte>(Uart::FIFO_DEPTH, 0x00)) ||
+            (this->countRequests(0x73) != reads)) {
+            Log().Get(ERROR) << "Receiving from an empty FIFO failed!";
+            return false;
+        }
+
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    UartBulkAsyncTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,211 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/communication/metrics.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulateduart.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/time_helper.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static uint32_t userCallbacks = 0;
+
+static void uartCallback(void)
+{
+    userCallbacks++;
+}
+
+class StreamFpga : public EasyFpga
+{
+    public:
+        StreamFpga() :
+            uart(std::make_shared<Uart>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(uart);
+        }
+
+        uart_ptr uart;
+};
+
+/**
+ * \brief Tests the receive stream of the Uart
+ *
+ * The test needs no easyFPGA. Bytes received by a simulated uart have
+ * to arrive in order in the host buffer, drained by bursts of the
+ * trigger level. Bytes not fitting into the host buffer have to be
+ * counted as dropped.
+ */
+class UartStreamTest : public Tester
+{
+    std::string testName(void) {
+        return "uart receive stream test";
+    }
+
+    uint64_t countRequests(byte opcode) {
+        MetricsSnapshot snapshot = Metrics::getInstance().getSnapshot();
+        for (auto& exchange : snapshot.exchanges) {
+            if (exchange.opcode == opcode) {
+                return exchange.requests;
+            }
+        }
+        return 0;
+    }
+
+    /* handles replies until the expected number of bytes is readable */
+    bool waitForBytes(StreamFpga& fpga, uint32_t expected) {
+        timevalue timeout = getMonotonicTimeInNanos() + 2000000000;
+
+        while (fpga.uart->readable() < expected) {
+            if (!fpga.handleReplies() || (getMonotonicTimeInNanos() > timeout)) {
+                Log().Get(ERROR) << "Only " << fpga.uart->readable() << " of " << expected << " bytes received!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        auto model = std::make_shared<SimulatedUart>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        StreamFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        if (!fpga.uart->init(115200, Uart::WORD_LENGTH::C8, Uart::PARITY::NO_PARITY, Uart::STOP_BIT_COUNT::ONE_BIT) ||
+            !fpga.uart->registerCallback(uartCallback) ||
+            !fpga.uart->startReceiveStream(Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_32, 256)) {
+            Log().Get(ERROR) << "Couldn't start the receive stream!";
+            return false;
+        }
+
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        /* 4 full FIFOs, each drained by 2 bursts of the trigger level */
+        std::vector<byte> data(256);
+        for (uint32_t i=0; i<data.size(); i++) {
+            data[i] = (byte)(i * 7 + 3);
+        }
+
+        uint64_t bursts = this->countRequests(0x73);
+        bool success = true;
+
+        for (uint32_t offset=0; offset<data.size(); offset+=Uart::FIFO_DEPTH) {
+            model->injectReceivedBytes(data.data() + offset, Uart::FIFO_DEPTH);
+            success &= this->waitForBytes(fpga, offset + Uart::FIFO_DEPTH);
+        }
+
+        std::vector<byte> received(data.size());
+        if (!success || (fpga.uart->read(received.data(), received.size()) != data.size()) || (received != data)) {
+            Log().Get(ERROR) << "The received bytes are wrong!";
+            success = false;
+        }
+
+        if (this->countRequests(0x73) - bursts != 8) {
+            Log().Get(ERROR) << "The FIFO wasn't drained by bursts of the trigger level!";
+            success = false;
+        }
+
+        if ((userCallbacks == 0) || (fpga.uart->readable() != 0)) {
+            Log().Get(ERROR) << "The registered callback wasn't invoked!";
+            success = false;
+        }
+
+        /* less bytes than the trigger level arrive by character timeouts */
+        model->injectReceivedBytes(data.data(), 5);
+        success &= this->waitForBytes(fpga, 5);
+        if ((fpga.uart->read(received.data(), 10) != 5) || (memcmp(received.data(), data.data(), 5) != 0)) {
+            Log().Get(ERROR) << "Bytes below the trigger level are wrong!";
+            success = false;
+        }
+
+        /* the stream keeps receiving after a failed drain */
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 4);
+        model->injectReceivedBytes(data.data(), 5);
+        success &= this->waitForBytes(fpga, 5);
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 0);
+        if ((fpga.uart->read(received.data(), 10) != 5) || (memcmp(received.data(), data.data(), 5) != 0)) {
+            Log().Get(ERROR) << "The stream didn't recover from a failed drain!";
+            success = false;
+        }
+
+        /* a full host buffer drops the newest bytes */
+        for (uint32_t offset=0; offset<data.size(); offset+=Uart::FIFO_DEPTH) {
+            model->injectReceivedBytes(data.data() + offset, Uart::FIFO_DEPTH);
+            success &= this->waitForBytes(fpga, offset + Uart::FIFO_DEPTH);
+        }
+        model->injectReceivedBytes(data.data(), 10);
+        timevalue until = getMonotonicTimeInNanos() + 2000000000;
+        while ((fpga.uart->getNumberOfDroppedBytes() < 10) && (getMonotonicTimeInNanos() < until)) {
+            fpga.handleReplies();
+        }
+        if ((fpga.uart->getNumberOfDroppedBytes() != 10) || (fpga.uart->readable() != data.size())) {
+            Log().Get(ERROR) << "Overflowing bytes weren't dropped!";
+            success = false;
+        }
+
+        /* stopped streams leave received bytes in the FIFO */
+        if (!fpga.uart->stopReceiveStream()) {
+            success = false;
+        }
+        fpga.uart->read(received.data(), received.size());
+        model->injectReceivedBytes(data.data(), 3);
+        fpga.handleReplies();
+
+        byte b = 0x00;
+        if ((fpga.uart->readable() != 0) || !fpga.uart->receive(&b) || (b != data[0])) {
+            Log().Get(ERROR) << "The stopped stream still received bytes!";
+            success = false;
+        }
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    UartStreamTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,153 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/register.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulateduart.h"
+#include "easyfpga/utils/config/configurationfile.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/time_helper.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+class StreamFpga : public EasyFpga
+{
+    public:
+        StreamFpga() :
+            uart(std::make_shared<Uart>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(uart);
+        }
+
+        uart_ptr uart;
+};
+
+/**
+ * \brief Tests the receive stream of the Uart in the asynchronous mode
+ *
+ * The test needs no easyFPGA. Bytes received by a simulated uart, above
+ * and below the trigger level, have to arrive in order in the host
+ * buffer while the application only calls EasyFpga::handleReplies().
+ */
+class UartStreamAsyncTest : public Tester
+{
+    std::string testName(void) {
+        return "uart receive stream test (async)";
+    }
+
+    bool receive(StreamFpga& fpga, std::shared_ptr<SimulatedUart> model, const std::vector<byte>& data) {
+        timevalue timeout = getMonotonicTimeInNanos() + 2000000000;
+
+        model->injectReceivedBytes(data.data(), data.size());
+        while (fpga.uart->readable() < data.size()) {
+            if (!fpga.handleReplies() || (getMonotonicTimeInNanos() > timeout)) {
+                Log().Get(ERROR) << "Only " << fpga.uart->readable() << " of " << data.size() << " bytes received!";
+                return false;
+            }
+        }
+
+        std::vector<byte> received(data.size());
+        if ((fpga.uart->read(received.data(), received.size()) != data.size()) || (received != data)) {
+            Log().Get(ERROR) << "The received bytes are wrong!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        if (ConfigurationFile::getInstance().getOperationMode() != OPERATION_MODE::ASYNC) {
+            Log().Get(ERROR) << "This test has to run in the asynchronous mode!";
+            return false;
+        }
+
+        auto model = std::make_shared<SimulatedUart>();
+
+        BoardSimulator board;
+        board.addCore(1, model);
+        board.startSoc();
+
+        StreamFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        /* init() doesn't support the async mode, so only enable the 64 byte FIFOs */
+        fpga.uart->getRegister(Uart::REGISTER::LCR)->writeAsync((byte)0x83);
+        fpga.uart->getRegister(Uart::REGISTER::FCR)->writeAsync((byte)0x21);
+        fpga.uart->getRegister(Uart::REGISTER::LCR)->writeAsync((byte)0x03);
+
+        bool success = fpga.uart->startReceiveStream(Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_16);
+        success &= fpga.handleReplies();
+        if (!success) {
+            Log().Get(ERROR) << "Couldn't start the receive stream!";
+            return false;
+        }
+
+        std::vector<byte> data(Uart::FIFO_DEPTH);
+        for (uint32_t i=0; i<data.size(); i++) {
+            data[i] = (byte)(i * 7 + 3);
+        }
+
+        for (uint32_t round=0; round<4; round++) {
+            success &= this->receive(fpga, model, data);
+        }
+        success &= this->receive(fpga, model, std::vector<byte>(data.begin(), data.begin() + 5));
+
+        /* the stream keeps receiving after a failed drain, which handleReplies() reports */
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 4);
+        model->injectReceivedBytes(data.data(), 5);
+        timevalue until = getMonotonicTimeInNanos() + 2000000000;
+        while ((fpga.uart->readable() < 5) && (getMonotonicTimeInNanos() < until)) {
+            fpga.handleReplies();
+        }
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 0);
+
+        std::vector<byte> received(5);
+        if ((fpga.uart->read(received.data(), received.size()) != 5) || (memcmp(received.data(), data.data(), 5) != 0)) {
+            Log().Get(ERROR) << "The stream didn't recover from a failed drain!";
+            success = false;
+        }
+
+        return success && (fpga.uart->getNumberOfDroppedBytes() == 0);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    UartStreamAsyncTest test;
+    return (uint32_t)test.runTest();
+}
@@ -19,21 +19,33 @@
  *
  */
 
+#include "communication/communicator.h"
 #include "configuration.h" /* WISHBONE_CLOCK_FREQUENCY */
 #include "easycores/pin.h"
 #include "easycores/register.h"
+#include "easycores/uart/callbacks/fifo_transfer.h"
 #include "easycores/uart/callbacks/init_method.h"
 #include "easycores/uart/callbacks/interrupt_identification.h"
 #include "easycores/uart/callbacks/set_baudrate_divisor.h"
 #include "easycores/uart/callbacks/read_modify_write.h"
+#include "easycores/uart/callbacks/stream_receive.h"
 #include "easycores/uart/uart.h"
 #include "utils/log/log.h"
+#include "utils/os/time_helper.h"
+#include "utils/spscringbuffer.h"
 
+#include <cstring>
 #include <sstream>
 
+const uint32_t Uart::FIFO_DEPTH;
+const uint32_t Uart::RECEIVE_STATUS_LENGTH;
+
 Uart::Uart() :
     EasyCore(UNIQUE_CORE_NUMBER),
-    _rxTriggerLevel(RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_1)
+    _rxTriggerLevel(RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_1),
+    _streaming(false),
+    _streamBuffer(NULL),
+    _droppedStreamBytes(0)
 {
     _pinMap.insert(std::make_pair(PIN::RXD, std::make_shared<Pin>("RXD_i", &_index, PIN::RXD, PIN_DIRECTION_TYPE::IN)));
     _pinMap.insert(std::make_pair(PIN::TXD, std::make_shared<Pin>("TXD_o", &_index, PIN::TXD, PIN_DIRECTION_TYPE::OUT)));
@@ -62,6 +74,8 @@ Uart::Uart() :
 
 Uart::~Uart()
 {
+    delete _streamBuffer;
+    _streamBuffer = NULL;
 }
 
 std::string Uart::getHdlInjections(void)
@@ -124,7 +138,7 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The word length parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The word length parameter is not valid.";
             return false;
     }
 
@@ -138,7 +152,7 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The number of stop bits is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The number of stop bits is not valid.";
             return false;
     }
 
@@ -157,7 +171,7 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
             break;
 
         default:
-            Log().Get(WARNING) << "Init method fails. The parity selection parameter is not valid.";
+            EASYFPGA_LOG(WARNING) << "Init method fails. The parity selection parameter is not valid.";
             return false;
     }
 
@@ -168,13 +182,13 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
         case OPERATION_MODE::SYNC:
             /* write line control register */
             if (!getRegister(REGISTER::LCR)->writeSync(lcrContent)) {
-                Log().Get(WARNING) << "Init method could not set the communication line parameters.";
+                EASYFPGA_LOG(WARNING) << "Init method could not set the communication line parameters.";
                 return false;
             }
 
             /* set baudrate */
             if (!this->setBaudrate(baudrate)) {
-                Log().Get(WARNING) << "Init method could not set the desired baudrate.";
+                EASYFPGA_LOG(WARNING) << "Init method could not set the desired baudrate.";
                 return false;
             }
 
@@ -190,7 +204,7 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
             }
 
             if (!getRegister(REGISTER::FCR)->writeSync((byte)0x21)) {
-                Log().Get(WARNING) << "Init method could not enable the 64 byte fifos.";
+                EASYFPGA_LOG(WARNING) << "Init method could not enable the 64 byte fifos.";
                 return false;
             }
 
@@ -201,7 +215,7 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
 
             /* disable tx empty interrupt */
             if (!this->disableInterrupt(INTERRUPT::TX_EMPTY)) {
-                Log().Get(WARNING) << "Init method could not disable the INTERRUPT::TX_EMPTY interrupt.";
+                EASYFPGA_LOG(WARNING) << "Init method could not disable the INTERRUPT::TX_EMPTY interrupt.";
                 return false;
             }
 
@@ -209,7 +223,7 @@ bool Uart::init(uint32_t baudrate, WORD_LENGTH wLength, PARITY parity, STOP_BIT_
 
         /** \todo Support async mode */
         case OPERATION_MODE::ASYNC:
-            Log().Get(WARNING) << "Async mode not yet supported. Aborting ...";
+            EASYFPGA_LOG(WARNING) << "Async mode not yet supported. Aborting ...";
             return false;
     }
 
@@ -221,7 +235,7 @@ bool Uart::setBaudrate(uint32_t baudrate)
     /* PARAMETER CHECK */
     uint32_t baudrateDivisorHelper = (uint32_t)(WISHBONE_CLOCK_FREQUENCY / (baudrate * 16));
 
-    Log().Get(DEBUG) << "Initialized baurate: " << (uint32_t)(WISHBONE_CLOCK_FREQUENCY / (baudrateDivisorHelper * 16));
+    EASYFPGA_LOG(DEBUG) << "Initialized baurate: " << (uint32_t)(WISHBONE_CLOCK_FREQUENCY / (baudrateDivisorHelper * 16));
 
     /* sanity check of divisor value */
     assert (baudrateDivisorHelper < (uint32_t)0xFFFF);
@@ -274,18 +288,22 @@ bool Uart::setRxTriggerLevel(RX_TRIGGER_LEVEL level)
         case Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_1:
             _rxTriggerLevel = RX_TRIGGER_LEVEL_1;
             value = (byte)0x01;
+            break;
 
         case Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_16:
             _rxTriggerLevel = RX_TRIGGER_LEVEL_16;
             value = (byte)0x41;
+            break;
 
         case Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_32:
             _rxTriggerLevel = RX_TRIGGER_LEVEL_32;
             value = (byte)0x81;
+            break;
 
         case Uart::RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_56:
             _rxTriggerLevel = RX_TRIGGER_LEVEL_56;
             value = (byte)0xC1;
+            break;
 
         default:
             return false;
@@ -564,6 +582,193 @@ bool Uart::identifyInterrupt(Uart::INTERRUPT* target)
     return false;
 }
 
+bool Uart::startReceiveStream(RX_TRIGGER_LEVEL level, uint32_t bufferSize)
+{
+    /* PARAMETER CHECK */
+    if (bufferSize == 0) {
+        EASYFPGA_LOG(WARNING) << "The buffer of a receive stream can't be empty.";
+        return false;
+    }
+
+    delete _streamBuffer;
+    _streamBuffer = new SpscRingBuffer<byte>(bufferSize);
+    _droppedStreamBytes = 0;
+    _streaming = true;
+
+    /* PERFORM AN ACTION DEPENDING ON MODE */
+    bool success = this->setRxTriggerLevel(level);
+    byte buffer;
+
+    /* enable RX_AVAILABLE and CHARACTER_TIMEOUT by a single read-modify-write */
+    switch (_OPERATION_MODE) {
+        case OPERATION_MODE::SYNC:
+            buffer = (byte)0x00;
+            success &= getRegister(REGISTER::IER)->readSync(&buffer);
+            setBit(buffer, 0);
+            setBit(buffer, 4);
+            success &= getRegister(REGISTER::IER)->writeSync(buffer);
+
+            return success && _communicator->enableGlobalInterrupts();
+
+        case OPERATION_MODE::ASYNC:
+            std::list<std::pair<uint8_t, LogicLevel>> pinsToModify;
+            pinsToModify.push_back(std::make_pair(0, HIGH));
+            pinsToModify.push_back(std::make_pair(4, HIGH));
+
+            callback_ptr c = std::make_shared<UartModifiedWriteCallback>(this, REGISTER::IER, pinsToModify);
+            success &= getRegister(REGISTER::IER)->readAsync(c->getBuffer(), c);
+
+            return success && _communicator->enableGlobalInterruptsAsync();
+    }
+
+    return false;
+}
+
+bool Uart::stopReceiveStream(void)
+{
+    _streaming = false;
+
+    /* PERFORM AN ACTION DEPENDING ON MODE */
+    byte buffer;
+
+    switch (_OPERATION_MODE) {
+        case OPERATION_MODE::SYNC:
+            buffer = (byte)0x00;
+            if (!getRegister(REGISTER::IER)->readSync(&buffer)) {
+                return false;
+            }
+            clrBit(buffer, 0);
+            clrBit(buffer, 4);
+            return getRegister(REGISTER::IER)->writeSync(buffer);
+
+        case OPERATION_MODE::ASYNC:
+            std::list<std::pair<uint8_t, LogicLevel>> pinsToModify;
+            pinsToModify.push_back(std::make_pair(0, LOW));
+            pinsToModify.push_back(std::make_pair(4, LOW));
+
+            callback_ptr c = std::make_shared<UartModifiedWriteCallback>(this, REGISTER::IER, pinsToModify);
+            return getRegister(REGISTER::IER)->readAsync(c->getBuffer(), c);
+    }
+
+    return false;
+}
+
+uint32_t Uart::readable(void)
+{
+    return (_streamBuffer != NULL) ? _streamBuffer->getSize() : 0;
+}
+
+uint32_t Uart::read(byte* targetBuffer, uint32_t maxCount)
+{
+    return (_streamBuffer != NULL) ? _streamBuffer->pop(targetBuffer, maxCount) : 0;
+}
+
+uint64_t Uart::getNumberOfDroppedBytes(void)
+{
+    return _droppedStreamBytes;
+}
+
+void Uart::appendToReceiveStream(const byte* data, uint32_t count)
+{
+    uint32_t appended = _streamBuffer->push(data, count);
+
+    if (appended < count) {
+        _droppedStreamBytes += count - appended;
+        EASYFPGA_LOG(WARNING) << "Receive stream buffer is full. " << count - appended << " bytes dropped!";
+    }
+}
+
+Uart::RX_TRIGGER_LEVEL Uart::getRxTriggerLevel(void)
+{
+    return _rxTriggerLevel;
+}
+
+bool Uart::executeCallback(void)
+{
+    if (!_streaming) {
+        return EasyCore::executeCallback();
+    }
+
+    callback_ptr c;
+
+    /* PERFORM AN ACTION DEPENDING ON MODE */
+    switch (_OPERATION_MODE) {
+        case OPERATION_MODE::SYNC:
+            if (!this->drainReceiveFifoSync()) {
+                EASYFPGA_LOG(WARNING) << "Couldn't drain the receive FIFO into the receive stream.";
+            }
+            break;
+
+        case OPERATION_MODE::ASYNC:
+            c = std::make_shared<UartStreamReceiveCallback>(this, 0);
+            if (!getRegister(REGISTER::IIR)->readAsync(c->getBuffer(), c)) {
+                EASYFPGA_LOG(WARNING) << "Couldn't drain the receive FIFO into the receive stream.";
+                _communicator->enableGlobalInterruptsAsync();
+            }
+            break;
+    }
+
+    EasyCore::executeCallback();
+    return true;
+}
+
+bool Uart::drainReceiveFifoSync(void)
+{
+    byte buffer[FIFO_DEPTH];
+    byte lineStatus[FIFO_DEPTH];
+    bool success = true;
+
+    while (success) {
+        byte identification;
+        if (!getRegister(REGISTER::IIR)->readSync(&identification)) {
+            success = false;
+            break;
+        }
+
+        if ((identification & 0x0F) == (byte)0x04) {
+            /* RX_AVAILABLE: at least the trigger level is in the FIFO */
+            uint32_t pending = (uint32_t)_rxTriggerLevel;
+            success = getRegister(REGISTER::RX)->readMultiTimesSync(buffer, (uint8_t)pending);
+            if (success) {
+                this->appendToReceiveStream(buffer, pending);
+            }
+        }
+        else if ((identification & 0x0F) == (byte)0x0C) {
+            /*
+             * CHARACTER_TIMEOUT: less bytes than the trigger level are in
+             * the FIFO. Pairs of line status and receive register reads
+             * are sent at once, a receive read is only valid if the line
+             * status before reported received data.
+             */
+            uint32_t pairs = ((uint32_t)_rxTriggerLevel > 1) ? (uint32_t)_rxTriggerLevel - 1 : 1;
+
+            _communicator->beginRequestBatch();
+            for (uint32_t i=0; i<pairs; i++) {
+                success &= getRegister(REGISTER::LSR)->readAsync(lineStatus + i);
+                success &= getRegister(REGISTER::RX)->readAsync(buffer + i);
+            }
+            success &= _communicator->finishRequestBatch();
+
+            if (success) {
+                uint32_t received = 0;
+                for (uint32_t i=0; i<pairs; i++) {
+                    if ((lineStatus[i] & LINE_STATUS::DATA_READY) != 0) {
+                        buffer[received++] = buffer[i];
+                    }
+                }
+                this->appendToReceiveStream(buffer, received);
+            }
+        }
+        else {
+            break;
+        }
+    }
+
+    /* the stream stops unless the interrupts are enabled again */
+    success &= _communicator->enableGlobalInterrupts();
+    return success;
+}
+
 bool Uart::transmit(byte b)
 {
     /* PARAMETER CHECK */
@@ -585,9 +790,21 @@ bool Uart::transmit(byte* buffer, uint32_t byteCount)
 {
     /* PARAMETER CHECK */
 
+    if (byteCount == 0) {
+        return true;
+    }
+
     /* PERFORM AN ACTION DEPENDING ON MODE */
-    /** \todo Implement this function */
-    Log().Get(WARNING) << "transmit(byte*, uint32_t) is not yet implemented. Aborting ...";
+    switch (_OPERATION_MODE) {
+        case OPERATION_MODE::SYNC:
+            return this->transferFifoSync(buffer, byteCount, true);
+
+        case OPERATION_MODE::ASYNC:
+            timevalue start = getMonotonicTimeInNanos();
+            callback_ptr c = std::make_shared<UartFifoTransferCallback>(this, buffer, byteCount, byteCount, true, start, start);
+            return getRegister(REGISTER::LSR)->readAsync(c->getBuffer(), c);
+    }
+
     return false;
 }
 
@@ -612,12 +829,98 @@ bool Uart::receive(byte* targetBuffer, uint32_t byteCount)
 {
     /* PARAMETER CHECK */
 
+    if (byteCount == 0) {
+        return true;
+    }
+
     /* PERFORM AN ACTION DEPENDING ON MODE */
-    /** \todo Implement this function */
-    Log().Get(WARNING) << "receive(byte*, uint32_t) is not yet implemented. Aborting ...";
+    switch (_OPERATION_MODE) {
+        case OPERATION_MODE::SYNC:
+            return this->transferFifoSync(targetBuffer, byteCount, false);
+
+        case OPERATION_MODE::ASYNC:
+            timevalue start = getMonotonicTimeInNanos();
+            callback_ptr c = std::make_shared<UartFifoTransferCallback>(this, targetBuffer, byteCount, byteCount, false, start, start);
+            return getRegister(REGISTER::IIR)->readAutoAddressIncrementAsync(c->getBuffer(), RECEIVE_STATUS_LENGTH, c);
+    }
+
     return false;
 }
 
+uint32_t Uart::getNumberOfReadableBytes(const byte* status)
+{
+    /* an RX_AVAILABLE interrupt guarantees the trigger level */
+    if ((status[0] & 0x0F) == (byte)0x04) {
+        return (uint32_t)_rxTriggerLevel;
+    }
+
+    /* otherwise only a single byte is known to be present */
+    if ((status[3] & LINE_STATUS::DATA_READY) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+bool Uart::transferFifoSync(byte* buffer, uint32_t byteCount, bool transmit)
+{
+    timevalue start = getMonotonicTimeInNanos();
+    timevalue lastChunk = start;
+    uint32_t remaining = byteCount;
+
+    while (remaining > 0) {
+        uint32_t chunk = (remaining < FIFO_DEPTH) ? remaining : FIFO_DEPTH;
+
+        if (transmit) {
+            byte lineStatus;
+            if (!getRegister(REGISTER::LSR)->readSync(&lineStatus)) {
+                return false;
+            }
+
+            if ((lineStatus & LINE_STATUS::TX_FIFO_EMPTY) == 0) {
+                /* only a FIFO which stopped draining is an error */
+                if (getMonotonicTimeInNanos() - lastChunk > (timevalue)UART_FIFO_TIMEOUT * 1000) {
+                    EASYFPGA_LOG(WARNING) << "Transmit FIFO didn't become empty. " << remaining << " of " << byteCount << " bytes aren't transmitted!";
+                    return false;
+                }
+                continue;
+            }
+
+            if (!getRegister(REGISTER::TX)->writeMultiTimesSync(buffer, (uint8_t)chunk)) {
+                return false;
+            }
+            lastChunk = getMonotonicTimeInNanos();
+        }
+        else {
+            /* IIR, LCR, MCR and LSR by a single exchange */
+            byte status[RECEIVE_STATUS_LENGTH];
+            if (!getRegister(REGISTER::IIR)->readAutoAddressIncrementSync(status, RECEIVE_STATUS_LENGTH)) {
+                return false;
+            }
+
+            uint32_t available = this->getNumberOfReadableBytes(status);
+            if (available == 0) {
+                memset(buffer, 0x00, remaining);
+                break;
+            }
+            chunk = (chunk < available) ? chunk : available;
+
+            if (!getRegister(REGISTER::RX)->readMultiTimesSync(buffer, (uint8_t)chunk)) {
+                return false;
+            }
+        }
+
+        buffer += chunk;
+        remaining -= chunk;
+    }
+
+    timevalue duration = getMonotonicTimeInNanos() - start;
+    EASYFPGA_LOG(DEBUG) << (transmit ? "Transmitted " : "Received ") << byteCount << " bytes with "
+                        << ((duration > 0) ? (uint64_t)byteCount * 1000000000 / duration : 0) << " bytes/s.";
+
+    return true;
+}
+
 
 bool Uart::clearBuffers(void)
 {
@@ -24,9 +24,12 @@
 #define SDK_EASYCORES_UART_UART_H_
 
 #include "easycores/easycore.h"
+#include "configuration.h" /* UART_STREAM_BUFFER_SIZE */
 #include "easycores/types.h"
 #include "utils/hardwaretypes.h"
+#include "utils/spscringbuffer_fwd.h"
 
+#include <atomic>
 #include <string>
 
 /**
@@ -84,7 +87,15 @@
  * The receive buffer trigger level configures how many received words
  * are required to issue an Uart::INTERRUPT::RX_AVAILABLE interrupt.
  * There are four levels allowed: 1, 16, 32 and 56. For convenience you
- * have to use the constants defined in Uart::RX_TRIGGER_LEVEL.
+ * have to use the constants defined in Uart::RX_TRIGGER_LEVEL. *
+ * <b>Receive stream</b>
+ *
+ * For continuous serial data, Uart::startReceiveStream() lets the
+ * framework handle the receive interrupts: On every interrupt, the
+ * receive FIFO is drained in bursts into a host buffer and the global
+ * interrupts are enabled again. The application takes the bytes out
+ * with the non-blocking methods Uart::readable() and Uart::read()
+ * after EasyFpga::handleReplies() has been called.
  */
 class Uart : public EasyCore
 {
@@ -341,6 +352,27 @@ class Uart : public EasyCore
             DLM = UNIQUE_CORE_NUMBER*MAX_GLOBAL_OFFSET+MAX_GLOBAL_PIN_COUNT+11
         };
 
+        /**
+         * \brief Bits of the line status register used by the framework.
+         */
+        enum LINE_STATUS : byte {
+            /**
+             * At least one character is in the receive FIFO.
+             */
+            DATA_READY = 0x01,
+
+            /**
+             * The transmit FIFO is empty.
+             */
+            TX_FIFO_EMPTY = 0x20
+        };
+
+        /**
+         * \brief Size of the receive and the transmit FIFO. (init()
+         *        enables the 64 byte mode.)
+         */
+        static const uint32_t FIFO_DEPTH = 64;
+
         /* CORE SETTINGS */
         /**
          * \brief Defines the possible lengths of the transmitted
@@ -616,6 +648,90 @@ class Uart : public EasyCore
          */
         bool identifyInterrupt(INTERRUPT* target);
 
+        /**
+         * \brief Lets the framework receive all incoming bytes into a
+         *        host buffer.
+         *
+         * Sets the RX trigger level and enables the RX_AVAILABLE and
+         * CHARACTER_TIMEOUT interrupts as well as the global interrupts.
+         * Whenever one of them is triggered, EasyFpga::handleReplies()
+         * reads the receive FIFO, a trigger level of bytes per exchange
+         * as long as RX_AVAILABLE is pending and single bytes after a
+         * CHARACTER_TIMEOUT, and enables the global interrupts again.
+         * In the asynchronous mode, these exchanges are completed by the
+         * next call of EasyFpga::handleReplies(). A callback registered
+         * by registerCallback() is still invoked for every interrupt.
+         *
+         * A higher trigger level needs less exchanges but leaves less
+         * time to drain the FIFO before it overruns.
+         *
+         * \param level The RX trigger level to use.
+         *
+         * \param bufferSize Capacity of the host buffer in bytes
+         *        (rounded up to a power of two). Bytes which don't fit
+         *        into it are dropped. Unread bytes of a former stream
+         *        are discarded.
+         *
+         * \return true if the exchanges could be processed successfully,<br>
+         *         false otherwise
+         */
+        bool startReceiveStream(RX_TRIGGER_LEVEL level = RX_TRIGGER_LEVEL::RX_TRIGGER_LEVEL_32, uint32_t bufferSize = UART_STREAM_BUFFER_SIZE);
+
+        /**
+         * \brief Disables the receive interrupts enabled by
+         *        startReceiveStream().
+         *
+         * Bytes already in the host buffer can still be read.
+         *
+         * \return true if the exchanges could be processed successfully,<br>
+         *         false otherwise
+         */
+        bool stopReceiveStream(void);
+
+        /**
+         * \brief Returns the number of received bytes which can be taken
+         *        by read() without blocking.
+         */
+        uint32_t readable(void);
+
+        /**
+         * \brief Takes received bytes out of the host buffer of the
+         *        receive stream. Never blocks.
+         *
+         * \param targetBuffer Location for up to maxCount bytes.
+         *
+         * \param maxCount Maximum number of bytes to take.
+         *
+         * \return The number of bytes written to targetBuffer
+         */
+        uint32_t read(byte* targetBuffer, uint32_t maxCount);
+
+        /**
+         * \brief Returns the number of received bytes dropped because the
+         *        host buffer of the receive stream was full.
+         */
+        uint64_t getNumberOfDroppedBytes(void);
+
+        /**
+         * \brief Appends bytes drained from the receive FIFO to the host
+         *        buffer. Used by the framework's callbacks only.
+         */
+        void appendToReceiveStream(const byte* data, uint32_t count);
+
+        /**
+         * \brief Returns the RX trigger level set by the user.
+         */
+        RX_TRIGGER_LEVEL getRxTriggerLevel(void);
+
+        /**
+         * \brief Drains the receive FIFO if the receive stream is
+         *        started, then calls the registered interrupt service
+         *        routine.
+         *
+         * \return true if the interrupt was handled
+         */
+        bool executeCallback(void);
+
         /* SPECIAL CORE METHODS */
         /**
          * \brief Transmits a single byte.
@@ -630,6 +746,12 @@ class Uart : public EasyCore
         /**
          * \brief Transmits a byte array automatically.
          *
+         * Whenever the line status register reports an empty transmit
+         * FIFO, up to FIFO_DEPTH bytes are written by a single exchange.
+         * In the asynchronous mode, this polling is continued by
+         * EasyFpga::handleReplies() until all bytes are written, so the
+         * buffer has to stay valid until then.
+         *
          * \param buffer Pointer to a byte array.
          *
          * \param byteCount Number of bytes to be transmitted.
@@ -661,6 +783,14 @@ class Uart : public EasyCore
          * characters in the receive buffer, the result will contain
          * trailing zero bytes.
          *
+         * Only bytes known to be in the receive FIFO are read: the RX
+         * trigger level if the interrupt identification register reports
+         * an RX_AVAILABLE interrupt (i.e. the receive interrupts are
+         * enabled), otherwise a single byte if the line status register
+         * reports received data. These registers are read by a single
+         * exchange before every read of at most FIFO_DEPTH bytes. If the
+         * FIFO is empty, the remaining bytes are set to zero.
+         *
          * \param targetBuffer A byte array pointer. The pointed location
          *        will contain the received byte array
          *        - after this method call if the framework works in
@@ -699,7 +829,34 @@ class Uart : public EasyCore
          */
         bool setAuxiliaryOutput2(LogicLevel level);
 
+        /**
+         * \brief Number of status bytes read before every chunk of
+         *        receive(byte*, uint32_t): IIR, LCR, MCR and LSR.
+         */
+        static const uint32_t RECEIVE_STATUS_LENGTH = 4;
+
+        /**
+         * \brief Returns the number of bytes known to be in the receive
+         *        FIFO.
+         *
+         * \param status RECEIVE_STATUS_LENGTH bytes read from the
+         *        IIR on.
+         */
+        uint32_t getNumberOfReadableBytes(const byte* status);
+
     protected:
+        /**
+         * \brief Transmits or receives a byte array in the synchronous
+         *        mode, see transmit() and receive().
+         */
+        bool transferFifoSync(byte* buffer, uint32_t byteCount, bool transmit);
+
+        /**
+         * \brief Drains the receive FIFO into the stream buffer in the
+         *        synchronous mode, see startReceiveStream().
+         */
+        bool drainReceiveFifoSync(void);
+
         /**
          * \brief Storing the last from the user adjusted RX trigger
          *        level.
@@ -708,6 +865,23 @@ class Uart : public EasyCore
          * be setted automatically in the clearBuffers method again.
          */
         RX_TRIGGER_LEVEL _rxTriggerLevel;
+
+        /**
+         * \brief Whether the receive interrupts are handled by the
+         *        framework.
+         */
+        bool _streaming;
+
+        /**
+         * \brief Host buffer of the receive stream, NULL before the
+         *        first startReceiveStream().
+         */
+        SpscRingBuffer<byte>* _streamBuffer;
+
+        /**
+         * \brief Counts the bytes which didn't fit into _streamBuffer.
+         */
+        std::atomic<uint64_t> _droppedStreamBytes;
 };
 
 #endif  // SDK_EASYCORES_UART_UART_H_
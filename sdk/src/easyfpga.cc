@@ -22,7 +22,9 @@
 #include "configuration.h" /* BANK_COUNT, PIN_COUNT */
 #include "easyfpga.h"
 #include "communication/communicator.h"
+#include "communication/metrics.h"
 #include "communication/protocol/calculator.h"
+#include "communication/sectormanifest.h"
 #include "easycores/easycore.h"
 #include "easycores/gpiopin.h"
 #include "easycores/types.h"
@@ -31,9 +33,12 @@
 #include "utils/idmanager.h"
 #include "utils/log/log.h"
 #include "utils/os/file.h"
+#include "utils/os/mappedfile.h"
 #include "utils/os/directory.h"
 
+#include <future> /* async() */
 #include <sstream>
+#include <vector>
 #include <iomanip> /* setw(), setfill() */
 
 EasyFpga::EasyFpga() :
@@ -72,14 +77,14 @@ EasyFpga::~EasyFpga()
 
 bool EasyFpga::init(uint32_t serialNumber, std::string pathToBinary)
 {
-    Log().Get(INFO) << "Check if the specified binary already exists. If not, try to generate this one...";
+    EASYFPGA_LOG(INFO) << "Check if the specified binary already exists. If not, try to generate this one...";
 
     File binary(pathToBinary);
     if (binary.exists()) {
-        Log().Get(DEBUG) << "The binary was found at the specified path. Check if the binary description changed...";
+        EASYFPGA_LOG(DEBUG) << "The binary was found at the specified path. Check if the binary description changed...";
     }
     else {
-        Log().Get(DEBUG) << "The binary was NOT found at the specified path. Try to generate a binary...";
+        EASYFPGA_LOG(DEBUG) << "The binary was NOT found at the specified path. Try to generate a binary...";
     }
 
     /*
@@ -96,36 +101,36 @@ bool EasyFpga::init(uint32_t serialNumber, std::string pathToBinary)
      * 2. Checks if a toolchain run will be neccessary and mightly execute
      *    it to build a new binary.
      */
-    Log().Get(INFO) << "Binary name: " << binary.getNameWithoutEnding();
-    Log().Get(INFO) << "Selected directory: " << path;
+    EASYFPGA_LOG(INFO) << "Binary name: " << binary.getNameWithoutEnding();
+    EASYFPGA_LOG(INFO) << "Selected directory: " << path;
 
     Generator g;
 
     if (g.generateBinary(binary.getNameWithoutEnding(), shared_from_this(), path.c_str())) {
-        Log().Get(INFO) << "Successful attempt for choosing the correct binary! :-D";
+        EASYFPGA_LOG(INFO) << "Successful attempt for choosing the correct binary! :-D";
     }
     else {
-        Log().Get(ERROR) << "Unsuccessful attempt to choose the correct binary. The fgpa initialization method will be aborted. :-(";
+        EASYFPGA_LOG(ERROR) << "Unsuccessful attempt to choose the correct binary. The fgpa initialization method will be aborted. :-(";
         return false;
     }
 
-    Log().Get(INFO) << "Connect to an easyFPGA...";
+    EASYFPGA_LOG(INFO) << "Connect to an easyFPGA...";
 
     if (!this->connectHardwareDevice(serialNumber)) {
         return false;
     }
 
-    Log().Get(INFO) << "Upload the given binary...";
+    EASYFPGA_LOG(INFO) << "Upload the given binary...";
 
     if (!this->uploadBinaryFile(pathToBinary)) {
         return false;
     }
 
-    Log().Get(DEBUG) << "Configure the to the fpga belonging easyCores...";
+    EASYFPGA_LOG(DEBUG) << "Configure the to the fpga belonging easyCores...";
 
     this->instantiateCores();
 
-    Log().Get(INFO) << "The fpga's initialization process was successful!";
+    EASYFPGA_LOG(INFO) << "The fpga's initialization process was successful!";
 
     return true;
 }
@@ -135,96 +140,156 @@ communicator_ptr EasyFpga::getCommunicator(void)
     return _com;
 }
 
+MetricsSnapshot EasyFpga::getMetrics(void)
+{
+    return Metrics::getInstance().getSnapshot();
+}
+
 bool EasyFpga::connectHardwareDevice(uint32_t serialNumber)
 {
     if (_com->init(serialNumber)) {
         uint32_t serialRead = 0;
         if (_com->readSerial(&serialRead)) {
-            Log().Get(DEBUG) << "Connection to an easyFPGA with serial number 0x" << std::hex << serialRead << " successfully established.";
+            EASYFPGA_LOG(DEBUG) << "Connection to an easyFPGA with serial number 0x" << std::hex << serialRead << " successfully established.";
         }
         return true;
     }
     else {
-        Log().Get(WARNING) << "No connection to an easyFPGA established. :-(";
+        EASYFPGA_LOG(WARNING) << "No connection to an easyFPGA established. :-(";
         return false;
     }
 }
 
-bool EasyFpga::uploadBinaryFile(std::string pathToBinary)
+bool EasyFpga::connectHardwareDevice(std::string devicePath)
 {
-    File binaryFile(pathToBinary);
-
-    uint64_t size = 0;
-    if (!binaryFile.getSize(&size)) {
-        Log().Get(ERROR) << "The binary (located on the pc) could not be read!";
-        Log().Get(ERROR) << "Did you used the right path to the binary in init() / uploadBinaryFile()?";
+    if (_com->initWithDevice(devicePath)) {
+        EASYFPGA_LOG(DEBUG) << "Connection to the easyFPGA at " << devicePath << " successfully established.";
+        return true;
+    }
+    else {
+        EASYFPGA_LOG(WARNING) << "No connection to an easyFPGA at " << devicePath << " established. :-(";
         return false;
     }
+}
 
-    Log().Get(DEBUG) << "Binary file size: " << size;
-    Log().Get(DEBUG) << "Write binary file into internal buffer...";
-    byte buffer[size];
-    if (!binaryFile.writeIntoByteBuffer(buffer)) {
-        Log().Get(ERROR) << "Error while reading binary!";
+bool EasyFpga::uploadBinaryFile(std::string pathToBinary)
+{
+    /* the binary is read directly from the page cache, not copied */
+    MappedFile binaryFile(pathToBinary);
+    if (!binaryFile.map()) {
+        EASYFPGA_LOG(ERROR) << "The binary (located on the pc) could not be read!";
+        EASYFPGA_LOG(ERROR) << "Did you used the right path to the binary in init() / uploadBinaryFile()?";
         return false;
     }
 
-    Log().Get(DEBUG) << "Get status from connected easyFPGA...";
+    const byte* buffer = binaryFile.getData();
+    uint64_t size = binaryFile.getSize();
+    EASYFPGA_LOG(DEBUG) << "Binary file size: " << size;
+
+    /* hash the local binary while the status is read from the easyFPGA */
+    std::future<uint32_t> localHashCalculation = std::async(std::launch::async, [buffer, size] {
+        return Calculator::updateAdler32Hash(Calculator::ADLER32_INITIAL_VALUE, buffer, size);
+    });
+
+    EASYFPGA_LOG(DEBUG) << "Get status from connected easyFPGA...";
     bool isFpgaConfigured = false;
     uint32_t remoteHash = 0;
     if (!_com->readStatus(&isFpgaConfigured, &remoteHash)) {
-        Log().Get(ERROR) << "The status of the easyFPGA board could not be read!";
+        EASYFPGA_LOG(ERROR) << "The status of the easyFPGA board could not be read!";
         return false;
     }
 
-    uint32_t localHash = Calculator::calculateAdler32Hash(buffer, size); // calculate hash from local binary
+    uint32_t localHash = localHashCalculation.get();
 
-    Log().Get(DEBUG) << "Is fpga configured: " << std::boolalpha << isFpgaConfigured;
-    Log().Get(DEBUG) << "Checksum from host binary: 0x" << std::hex << localHash;
-    Log().Get(DEBUG) << "Checksum from easyFPGA binary: 0x" << std::hex << remoteHash;
+    EASYFPGA_LOG(DEBUG) << "Is fpga configured: " << std::boolalpha << isFpgaConfigured;
+    EASYFPGA_LOG(DEBUG) << "Checksum from host binary: 0x" << std::hex << localHash;
+    EASYFPGA_LOG(DEBUG) << "Checksum from easyFPGA binary: 0x" << std::hex << remoteHash;
 
     if (localHash == remoteHash) {
-        Log().Get(DEBUG) << "No new binary upload neccessary.";
+        EASYFPGA_LOG(DEBUG) << "No new binary upload neccessary.";
 
         if (!isFpgaConfigured) {
-            Log().Get(DEBUG) << "Configure FPGA with the stored binary...";
+            EASYFPGA_LOG(DEBUG) << "Configure FPGA with the stored binary...";
             if (_com->configureFpga()) {
-                Log().Get(DEBUG) << "Success!";
+                EASYFPGA_LOG(DEBUG) << "Success!";
                 return true;
             }
             else {
-                Log().Get(ERROR) << "Configuration faulty!";
+                EASYFPGA_LOG(ERROR) << "Configuration faulty!";
             }
         }
         else {
-            Log().Get(DEBUG) << "No new configuration neccessary. Success!";
+            EASYFPGA_LOG(DEBUG) << "No new configuration neccessary. Success!";
             return true;
         }
     }
     else {
-        Log().Get(DEBUG) << "Try to upload a new binary...";
-        if (_com->writeBinary(buffer, size)) {
-            Log().Get(DEBUG) << "Binary upload ok. Now write new status to the easyFPGA...";
+        EASYFPGA_LOG(DEBUG) << "Try to upload a new binary...";
+
+        /*
+         * If we know which binary the easyFPGA stores, only the sectors
+         * which differ from the new binary have to be written.
+         */
+        SectorManifest manifest(ConfigurationFile::getInstance().getSectorManifestFile());
+        std::vector<uint64_t> sectorHashes(SectorManifest::calculateSectorHashes(buffer, size));
+        std::vector<bool> sectorMask;
+        uint32_t serial = 0;
+
+        if (_com->readSerial(&serial) && (serial != 0)) {
+            std::vector<uint64_t> storedHashes;
+            if (manifest.lookup(serial, remoteHash, &storedHashes)) {
+                uint32_t changedSectors = 0;
+                sectorMask.resize(sectorHashes.size());
+                for (uint32_t i=0; i<sectorHashes.size(); i++) {
+                    sectorMask[i] = (i >= storedHashes.size()) || (storedHashes[i] != sectorHashes[i]);
+                    changedSectors += sectorMask[i] ? 1 : 0;
+                }
+                EASYFPGA_LOG(INFO) << std::dec << changedSectors << " of " << (uint32_t)sectorHashes.size() << " sectors changed since the last upload.";
+            }
+
+            /* the memory doesn't match the entry any more once we start writing */
+            manifest.remove(serial);
+            manifest.save();
+        }
+        else {
+            serial = 0;
+        }
+
+        /*
+         * A delta upload keeps the old status until the new one will be
+         * written. If it's interrupted, the status would still match the
+         * old binary although some of its sectors are overwritten.
+         */
+        if (!sectorMask.empty() && !_com->writeStatus(false, 0, 0)) {
+            EASYFPGA_LOG(ERROR) << "Error while invalidating the status!";
+        }
+        else if (_com->writeBinary(buffer, size, sectorMask)) {
+            EASYFPGA_LOG(DEBUG) << "Binary upload ok. Now write new status to the easyFPGA...";
             if (_com->writeStatus(true, size, localHash)) {
-                Log().Get(DEBUG) << "Configure Fpga with uploaded VHDL binary...";
+                if (serial != 0) {
+                    manifest.store(serial, localHash, sectorHashes);
+                    manifest.save();
+                }
+
+                EASYFPGA_LOG(DEBUG) << "Configure Fpga with uploaded VHDL binary...";
                 if (_com->configureFpga()) {
-                    Log().Get(DEBUG) << "Configuration done. Success!";
+                    EASYFPGA_LOG(DEBUG) << "Configuration done. Success!";
                     return true;
                 }
                 else {
-                    Log().Get(ERROR) << "Configuration faulty!";
+                    EASYFPGA_LOG(ERROR) << "Configuration faulty!";
                 }
             }
             else {
-                Log().Get(ERROR) << "Error while writing status!";
+                EASYFPGA_LOG(ERROR) << "Error while writing status!";
             }
         }
         else {
-            Log().Get(ERROR) << "Error while binary upload!";
+            EASYFPGA_LOG(ERROR) << "Error while binary upload!";
         }
     }
 
-    Log().Get(WARNING) << "Binary could not be uploaded!";
+    EASYFPGA_LOG(WARNING) << "Binary could not be uploaded!";
     return false;
 }
 
@@ -267,11 +332,11 @@ bool EasyFpga::addEasyCore(easycore_ptr core)
                 return true;
             }
             else {
-                Log().Get(ERROR) << "This easyCore can not be added to this easyFPGA. Maximum number of easyCores reached!";
+                EASYFPGA_LOG(ERROR) << "This easyCore can not be added to this easyFPGA. Maximum number of easyCores reached!";
             }
         }
         else {
-            Log().Get(ERROR) << "This easyCore can not be added to this easyFPGA. The core belongs already to an other easyFPGA!";
+            EASYFPGA_LOG(ERROR) << "This easyCore can not be added to this easyFPGA. The core belongs already to an other easyFPGA!";
         }
     }
 
@@ -285,7 +350,7 @@ bool EasyFpga::removeEasyCore(easycore_ptr coreToRemove)
         size_t elementsErased = _easyCoreMap->erase(i);
 
         if (elementsErased < 1) {
-            Log().Get(WARNING) << "This easyCore can not be removed from this fpga because the core either was not added before or it belongs to another core!";
+            EASYFPGA_LOG(WARNING) << "This easyCore can not be removed from this fpga because the core either was not added before or it belongs to another core!";
         }
         else if (elementsErased == 1) {
             if (_freeCoreIndices->releaseId(i)) {
@@ -294,17 +359,17 @@ bool EasyFpga::removeEasyCore(easycore_ptr coreToRemove)
                 return true;
             }
             else {
-                Log().Get(ERROR) << "Internal Error! There are more core ids in the stack as allocated.";
+                EASYFPGA_LOG(ERROR) << "Internal Error! There are more core ids in the stack as allocated.";
                 assert(false);
             }
         }
         else {
-            Log().Get(ERROR) << "Internal Error! There more than one easyCores with one core index.";
+            EASYFPGA_LOG(ERROR) << "Internal Error! There more than one easyCores with one core index.";
             assert(false);
         }
     }
     else {
-        Log().Get(ERROR) << "The core instance was invalid.";
+        EASYFPGA_LOG(ERROR) << "The core instance was invalid.";
     }
 
     return false;
@@ -317,7 +382,7 @@ bool EasyFpga::connect(PinConst sourceGpioPin, PinConst sinkGpioPin)
     gpiopin_ptr gpio2 = this->getGpioPin(sinkGpioPin);
 
     if ((gpio1 == nullptr) || (gpio2 == nullptr)) {
-        Log().Get(ERROR) << "At least one PinConst is faulty!";
+        EASYFPGA_LOG(ERROR) << "At least one PinConst is faulty!";
         exit(-1);
         return false;
     }
@@ -330,12 +395,12 @@ bool EasyFpga::connect(easycore_ptr sourceCore, PinConst sourceCorePin, PinConst
 {
     /* PARAMETER CHECK */
     if (sourceCore == nullptr) {
-        Log().Get(ERROR) << "The pointer to the easyCore is invalid!";
+        EASYFPGA_LOG(ERROR) << "The pointer to the easyCore is invalid!";
         exit(-1);
     }
 
     if (_easyCoreMap->find(sourceCore->getIndex()) == _easyCoreMap->end()) {
-        Log().Get(ERROR) << "The easyCore currently doesn't belong to this easyFPGA! Aborting... Did you already added this core?";
+        EASYFPGA_LOG(ERROR) << "The easyCore currently doesn't belong to this easyFPGA! Aborting... Did you already added this core?";
         exit(-1);
     }
 
@@ -343,23 +408,23 @@ bool EasyFpga::connect(easycore_ptr sourceCore, PinConst sourceCorePin, PinConst
     gpiopin_ptr gpio = this->getGpioPin(sinkGpioPin);
 
     if ((pin == nullptr) || (gpio == nullptr)) {
-        Log().Get(ERROR) << "At least one PinConst is faulty!";
+        EASYFPGA_LOG(ERROR) << "At least one PinConst is faulty!";
         exit(-1);
     }
 
     if (pin->hasType(PIN_DIRECTION_TYPE::UNDEFINED)) {
-        Log().Get(ERROR) << "An internal error occured! An easyCore implementation will be wrong initialized in the constructor...";
+        EASYFPGA_LOG(ERROR) << "An internal error occured! An easyCore implementation will be wrong initialized in the constructor...";
         exit(-1);
     }
 
     /* PERFORM A CONNECT IF POSSIBLE */
     if (gpio->hasType(PIN_DIRECTION_TYPE::UNDEFINED)) {
         if (pin->hasType(PIN_DIRECTION_TYPE::INOUT)) {
-            Log().Get(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'INOUT'.";
+            EASYFPGA_LOG(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'INOUT'.";
             gpio->setType(PIN_DIRECTION_TYPE::INOUT);
         }
         else {
-            Log().Get(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'OUT'.";
+            EASYFPGA_LOG(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'OUT'.";
             gpio->setType(PIN_DIRECTION_TYPE::OUT);
         }
         return gpio->connectTo(pin);
@@ -378,12 +443,12 @@ bool EasyFpga::connect(PinConst sourceGpioPin, easycore_ptr sinkCore, PinConst s
 {
     /* PARAMETER CHECK */
     if (sinkCore == nullptr) {
-        Log().Get(ERROR) << "The pointer to the easyCore is invalid!";
+        EASYFPGA_LOG(ERROR) << "The pointer to the easyCore is invalid!";
         exit(-1);
     }
 
     if (_easyCoreMap->find(sinkCore->getIndex()) == _easyCoreMap->end()) {
-        Log().Get(ERROR) << "The easyCore currently doesn't belong to this easyFPGA! Aborting... Did you already added this core?";
+        EASYFPGA_LOG(ERROR) << "The easyCore currently doesn't belong to this easyFPGA! Aborting... Did you already added this core?";
         exit(-1);
     }
 
@@ -391,23 +456,23 @@ bool EasyFpga::connect(PinConst sourceGpioPin, easycore_ptr sinkCore, PinConst s
     gpiopin_ptr gpio = this->getGpioPin(sourceGpioPin);
 
     if ((pin == nullptr) || (gpio == nullptr)) {
-        Log().Get(ERROR) << "At least one PinConst is faulty!";
+        EASYFPGA_LOG(ERROR) << "At least one PinConst is faulty!";
         exit(-1);
     }
 
     if (pin->hasType(PIN_DIRECTION_TYPE::UNDEFINED)) {
-        Log().Get(ERROR) << "An internal error occured! An easyCore implementation will be wrong initialized in the constructor...";
+        EASYFPGA_LOG(ERROR) << "An internal error occured! An easyCore implementation will be wrong initialized in the constructor...";
         exit(-1);
     }
 
     /* PERFORM A CONNECT IF POSSIBLE */
     if (gpio->hasType(PIN_DIRECTION_TYPE::UNDEFINED)) {
         if (pin->hasType(PIN_DIRECTION_TYPE::INOUT)) {
-            Log().Get(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'INOUT'.";
+            EASYFPGA_LOG(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'INOUT'.";
             gpio->setType(PIN_DIRECTION_TYPE::INOUT);
         }
         else {
-            Log().Get(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'IN'.";
+            EASYFPGA_LOG(DEBUG) << "Pin " << gpio->getLogName() << " gets the direction 'IN'.";
             gpio->setType(PIN_DIRECTION_TYPE::IN);
         }
         return gpio->connectTo(pin);
@@ -426,12 +491,12 @@ bool EasyFpga::connect(easycore_ptr sourceCore, PinConst sourceCorePin, easycore
 {
     /* PARAMETER CHECK */
     if ((sourceCore == nullptr) || (sinkCore == nullptr)) {
-        Log().Get(ERROR) << "At least one easyCore pointer is invalid!";
+        EASYFPGA_LOG(ERROR) << "At least one easyCore pointer is invalid!";
         exit(-1);
     }
 
     if ((_easyCoreMap->find(sourceCore->getIndex()) == _easyCoreMap->end()) || (_easyCoreMap->find(sinkCore->getIndex()) == _easyCoreMap->end())) {
-        Log().Get(ERROR) << "At least one easyCore doesn't belong to this easyFPGA! Aborting... Do you already added this core?";
+        EASYFPGA_LOG(ERROR) << "At least one easyCore doesn't belong to this easyFPGA! Aborting... Do you already added this core?";
         exit(-1);
     }
 
@@ -439,22 +504,22 @@ bool EasyFpga::connect(easycore_ptr sourceCore, PinConst sourceCorePin, easycore
     pin_ptr pin2 = sinkCore->getPin(sinkCorePin);
 
     if ((pin1 == nullptr) || (pin2 == nullptr)) {
-        Log().Get(ERROR) << "At least one PinConst is faulty!";
+        EASYFPGA_LOG(ERROR) << "At least one PinConst is faulty!";
         exit(-1);
     }
 
     if (pin1->hasType(PIN_DIRECTION_TYPE::INOUT) || pin2->hasType(PIN_DIRECTION_TYPE::INOUT)) {
-        Log().Get(ERROR) << "You try to connect at least one INOUT pin (" << pin1->getLogName() << " and/or " << pin2->getLogName() << ") internally! Please make sure, that all INOUT pins in your hardware description are connected to gpio pins only...";
+        EASYFPGA_LOG(ERROR) << "You try to connect at least one INOUT pin (" << pin1->getLogName() << " and/or " << pin2->getLogName() << ") internally! Please make sure, that all INOUT pins in your hardware description are connected to gpio pins only...";
         exit(-1);
     }
 
     if (!pin1->hasType(PIN_DIRECTION_TYPE::OUT)) {
-        Log().Get(ERROR) << "Pin " << pin1->getLogName() << " isn't a source. Correct your binary description please...";
+        EASYFPGA_LOG(ERROR) << "Pin " << pin1->getLogName() << " isn't a source. Correct your binary description please...";
         exit(-1);
     }
 
     if (!pin2->hasType(PIN_DIRECTION_TYPE::IN)) {
-        Log().Get(ERROR) << "Pin " << pin2->getLogName() << " isn't a sink. Correct your binary description please...";
+        EASYFPGA_LOG(ERROR) << "Pin " << pin2->getLogName() << " isn't a sink. Correct your binary description please...";
         exit(-1);
     }
 
@@ -23,6 +23,7 @@
 #define SDK_EASYFPGA_H_
 
 #include "communication/communicator_ptr.h"
+#include "communication/metrics.h"
 #include "easycore_map_ptr.h"
 #include "easycores/easycore_ptr.h"
 #include "easycores/gpiopin_ptr.h"
@@ -129,6 +130,20 @@ class EasyFpga : public std::enable_shared_from_this<EasyFpga>
          */
         bool connectHardwareDevice(uint32_t serialNumber);
 
+        /**
+         * \brief Connects the framework to the easyFPGA board at the
+         *        given serial device without searching for it.
+         *
+         * Used by the BoardManager, which already knows all devices.
+         *
+         * \param devicePath The serial device, e.g. /dev/ttyUSB0
+         *
+         * \return true if the device is an easyFPGA and the connection
+         *         could be established,<br>
+         *         false otherwise
+         */
+        bool connectHardwareDevice(std::string devicePath);
+
         /**
          * \brief Uploads the given binary if neccessary.
          *
@@ -180,6 +195,16 @@ class EasyFpga : public std::enable_shared_from_this<EasyFpga>
          */
         bool enableInterrupts(void);
 
+        /**
+         * \brief Returns the exchange counters, reply latencies and
+         *        async queue depths.
+         *
+         * The metrics are collected for all easyFPGAs of the process
+         * together. Set the option \c METRICS_FILE in \a project.conf
+         * to write them periodically in the Prometheus text format.
+         */
+        MetricsSnapshot getMetrics(void);
+
         /* FOR BINARY GENERATION */
         /**
          * \brief Defines the available GPIO pins of this easyFPGA board.
@@ -59,12 +59,12 @@ Generator::~Generator()
 bool Generator::generateBinaries(std::string directory)
 {
     if (directory.empty()) {
-        Log().Get(ERROR) << "Path to working directory empty...";
+        EASYFPGA_LOG(ERROR) << "Path to working directory empty...";
         return false;
     }
 
-    Log().Get(INFO) << "Start generation process...";
-    Log().Get(DEBUG) << "Project directory '" << directory << "' selected.";
+    EASYFPGA_LOG(INFO) << "Start generation process...";
+    EASYFPGA_LOG(DEBUG) << "Project directory '" << directory << "' selected.";
 
     std::initializer_list<std::string> endingsListInit = {".cc", ".h"};
     std::list<std::string> interestingEndings(endingsListInit);
@@ -80,7 +80,7 @@ bool Generator::generateBinaries(std::string directory)
             endings << ", '" << *it << "'";
         }
     }
-    Log().Get(DEBUG) << "Looking for binary description files with endings " << endings.str() << " in the project directory...";
+    EASYFPGA_LOG(DEBUG) << "Looking for binary description files with endings " << endings.str() << " in the project directory...";
 
     Directory dir(directory);
     std::list<std::string> fileNames = dir.getAllFileNamesWithEndings(interestingEndings);
@@ -94,18 +94,18 @@ bool Generator::generateBinaries(std::string directory)
             File f(fullFileName);
             std::string name = f.getAnEasyFpgaName();
             if (!name.empty()) {
-                Log().Get(DEBUG) << f.getLogName() << " contains a binary description!";
+                EASYFPGA_LOG(DEBUG) << f.getLogName() << " contains a binary description!";
                 easyFpgaNames.push_back(name);
             } else {
-                Log().Get(DEBUG) << f.getLogName() << " doesn't contain a binary description!";
+                EASYFPGA_LOG(DEBUG) << f.getLogName() << " doesn't contain a binary description!";
             }
         }
 
         if (easyFpgaNames.size() > 0) {
-            Log().Get(INFO) << "The Generator found " << easyFpgaNames.size() << " easyFPGA description(s).";
+            EASYFPGA_LOG(INFO) << "The Generator found " << easyFpgaNames.size() << " easyFPGA description(s).";
         }
         else {
-            Log().Get(WARNING) << "In the working directory are cpp files, but no easyFPGA describing classes!";
+            EASYFPGA_LOG(WARNING) << "In the working directory are cpp files, but no easyFPGA describing classes!";
             return false;
         }
 
@@ -116,14 +116,14 @@ bool Generator::generateBinaries(std::string directory)
 
             std::string binaryName = *it3;
 
-            Log().Get(INFO) << "Create binary '" << binaryName << ".bin'...";
+            EASYFPGA_LOG(INFO) << "Create binary '" << binaryName << ".bin'...";
 
             if (success) {
                 std::stringstream compile;
                 compile << "g++ -std=c++0x -I " << directory << " -I " << _HEADER_DIRECTORY << " -c " << directory << "/" << binaryName << ".cc -o " << directory << "/" << binaryName << ".o -DBINARY_GENERATION_PROCESS";
-                Log().Get(DEBUG) << "Compile: " << compile.str();
+                EASYFPGA_LOG(DEBUG) << "Compile: " << compile.str();
                 if (system(compile.str().c_str()) != 0) {
-                    Log().Get(ERROR) << "Compilation of the binary generator executable for this binary failed!";
+                    EASYFPGA_LOG(ERROR) << "Compilation of the binary generator executable for this binary failed!";
                     success = false;
                 }
             }
@@ -131,9 +131,9 @@ bool Generator::generateBinaries(std::string directory)
             if (success) {
                 std::stringstream link;
                 link << "g++ " << directory << "/" << binaryName << ".o -o " << directory << "/" << binaryName << " -L " << _LIBRARY_DIRECTORY << " -lEasyFpga -lrt";
-                Log().Get(DEBUG) << "Link: " << link.str();
+                EASYFPGA_LOG(DEBUG) << "Link: " << link.str();
                 if (system(link.str().c_str()) != 0) {
-                    Log().Get(ERROR) << "Unable to link framework to the binary generator!";
+                    EASYFPGA_LOG(ERROR) << "Unable to link framework to the binary generator!";
                     success = false;
                 }
             }
@@ -142,21 +142,21 @@ bool Generator::generateBinaries(std::string directory)
                 std::stringstream execute;
                 execute << directory << "/" << binaryName << " " << directory;
                 if (system(execute.str().c_str()) != 0) {
-                    Log().Get(ERROR) << "At least one error occured during binary generation! Please have a look to the log files...";
+                    EASYFPGA_LOG(ERROR) << "At least one error occured during binary generation! Please have a look to the log files...";
                     success = false;
                 }
             }
 
-            Log().Get(DEBUG) << "Delete auto-generated files...";
+            EASYFPGA_LOG(DEBUG) << "Delete auto-generated files...";
             if (!this->cleanupBuildDirectory(directory, binaryName, !success)) {
-                Log().Get(WARNING) << "Not all auto-generated files could be deleted!";
+                EASYFPGA_LOG(WARNING) << "Not all auto-generated files could be deleted!";
             }
 
             if (success) {
-                Log().Get(INFO) << "The binary '" << binaryName << ".bin' has been created successfully.";
+                EASYFPGA_LOG(INFO) << "The binary '" << binaryName << ".bin' has been created successfully.";
             }
             else {
-                Log().Get(WARNING) << "The binary generation of '" << binaryName << ".bin' was NOT successful!";
+                EASYFPGA_LOG(WARNING) << "The binary generation of '" << binaryName << ".bin' was NOT successful!";
             }
 
             overallSuccess &= success;
@@ -165,7 +165,7 @@ bool Generator::generateBinaries(std::string directory)
         return overallSuccess;
     }
     else {
-        Log().Get(WARNING) << "There are no interesting cpp files in the project directory! Did you follow the naming conventions?";
+        EASYFPGA_LOG(WARNING) << "There are no interesting cpp files in the project directory! Did you follow the naming conventions?";
 
         return false;
     }
@@ -173,25 +173,25 @@ bool Generator::generateBinaries(std::string directory)
 
 bool Generator::generateBinary(std::string binaryName, EasyFpga* fpga, const char* directory)
 {
-    Log().Get(DEBUG) << "Generating vhdl...";
+    EASYFPGA_LOG(DEBUG) << "Generating vhdl...";
     switch (this->generateHdl(std::string(directory), binaryName, std::shared_ptr<EasyFpga>(fpga))) {
         case HDL_GENERATION_STATUS::NEW_BUILD_NECCESSARY:
-            Log().Get(DEBUG) << "Run toolchain with generated vhdl...";
+            EASYFPGA_LOG(DEBUG) << "Run toolchain with generated vhdl...";
             if (this->runToolchain(binaryName, std::string(directory))) {
-                Log().Get(DEBUG) << "Toolchain successfully executed!";
+                EASYFPGA_LOG(DEBUG) << "Toolchain successfully executed!";
                 return true;
             }
             else {
-                Log().Get(ERROR) << "The toolchain has detected errors! The build process for this binary will be aborted.";
+                EASYFPGA_LOG(ERROR) << "The toolchain has detected errors! The build process for this binary will be aborted.";
                 return false;
             }
 
         case HDL_GENERATION_STATUS::NO_NEW_BUILD_NECCESSARY:
-            Log().Get(DEBUG) << "The hardware description has not changed. Running the toolchain not neccessary!";
+            EASYFPGA_LOG(DEBUG) << "The hardware description has not changed. Running the toolchain not neccessary!";
             return true;
 
         case HDL_GENERATION_STATUS::ERRORS_AT_STRUCTURE_DESCRIPTION:
-            Log().Get(ERROR) << "The fpga decription was faulty! The build process for this binary will be aborted.";
+            EASYFPGA_LOG(ERROR) << "The fpga decription was faulty! The build process for this binary will be aborted.";
             return false;
 
         default:
@@ -201,37 +201,37 @@ bool Generator::generateBinary(std::string binaryName, EasyFpga* fpga, const cha
 
 bool Generator::generateBinary(std::string binaryName, easyfpga_ptr fpga, const char* directory)
 {
-    Log().Get(DEBUG) << "Generating vhdl...";
+    EASYFPGA_LOG(DEBUG) << "Generating vhdl...";
 
     bool success;
 
     switch (this->generateHdl(std::string(directory), binaryName, fpga)) {
         case HDL_GENERATION_STATUS::NEW_BUILD_NECCESSARY:
-            Log().Get(DEBUG) << "Run toolchain with generated vhdl...";
+            EASYFPGA_LOG(DEBUG) << "Run toolchain with generated vhdl...";
             if (this->runToolchain(binaryName, std::string(directory))) {
-                Log().Get(DEBUG) << "Toolchain successfully executed!";
+                EASYFPGA_LOG(DEBUG) << "Toolchain successfully executed!";
                 success = true;
             }
             else {
-                Log().Get(ERROR) << "The toolchain has detected errors! The build process for this binary will be aborted.";
+                EASYFPGA_LOG(ERROR) << "The toolchain has detected errors! The build process for this binary will be aborted.";
                 success = false;
             }
 
             if (success) {
-                Log().Get(INFO) << "The binary '" << binaryName << ".bin' has been created successfully.";
+                EASYFPGA_LOG(INFO) << "The binary '" << binaryName << ".bin' has been created successfully.";
             }
             else {
-                Log().Get(WARNING) << "The binary generation of '" << binaryName << ".bin' was NOT successful!";
+                EASYFPGA_LOG(WARNING) << "The binary generation of '" << binaryName << ".bin' was NOT successful!";
             }
             break;
 
         case HDL_GENERATION_STATUS::NO_NEW_BUILD_NECCESSARY:
-            Log().Get(DEBUG) << "The hardware description has not changed. Running the toolchain not neccessary!";
+            EASYFPGA_LOG(DEBUG) << "The hardware description has not changed. Running the toolchain not neccessary!";
             success = true;
             break;
 
         case HDL_GENERATION_STATUS::ERRORS_AT_STRUCTURE_DESCRIPTION:
-            Log().Get(ERROR) << "The fpga decription was faulty! The build process for this binary will be aborted.";
+            EASYFPGA_LOG(ERROR) << "The fpga decription was faulty! The build process for this binary will be aborted.";
             success = false;
             break;
 
@@ -239,9 +239,9 @@ bool Generator::generateBinary(std::string binaryName, easyfpga_ptr fpga, const
             success = false;
     }
 
-    Log().Get(DEBUG) << "Delete auto-generated files...";
+    EASYFPGA_LOG(DEBUG) << "Delete auto-generated files...";
     if (!this->cleanupBuildDirectory(directory, binaryName, !success)) {
-        Log().Get(WARNING) << "Not all auto-generated files could be deleted!";
+        EASYFPGA_LOG(WARNING) << "Not all auto-generated files could be deleted!";
         return false;
     }
 
@@ -600,7 +600,7 @@ HDL_GENERATION_STATUS Generator::generateHdl(std::string directory, std::string
         }
     }
 
-    Log().Get(DEBUG) << "This easyFpga uses " << usedCoresTypes.size() << " different easyCore(s).";
+    EASYFPGA_LOG(DEBUG) << "This easyFpga uses " << usedCoresTypes.size() << " different easyCore(s).";
 
     /*
      * STEP 5: Generate the hdl sources and the toolchain scripts
@@ -786,52 +786,52 @@ bool Generator::runToolchain(std::string binaryName, std::string directory)
     FILE* logFile = fopen(ss0.str().c_str(), "w");
 
     /* XST */
-    Log().Get(INFO) << "Step 1/5: XST";
+    EASYFPGA_LOG(INFO) << "Step 1/5: XST";
     //Log().Get(DEBUG) << std::string("xst -ifn ").append(directory).append("/xst-script");
     success = this->executeAndWriteToLog(std::string("xst -ifn ").append(directory).append("/xst-script").c_str(), logFile);
 
     /* NGDBUILD */
     if (success) {
-        Log().Get(INFO) << "Step 2/5: NGDBUILD";
+        EASYFPGA_LOG(INFO) << "Step 2/5: NGDBUILD";
         std::stringstream ss1;
         ss1 << "ngdbuild -uc " << _SOC_DIRECTORY << "/easyFPGA.ucf -aul " << directory << "/" << binaryName << ".ngc " << directory << "/" << binaryName << ".ngd";
         success = this->executeAndWriteToLog(ss1.str().c_str(), logFile);
     }
     else {
-        Log().Get(WARNING) << "Step 2/5: NGDBUILD skipped because errors occured!";
+        EASYFPGA_LOG(WARNING) << "Step 2/5: NGDBUILD skipped because errors occured!";
     }
 
     /* MAP */
     if (success) {
-        Log().Get(INFO) << "Step 3/5: MAP";
+        EASYFPGA_LOG(INFO) << "Step 3/5: MAP";
         std::stringstream ss2;
         ss2 << "map -p xc6slx9-tqg144-2 -w -o " << directory << "/" << binaryName << "-before-par.ncd " << directory << "/" << binaryName << ".ngd";
         success = this->executeAndWriteToLog(ss2.str().c_str(), logFile);
     }
     else {
-        Log().Get(WARNING) << "Step 3/5: MAP skipped because errors occured!";
+        EASYFPGA_LOG(WARNING) << "Step 3/5: MAP skipped because errors occured!";
     }
 
     /* PAR */
     if (success) {
-        Log().Get(INFO) << "Step 4/5: PAR";
+        EASYFPGA_LOG(INFO) << "Step 4/5: PAR";
         std::stringstream ss3;
         ss3 << "par -w " << binaryName << "-before-par.ncd " << directory << "/" << binaryName << ".ncd";
         success = this->executeAndWriteToLog(ss3.str().c_str(), logFile);
     }
     else {
-        Log().Get(WARNING) << "Step 4/5: PAR skipped because errors occured!";
+        EASYFPGA_LOG(WARNING) << "Step 4/5: PAR skipped because errors occured!";
     }
 
     /* BITGEN */
     if (success) {
-        Log().Get(INFO) << "Step 5/5: BITGEN";
+        EASYFPGA_LOG(INFO) << "Step 5/5: BITGEN";
         std::stringstream ss4;
         ss4 << "bitgen -w -g binary:yes -g compress " << directory << "/" << binaryName << ".ncd";
         success = this->executeAndWriteToLog(ss4.str().c_str(), logFile);
     }
     else {
-        Log().Get(WARNING) << "Step 5/5: BITGEN skipped because errors occured!";
+        EASYFPGA_LOG(WARNING) << "Step 5/5: BITGEN skipped because errors occured!";
     }
 
     fclose(logFile);
@@ -0,0 +1,675 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "communication/protocol/calculator.h"
+#include "communication/protocol/exchange.h"
+#include "simulator/boardsimulator.h"
+#include "simulator/simulatedcore.h"
+#include "utils/log/log.h"
+
+#include <cerrno>
+#include <cstring> /* memcpy(), memset(), strerror() */
+
+#include <fcntl.h> /* posix_openpt(), open(), fcntl() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <termios.h> /* tcgetattr(), cfmakeraw(), tcsetattr() */
+#include <time.h> /* nanosleep() */
+#include <unistd.h> /* read(), write(), close() */
+
+/* mcu opcodes */
+static const byte MCU_SELECT_SOC = 0x44;
+static const byte MCU_SERIAL_READ = 0xD3;
+static const byte MCU_SERIAL_WRITE = 0xDD;
+static const byte MCU_STATUS_READ = 0xC3;
+static const byte MCU_STATUS_WRITE = 0xCC;
+static const byte MCU_SECTOR_WRITE = 0x22;
+static const byte MCU_CONFIGURE = 0x33;
+
+/* soc opcodes */
+static const byte SOC_SELECT_MCU = 0x55;
+static const byte SOC_INTERRUPT_ENABLE = 0xAA;
+static const byte SOC_READ = 0x77;
+static const byte SOC_READ_AUTO_INCREMENT = 0x79;
+static const byte SOC_READ_MULTIPLE = 0x73;
+static const byte SOC_WRITE = 0x66;
+static const byte SOC_WRITE_AUTO_INCREMENT = 0x69;
+static const byte SOC_WRITE_MULTIPLE = 0x65;
+
+static const byte DETECT = 0xEE;
+
+BoardSimulator::BoardSimulator(uint32_t serial) :
+    _master(-1),
+    _slave(-1),
+    _running(false),
+    _target(TARGET::MCU),
+    _interruptsEnabled(false),
+    _requestLength(0),
+    _serial(serial),
+    _socUploaded(false),
+    _fpgaConfigured(false),
+    _binarySize(0),
+    _binaryHash(0),
+    _latency(0),
+    _baudrate(0),
+    _errorType(ERROR_TYPE::CORRUPT_PARITY),
+    _errorCount(0),
+    _errorInterval(1),
+    _repliesUntilError(1)
+{
+    memset(&_statistics, 0x00, sizeof(_statistics));
+}
+
+BoardSimulator::~BoardSimulator()
+{
+    this->stop();
+
+    /* the models may outlive the simulator */
+    std::lock_guard<std::mutex> lock(_coreMutex);
+    for (auto& core : _cores) {
+        core.second->setChangeListener(nullptr);
+    }
+}
+
+bool BoardSimulator::addCore(CoreIndex index, simulatedcore_ptr core)
+{
+    std::lock_guard<std::mutex> lock(_coreMutex);
+
+    if ((index < 1) || (index > 255) || (_cores.find(index) != _cores.end())) {
+        EASYFPGA_LOG(ERROR) << "The simulator can't add a core with index " << (int32_t)index << "!";
+        return false;
+    }
+
+    core->setChangeListener([this] {
+        _loop.wakeUp();
+    });
+    _cores.insert(std::make_pair(index, core));
+
+    return true;
+}
+
+void BoardSimulator::startSoc(void)
+{
+    std::lock_guard<std::mutex> lock(_mcuMutex);
+    _socUploaded = true;
+    _fpgaConfigured = true;
+    _target = TARGET::SOC;
+}
+
+bool BoardSimulator::start(void)
+{
+    if (_running) {
+        return true;
+    }
+
+    _master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((_master < 0) || (grantpt(_master) != 0) || (unlockpt(_master) != 0)) {
+        EASYFPGA_LOG(ERROR) << "The simulator couldn't create a pseudo terminal: " << strerror(errno);
+        this->stop();
+        return false;
+    }
+
+    struct termios tio;
+    tcgetattr(_master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(_master, TCSANOW, &tio);
+
+    _device = std::string(ptsname(_master));
+
+    /*
+     * Keeping the slave side open prevents hangups of the master while
+     * no host is connected.
+     */
+    _slave = open(_device.c_str(), O_RDWR | O_NOCTTY);
+    fcntl(_master, F_SETFL, fcntl(_master, F_GETFL) | O_NONBLOCK);
+
+    if ((_slave < 0) || !_loop.isValid() || !_loop.add(_master, [this](uint32_t events) { this->receive(events); })) {
+        EASYFPGA_LOG(ERROR) << "The simulator couldn't watch the pseudo terminal " << _device << "!";
+        this->stop();
+        return false;
+    }
+
+    EASYFPGA_LOG(DEBUG) << "Simulated easyFPGA listening at " << _device;
+
+    _running = true;
+    _thread = std::thread([this] {
+        while (_running) {
+            _loop.runOnce(-1);
+            this->notifyInterrupt();
+        }
+    });
+
+    return true;
+}
+
+void BoardSimulator::stop(void)
+{
+    if (_running) {
+        _running = false;
+        _loop.wakeUp();
+        _thread.join();
+        _loop.remove(_master);
+    }
+
+    if (_slave >= 0) {
+        close(_slave);
+        _slave = -1;
+    }
+    if (_master >= 0) {
+        close(_master);
+        _master = -1;
+    }
+}
+
+std::string BoardSimulator::getDevice(void)
+{
+    return _device;
+}
+
+void BoardSimulator::setLatency(uint32_t latency, uint32_t baudrate)
+{
+    std::lock_guard<std::mutex> lock(_settingsMutex);
+    _latency = latency;
+    _baudrate = baudrate;
+}
+
+void BoardSimulator::injectErrors(ERROR_TYPE type, uint32_t count, uint32_t interval)
+{
+    std::lock_guard<std::mutex> lock(_settingsMutex);
+    _errorType = type;
+    _errorCount = count;
+    _errorInterval = (interval < 1) ? 1 : interval;
+    _repliesUntilError = 1;
+}
+
+BoardSimulator::Statistics BoardSimulator::getStatistics(void)
+{
+    std::lock_guard<std::mutex> lock(_statisticsMutex);
+    return _statistics;
+}
+
+std::vector<byte> BoardSimulator::getFlash(void)
+{
+    std::lock_guard<std::mutex> lock(_mcuMutex);
+    return _flash;
+}
+
+void BoardSimulator::setStatus(bool socUploaded, uint32_t binarySize, uint32_t binaryHash)
+{
+    std::lock_guard<std::mutex> lock(_mcuMutex);
+    _socUploaded = socUploaded;
+    _binarySize = binarySize;
+    _binaryHash = binaryHash;
+}
+
+void BoardSimulator::receive(uint32_t events)
+{
+    byte buffer[4096];
+    ssize_t count;
+
+    while ((count = read(_master, buffer, sizeof(buffer))) > 0) {
+        _received.insert(_received.end(), buffer, buffer+count);
+    }
+
+    uint32_t position = 0;
+    while (position < _received.size()) {
+        const byte* request = _received.data() + position;
+        uint32_t available = _received.size() - position;
+
+        uint32_t length = this->getRequestLength(request, available);
+        if (length == 0) {
+            std::lock_guard<std::mutex> lock(_statisticsMutex);
+            _statistics.discardedBytes++;
+            position++;
+            continue;
+        }
+        if (length > available) {
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_statisticsMutex);
+            _statistics.requests++;
+        }
+
+        _requestLength = length;
+        if (_target == TARGET::MCU) {
+            this->handleMcuRequest(request);
+        }
+        else {
+            this->handleSocRequest(request);
+        }
+        position += length;
+    }
+
+    _received.erase(_received.begin(), _received.begin()+position);
+}
+
+uint32_t BoardSimulator::getRequestLength(const byte* request, uint32_t available)
+{
+    if (request[0] == DETECT) {
+        return 1;
+    }
+
+    if (_target == TARGET::MCU) {
+        switch (request[0]) {
+            case MCU_SELECT_SOC:
+            case MCU_SERIAL_READ:
+            case MCU_STATUS_READ:
+            case MCU_CONFIGURE:
+                return 1;
+
+            case MCU_SERIAL_WRITE:
+                return 6;
+
+            case MCU_STATUS_WRITE:
+                return 13;
+
+            case MCU_SECTOR_WRITE:
+                return 4103;
+
+            default:
+                return 0;
+        }
+    }
+
+    switch (request[0]) {
+        case SOC_SELECT_MCU:
+        case SOC_INTERRUPT_ENABLE:
+            return 3;
+
+        case SOC_READ:
+            return 5;
+
+        case SOC_WRITE:
+        case SOC_READ_AUTO_INCREMENT:
+        case SOC_READ_MULTIPLE:
+            return 6;
+
+        case SOC_WRITE_AUTO_INCREMENT:
+        case SOC_WRITE_MULTIPLE:
+            /* opcode, id, core, address, length, data, parity */
+            return (available < 5) ? 5 : (6 + request[4]);
+
+        default:
+            return 0;
+    }
+}
+
+void BoardSimulator::handleMcuRequest(const byte* request)
+{
+    byte reply[13];
+    ERROR_TYPE error;
+
+    std::unique_lock<std::mutex> lock(_mcuMutex);
+
+    switch (request[0]) {
+        case DETECT:
+            reply[0] = 0xFF;
+            reply[1] = 0x22;
+            reply[2] = Calculator::calculateXorParity(reply, 2);
+            lock.unlock();
+            this->reply(reply, 3);
+            break;
+
+        case MCU_SELECT_SOC:
+            reply[0] = _fpgaConfigured ? Exchange::SHARED_REPLY_CODES::ACK : Exchange::SHARED_REPLY_CODES::NACK;
+            if (_fpgaConfigured) {
+                _target = TARGET::SOC;
+            }
+            lock.unlock();
+            this->reply(reply, 1);
+            break;
+
+        case MCU_SERIAL_READ:
+            reply[0] = 0xD9;
+            for (uint32_t i=0; i<4; i++) {
+                reply[1+i] = (byte)(_serial >> (8*i));
+            }
+            reply[5] = Calculator::calculateXorParity(reply, 5);
+            lock.unlock();
+            this->reply(reply, 6);
+            break;
+
+        case MCU_SERIAL_WRITE:
+            if (Calculator::calculateXorParity(request, 5) == request[5]) {
+                _serial = request[1] | (request[2] << 8) | (request[3] << 16) | ((uint32_t)request[4] << 24);
+                reply[0] = Exchange::SHARED_REPLY_CODES::ACK;
+            }
+            else {
+                reply[0] = Exchange::SHARED_REPLY_CODES::NACK;
+            }
+            lock.unlock();
+            this->reply(reply, 1);
+            break;
+
+        case MCU_STATUS_READ:
+            memset(reply, 0x00, sizeof(reply));
+            reply[0] = 0xC9;
+            reply[1] = (_socUploaded ? 0x01 : 0x00) | (_fpgaConfigured ? 0x04 : 0x00);
+            for (uint32_t i=0; i<4; i++) {
+                reply[4+i] = (byte)(_binarySize >> (8*i));
+                reply[8+i] = (byte)(_binaryHash >> (8*i));
+            }
+            reply[12] = Calculator::calculateXorParity(reply+1, 11);
+            lock.unlock();
+            this->reply(reply, 13);
+            break;
+
+        case MCU_STATUS_WRITE:
+            if (Calculator::calculateXorParity(request+1, 11) == request[12]) {
+                _socUploaded = ((request[1] & 0x01) != 0);
+                _binarySize = request[4] | (request[5] << 8) | (request[6] << 16) | ((uint32_t)request[7] << 24);
+                _binaryHash = request[8] | (request[9] << 8) | (request[10] << 16) | ((uint32_t)request[11] << 24);
+                reply[0] = Exchange::SHARED_REPLY_CODES::ACK;
+            }
+            else {
+                reply[0] = Exchange::SHARED_REPLY_CODES::NACK;
+            }
+            lock.unlock();
+            this->reply(reply, 1);
+            break;
+
+        case MCU_SECTOR_WRITE:
+            lock.unlock();
+            if (this->nextReplyIsFaulty(&error)) {
+                if (error != ERROR_TYPE::DROP_REPLY) {
+                    /* a corrupted sector fails the checksum test */
+                    reply[0] = Exchange::SHARED_REPLY_CODES::NACK;
+                    this->reply(reply, 1);
+                }
+                break;
+            }
+            else {
+                uint32_t hash = request[4099] | (request[4100] << 8) | (request[4101] << 16) | ((uint32_t)request[4102] << 24);
+                if (Calculator::calculateAdler32Hash(request+1, 4098) != hash) {
+                    reply[0] = Exchange::SHARED_REPLY_CODES::NACK;
+                    this->reply(reply, 1);
+                    break;
+                }
+
+                uint32_t sector = request[1] | ((request[2] & 0x03) << 8);
+                lock.lock();
+                if (_flash.size() < (sector+1)*4096) {
+                    _flash.resize((sector+1)*4096, 0xFF);
+                }
+                memcpy(_flash.data() + sector*4096, request+3, 4096);
+                lock.unlock();
+
+                {
+                    std::lock_guard<std::mutex> statisticsLock(_statisticsMutex);
+                    _statistics.writtenSectors++;
+                }
+
+                reply[0] = Exchange::SHARED_REPLY_CODES::ACK;
+                this->reply(reply, 1);
+            }
+            break;
+
+        case MCU_CONFIGURE:
+            _fpgaConfigured = _socUploaded;
+            reply[0] = _fpgaConfigured ? Exchange::SHARED_REPLY_CODES::ACK : Exchange::SHARED_REPLY_CODES::NACK;
+            lock.unlock();
+            this->reply(reply, 1);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BoardSimulator::handleSocRequest(const byte* request)
+{
+    byte reply[3];
+
+    if (request[0] == DETECT) {
+        reply[0] = 0xFF;
+        reply[1] = 0xEF;
+        reply[2] = Calculator::calculateXorParity(reply, 2);
+        this->reply(reply, 3);
+        return;
+    }
+
+    byte id = request[1];
+    if (Calculator::calculateXorParity(request, _requestLength-1) != request[_requestLength-1]) {
+        this->nack(id, NACK_CODE::PARITY_ERROR);
+        return;
+    }
+
+    switch (request[0]) {
+        case SOC_SELECT_MCU:
+            _target = TARGET::MCU;
+            _interruptsEnabled = false;
+            break;
+
+        case SOC_INTERRUPT_ENABLE:
+            _interruptsEnabled = true;
+            break;
+
+        default: {
+            simulatedcore_ptr core = this->findCore(request[2]);
+            if (core == nullptr) {
+                this->nack(id, NACK_CODE::UNKNOWN_CORE);
+            }
+            else {
+                this->handleRegisterRequest(request, core);
+            }
+            return;
+        }
+    }
+
+    reply[0] = Exchange::SHARED_REPLY_CODES::ACK;
+    reply[1] = id;
+    reply[2] = Calculator::calculateXorParity(reply, 2);
+    this->reply(reply, 3);
+}
+
+void BoardSimulator::handleRegisterRequest(const byte* request, simulatedcore_ptr core)
+{
+    byte id = request[1];
+    byte address = request[3];
+
+    ERROR_TYPE error;
+    bool faulty = this->nextReplyIsFaulty(&error);
+    if (faulty && (error == ERROR_TYPE::NACK)) {
+        this->nack(id, NACK_CODE::INJECTED_ERROR);
+        return;
+    }
+    if (faulty && (error == ERROR_TYPE::DROP_REPLY)) {
+        return;
+    }
+
+    /* opcode, id, up to 255 bytes and the parity */
+    byte reply[258];
+    uint32_t replyLength = 3;
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+
+    reply[0] = Exchange::SHARED_REPLY_CODES::ACK;
+    reply[1] = id;
+
+    switch (request[0]) {
+        case SOC_READ:
+            reply[0] = 0x88;
+            reply[2] = core->readRegister(address);
+            replyLength = 4;
+            reads = 1;
+            break;
+
+        case SOC_READ_AUTO_INCREMENT:
+        case SOC_READ_MULTIPLE:
+            reply[0] = (request[0] == SOC_READ_AUTO_INCREMENT) ? 0x90 : 0x93;
+            reads = request[4];
+            for (uint32_t i=0; i<reads; i++) {
+                reply[2+i] = core->readRegister((request[0] == SOC_READ_AUTO_INCREMENT) ? (byte)(address+i) : address);
+            }
+            replyLength = 3 + reads;
+            break;
+
+        case SOC_WRITE:
+            core->writeRegister(address, request[4]);
+            writes = 1;
+            break;
+
+        case SOC_WRITE_AUTO_INCREMENT:
+        case SOC_WRITE_MULTIPLE:
+            writes = request[4];
+            for (uint32_t i=0; i<writes; i++) {
+                core->writeRegister((request[0] == SOC_WRITE_AUTO_INCREMENT) ? (byte)(address+i) : address, request[5+i]);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    reply[replyLength-1] = Calculator::calculateXorParity(reply, replyLength-1);
+    if (faulty) {
+        reply[replyLength-1] ^= 0x01;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_statisticsMutex);
+        _statistics.registerReads += reads;
+        _statistics.registerWrites += writes;
+    }
+
+    this->reply(reply, replyLength);
+}
+
+void BoardSimulator::notifyInterrupt(void)
+{
+    /* a notification mustn't split a request and its reply */
+    if ((_target != TARGET::SOC) || !_interruptsEnabled || !_received.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_coreMutex);
+    for (auto& core : _cores) {
+        if (core.second->isInterruptPending()) {
+            lock.unlock();
+
+            byte notification[3];
+            notification[0] = Exchange::SHARED_REPLY_CODES::INTERRUPT;
+            notification[1] = (byte)core.first;
+            notification[2] = (byte)core.first;
+            this->writeCompletely(notification, 3);
+
+            _interruptsEnabled = false;
+
+            std::lock_guard<std::mutex> statisticsLock(_statisticsMutex);
+            _statistics.interrupts++;
+            return;
+        }
+    }
+}
+
+bool BoardSimulator::nextReplyIsFaulty(ERROR_TYPE* type)
+{
+    std::lock_guard<std::mutex> lock(_settingsMutex);
+
+    if ((_errorCount == 0) || (--_repliesUntilError > 0)) {
+        return false;
+    }
+
+    _repliesUntilError = _errorInterval;
+    _errorCount--;
+    *type = _errorType;
+
+    std::lock_guard<std::mutex> statisticsLock(_statisticsMutex);
+    _statistics.injectedErrors++;
+    return true;
+}
+
+void BoardSimulator::reply(const byte* data, uint32_t length)
+{
+    this->delay(length);
+    this->writeCompletely(data, length);
+}
+
+void BoardSimulator::nack(byte id, byte code)
+{
+    byte reply[4];
+    reply[0] = Exchange::SHARED_REPLY_CODES::NACK;
+    reply[1] = id;
+    reply[2] = code;
+    reply[3] = Calculator::calculateXorParity(reply, 3);
+
+    {
+        std::lock_guard<std::mutex> lock(_statisticsMutex);
+        _statistics.nacks++;
+    }
+
+    this->reply(reply, 4);
+}
+
+void BoardSimulator::delay(uint32_t replyLength)
+{
+    uint64_t delay;
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        delay = _latency * 1000ULL;
+        if (_baudrate > 0) {
+            delay += (_requestLength + replyLength) * 10 * 1000000000ULL / _baudrate;
+        }
+    }
+
+    if (delay == 0) {
+        return;
+    }
+
+    struct timespec remaining;
+    remaining.tv_sec = delay / 1000000000ULL;
+    remaining.tv_nsec = delay % 1000000000ULL;
+    while ((nanosleep(&remaining, &remaining) != 0) && (errno == EINTR)) {
+    }
+}
+
+void BoardSimulator::writeCompletely(const byte* data, uint32_t length)
+{
+    uint32_t written = 0;
+    while (written < length) {
+        ssize_t count = write(_master, data+written, length-written);
+        if (count > 0) {
+            written += count;
+        }
+        else if ((count < 0) && (errno == EAGAIN)) {
+            /* the host doesn't read fast enough */
+            struct pollfd pfd;
+            pfd.fd = _master;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            poll(&pfd, 1, 100);
+        }
+        else if ((count < 0) && (errno != EINTR)) {
+            EASYFPGA_LOG(WARNING) << "The simulator couldn't write its reply: " << strerror(errno);
+            return;
+        }
+    }
+}
+
+simulatedcore_ptr BoardSimulator::findCore(CoreIndex index)
+{
+    std::lock_guard<std::mutex> lock(_coreMutex);
+    auto core = _cores.find(index);
+    return (core != _cores.end()) ? core->second : nullptr;
+}
@@ -0,0 +1,270 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_BOARDSIMULATOR_H_
+#define SDK_SIMULATOR_BOARDSIMULATOR_H_
+
+#include "easycores/types.h" /* CoreIndex */
+#include "simulator/simulatedcore_ptr.h"
+#include "utils/hardwaretypes.h"
+#include "utils/os/eventloop.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Simulates an easyFPGA board behind a pseudo terminal
+ *
+ * The simulator answers the exchanges of communication/protocol like a
+ * board: the mcu's detect, serial, status, sector write, configure and
+ * select soc exchanges and the soc's detect, select mcu, interrupt
+ * enable and all register read/write exchanges. Register accesses are
+ * forwarded to the SimulatedCore models added under their core index.
+ * EasyFpga assigns the indices 1, 2, 3, ... to the easyCores in the
+ * order they are added in defineStructure().
+ *
+ * After an interrupt enable exchange, the first active interrupt line
+ * of a core is reported by an interrupt notification. Like the real
+ * soc, further interrupts have to be enabled again.
+ *
+ * The simulator is deterministic: each request is answered completely
+ * before the next one is processed, with a configurable latency, and
+ * errors are injected at configurable replies.
+ *
+ * \code
+ * BoardSimulator board;
+ * auto uart = std::make_shared<SimulatedUart>();
+ * board.addCore(1, uart);
+ * board.start();
+ * fpga.connectHardwareDevice(board.getDevice());
+ * \endcode
+ */
+class BoardSimulator
+{
+    public:
+        /**
+         * \brief Faulty replies which can be injected
+         */
+        enum ERROR_TYPE : uint8_t {
+            /**
+             * The reply's parity (or sector checksum) is wrong.
+             */
+            CORRUPT_PARITY = 0,
+
+            /**
+             * The request is answered by a NACK.
+             */
+            NACK,
+
+            /**
+             * The request isn't answered at all. Note that a sync
+             * operation treats a missing reply as a connection error.
+             */
+            DROP_REPLY
+        };
+
+        /**
+         * \brief Error codes of the simulator's soc NACKs
+         */
+        enum NACK_CODE : byte {
+            PARITY_ERROR = 0x01,
+            UNKNOWN_CORE = 0x02,
+            INJECTED_ERROR = 0x03
+        };
+
+        /**
+         * \brief Counters of the handled exchanges
+         */
+        struct Statistics {
+            uint64_t requests;
+            uint64_t registerReads;
+            uint64_t registerWrites;
+            uint64_t writtenSectors;
+            uint64_t interrupts;
+            uint64_t injectedErrors;
+            uint64_t nacks;
+            uint64_t discardedBytes;
+        };
+
+        /**
+         * \brief Creates a board whose mcu is running and whose fpga
+         *        isn't configured.
+         *
+         * \param serial The serial number reported by the mcu.
+         */
+        BoardSimulator(uint32_t serial = 0x00000001);
+        ~BoardSimulator();
+
+        BoardSimulator(const BoardSimulator&) = delete;
+        BoardSimulator& operator=(const BoardSimulator&) = delete;
+
+        /**
+         * \brief Adds a core model. Has to be called before start().
+         *
+         * \return false if the index is already used or is 0
+         */
+        bool addCore(CoreIndex index, simulatedcore_ptr core);
+
+        /**
+         * \brief Lets the fpga run an uploaded soc, so that a connecting
+         *        host talks to the soc. Has to be called before start().
+         */
+        void startSoc(void);
+
+        /**
+         * \brief Opens the pseudo terminal and starts answering.
+         *
+         * \return true at success,<br>
+         *         false if the pseudo terminal couldn't be created
+         */
+        bool start(void);
+
+        /**
+         * \brief Stops answering and closes the pseudo terminal.
+         */
+        void stop(void);
+
+        /**
+         * \brief Returns the device to connect to, e.g. /dev/pts/3.
+         */
+        std::string getDevice(void);
+
+        /**
+         * \brief Delays every reply.
+         *
+         * \param latency Fixed delay in us.
+         *
+         * \param baudrate Additionally delays the reply by the time the
+         *        request and the reply take on a serial line with this
+         *        baudrate (10 bits per byte). 0 disables this delay.
+         */
+        void setLatency(uint32_t latency, uint32_t baudrate = 0);
+
+        /**
+         * \brief Injects faulty replies to register and sector write
+         *        exchanges.
+         *
+         * \param type The kind of the faulty replies.
+         *
+         * \param count The number of faulty replies, 0 disables the
+         *        injection.
+         *
+         * \param interval Every interval-th reply, starting with the
+         *        next one, is faulty.
+         */
+        void injectErrors(ERROR_TYPE type, uint32_t count, uint32_t interval = 1);
+
+        /**
+         * \brief Returns the exchange counters.
+         */
+        Statistics getStatistics(void);
+
+        /**
+         * \brief Returns the mcu's flash memory written by sector write
+         *        exchanges.
+         */
+        std::vector<byte> getFlash(void);
+
+        /**
+         * \brief Changes the status stored by the mcu, e.g. to simulate
+         *        an upload by another host.
+         */
+        void setStatus(bool socUploaded, uint32_t binarySize, uint32_t binaryHash);
+
+    private:
+        enum TARGET : uint8_t {
+            MCU,
+            SOC
+        };
+
+        /* reads the pseudo terminal and processes complete requests */
+        void receive(uint32_t events);
+
+        /*
+         * Length of a request, 0 for an unknown opcode. The length may
+         * grow while more bytes of the request are available.
+         */
+        uint32_t getRequestLength(const byte* request, uint32_t available);
+
+        void handleMcuRequest(const byte* request);
+        void handleSocRequest(const byte* request);
+        void handleRegisterRequest(const byte* request, simulatedcore_ptr core);
+
+        /* sends an interrupt notification if enabled and a line is active */
+        void notifyInterrupt(void);
+
+        /* decides whether the next reply is faulty */
+        bool nextReplyIsFaulty(ERROR_TYPE* type);
+
+        /* sends a reply after the configured latency */
+        void reply(const byte* data, uint32_t length);
+        void nack(byte id, byte code);
+        void delay(uint32_t replyLength);
+        void writeCompletely(const byte* data, uint32_t length);
+
+        simulatedcore_ptr findCore(CoreIndex index);
+
+        int _master;
+        int _slave;
+        std::string _device;
+
+        EventLoop _loop;
+        std::thread _thread;
+        std::atomic<bool> _running;
+
+        /* protocol state, touched by the simulator thread only */
+        TARGET _target;
+        bool _interruptsEnabled;
+        std::vector<byte> _received;
+        uint32_t _requestLength;
+
+        std::mutex _coreMutex;
+        std::map<CoreIndex, simulatedcore_ptr> _cores;
+
+        /* mcu state */
+        std::mutex _mcuMutex;
+        uint32_t _serial;
+        bool _socUploaded;
+        bool _fpgaConfigured;
+        uint32_t _binarySize;
+        uint32_t _binaryHash;
+        std::vector<byte> _flash;
+
+        /* latency and error injection */
+        std::mutex _settingsMutex;
+        uint32_t _latency;
+        uint32_t _baudrate;
+        ERROR_TYPE _errorType;
+        uint32_t _errorCount;
+        uint32_t _errorInterval;
+        uint32_t _repliesUntilError;
+
+        std::mutex _statisticsMutex;
+        Statistics _statistics;
+};
+
+#endif  // SDK_SIMULATOR_BOARDSIMULATOR_H_
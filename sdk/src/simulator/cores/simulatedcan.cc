@@ -0,0 +1,532 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulatedcan.h"
+
+#include <cstring> /* memset(), memcpy() */
+
+/* compares the bits which are neither masked nor unused */
+static bool matches(byte value, byte code, byte mask, byte used)
+{
+    return (((value ^ code) & ~mask & used) == 0);
+}
+
+SimulatedCan::SimulatedCan() :
+    _rxFifoBytes(0),
+    _loopback(false),
+    _rejectedFrames(0),
+    _overrunFrames(0),
+    _control(0x01),
+    _clockDivider(0x00),
+    _interruptEnable(0x00),
+    _interrupts(0x00),
+    _overrun(false),
+    _transmissionComplete(true),
+    _acceptanceCode(0x00),
+    _acceptanceMask(0xFF),
+    _errorWarningLimit(96)
+{
+    _busTiming[0] = (byte)0x00;
+    _busTiming[1] = (byte)0x00;
+    memset(_basicTransmitBuffer, 0x00, sizeof(_basicTransmitBuffer));
+    memset(_acceptanceCodes, 0x00, sizeof(_acceptanceCodes));
+    memset(_acceptanceMasks, 0xFF, sizeof(_acceptanceMasks));
+    memset(_transmitBuffer, 0x00, sizeof(_transmitBuffer));
+}
+
+SimulatedCan::~SimulatedCan()
+{
+}
+
+std::string SimulatedCan::getName(void)
+{
+    return "can";
+}
+
+bool SimulatedCan::injectFrame(const SimulatedCanFrame& frame)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool received = this->receive(frame);
+    this->notifyChange();
+    return received;
+}
+
+std::vector<SimulatedCanFrame> SimulatedCan::takeTransmittedFrames(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<SimulatedCanFrame> transmitted;
+    transmitted.swap(_transmitted);
+    return transmitted;
+}
+
+void SimulatedCan::setLoopback(bool loopback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _loopback = loopback;
+}
+
+uint32_t SimulatedCan::getNumberOfRejectedFrames(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _rejectedFrames;
+}
+
+uint32_t SimulatedCan::getNumberOfOverrunFrames(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _overrunFrames;
+}
+
+byte SimulatedCan::read(byte address)
+{
+    if (address == 0x1F) {
+        return _clockDivider;
+    }
+
+    return this->isExtendedMode() ? this->readExtended(address) : this->readBasic(address);
+}
+
+void SimulatedCan::write(byte address, byte value)
+{
+    if (address == 0x1F) {
+        /* the mode bits can be changed in reset mode only */
+        _clockDivider = this->isResetMode() ? value : ((_clockDivider & 0xC0) | (value & 0x3F));
+        return;
+    }
+
+    bool wasResetMode = this->isResetMode();
+
+    if (this->isExtendedMode()) {
+        this->writeExtended(address, value);
+    }
+    else {
+        this->writeBasic(address, value);
+    }
+
+    /* entering the reset mode empties the receive fifo */
+    if (!wasResetMode && this->isResetMode()) {
+        _rxFifo.clear();
+        _rxFifoBytes = 0;
+        _interrupts = 0x00;
+    }
+}
+
+bool SimulatedCan::isInterruptLineActive(void)
+{
+    return (this->getInterruptBits() != 0x00);
+}
+
+bool SimulatedCan::isExtendedMode(void)
+{
+    return ((_clockDivider & 0x80) != 0);
+}
+
+bool SimulatedCan::isResetMode(void)
+{
+    return ((_control & 0x01) != 0);
+}
+
+byte SimulatedCan::getInterruptEnableBits(void)
+{
+    if (this->isExtendedMode()) {
+        return _interruptEnable;
+    }
+
+    /* RIE, TIE, EIE and OIE are control register bits 1 to 4 */
+    return (_control & 0x1E) >> 1;
+}
+
+byte SimulatedCan::getInterruptBits(void)
+{
+    byte interrupts = _interrupts;
+    if (!_rxFifo.empty()) {
+        interrupts |= INTERRUPT_BIT::RECEIVE;
+    }
+    return interrupts & this->getInterruptEnableBits();
+}
+
+byte SimulatedCan::readBasic(byte address)
+{
+    byte value;
+    byte buffer[10];
+
+    switch (address) {
+        case 0x00:
+            return _control;
+
+        case 0x01:
+            return (byte)0xFF;
+
+        case 0x02:
+            return (_rxFifo.empty() ? 0x00 : 0x01) | (_overrun ? 0x02 : 0x00) | 0x04 | (_transmissionComplete ? 0x08 : 0x00);
+
+        case 0x03:
+            value = this->getInterruptBits();
+            _interrupts = 0x00;
+            return value;
+
+        case 0x04:
+            return this->isResetMode() ? _acceptanceCode : 0xFF;
+
+        case 0x05:
+            return this->isResetMode() ? _acceptanceMask : 0xFF;
+
+        case 0x06:
+        case 0x07:
+            return this->isResetMode() ? _busTiming[address-0x06] : 0xFF;
+
+        default:
+            break;
+    }
+
+    if ((0x0A <= address) && (address <= 0x13)) {
+        return this->isResetMode() ? 0xFF : _basicTransmitBuffer[address-0x0A];
+    }
+
+    if ((0x14 <= address) && (address <= 0x1D)) {
+        this->encodeReceiveBuffer(buffer);
+        return buffer[address-0x14];
+    }
+
+    return (byte)0x00;
+}
+
+byte SimulatedCan::readExtended(byte address)
+{
+    byte value;
+    byte buffer[13];
+
+    switch (address) {
+        case 0x00:
+            return _control;
+
+        case 0x01:
+            return (byte)0x00;
+
+        case 0x02:
+            return (_rxFifo.empty() ? 0x00 : 0x01) | (_overrun ? 0x02 : 0x00) | 0x04 | (_transmissionComplete ? 0x08 : 0x00);
+
+        case 0x03:
+            value = this->getInterruptBits();
+            _interrupts = 0x00;
+            return value;
+
+        case 0x04:
+            return _interruptEnable;
+
+        case 0x06:
+        case 0x07:
+            return _busTiming[address-0x06];
+
+        case 0x0D:
+            return _errorWarningLimit;
+
+        case 0x1D:
+            return (byte)_rxFifo.size();
+
+        default:
+            break;
+    }
+
+    if ((0x10 <= address) && (address <= 0x1C)) {
+        if (this->isResetMode()) {
+            if (address <= 0x13) {
+                return _acceptanceCodes[address-0x10];
+            }
+            if (address <= 0x17) {
+                return _acceptanceMasks[address-0x14];
+            }
+            return (byte)0x00;
+        }
+        this->encodeReceiveBuffer(buffer);
+        return buffer[address-0x10];
+    }
+
+    return (byte)0x00;
+}
+
+void SimulatedCan::writeBasic(byte address, byte value)
+{
+    switch (address) {
+        case 0x00:
+            _control = value;
+            return;
+
+        case 0x01:
+            this->command(value);
+            return;
+
+        case 0x04:
+            if (this->isResetMode()) {
+                _acceptanceCode = value;
+            }
+            return;
+
+        case 0x05:
+            if (this->isResetMode()) {
+                _acceptanceMask = value;
+            }
+            return;
+
+        case 0x06:
+        case 0x07:
+            if (this->isResetMode()) {
+                _busTiming[address-0x06] = value;
+            }
+            return;
+
+        default:
+            break;
+    }
+
+    if ((0x0A <= address) && (address <= 0x13) && !this->isResetMode()) {
+        _basicTransmitBuffer[address-0x0A] = value;
+    }
+}
+
+void SimulatedCan::writeExtended(byte address, byte value)
+{
+    switch (address) {
+        case 0x00:
+            /* listen only, self test and filter mode can be changed in reset mode only */
+            _control = this->isResetMode() ? value : ((_control & 0x0E) | (value & 0x11));
+            return;
+
+        case 0x01:
+            this->command(value);
+            return;
+
+        case 0x04:
+            _interruptEnable = value;
+            return;
+
+        case 0x06:
+        case 0x07:
+            if (this->isResetMode()) {
+                _busTiming[address-0x06] = value;
+            }
+            return;
+
+        case 0x0D:
+            if (this->isResetMode()) {
+                _errorWarningLimit = value;
+            }
+            return;
+
+        default:
+            break;
+    }
+
+    if ((0x10 <= address) && (address <= 0x1C)) {
+        if (!this->isResetMode()) {
+            _transmitBuffer[address-0x10] = value;
+        }
+        else if (address <= 0x13) {
+            _acceptanceCodes[address-0x10] = value;
+        }
+        else if (address <= 0x17) {
+            _acceptanceMasks[address-0x14] = value;
+        }
+    }
+}
+
+void SimulatedCan::command(byte value)
+{
+    if (this->isResetMode()) {
+        return;
+    }
+
+    /* self reception request exists in the extended mode only */
+    bool selfReception = this->isExtendedMode() && ((value & 0x10) != 0);
+
+    if (((value & 0x01) != 0) || selfReception) {
+        this->transmit(selfReception);
+    }
+
+    /* release receive buffer */
+    if (((value & 0x04) != 0) && !_rxFifo.empty()) {
+        _rxFifoBytes -= SimulatedCan::getFifoSize(_rxFifo.front());
+        _rxFifo.pop_front();
+    }
+
+    /* clear data overrun */
+    if ((value & 0x08) != 0) {
+        _overrun = false;
+    }
+}
+
+void SimulatedCan::transmit(bool selfReception)
+{
+    SimulatedCanFrame frame;
+    memset(&frame, 0x00, sizeof(frame));
+
+    const byte* data;
+
+    if (this->isExtendedMode()) {
+        byte information = _transmitBuffer[0];
+        frame.extended = ((information & 0x80) != 0);
+        frame.remote = ((information & 0x40) != 0);
+        frame.length = information & 0x0F;
+
+        if (frame.extended) {
+            frame.identifier = (_transmitBuffer[1] << 21) | (_transmitBuffer[2] << 13) |
+                               (_transmitBuffer[3] << 5) | (_transmitBuffer[4] >> 3);
+            data = _transmitBuffer + 5;
+        }
+        else {
+            frame.identifier = (_transmitBuffer[1] << 3) | (_transmitBuffer[2] >> 5);
+            data = _transmitBuffer + 3;
+        }
+    }
+    else {
+        frame.extended = false;
+        frame.remote = ((_basicTransmitBuffer[1] & 0x10) != 0);
+        frame.length = _basicTransmitBuffer[1] & 0x0F;
+        frame.identifier = (_basicTransmitBuffer[0] << 3) | (_basicTransmitBuffer[1] >> 5);
+        data = _basicTransmitBuffer + 2;
+    }
+
+    if (frame.length > 8) {
+        frame.length = 8;
+    }
+    if (!frame.remote) {
+        memcpy(frame.data, data, frame.length);
+    }
+
+    _transmitted.push_back(frame);
+    _transmissionComplete = true;
+    _interrupts |= INTERRUPT_BIT::TRANSMIT & this->getInterruptEnableBits();
+
+    if (_loopback || selfReception) {
+        this->receive(frame);
+    }
+}
+
+bool SimulatedCan::receive(const SimulatedCanFrame& frame)
+{
+    if (this->isResetMode() || (frame.extended && !this->isExtendedMode()) || !this->isAccepted(frame)) {
+        _rejectedFrames++;
+        return false;
+    }
+
+    uint32_t size = SimulatedCan::getFifoSize(frame);
+    if (_rxFifoBytes + size > RX_FIFO_SIZE) {
+        _overrun = true;
+        _overrunFrames++;
+        _interrupts |= INTERRUPT_BIT::DATA_OVERRUN & this->getInterruptEnableBits();
+        return false;
+    }
+
+    _rxFifo.push_back(frame);
+    _rxFifoBytes += size;
+    return true;
+}
+
+bool SimulatedCan::isAccepted(const SimulatedCanFrame& frame)
+{
+    byte rtr = frame.remote ? 1 : 0;
+    uint32_t id = frame.identifier;
+
+    if (!this->isExtendedMode()) {
+        return matches(id >> 3, _acceptanceCode, _acceptanceMask, 0xFF);
+    }
+
+    const byte* acr = _acceptanceCodes;
+    const byte* amr = _acceptanceMasks;
+
+    /* absent data bytes aren't compared */
+    byte data0Used = (!frame.remote && (frame.length > 0)) ? 0xFF : 0x00;
+    byte data1Used = (!frame.remote && (frame.length > 1)) ? 0xFF : 0x00;
+
+    if ((_control & 0x08) != 0) {
+        /* single filter: one 32-bit filter */
+        if (frame.extended) {
+            return matches(id >> 21, acr[0], amr[0], 0xFF) &&
+                   matches(id >> 13, acr[1], amr[1], 0xFF) &&
+                   matches(id >> 5, acr[2], amr[2], 0xFF) &&
+                   matches(((id & 0x1F) << 3) | (rtr << 2), acr[3], amr[3], 0xFC);
+        }
+
+        return matches(id >> 3, acr[0], amr[0], 0xFF) &&
+               matches(((id & 0x07) << 5) | (rtr << 4), acr[1], amr[1], 0xF0) &&
+               matches(frame.data[0], acr[2], amr[2], data0Used) &&
+               matches(frame.data[1], acr[3], amr[3], data1Used);
+    }
+
+    /* dual filter: the frame has to pass one of two shorter filters */
+    if (frame.extended) {
+        return (matches(id >> 21, acr[0], amr[0], 0xFF) && matches(id >> 13, acr[1], amr[1], 0xFF)) ||
+               (matches(id >> 21, acr[2], amr[2], 0xFF) && matches(id >> 13, acr[3], amr[3], 0xFF));
+    }
+
+    byte bits = ((id & 0x07) << 5) | (rtr << 4);
+    byte dataCode = (acr[1] << 4) | (acr[3] & 0x0F);
+    byte dataMask = (amr[1] << 4) | (amr[3] & 0x0F);
+
+    return (matches(id >> 3, acr[0], amr[0], 0xFF) && matches(bits, acr[1], amr[1], 0xF0) &&
+            matches(frame.data[0], dataCode, dataMask, data0Used)) ||
+           (matches(id >> 3, acr[2], amr[2], 0xFF) && matches(bits, acr[3], amr[3], 0xF0));
+}
+
+uint32_t SimulatedCan::getFifoSize(const SimulatedCanFrame& frame)
+{
+    return (frame.extended ? 5 : 3) + (frame.remote ? 0 : frame.length);
+}
+
+void SimulatedCan::encodeReceiveBuffer(byte* target)
+{
+    bool extendedMode = this->isExtendedMode();
+    memset(target, 0x00, extendedMode ? 13 : 10);
+
+    if (_rxFifo.empty()) {
+        return;
+    }
+
+    const SimulatedCanFrame& frame = _rxFifo.front();
+    byte rtr = frame.remote ? 1 : 0;
+    uint32_t id = frame.identifier;
+    byte* data;
+
+    if (!extendedMode) {
+        target[0] = id >> 3;
+        target[1] = ((id & 0x07) << 5) | (rtr << 4) | frame.length;
+        data = target + 2;
+    }
+    else if (frame.extended) {
+        target[0] = 0x80 | (rtr << 6) | frame.length;
+        target[1] = id >> 21;
+        target[2] = id >> 13;
+        target[3] = id >> 5;
+        target[4] = ((id & 0x1F) << 3) | (rtr << 2);
+        data = target + 5;
+    }
+    else {
+        target[0] = (rtr << 6) | frame.length;
+        target[1] = id >> 3;
+        target[2] = ((id & 0x07) << 5) | (rtr << 4);
+        data = target + 3;
+    }
+
+    if (!frame.remote) {
+        memcpy(data, frame.data, frame.length);
+    }
+}
@@ -0,0 +1,162 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDCAN_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDCAN_H_
+
+#include "simulator/simulatedcore.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * \brief A frame on the simulated CAN bus
+ */
+struct SimulatedCanFrame {
+    uint32_t identifier;
+    bool extended;
+    bool remote;
+    uint8_t length;
+    byte data[8];
+};
+
+/**
+ * \brief Model of the Can core (SJA1000 compatible)
+ *
+ * Clock divider bit 7 switches between the basic mode and the extended
+ * (PeliCAN) mode register layouts. In reset mode, the acceptance and
+ * bus timing registers are accessible, in operating mode the transmit
+ * and receive buffers.
+ *
+ * Transmitting takes no time. A transmitted frame is appended to the
+ * transmitted frames and, in loopback (setLoopback() or a self
+ * reception request), received again. Received frames have to pass the
+ * acceptance filter (single and dual filter mode in the extended mode)
+ * and are queued in a 64 byte receive FIFO like in the SJA1000. Frames
+ * not fitting into it set the data overrun status.
+ *
+ * The interrupt register bits are set only if enabled (control
+ * register in basic mode, interrupt enable register in extended mode).
+ * Reading the interrupt register clears all bits but the receive
+ * interrupt, which stays set while the receive FIFO isn't empty.
+ */
+class SimulatedCan : public SimulatedCore
+{
+    public:
+        SimulatedCan();
+        ~SimulatedCan();
+
+        std::string getName(void);
+
+        /**
+         * \brief Receives a frame from the bus.
+         *
+         * \return true if the frame passed the acceptance filter and
+         *         fitted into the receive FIFO,<br>
+         *         false otherwise
+         */
+        bool injectFrame(const SimulatedCanFrame& frame);
+
+        /**
+         * \brief Returns the frames transmitted since the last call.
+         */
+        std::vector<SimulatedCanFrame> takeTransmittedFrames(void);
+
+        /**
+         * \brief Receives every transmitted frame again.
+         */
+        void setLoopback(bool loopback);
+
+        /**
+         * \brief Returns the number of frames which didn't pass the
+         *        acceptance filter.
+         */
+        uint32_t getNumberOfRejectedFrames(void);
+
+        /**
+         * \brief Returns the number of frames lost because of a full
+         *        receive FIFO.
+         */
+        uint32_t getNumberOfOverrunFrames(void);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+        bool isInterruptLineActive(void);
+
+    private:
+        enum INTERRUPT_BIT : byte {
+            RECEIVE = 0x01,
+            TRANSMIT = 0x02,
+            DATA_OVERRUN = 0x08
+        };
+
+        static const uint32_t RX_FIFO_SIZE = 64;
+
+        bool isExtendedMode(void);
+        bool isResetMode(void);
+        byte getInterruptEnableBits(void);
+        byte getInterruptBits(void);
+
+        byte readBasic(byte address);
+        byte readExtended(byte address);
+        void writeBasic(byte address, byte value);
+        void writeExtended(byte address, byte value);
+        void command(byte value);
+
+        void transmit(bool selfReception);
+        bool receive(const SimulatedCanFrame& frame);
+        bool isAccepted(const SimulatedCanFrame& frame);
+        static uint32_t getFifoSize(const SimulatedCanFrame& frame);
+
+        /* the receive buffer window in the layout of the current mode */
+        void encodeReceiveBuffer(byte* target);
+
+        std::deque<SimulatedCanFrame> _rxFifo;
+        uint32_t _rxFifoBytes;
+        std::vector<SimulatedCanFrame> _transmitted;
+        bool _loopback;
+        uint32_t _rejectedFrames;
+        uint32_t _overrunFrames;
+
+        byte _control;
+        byte _clockDivider;
+        byte _busTiming[2];
+        byte _interruptEnable;
+        byte _interrupts;
+        bool _overrun;
+        bool _transmissionComplete;
+
+        /* basic mode */
+        byte _acceptanceCode;
+        byte _acceptanceMask;
+        byte _basicTransmitBuffer[10];
+
+        /* extended mode */
+        byte _acceptanceCodes[4];
+        byte _acceptanceMasks[4];
+        byte _errorWarningLimit;
+        byte _transmitBuffer[13];
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDCAN_H_
@@ -0,0 +1,147 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulatedgpio8.h"
+
+SimulatedGpio8::SimulatedGpio8() :
+    _inputs(0x00),
+    _pins(0x00),
+    _out(0x00),
+    _oe(0x00),
+    _inte(0x00),
+    _ptrig(0x00),
+    _ctrl(0x00),
+    _ints(0x00)
+{
+}
+
+SimulatedGpio8::~SimulatedGpio8()
+{
+}
+
+std::string SimulatedGpio8::getName(void)
+{
+    return "gpio8";
+}
+
+void SimulatedGpio8::setInputs(byte levels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _inputs = levels;
+    this->update();
+    this->notifyChange();
+}
+
+byte SimulatedGpio8::getPins(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pins;
+}
+
+byte SimulatedGpio8::getOutputEnable(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _oe;
+}
+
+byte SimulatedGpio8::read(byte address)
+{
+    switch (address) {
+        case REGISTER::IN:
+            return _pins;
+
+        case REGISTER::OUT:
+            return _out;
+
+        case REGISTER::OE:
+            return _oe;
+
+        case REGISTER::INTE:
+            return _inte;
+
+        case REGISTER::PTRIG:
+            return _ptrig;
+
+        case REGISTER::CTRL:
+            return (_ctrl & 0x01) | (this->isInterruptLineActive() ? 0x02 : 0x00);
+
+        case REGISTER::INTS:
+            return _ints;
+
+        default:
+            return (byte)0x00;
+    }
+}
+
+void SimulatedGpio8::write(byte address, byte value)
+{
+    switch (address) {
+        case REGISTER::OUT:
+            _out = value;
+            this->update();
+            break;
+
+        case REGISTER::OE:
+            _oe = value;
+            this->update();
+            break;
+
+        case REGISTER::INTE:
+            _inte = value;
+            break;
+
+        case REGISTER::PTRIG:
+            _ptrig = value;
+            break;
+
+        case REGISTER::CTRL:
+            _ctrl = value & 0x01;
+            break;
+
+        case REGISTER::INTS:
+            _ints = value;
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool SimulatedGpio8::isInterruptLineActive(void)
+{
+    return ((_ctrl & 0x01) != 0) && (_ints != 0x00);
+}
+
+byte SimulatedGpio8::calculatePins(void)
+{
+    return (_out & _oe) | (_inputs & ~_oe);
+}
+
+void SimulatedGpio8::update(void)
+{
+    byte pins = this->calculatePins();
+    byte rising = pins & ~_pins;
+    byte falling = ~pins & _pins;
+
+    _ints |= _inte & ((rising & _ptrig) | (falling & ~_ptrig));
+    _pins = pins;
+}
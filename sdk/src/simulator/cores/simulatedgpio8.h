@@ -0,0 +1,94 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDGPIO8_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDGPIO8_H_
+
+#include "simulator/simulatedcore.h"
+
+/**
+ * \brief Model of the Gpio8 core (OpenCores GPIO with 8 pins)
+ *
+ * Registers: IN (0x00), OUT (0x04), OE (0x08), INTE (0x0C), PTRIG
+ * (0x10), CTRL (0x18) and INTS (0x1C).
+ *
+ * A pin with its OE bit set drives its OUT bit, all other pins read
+ * the level set by setInputs(). Every edge of a pin with its INTE bit
+ * set (rising if its PTRIG bit is set, falling otherwise) sets its INTS
+ * bit. The interrupt line is active while CTRL bit 0 is set and an INTS
+ * bit is pending.
+ */
+class SimulatedGpio8 : public SimulatedCore
+{
+    public:
+        SimulatedGpio8();
+        ~SimulatedGpio8();
+
+        std::string getName(void);
+
+        /**
+         * \brief Sets the levels applied externally to the pins.
+         */
+        void setInputs(byte levels);
+
+        /**
+         * \brief Returns the levels of all pins.
+         */
+        byte getPins(void);
+
+        /**
+         * \brief Returns the output enable bits.
+         */
+        byte getOutputEnable(void);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+        bool isInterruptLineActive(void);
+
+    private:
+        enum REGISTER : byte {
+            IN = 0x00,
+            OUT = 0x04,
+            OE = 0x08,
+            INTE = 0x0C,
+            PTRIG = 0x10,
+            CTRL = 0x18,
+            INTS = 0x1C
+        };
+
+        byte calculatePins(void);
+
+        /* detects edges after an input or output change */
+        void update(void);
+
+        byte _inputs;
+        byte _pins;
+        byte _out;
+        byte _oe;
+        byte _inte;
+        byte _ptrig;
+        byte _ctrl;
+        byte _ints;
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDGPIO8_H_
@@ -0,0 +1,183 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulatedi2c.h"
+
+SimulatedI2C::SimulatedI2C() :
+    _reading(false),
+    _pointerExpected(false),
+    _prerLow(0xFF),
+    _prerHigh(0xFF),
+    _ctrl(0x00),
+    _txr(0x00),
+    _rxr(0x00),
+    _noAcknowledge(false),
+    _busy(false),
+    _interruptFlag(false)
+{
+    _selected = _slaves.end();
+}
+
+SimulatedI2C::~SimulatedI2C()
+{
+}
+
+std::string SimulatedI2C::getName(void)
+{
+    return "i2c";
+}
+
+void SimulatedI2C::addSlave(uint8_t address)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Slave slave;
+    slave.memory.assign(256, 0x00);
+    slave.pointer = 0x00;
+    _slaves[address] = slave;
+}
+
+std::vector<byte> SimulatedI2C::getSlaveMemory(uint8_t address)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto slave = _slaves.find(address);
+    if (slave == _slaves.end()) {
+        return std::vector<byte>();
+    }
+    return slave->second.memory;
+}
+
+void SimulatedI2C::setSlaveMemory(uint8_t address, byte memoryAddress, byte value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto slave = _slaves.find(address);
+    if (slave != _slaves.end()) {
+        slave->second.memory[memoryAddress] = value;
+    }
+}
+
+byte SimulatedI2C::read(byte address)
+{
+    switch (address) {
+        case REGISTER::PRER_LOW:
+            return _prerLow;
+
+        case REGISTER::PRER_HIGH:
+            return _prerHigh;
+
+        case REGISTER::CTRL:
+            return _ctrl;
+
+        case REGISTER::TXR_RXR:
+            return _rxr;
+
+        case REGISTER::CR_SR:
+            return (_noAcknowledge ? 0x80 : 0x00) | (_busy ? 0x40 : 0x00) | (_interruptFlag ? 0x01 : 0x00);
+
+        default:
+            return (byte)0x00;
+    }
+}
+
+void SimulatedI2C::write(byte address, byte value)
+{
+    switch (address) {
+        case REGISTER::PRER_LOW:
+            _prerLow = value;
+            break;
+
+        case REGISTER::PRER_HIGH:
+            _prerHigh = value;
+            break;
+
+        case REGISTER::CTRL:
+            _ctrl = value;
+            break;
+
+        case REGISTER::TXR_RXR:
+            _txr = value;
+            break;
+
+        case REGISTER::CR_SR:
+            if ((value & 0x01) != 0) {
+                _interruptFlag = false;
+            }
+            if (((_ctrl & 0x40) != 0) && ((value & 0xF0) != 0)) {
+                this->execute(value);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool SimulatedI2C::isInterruptLineActive(void)
+{
+    return _interruptFlag && ((_ctrl & 0x80) != 0);
+}
+
+void SimulatedI2C::execute(byte command)
+{
+    bool start = ((command & 0x80) != 0);
+    bool stop = ((command & 0x40) != 0);
+    bool read = ((command & 0x20) != 0);
+    bool write = ((command & 0x10) != 0);
+
+    if (write) {
+        if (start) {
+            /* slave address with R/W bit */
+            _selected = _slaves.find(_txr >> 1);
+            _reading = ((_txr & 0x01) != 0);
+            _pointerExpected = !_reading;
+            _noAcknowledge = (_selected == _slaves.end());
+            _busy = true;
+        }
+        else if ((_selected != _slaves.end()) && !_reading) {
+            if (_pointerExpected) {
+                _selected->second.pointer = _txr;
+                _pointerExpected = false;
+            }
+            else {
+                _selected->second.memory[_selected->second.pointer++] = _txr;
+            }
+            _noAcknowledge = false;
+        }
+        else {
+            _noAcknowledge = true;
+        }
+    }
+    else if (read) {
+        if ((_selected != _slaves.end()) && _reading) {
+            _rxr = _selected->second.memory[_selected->second.pointer++];
+        }
+        else {
+            /* nobody drives the bus */
+            _rxr = (byte)0xFF;
+        }
+    }
+
+    if (stop) {
+        _busy = false;
+    }
+
+    _interruptFlag = true;
+}
@@ -0,0 +1,111 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDI2C_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDI2C_H_
+
+#include "simulator/simulatedcore.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * \brief Model of the I2C core (OpenCores I2C master) with slaves
+ *
+ * Registers: PRERlo (0x00), PRERhi (0x01), CTRL (0x02), TXR/RXR (0x03)
+ * and CR/SR (0x04). Like the I2C class uses it, CTRL bit 6 enables the
+ * core and bit 7 its interrupt.
+ *
+ * The slaves are memories addressed like common register based chips:
+ * the first byte written after the slave address sets the memory
+ * pointer, further bytes are written to or read from the pointer,
+ * which increments after each byte. A stop condition doesn't release
+ * the addressed slave, the next start condition does. Transfers take no
+ * time, so SR never reports a transfer in progress. The interrupt flag
+ * is set after every command and cleared by the IACK bit.
+ */
+class SimulatedI2C : public SimulatedCore
+{
+    public:
+        SimulatedI2C();
+        ~SimulatedI2C();
+
+        std::string getName(void);
+
+        /**
+         * \brief Connects a slave with 256 bytes of zeroed memory.
+         *
+         * \param address 7-bit slave address
+         */
+        void addSlave(uint8_t address);
+
+        /**
+         * \brief Returns the memory of a slave or an empty vector if no
+         *        slave has this address.
+         */
+        std::vector<byte> getSlaveMemory(uint8_t address);
+
+        /**
+         * \brief Changes a byte of a slave's memory.
+         */
+        void setSlaveMemory(uint8_t address, byte memoryAddress, byte value);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+        bool isInterruptLineActive(void);
+
+    private:
+        enum REGISTER : byte {
+            PRER_LOW = 0x00,
+            PRER_HIGH = 0x01,
+            CTRL = 0x02,
+            TXR_RXR = 0x03,
+            CR_SR = 0x04
+        };
+
+        struct Slave {
+            std::vector<byte> memory;
+            byte pointer;
+        };
+
+        void execute(byte command);
+
+        std::map<uint8_t, Slave> _slaves;
+
+        /* the addressed slave, or none if _slaves.end() */
+        std::map<uint8_t, Slave>::iterator _selected;
+        bool _reading;
+        bool _pointerExpected;
+
+        byte _prerLow;
+        byte _prerHigh;
+        byte _ctrl;
+        byte _txr;
+        byte _rxr;
+        bool _noAcknowledge;
+        bool _busy;
+        bool _interruptFlag;
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDI2C_H_
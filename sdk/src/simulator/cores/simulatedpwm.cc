@@ -0,0 +1,60 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulatedpwm.h"
+
+SimulatedPwm::SimulatedPwm(uint8_t resolution) :
+    _RESOLUTION(resolution)
+{
+    _dutyCycle[0] = (byte)0x00;
+    _dutyCycle[1] = (byte)0x00;
+}
+
+SimulatedPwm::~SimulatedPwm()
+{
+}
+
+std::string SimulatedPwm::getName(void)
+{
+    return (_RESOLUTION == 16) ? "pwm16" : "pwm8";
+}
+
+uint16_t SimulatedPwm::getDutyCycle(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dutyCycle[0] | (_dutyCycle[1] << 8);
+}
+
+byte SimulatedPwm::read(byte address)
+{
+    if ((address == 0x00) || ((address == 0x01) && (_RESOLUTION == 16))) {
+        return _dutyCycle[address];
+    }
+    return (byte)0x00;
+}
+
+void SimulatedPwm::write(byte address, byte value)
+{
+    if ((address == 0x00) || ((address == 0x01) && (_RESOLUTION == 16))) {
+        _dutyCycle[address] = value;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDPWM_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDPWM_H_
+
+#include "simulator/simulatedcore.h"
+
+#include <cstdint>
+
+/**
+ * \brief Model of the Pwm8 and Pwm16 cores
+ *
+ * The duty cycle registers are plain registers. A Pwm8 has the duty
+ * cycle at address 0x00, a Pwm16 its low byte at 0x00 and its high byte
+ * at 0x01. Other addresses read as 0x00.
+ */
+class SimulatedPwm : public SimulatedCore
+{
+    public:
+        /**
+         * \param resolution 8 or 16 bits
+         */
+        SimulatedPwm(uint8_t resolution);
+        ~SimulatedPwm();
+
+        std::string getName(void);
+
+        /**
+         * \brief Returns the duty cycle last written by the host.
+         */
+        uint16_t getDutyCycle(void);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+
+    private:
+        const uint8_t _RESOLUTION;
+        byte _dutyCycle[2];
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDPWM_H_
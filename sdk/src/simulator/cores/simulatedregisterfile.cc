@@ -0,0 +1,55 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulatedregisterfile.h"
+
+#include <cstring> /* memset() */
+
+SimulatedRegisterFile::SimulatedRegisterFile()
+{
+    memset(_registers, 0x00, sizeof(_registers));
+}
+
+SimulatedRegisterFile::~SimulatedRegisterFile()
+{
+}
+
+std::string SimulatedRegisterFile::getName(void)
+{
+    return "registers";
+}
+
+byte SimulatedRegisterFile::getRegister(byte address)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _registers[address];
+}
+
+byte SimulatedRegisterFile::read(byte address)
+{
+    return _registers[address];
+}
+
+void SimulatedRegisterFile::write(byte address, byte value)
+{
+    _registers[address] = value;
+}
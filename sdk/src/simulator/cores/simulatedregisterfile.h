@@ -0,0 +1,55 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDREGISTERFILE_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDREGISTERFILE_H_
+
+#include "simulator/simulatedcore.h"
+
+/**
+ * \brief A core consisting of 256 plain read/write registers
+ *
+ * Usable as a stand-in for any core without side effects, e.g. for
+ * measuring the raw exchange performance.
+ */
+class SimulatedRegisterFile : public SimulatedCore
+{
+    public:
+        SimulatedRegisterFile();
+        ~SimulatedRegisterFile();
+
+        std::string getName(void);
+
+        /**
+         * \brief Returns a register's content without an exchange.
+         */
+        byte getRegister(byte address);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+
+    private:
+        byte _registers[256];
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDREGISTERFILE_H_
@@ -0,0 +1,191 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulatedspi.h"
+
+#include <algorithm>
+
+SimulatedSpi::SimulatedSpi() :
+    _shiftDuration(0),
+    _spcr(0x10),
+    _sper(0x00),
+    _spif(false),
+    _wcol(false),
+    _writePointer(0),
+    _readPointer(0),
+    _readFifoGuard(false)
+{
+    for (uint8_t i=0; i<4; i++) {
+        _readFifo[i] = (byte)0x00;
+    }
+}
+
+SimulatedSpi::~SimulatedSpi()
+{
+}
+
+std::string SimulatedSpi::getName(void)
+{
+    return "spi";
+}
+
+void SimulatedSpi::setSlave(Slave slave)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _slave = slave;
+}
+
+std::vector<byte> SimulatedSpi::takeTransmittedBytes(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<byte> transmitted;
+    transmitted.swap(_transmitted);
+    return transmitted;
+}
+
+void SimulatedSpi::setShiftDuration(uint32_t microseconds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shiftDuration = std::chrono::microseconds(microseconds);
+}
+
+byte SimulatedSpi::read(byte address)
+{
+    /* bytes shifted out in the meantime */
+    this->transfer();
+
+    byte value;
+    bool readFifoEmpty = (_writePointer == _readPointer) && !_readFifoGuard;
+    bool readFifoFull = (_writePointer == _readPointer) && _readFifoGuard;
+
+    switch (address) {
+        case REGISTER::SPCR:
+            return _spcr;
+
+        case REGISTER::SPSR:
+            value = 0x04; /* WFEMPTY */
+            value |= readFifoEmpty ? 0x01 : 0x00;
+            value |= readFifoFull ? 0x02 : 0x00;
+            value |= (_writeFifo.size() >= 4) ? 0x08 : 0x00;
+            value |= _wcol ? 0x40 : 0x00;
+            value |= _spif ? 0x80 : 0x00;
+            if (!_writeFifo.empty()) {
+                value &= ~0x04;
+            }
+            return value;
+
+        case REGISTER::SPDR:
+            value = _readFifo[_readPointer];
+            _readPointer = (_readPointer + 1) & 0x03;
+            _readFifoGuard = false;
+            return value;
+
+        case REGISTER::SPER:
+            return _sper;
+
+        default:
+            return (byte)0x00;
+    }
+}
+
+void SimulatedSpi::write(byte address, byte value)
+{
+    switch (address) {
+        case REGISTER::SPCR:
+            _spcr = value;
+            _shiftStart = std::chrono::steady_clock::now();
+            if ((_spcr & 0x40) != 0) {
+                this->transfer();
+            }
+            else {
+                this->clearFifos();
+            }
+            break;
+
+        case REGISTER::SPSR:
+            /* the flags are cleared by writing a one */
+            _spif &= ((value & 0x80) == 0);
+            _wcol &= ((value & 0x40) == 0);
+            break;
+
+        case REGISTER::SPDR:
+            if (_writeFifo.size() >= 4) {
+                _wcol = true;
+                break;
+            }
+            if (_writeFifo.empty()) {
+                _shiftStart = std::chrono::steady_clock::now();
+            }
+            _writeFifo.push_back(value);
+            if ((_spcr & 0x40) != 0) {
+                this->transfer();
+            }
+            break;
+
+        case REGISTER::SPER:
+            _sper = value;
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool SimulatedSpi::isInterruptLineActive(void)
+{
+    return _spif && ((_spcr & 0x80) != 0);
+}
+
+void SimulatedSpi::transfer(void)
+{
+    if ((_spcr & 0x40) == 0) {
+        return;
+    }
+
+    size_t count = _writeFifo.size();
+    if (_shiftDuration.count() > 0) {
+        auto elapsed = std::chrono::steady_clock::now() - _shiftStart;
+        count = std::min(count, (size_t)(elapsed / _shiftDuration));
+        _shiftStart += count * _shiftDuration;
+    }
+
+    for (size_t i=0; i<count; i++) {
+        byte mosi = _writeFifo[i];
+        _transmitted.push_back(mosi);
+
+        _readFifo[_writePointer] = _slave ? _slave(mosi) : mosi;
+        _writePointer = (_writePointer + 1) & 0x03;
+        if (_writePointer == _readPointer) {
+            _readFifoGuard = true;
+        }
+        _spif = true;
+    }
+    _writeFifo.erase(_writeFifo.begin(), _writeFifo.begin() + count);
+}
+
+void SimulatedSpi::clearFifos(void)
+{
+    _writeFifo.clear();
+    _writePointer = 0;
+    _readPointer = 0;
+    _readFifoGuard = false;
+}
@@ -0,0 +1,121 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDSPI_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDSPI_H_
+
+#include "simulator/simulatedcore.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * \brief Model of the Spi core (OpenCores simple_spi master)
+ *
+ * Registers: SPCR (0x00), SPSR (0x01), SPDR (0x02) and SPER (0x03).
+ *
+ * While SPCR bit 6 (SPE) is set, the bytes written to SPDR are
+ * transferred one after another, at once or after the shift duration
+ * set by setShiftDuration(): the slave's answer is written into the 4
+ * byte read FIFO and SPSR bit 7 (SPIF) is set. Like in the hardware, the read FIFO
+ * overwrites its oldest byte when it is full and every read of SPDR
+ * advances its read pointer. Clearing SPE empties both FIFOs. The
+ * interrupt line is active while SPIF and SPCR bit 7 (SPIE) are set.
+ */
+class SimulatedSpi : public SimulatedCore
+{
+    public:
+        /**
+         * \brief Answers a byte transferred by the master.
+         */
+        typedef std::function<byte(byte)> Slave;
+
+        SimulatedSpi();
+        ~SimulatedSpi();
+
+        std::string getName(void);
+
+        /**
+         * \brief Sets the slave answering the transfers. Without a
+         *        slave, MISO is connected to MOSI (loopback).
+         */
+        void setSlave(Slave slave);
+
+        /**
+         * \brief Returns the bytes transferred since the last call.
+         */
+        std::vector<byte> takeTransmittedBytes(void);
+
+        /**
+         * \brief Sets the time needed for shifting out a byte, like a
+         *        slow SPI clock does. Until then, the byte stays in the
+         *        write FIFO and nothing arrives in the read FIFO.
+         *
+         * \param microseconds Shift duration per byte, 0 (default) for
+         *        transferring every byte at once
+         */
+        void setShiftDuration(uint32_t microseconds);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+        bool isInterruptLineActive(void);
+
+    private:
+        enum REGISTER : byte {
+            SPCR = 0x00,
+            SPSR = 0x01,
+            SPDR = 0x02,
+            SPER = 0x03
+        };
+
+        void transfer(void);
+        void clearFifos(void);
+
+        Slave _slave;
+        std::vector<byte> _transmitted;
+
+        /* start of shifting the first byte of the write fifo */
+        std::chrono::microseconds _shiftDuration;
+        std::chrono::steady_clock::time_point _shiftStart;
+
+        byte _spcr;
+        byte _sper;
+        bool _spif;
+        bool _wcol;
+
+        /* write fifo, holds bytes only while the core is disabled */
+        std::vector<byte> _writeFifo;
+
+        /*
+         * read fifo with the pointer semantics of the hardware's fifo4:
+         * equal pointers mean full if the guard is set, empty otherwise
+         */
+        byte _readFifo[4];
+        uint8_t _writePointer;
+        uint8_t _readPointer;
+        bool _readFifoGuard;
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDSPI_H_
@@ -0,0 +1,292 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/cores/simulateduart.h"
+
+#include <algorithm>
+
+SimulatedUart::SimulatedUart() :
+    _transmitDuration(0),
+    _loopback(false),
+    _overrun(false),
+    _transmitterEmptyPending(false),
+    _overrunBytes(0),
+    _ier(0x00),
+    _fcr(0x00),
+    _lcr(0x00),
+    _mcr(0x00),
+    _scr(0x00),
+    _dll(0x00),
+    _dlm(0x00),
+    _rbr(0x00)
+{
+}
+
+SimulatedUart::~SimulatedUart()
+{
+}
+
+std::string SimulatedUart::getName(void)
+{
+    return "uart";
+}
+
+void SimulatedUart::injectReceivedBytes(const byte* data, uint32_t length)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (uint32_t i=0; i<length; i++) {
+        this->receive(data[i]);
+    }
+    this->notifyChange();
+}
+
+std::vector<byte> SimulatedUart::takeTransmittedBytes(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<byte> transmitted;
+    transmitted.swap(_transmitted);
+    return transmitted;
+}
+
+void SimulatedUart::setLoopback(bool loopback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _loopback = loopback;
+}
+
+void SimulatedUart::setTransmitDuration(uint32_t microseconds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _transmitDuration = std::chrono::microseconds(microseconds);
+}
+
+uint16_t SimulatedUart::getBaudrateDivisor(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dll | (_dlm << 8);
+}
+
+uint32_t SimulatedUart::getNumberOfOverrunBytes(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _overrunBytes;
+}
+
+byte SimulatedUart::read(byte address)
+{
+    bool dlab = ((_lcr & 0x80) != 0);
+    byte value;
+
+    /* bytes sent in the meantime */
+    this->transmit();
+
+    switch (address) {
+        case REGISTER::RX_TX:
+            if (dlab) {
+                return _dll;
+            }
+            /* like the hardware, an empty fifo repeats the last byte */
+            if (!_rxFifo.empty()) {
+                _rbr = _rxFifo.front();
+                _rxFifo.pop_front();
+            }
+            return _rbr;
+
+        case REGISTER::IER:
+            return dlab ? _dlm : _ier;
+
+        case REGISTER::IIR_FCR:
+            value = this->identifyInterrupt();
+            /* reading the iir acknowledges a transmitter empty interrupt */
+            if ((value & 0x0F) == 0x02) {
+                _transmitterEmptyPending = false;
+            }
+            if ((_fcr & 0x01) != 0) {
+                value |= 0xC0 | (_fcr & 0x20);
+            }
+            return value;
+
+        case REGISTER::LCR:
+            return _lcr;
+
+        case REGISTER::MCR:
+            return _mcr;
+
+        case REGISTER::LSR:
+            /* transmitter holding register and transmitter empty */
+            value = _txFifo.empty() ? 0x60 : 0x00;
+            value |= _rxFifo.empty() ? 0x00 : 0x01;
+            value |= _overrun ? 0x02 : 0x00;
+            _overrun = false;
+            return value;
+
+        case REGISTER::MSR:
+            if ((_mcr & 0x10) != 0) {
+                /* loopback: RTS->CTS, DTR->DSR, OUT1->RI, OUT2->DCD */
+                return ((_mcr & 0x02) << 3) | ((_mcr & 0x01) << 5) | ((_mcr & 0x0C) << 4);
+            }
+            return (byte)0xB0;
+
+        case REGISTER::SCR:
+            return _scr;
+
+        default:
+            return (byte)0x00;
+    }
+}
+
+void SimulatedUart::write(byte address, byte value)
+{
+    bool dlab = ((_lcr & 0x80) != 0);
+
+    switch (address) {
+        case REGISTER::RX_TX:
+            if (dlab) {
+                _dll = value;
+                break;
+            }
+            if (_txFifo.empty()) {
+                _transmitStart = std::chrono::steady_clock::now();
+            }
+            _txFifo.push_back(value);
+            /* writing the transmitter holding register acknowledges its interrupt */
+            _transmitterEmptyPending = false;
+            this->transmit();
+            break;
+
+        case REGISTER::IER:
+            if (dlab) {
+                _dlm = value;
+                break;
+            }
+            /* enabling the transmitter empty interrupt reports the empty transmitter */
+            if (((value & 0x02) != 0) && ((_ier & 0x02) == 0)) {
+                _transmitterEmptyPending = true;
+            }
+            _ier = value;
+            break;
+
+        case REGISTER::IIR_FCR:
+            if ((value & 0x02) != 0) {
+                _rxFifo.clear();
+            }
+            if ((value & 0x04) != 0) {
+                _txFifo.clear();
+            }
+            /* the 64 byte mode can be changed only while DLAB is set */
+            _fcr = (value & 0xC1) | (dlab ? (value & 0x20) : (_fcr & 0x20));
+            while (_rxFifo.size() > this->getFifoDepth()) {
+                _rxFifo.pop_back();
+            }
+            break;
+
+        case REGISTER::LCR:
+            _lcr = value;
+            break;
+
+        case REGISTER::MCR:
+            _mcr = value;
+            break;
+
+        case REGISTER::SCR:
+            _scr = value;
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool SimulatedUart::isInterruptLineActive(void)
+{
+    return ((this->identifyInterrupt() & 0x01) == 0);
+}
+
+void SimulatedUart::transmit(void)
+{
+    size_t count = _txFifo.size();
+    if (_transmitDuration.count() > 0) {
+        auto elapsed = std::chrono::steady_clock::now() - _transmitStart;
+        count = std::min(count, (size_t)(elapsed / _transmitDuration));
+        _transmitStart += count * _transmitDuration;
+    }
+
+    for (size_t i=0; i<count; i++) {
+        byte data = _txFifo.front();
+        _txFifo.pop_front();
+
+        _transmitted.push_back(data);
+        if (_loopback || ((_mcr & 0x10) != 0)) {
+            this->receive(data);
+        }
+    }
+
+    if ((count > 0) && _txFifo.empty()) {
+        _transmitterEmptyPending = true;
+    }
+}
+
+void SimulatedUart::receive(byte data)
+{
+    if (_rxFifo.size() < this->getFifoDepth()) {
+        _rxFifo.push_back(data);
+    }
+    else {
+        _overrun = true;
+        _overrunBytes++;
+    }
+}
+
+uint32_t SimulatedUart::getFifoDepth(void)
+{
+    if ((_fcr & 0x01) == 0) {
+        return 1;
+    }
+    return ((_fcr & 0x20) != 0) ? 64 : 16;
+}
+
+uint32_t SimulatedUart::getTriggerLevel(void)
+{
+    static const uint32_t LEVELS[2][4] = {{1, 4, 8, 14}, {1, 16, 32, 56}};
+
+    if ((_fcr & 0x01) == 0) {
+        return 1;
+    }
+    return LEVELS[((_fcr & 0x20) != 0) ? 1 : 0][(_fcr & 0xC0) >> 6];
+}
+
+byte SimulatedUart::identifyInterrupt(void)
+{
+    if (((_ier & 0x04) != 0) && _overrun) {
+        return (byte)0x06;
+    }
+    if (((_ier & 0x01) != 0) && (_rxFifo.size() >= this->getTriggerLevel())) {
+        return (byte)0x04;
+    }
+    if (((_ier & 0x01) != 0) && !_rxFifo.empty()) {
+        return (byte)0x0C;
+    }
+    if (((_ier & 0x02) != 0) && _transmitterEmptyPending) {
+        return (byte)0x02;
+    }
+    return (byte)0x01;
+}
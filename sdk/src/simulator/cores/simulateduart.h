@@ -0,0 +1,140 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_CORES_SIMULATEDUART_H_
+#define SDK_SIMULATOR_CORES_SIMULATEDUART_H_
+
+#include "simulator/simulatedcore.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * \brief Model of the Uart core (16750 compatible)
+ *
+ * Registers: RX/TX (0x00), IER (0x01), IIR/FCR (0x02), LCR (0x03), MCR
+ * (0x04), LSR (0x05), MSR (0x06), SCR (0x07) and, while LCR bit 7 is
+ * set, DLL (0x00) and DLM (0x01).
+ *
+ * A byte written to TX enters the transmit FIFO and is sent at once or
+ * after the duration set by setTransmitDuration(). Then it is appended
+ * to the transmitted bytes, and in loopback (MCR bit 4 or
+ * setLoopback()) it is received again. The receive FIFO
+ * holds 1, 16 or 64 bytes depending on FCR, further bytes set the
+ * overrun flag. Because the simulated line is idle as soon as injected
+ * bytes are received, a FIFO below its trigger level reports a
+ * character timeout immediately.
+ */
+class SimulatedUart : public SimulatedCore
+{
+    public:
+        SimulatedUart();
+        ~SimulatedUart();
+
+        std::string getName(void);
+
+        /**
+         * \brief Receives bytes from the line.
+         */
+        void injectReceivedBytes(const byte* data, uint32_t length);
+
+        /**
+         * \brief Returns the bytes transmitted since the last call.
+         */
+        std::vector<byte> takeTransmittedBytes(void);
+
+        /**
+         * \brief Connects the line's TX to its RX.
+         */
+        void setLoopback(bool loopback);
+
+        /**
+         * \brief Sets the time needed for sending a byte, like a slow
+         *        baud rate does. Until then, the byte stays in the
+         *        transmit FIFO.
+         *
+         * \param microseconds Duration per byte, 0 (default) for
+         *        sending every byte at once
+         */
+        void setTransmitDuration(uint32_t microseconds);
+
+        /**
+         * \brief Returns the divisor latch (DLM:DLL).
+         */
+        uint16_t getBaudrateDivisor(void);
+
+        /**
+         * \brief Returns the number of bytes lost because of a full
+         *        receive FIFO.
+         */
+        uint32_t getNumberOfOverrunBytes(void);
+
+    protected:
+        byte read(byte address);
+        void write(byte address, byte value);
+        bool isInterruptLineActive(void);
+
+    private:
+        enum REGISTER : byte {
+            RX_TX = 0x00,
+            IER = 0x01,
+            IIR_FCR = 0x02,
+            LCR = 0x03,
+            MCR = 0x04,
+            LSR = 0x05,
+            MSR = 0x06,
+            SCR = 0x07
+        };
+
+        void receive(byte data);
+        void transmit(void);
+        uint32_t getFifoDepth(void);
+        uint32_t getTriggerLevel(void);
+        byte identifyInterrupt(void);
+
+        std::deque<byte> _rxFifo;
+        std::deque<byte> _txFifo;
+        std::vector<byte> _transmitted;
+
+        /* start of sending the first byte of the transmit fifo */
+        std::chrono::microseconds _transmitDuration;
+        std::chrono::steady_clock::time_point _transmitStart;
+        bool _loopback;
+        bool _overrun;
+        bool _transmitterEmptyPending;
+        uint32_t _overrunBytes;
+
+        byte _ier;
+        byte _fcr;
+        byte _lcr;
+        byte _mcr;
+        byte _scr;
+        byte _dll;
+        byte _dlm;
+
+        /* last byte read from the receive fifo */
+        byte _rbr;
+};
+
+#endif  // SDK_SIMULATOR_CORES_SIMULATEDUART_H_
@@ -0,0 +1,67 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "simulator/simulatedcore.h"
+
+SimulatedCore::SimulatedCore()
+{
+}
+
+SimulatedCore::~SimulatedCore()
+{
+}
+
+byte SimulatedCore::readRegister(byte address)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return this->read(address);
+}
+
+void SimulatedCore::writeRegister(byte address, byte value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    this->write(address, value);
+}
+
+bool SimulatedCore::isInterruptPending(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return this->isInterruptLineActive();
+}
+
+void SimulatedCore::setChangeListener(std::function<void()> listener)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _listener = listener;
+}
+
+bool SimulatedCore::isInterruptLineActive(void)
+{
+    return false;
+}
+
+void SimulatedCore::notifyChange(void)
+{
+    if (_listener) {
+        _listener();
+    }
+}
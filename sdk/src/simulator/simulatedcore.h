@@ -0,0 +1,102 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_SIMULATOR_SIMULATEDCORE_H_
+#define SDK_SIMULATOR_SIMULATEDCORE_H_
+
+#include "utils/hardwaretypes.h"
+
+#include <functional>
+#include <mutex>
+#include <string>
+
+/**
+ * \brief Register file model of an easyCore inside a BoardSimulator
+ *
+ * A model sees the register accesses of the soc exchanges with the
+ * address offsets the easyCore classes use. Accesses of the simulator
+ * and the methods a test uses for stimulating a model (e.g. injecting
+ * received bytes) are serialized by _mutex.
+ *
+ * Derived classes implement read() and write() and, if the core has an
+ * interrupt line, isInterruptLineActive(). Whenever an external event
+ * might have raised the interrupt line, they have to call
+ * notifyChange() so that the simulator checks it immediately.
+ */
+class SimulatedCore
+{
+    public:
+        SimulatedCore();
+        virtual ~SimulatedCore();
+
+        SimulatedCore(const SimulatedCore&) = delete;
+        SimulatedCore& operator=(const SimulatedCore&) = delete;
+
+        /**
+         * \brief Returns a short name of the modeled core, e.g. "uart".
+         */
+        virtual std::string getName(void) = 0;
+
+        /**
+         * \brief Reads a register like the soc does for a read exchange.
+         */
+        byte readRegister(byte address);
+
+        /**
+         * \brief Writes a register like the soc does for a write
+         *        exchange.
+         */
+        void writeRegister(byte address, byte value);
+
+        /**
+         * \brief Checks whether the core's interrupt line is active.
+         */
+        bool isInterruptPending(void);
+
+        /**
+         * \brief Sets the function called by notifyChange(). Used by
+         *        the BoardSimulator only.
+         */
+        void setChangeListener(std::function<void()> listener);
+
+    protected:
+        virtual byte read(byte address) = 0;
+        virtual void write(byte address, byte value) = 0;
+
+        /**
+         * The default implementation has no interrupt line.
+         */
+        virtual bool isInterruptLineActive(void);
+
+        /**
+         * Tells the simulator that the interrupt line might have
+         * changed outside of a register access.
+         */
+        void notifyChange(void);
+
+        std::mutex _mutex;
+
+    private:
+        std::function<void()> _listener;
+};
+
+#endif  // SDK_SIMULATOR_SIMULATEDCORE_H_
@@ -0,0 +1,360 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/easycores/can/can.h"
+#include "easyfpga/easycores/can/can_ptr.h"
+#include "easyfpga/easycores/can/utils/canframe_extended.h"
+#include "easyfpga/easycores/can/utils/canframe_ptr.h"
+#include "easyfpga/easycores/gpio/gpio8.h"
+#include "easyfpga/easycores/gpio/gpio8_ptr.h"
+#include "easyfpga/easycores/i2c/i2c.h"
+#include "easyfpga/easycores/i2c/i2c_ptr.h"
+#include "easyfpga/easycores/pwm/pwm16.h"
+#include "easyfpga/easycores/pwm/pwm16_ptr.h"
+#include "easyfpga/easycores/pwm/pwm8.h"
+#include "easyfpga/easycores/pwm/pwm8_ptr.h"
+#include "easyfpga/easycores/spi/spi.h"
+#include "easyfpga/easycores/spi/spi_ptr.h"
+#include "easyfpga/easycores/uart/uart.h"
+#include "easyfpga/easycores/uart/uart_ptr.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedcan.h"
+#include "easyfpga/simulator/cores/simulatedgpio8.h"
+#include "easyfpga/simulator/cores/simulatedi2c.h"
+#include "easyfpga/simulator/cores/simulatedpwm.h"
+#include "easyfpga/simulator/cores/simulatedspi.h"
+#include "easyfpga/simulator/cores/simulateduart.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring> /* memcmp() */
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<uint32_t> gpioInterrupts(0);
+
+static void gpioCallback(void)
+{
+    gpioInterrupts++;
+}
+
+/**
+ * \brief An easyFPGA containing one core of each simulated kind
+ *
+ * The cores get the indices 1 (gpio) to 7 (pwm16).
+ */
+class SimulatedFpga : public EasyFpga
+{
+    public:
+        SimulatedFpga() :
+            gpio(std::make_shared<Gpio8>()),
+            uart(std::make_shared<Uart>()),
+            spi(std::make_shared<Spi>()),
+            i2c(std::make_shared<I2C>()),
+            can(std::make_shared<Can>()),
+            pwm8(std::make_shared<Pwm8>()),
+            pwm16(std::make_shared<Pwm16>())
+        {
+        }
+
+        void defineStructure(void) {
+            this->addEasyCore(gpio);
+            this->addEasyCore(uart);
+            this->addEasyCore(spi);
+            this->addEasyCore(i2c);
+            this->addEasyCore(can);
+            this->addEasyCore(pwm8);
+            this->addEasyCore(pwm16);
+        }
+
+        gpio8_ptr gpio;
+        uart_ptr uart;
+        spi_ptr spi;
+        i2c_ptr i2c;
+        can_ptr can;
+        pwm8_ptr pwm8;
+        pwm16_ptr pwm16;
+};
+
+/**
+ * \brief Tests the BoardSimulator with the easyCore classes
+ *
+ * The test needs no easyFPGA. Every core of a SimulatedFpga is driven
+ * through its easyCore API while the simulated board checks the
+ * effects or provides the stimuli. Afterwards a gpio interrupt is
+ * triggered, the latency is checked and errors are injected which the
+ * framework has to recover from by retries.
+ */
+class BoardSimulatorTest : public Tester
+{
+    std::string testName(void) {
+        return "board simulator test";
+    }
+
+    bool testGpio(SimulatedFpga& fpga, std::shared_ptr<SimulatedGpio8> model) {
+        byte pins = 0x00;
+
+        bool success = fpga.gpio->makeAllPinsOutput() && fpga.gpio->setAllPins((byte)0xA5);
+        success &= fpga.gpio->getAllPins(&pins);
+        if (!success || (pins != 0xA5) || (model->getOutputEnable() != 0xFF) || (model->getPins() != 0xA5)) {
+            Log().Get(ERROR) << "Gpio output failed!";
+            return false;
+        }
+
+        return fpga.gpio->makeAllPinsInput();
+    }
+
+    bool testUart(SimulatedFpga& fpga, std::shared_ptr<SimulatedUart> model) {
+        byte received = 0x00;
+
+        bool success = fpga.uart->init(115200, Uart::WORD_LENGTH::C8, Uart::PARITY::NO_PARITY, Uart::STOP_BIT_COUNT::ONE_BIT);
+        success &= fpga.uart->transmit((byte)0x42) && fpga.uart->transmit((byte)0x43);
+
+        std::vector<byte> transmitted(model->takeTransmittedBytes());
+        if (!success || (model->getBaudrateDivisor() == 0) || (transmitted.size() != 2) ||
+            (transmitted[0] != 0x42) || (transmitted[1] != 0x43)) {
+            Log().Get(ERROR) << "Uart transmission failed!";
+            return false;
+        }
+
+        byte line[2] = { 0x55, 0xAA };
+        model->injectReceivedBytes(line, 2);
+        for (uint32_t i=0; i<2; i++) {
+            if (!fpga.uart->receive(&received) || (received != line[i])) {
+                Log().Get(ERROR) << "Uart reception failed!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testSpi(SimulatedFpga& fpga, std::shared_ptr<SimulatedSpi> model) {
+        byte received = 0x00;
+
+        model->setSlave([](byte mosi) {
+            return (byte)~mosi;
+        });
+
+        bool success = fpga.spi->init(Spi::SPI_MODE::MODE_0, Spi::CLOCK_SPEED::SCK_19531_HZ);
+        for (byte b=0x10; b<0x16; b++) {
+            success &= fpga.spi->transceive(b, &received) && (received == (byte)~b);
+        }
+
+        std::vector<byte> transmitted(model->takeTransmittedBytes());
+        if (!success || (transmitted.size() != 6) || (transmitted[5] != 0x15)) {
+            Log().Get(ERROR) << "Spi transfer failed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testI2c(SimulatedFpga& fpga, std::shared_ptr<SimulatedI2C> model) {
+        byte value = 0x00;
+
+        model->addSlave(0x50);
+        model->setSlaveMemory(0x50, 0x21, 0x99);
+
+        bool success = fpga.i2c->init(I2C::CLOCK_SPEED::MODE_STANDARD);
+        success &= fpga.i2c->writeByte(0x50, 0x20, 0xAB);
+        if (!success || (model->getSlaveMemory(0x50)[0x20] != 0xAB)) {
+            Log().Get(ERROR) << "I2C write failed!";
+            return false;
+        }
+
+        if (!fpga.i2c->readByte(0x50, 0x21, &value) || (value != 0x99)) {
+            Log().Get(ERROR) << "I2C read failed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testCan(SimulatedFpga& fpga, std::shared_ptr<SimulatedCan> model) {
+        byte data[4] = { 0xDE, 0xAD, 0xBE, 0xEF };
+
+        bool success = fpga.can->init(Can::BITRATE::BITRATE_125K, Can::USAGE_MODE::EXTENDEND_MODE);
+        success &= fpga.can->transmit(std::make_shared<CanFrameExtended>(0x1234567, data, 4));
+
+        std::vector<SimulatedCanFrame> transmitted(model->takeTransmittedFrames());
+        if (!success || (transmitted.size() != 1) || !transmitted[0].extended ||
+            (transmitted[0].identifier != 0x1234567) || (transmitted[0].length != 4) ||
+            (memcmp(transmitted[0].data, data, 4) != 0)) {
+            Log().Get(ERROR) << "Can transmission failed!";
+            return false;
+        }
+
+        SimulatedCanFrame frame = { 0x0ABCDEF, true, false, 3, { 0x01, 0x02, 0x03 } };
+        canframe_ptr received;
+        if (!model->injectFrame(frame) || !fpga.can->getReceivedFrame(received) || (received == nullptr)) {
+            Log().Get(ERROR) << "Can reception failed!";
+            return false;
+        }
+
+        byte receivedData[8];
+        received->getData(receivedData);
+        if ((received->getIdentifier() != 0x0ABCDEF) || (received->getDataLength() != 3) ||
+            (memcmp(receivedData, frame.data, 3) != 0)) {
+            Log().Get(ERROR) << "Received a wrong can frame!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testPwm(SimulatedFpga& fpga, std::shared_ptr<SimulatedPwm> model8, std::shared_ptr<SimulatedPwm> model16) {
+        byte cycle = 0x00;
+
+        bool success = fpga.pwm8->setDutyCycle((byte)0x80) && fpga.pwm16->setDutyCycle((uint16_t)0x1234);
+        success &= fpga.pwm8->getDutyCycle(&cycle);
+        if (!success || (model8->getDutyCycle() != 0x80) || (model16->getDutyCycle() != 0x1234) || (cycle != 0x80)) {
+            Log().Get(ERROR) << "Pwm duty cycles are wrong!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testInterrupt(SimulatedFpga& fpga, std::shared_ptr<SimulatedGpio8> model) {
+        model->setInputs((byte)0x00);
+
+        bool success = fpga.gpio->registerCallback(gpioCallback);
+        success &= fpga.gpio->enablePinInterrupt(Gpio8::PIN::GPIO0, true);
+        success &= fpga.gpio->clearInterrupts() && fpga.gpio->releaseInterrupts();
+        success &= fpga.enableInterrupts();
+
+        model->setInputs((byte)0x01);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        success &= fpga.handleReplies();
+
+        if (!success || (gpioInterrupts != 1)) {
+            Log().Get(ERROR) << "The gpio interrupt wasn't handled!";
+            return false;
+        }
+
+        return fpga.gpio->clearInterrupts();
+    }
+
+    bool testLatency(SimulatedFpga& fpga, BoardSimulator& board) {
+        byte cycle = 0x00;
+
+        board.setLatency(2000);
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i=0; i<10; i++) {
+            if (!fpga.pwm8->getDutyCycle(&cycle)) {
+                return false;
+            }
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        board.setLatency(0);
+
+        if (duration < std::chrono::milliseconds(20)) {
+            Log().Get(ERROR) << "The replies weren't delayed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testErrorInjection(SimulatedFpga& fpga, BoardSimulator& board, BoardSimulator::ERROR_TYPE type) {
+        byte cycle = 0x00;
+        uint64_t injectedBefore = board.getStatistics().injectedErrors;
+
+        board.injectErrors(type, 2);
+        bool success = fpga.pwm8->setDutyCycle((byte)0x33) && fpga.pwm8->getDutyCycle(&cycle);
+
+        if (!success || (cycle != 0x33) || (board.getStatistics().injectedErrors != injectedBefore + 2)) {
+            Log().Get(ERROR) << "The framework didn't recover from injected errors!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        auto gpio = std::make_shared<SimulatedGpio8>();
+        auto uart = std::make_shared<SimulatedUart>();
+        auto spi = std::make_shared<SimulatedSpi>();
+        auto i2c = std::make_shared<SimulatedI2C>();
+        auto can = std::make_shared<SimulatedCan>();
+        auto pwm8 = std::make_shared<SimulatedPwm>(8);
+        auto pwm16 = std::make_shared<SimulatedPwm>(16);
+
+        BoardSimulator board;
+        board.addCore(1, gpio);
+        board.addCore(2, uart);
+        board.addCore(3, spi);
+        board.addCore(4, i2c);
+        board.addCore(5, can);
+        board.addCore(6, pwm8);
+        board.addCore(7, pwm16);
+        board.startSoc();
+
+        SimulatedFpga fpga;
+        if (!board.start() || !fpga.connectHardwareDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated board!";
+            return false;
+        }
+        fpga.instantiateCores();
+
+        bool success = true;
+
+        Log().Get(INFO) << "Test the easyCores...";
+        success &= this->testGpio(fpga, gpio);
+        success &= this->testUart(fpga, uart);
+        success &= this->testSpi(fpga, spi);
+        success &= this->testI2c(fpga, i2c);
+        success &= this->testCan(fpga, can);
+        success &= this->testPwm(fpga, pwm8, pwm16);
+
+        Log().Get(INFO) << "Test an interrupt...";
+        success &= this->testInterrupt(fpga, gpio);
+
+        Log().Get(INFO) << "Test the latency...";
+        success &= this->testLatency(fpga, board);
+
+        Log().Get(INFO) << "Test corrupted replies and NACKs...";
+        success &= this->testErrorInjection(fpga, board, BoardSimulator::ERROR_TYPE::CORRUPT_PARITY);
+        success &= this->testErrorInjection(fpga, board, BoardSimulator::ERROR_TYPE::NACK);
+
+        BoardSimulator::Statistics statistics = board.getStatistics();
+        Log().Get(INFO) << "Simulated exchanges: " << statistics.requests << " requests, "
+            << statistics.registerReads << " register reads, " << statistics.registerWrites << " register writes, "
+            << statistics.interrupts << " interrupts, " << statistics.nacks << " NACKs";
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    BoardSimulatorTest test;
+    return (uint32_t)test.runTest();
+}
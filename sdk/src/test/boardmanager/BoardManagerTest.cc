@@ -0,0 +1,219 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/boardmanager.h"
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h> /* posix_openpt() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <sys/stat.h> /* mkdir() */
+#include <termios.h>
+#include <unistd.h> /* read(), write(), close(), symlink() */
+
+/* must match USB_DEVICE_PATH in project.conf */
+static const std::string DEVICE_DIRECTORY("/tmp/easyfpga-boardmanager-test/");
+
+static const uint32_t BOARD_COUNT = 4;
+static const uint32_t SERIAL_READS_PER_BOARD = 100;
+
+/* time a pseudo board needs for answering a request */
+static const uint32_t BOARD_LATENCY_US = 500;
+
+/**
+ * \brief An easyFPGA without any cores
+ */
+class EmptyFpga : public EasyFpga
+{
+    void defineStructure(void) {
+    }
+};
+
+/**
+ * \brief Tests the BoardManager with several pseudo boards
+ *
+ * The test needs no easyFPGA. Every board is the master side of a
+ * pseudo terminal, linked as ttyUSB<n> into the directory configured in
+ * project.conf. The boards behave like an mcu: they answer detect and
+ * serial read requests after a short delay. All boards have to be found
+ * and the serial reads have to run in parallel.
+ */
+class BoardManagerTest : public Tester
+{
+    std::string testName(void) {
+        return "board manager test";
+    }
+
+    static void answerRequests(int master, uint32_t serial, std::atomic<bool>* running) {
+        while (*running) {
+            struct pollfd pfd;
+            pfd.fd = master;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if ((poll(&pfd, 1, 10) <= 0) || !(pfd.revents & POLLIN)) {
+                continue;
+            }
+
+            byte requests[64];
+            ssize_t count = read(master, requests, sizeof(requests));
+            for (ssize_t i=0; i<count; i++) {
+                byte reply[6];
+                ssize_t length = 0;
+
+                if (requests[i] == (byte)0xEE) {
+                    /* detect: mcu is running */
+                    reply[0] = 0xFF;
+                    reply[1] = 0x22;
+                    reply[2] = reply[0] ^ reply[1];
+                    length = 3;
+                }
+                else if (requests[i] == (byte)0xD3) {
+                    /* serial read */
+                    reply[0] = 0xD9;
+                    reply[5] = reply[0];
+                    for (uint32_t j=0; j<4; j++) {
+                        reply[1+j] = (byte)(serial >> (8*j));
+                        reply[5] ^= reply[1+j];
+                    }
+                    length = 6;
+                }
+
+                if (length > 0) {
+                    usleep(BOARD_LATENCY_US);
+                    if (write(master, reply, length) != length) {
+                        Log().Get(ERROR) << "Pseudo board couldn't write its reply!";
+                    }
+                }
+            }
+        }
+    }
+
+    bool testMethod(void) {
+        mkdir(DEVICE_DIRECTORY.c_str(), 0700);
+
+        int masters[BOARD_COUNT];
+        std::thread boards[BOARD_COUNT];
+        std::atomic<bool> running(true);
+
+        for (uint32_t i=0; i<BOARD_COUNT; i++) {
+            masters[i] = posix_openpt(O_RDWR | O_NOCTTY);
+            if ((masters[i] < 0) || (grantpt(masters[i]) != 0) || (unlockpt(masters[i]) != 0)) {
+                Log().Get(ERROR) << "Couldn't create a pseudo terminal!";
+                return false;
+            }
+
+            struct termios tio;
+            tcgetattr(masters[i], &tio);
+            cfmakeraw(&tio);
+            tcsetattr(masters[i], TCSANOW, &tio);
+
+            std::string link(DEVICE_DIRECTORY + "ttyUSB" + std::to_string(i));
+            unlink(link.c_str());
+            if (symlink(ptsname(masters[i]), link.c_str()) != 0) {
+                Log().Get(ERROR) << "Couldn't create " << link << "!";
+                return false;
+            }
+
+            boards[i] = std::thread(answerRequests, masters[i], 0x1000 + i, &running);
+        }
+
+        bool success = true;
+        {
+            BoardManager manager([] { return std::make_shared<EmptyFpga>(); });
+
+            if (manager.connectAll() != BOARD_COUNT) {
+                Log().Get(ERROR) << "Not all pseudo boards were found!";
+                success = false;
+            }
+
+            for (uint32_t i=0; i<manager.getNumberOfBoards(); i++) {
+                if ((manager.getSerialNumber(i) & 0xFFFFFFF0) != 0x1000) {
+                    Log().Get(ERROR) << "Unexpected serial of board " << i << "!";
+                    success = false;
+                }
+            }
+
+            success &= manager.runOnAllBoards([] (easyfpga_ptr fpga) {
+                uint32_t expected = 0;
+                if (!fpga->getCommunicator()->readSerial(&expected)) {
+                    return false;
+                }
+
+                for (uint32_t i=1; i<SERIAL_READS_PER_BOARD; i++) {
+                    uint32_t serial = 0;
+                    if (!fpga->getCommunicator()->readSerial(&serial) || (serial != expected)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            });
+
+            BoardManager::Statistics statistics = manager.getStatistics();
+            Log().Get(INFO) << statistics.boards << " boards, " << statistics.finishedJobs << " jobs ("
+                << statistics.failedJobs << " failed), " << statistics.sentBytes << " bytes sent, "
+                << statistics.receivedBytes << " bytes received, " << statistics.getBytesPerSecond() << " bytes/s, "
+                << "average parallelism " << statistics.getAverageParallelism();
+
+            if ((statistics.finishedJobs != BOARD_COUNT) || (statistics.failedJobs != 0)) {
+                success = false;
+            }
+
+            if (statistics.receivedBytes != BOARD_COUNT * SERIAL_READS_PER_BOARD * 6) {
+                Log().Get(ERROR) << "Unexpected number of received bytes!";
+                success = false;
+            }
+
+            /* the boards answer slowly: the jobs have to overlap */
+            if (statistics.getAverageParallelism() < 1.5) {
+                Log().Get(ERROR) << "The boards weren't driven in parallel!";
+                success = false;
+            }
+        }
+
+        running = false;
+        for (uint32_t i=0; i<BOARD_COUNT; i++) {
+            boards[i].join();
+            close(masters[i]);
+            unlink((DEVICE_DIRECTORY + "ttyUSB" + std::to_string(i)).c_str());
+        }
+        rmdir(DEVICE_DIRECTORY.c_str());
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    BoardManagerTest test;
+    return (uint32_t)test.runTest();
+}
@@ -0,0 +1,160 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/easyfpga.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <cstdio> /* remove(1) */
+#include <cstring> /* memcmp() */
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* must match SECTOR_MANIFEST_FILE in project.conf */
+static const std::string MANIFEST_FILE("/tmp/easyfpga-delta-upload-test.manifest");
+
+static const std::string BINARY_FILE("delta_upload_test.bin");
+
+/* 30 complete sectors and a partial one */
+static const uint32_t BINARY_SIZE = 30*4096 + 1234;
+static const uint32_t SECTOR_COUNT = 31;
+
+static const uint32_t SERIAL = 0x4711;
+
+/**
+ * \brief An easyFPGA without any cores
+ */
+class EmptyFpga : public EasyFpga
+{
+    void defineStructure(void) {
+    }
+};
+
+/**
+ * \brief Tests that EasyFpga::uploadBinaryFile() writes only changed
+ *        sectors
+ *
+ * The test needs no easyFPGA. A simulated board receives a binary, then a
+ * version with two changed sectors. Only these sectors have to be
+ * written. If the easyFPGA's status reports an unknown binary, the
+ * whole binary has to be written again, as it has after an interrupted
+ * delta upload.
+ */
+class DeltaUploadTest : public Tester
+{
+    std::string testName(void) {
+        return "delta upload test";
+    }
+
+    bool upload(BoardSimulator& board, const std::vector<char>& content, uint32_t expectedSectors) {
+        std::ofstream file(BINARY_FILE, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), content.size());
+        file.close();
+
+        uint64_t sectorsBefore = board.getStatistics().writtenSectors;
+
+        EmptyFpga fpga;
+        if (!fpga.connectHardwareDevice(board.getDevice()) || !fpga.uploadBinaryFile(BINARY_FILE)) {
+            Log().Get(ERROR) << "The binary upload failed!";
+            return false;
+        }
+
+        uint32_t writtenSectors = board.getStatistics().writtenSectors - sectorsBefore;
+        if (writtenSectors != expectedSectors) {
+            Log().Get(ERROR) << "Wrote " << writtenSectors << " sectors instead of " << expectedSectors << "!";
+            return false;
+        }
+
+        std::vector<byte> flash(board.getFlash());
+        if ((flash.size() != SECTOR_COUNT*4096) || (memcmp(flash.data(), content.data(), content.size()) != 0)) {
+            Log().Get(ERROR) << "The stored binary differs from the uploaded one!";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        std::remove(MANIFEST_FILE.c_str());
+
+        std::vector<char> first(BINARY_SIZE);
+        for (uint32_t i=0; i<BINARY_SIZE; i++) {
+            first[i] = (char)(i * 13 + (i >> 12));
+        }
+
+        std::vector<char> second(first);
+        second[3*4096 + 100] ^= 0x01;
+        second[17*4096 + 4095] ^= 0x80;
+
+        bool success = true;
+        BoardSimulator board(SERIAL);
+        if (!board.start()) {
+            return false;
+        }
+
+        Log().Get(INFO) << "Upload a binary to an unknown board...";
+        success &= this->upload(board, first, SECTOR_COUNT);
+
+        Log().Get(INFO) << "Upload a binary with two changed sectors...";
+        success &= this->upload(board, second, 2);
+
+        Log().Get(INFO) << "Upload the same binary again...";
+        success &= this->upload(board, second, 0);
+
+        Log().Get(INFO) << "Upload after another host changed the board...";
+        board.setStatus(true, BINARY_SIZE, 0x12345678);
+        success &= this->upload(board, first, SECTOR_COUNT);
+
+        Log().Get(INFO) << "Upload after an interrupted delta upload...";
+        std::ofstream file(BINARY_FILE, std::ios::binary | std::ios::trunc);
+        file.write(second.data(), second.size());
+        file.close();
+
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 8);
+        {
+            EmptyFpga fpga;
+            if (fpga.connectHardwareDevice(board.getDevice()) && fpga.uploadBinaryFile(BINARY_FILE)) {
+                Log().Get(ERROR) << "The faulty delta upload succeeded!";
+                success = false;
+            }
+        }
+        board.injectErrors(BoardSimulator::ERROR_TYPE::NACK, 0);
+
+        /* the status mustn't claim the previous binary any more */
+        success &= this->upload(board, first, SECTOR_COUNT);
+
+        std::remove(BINARY_FILE.c_str());
+        std::remove(MANIFEST_FILE.c_str());
+        std::remove((MANIFEST_FILE + ".lock").c_str());
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    DeltaUploadTest test;
+    return (uint32_t)test.runTest();
+}
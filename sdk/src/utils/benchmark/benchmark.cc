@@ -0,0 +1,284 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/benchmark/benchmark.h"
+#include "utils/log/log.h"
+#include "utils/os/time_helper.h"
+
+#include <algorithm> /* sort() */
+#include <cstdlib> /* strtoul(), strtod() */
+#include <cstring> /* strcmp() */
+#include <fstream>
+#include <iomanip> /* std::setprecision() */
+#include <sstream>
+
+Benchmark::Benchmark() :
+    _warmup(10),
+    _repetitions(100),
+    _fixedRepetitions(false),
+    _maximumRegression(-1.0)
+{
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+int Benchmark::runBenchmark(int argc, char** argv)
+{
+    if (!this->parseArguments(argc, argv)) {
+        EASYFPGA_LOG(ERROR) << "Usage: " << argv[0] << " [--output <file>] [--baseline <file>] "
+            << "[--max-regression <percent>] [--warmup <n>] [--repetitions <n>]";
+        return 2;
+    }
+
+    EASYFPGA_LOG(INFO) << "START " << this->benchmarkName();
+
+    LogLevel configuredLevel = Log::getMinimumOutputLevel();
+    if (configuredLevel < INFO) {
+        Log::setMinimumOutputLevel(INFO);
+    }
+
+    bool success = this->benchmarkMethod();
+
+    Log::setMinimumOutputLevel(configuredLevel);
+
+    if (!_outputFile.empty()) {
+        success &= this->writeResults();
+    }
+    if (!_baselineFile.empty()) {
+        success &= this->compareWithBaseline();
+    }
+
+    if (success) {
+        EASYFPGA_LOG(INFO) << "BENCHMARK SUCCESSFUL";
+    }
+    else {
+        EASYFPGA_LOG(INFO) << "BENCHMARK FAILED";
+    }
+
+    return success ? 0 : 1;
+}
+
+bool Benchmark::measure(std::string caseName, uint32_t operations, uint64_t bytes, std::function<bool()> run)
+{
+    for (uint32_t i=0; i<_warmup; i++) {
+        if (!run()) {
+            EASYFPGA_LOG(ERROR) << "Case " << caseName << " failed while warming up!";
+            return false;
+        }
+    }
+
+    std::vector<int64_t> durations;
+    durations.reserve(_repetitions);
+
+    for (uint32_t i=0; i<_repetitions; i++) {
+        timevalue start = getMonotonicTimeInNanos();
+        bool success = run();
+        timevalue end = getMonotonicTimeInNanos();
+
+        if (!success) {
+            EASYFPGA_LOG(ERROR) << "Case " << caseName << " failed!";
+            return false;
+        }
+        durations.push_back(end - start);
+    }
+
+    if (durations.empty()) {
+        return true;
+    }
+
+    std::sort(durations.begin(), durations.end());
+
+    int64_t sum = 0;
+    for (int64_t duration : durations) {
+        sum += duration;
+    }
+
+    /* nearest rank percentiles */
+    auto percentile = [&durations](uint32_t p) {
+        size_t rank = (durations.size() * p + 99) / 100;
+        return durations[(rank > 0) ? rank-1 : 0];
+    };
+
+    Result result;
+    result.name = caseName;
+    result.operations = operations;
+    result.bytes = bytes;
+    result.repetitions = durations.size();
+    result.minimum = durations.front();
+    result.mean = sum / (int64_t)durations.size();
+    result.p50 = percentile(50);
+    result.p90 = percentile(90);
+    result.p99 = percentile(99);
+    result.maximum = durations.back();
+    _results.push_back(result);
+
+    double seconds = result.mean / 1e9;
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << caseName << ": p50 " << result.p50 / 1000.0 << " us, p99 "
+        << result.p99 / 1000.0 << " us, " << operations / seconds << " ops/s";
+    if (bytes > 0) {
+        ss << ", " << bytes / seconds / 1024.0 << " KiB/s";
+    }
+    EASYFPGA_LOG(INFO) << ss.str();
+
+    return true;
+}
+
+void Benchmark::setRepetitions(uint32_t warmup, uint32_t repetitions)
+{
+    if (!_fixedRepetitions) {
+        _warmup = warmup;
+        _repetitions = repetitions;
+    }
+}
+
+bool Benchmark::parseArguments(int argc, char** argv)
+{
+    for (int i=1; i<argc; i++) {
+        if (i+1 >= argc) {
+            return false;
+        }
+
+        if (strcmp(argv[i], "--output") == 0) {
+            _outputFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0) {
+            _baselineFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--max-regression") == 0) {
+            _maximumRegression = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--warmup") == 0) {
+            _warmup = strtoul(argv[++i], NULL, 10);
+            _fixedRepetitions = true;
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0) {
+            _repetitions = strtoul(argv[++i], NULL, 10);
+            _fixedRepetitions = true;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Benchmark::writeResults(void)
+{
+    std::ofstream file(_outputFile, std::ios::trunc);
+    if (!file) {
+        EASYFPGA_LOG(ERROR) << "The benchmark results couldn't be written to " << _outputFile << "!";
+        return false;
+    }
+
+    /* one case per line, so that readBaseline() needs no JSON parser */
+    file << "{" << std::endl;
+    file << "  \"benchmark\": \"" << this->benchmarkName() << "\"," << std::endl;
+    file << "  \"timestamp\": " << getCurrentTimeInMillis() / 1000 << "," << std::endl;
+    file << "  \"cases\": [" << std::endl;
+
+    for (uint32_t i=0; i<_results.size(); i++) {
+        const Result& r = _results[i];
+        double seconds = r.mean / 1e9;
+
+        file << "    {\"name\": \"" << r.name << "\", \"repetitions\": " << r.repetitions
+            << ", \"operations\": " << r.operations << ", \"bytes\": " << r.bytes
+            << ", \"min_ns\": " << r.minimum << ", \"mean_ns\": " << r.mean
+            << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90 << ", \"p99_ns\": " << r.p99
+            << ", \"max_ns\": " << r.maximum
+            << std::fixed << std::setprecision(1)
+            << ", \"operations_per_second\": " << r.operations / seconds
+            << ", \"bytes_per_second\": " << r.bytes / seconds << "}"
+            << ((i+1 < _results.size()) ? "," : "") << std::endl;
+    }
+
+    file << "  ]" << std::endl;
+    file << "}" << std::endl;
+
+    return file.good();
+}
+
+bool Benchmark::readBaseline(std::string fileName, std::map<std::string, int64_t>* medians)
+{
+    std::ifstream file(fileName);
+    if (!file) {
+        return false;
+    }
+
+    const std::string NAME_KEY("\"name\": \"");
+    const std::string MEDIAN_KEY("\"p50_ns\": ");
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t name = line.find(NAME_KEY);
+        size_t median = line.find(MEDIAN_KEY);
+        if ((name == std::string::npos) || (median == std::string::npos)) {
+            continue;
+        }
+
+        name += NAME_KEY.length();
+        size_t nameEnd = line.find('"', name);
+        if (nameEnd == std::string::npos) {
+            continue;
+        }
+
+        (*medians)[line.substr(name, nameEnd - name)] = strtoll(line.c_str() + median + MEDIAN_KEY.length(), NULL, 10);
+    }
+
+    return true;
+}
+
+bool Benchmark::compareWithBaseline(void)
+{
+    std::map<std::string, int64_t> medians;
+    if (!readBaseline(_baselineFile, &medians)) {
+        EASYFPGA_LOG(INFO) << "No baseline found at " << _baselineFile << ".";
+        return true;
+    }
+
+    bool success = true;
+
+    for (const Result& result : _results) {
+        auto baseline = medians.find(result.name);
+        if ((baseline == medians.end()) || (baseline->second <= 0)) {
+            continue;
+        }
+
+        double change = 100.0 * (result.p50 - baseline->second) / baseline->second;
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1) << result.name << ": p50 " << baseline->second / 1000.0
+            << " us -> " << result.p50 / 1000.0 << " us (" << std::showpos << change << "%)";
+
+        if ((_maximumRegression >= 0.0) && (change > _maximumRegression)) {
+            EASYFPGA_LOG(WARNING) << "Regression of " << ss.str();
+            success = false;
+        }
+        else {
+            EASYFPGA_LOG(INFO) << ss.str();
+        }
+    }
+
+    return success;
+}
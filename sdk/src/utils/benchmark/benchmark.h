@@ -0,0 +1,139 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SDK_UTILS_BENCHMARK_BENCHMARK_H_
+#define SDK_UTILS_BENCHMARK_BENCHMARK_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Base class for benchmarks of the SDK
+ *
+ * Like a Tester, a benchmark implements benchmarkName() and
+ * benchmarkMethod(). The latter calls measure() for every case. The
+ * makefile builds every file ending up with "*Benchmark.cc" and runs
+ * it by the target \c bench.
+ *
+ * A case is executed a few times for warming up, then it's timed for
+ * a number of repetitions. The results (minimum, mean, percentiles
+ * and maximum of a repetition as well as the resulting operations and
+ * bytes per second) are logged and written to a JSON file.
+ *
+ * The command line options of runBenchmark() are:
+ * - \c --output \a file: Writes the results as JSON.
+ * - \c --baseline \a file: Compares the median of every case with the
+ *   one in a former output file.
+ * - \c --max-regression \a percent: Lets the benchmark fail if a median
+ *   is slower than the baseline by more than this.
+ * - \c --warmup \a n and \c --repetitions \a n: Overwrite the defaults.
+ *
+ * Debug messages are filtered while benchmarkMethod() runs.
+ */
+class Benchmark
+{
+    public:
+        Benchmark();
+        virtual ~Benchmark();
+
+        /**
+         * \brief Executes the benchmark.
+         *
+         * \return 0 if all cases could be executed without regression,<br>
+         *         1 otherwise,<br>
+         *         2 for wrong command line options
+         */
+        int runBenchmark(int argc, char** argv);
+
+    protected:
+        /**
+         * \brief Should return the benchmark's name.
+         */
+        virtual std::string benchmarkName(void) = 0;
+
+        /**
+         * \brief Should prepare the environment and measure all cases.
+         *
+         * \return true if all cases could be executed,<br>
+         *         false otherwise
+         */
+        virtual bool benchmarkMethod(void) = 0;
+
+        /**
+         * \brief Measures a case.
+         *
+         * \param caseName Unique name of the case within the benchmark.
+         *
+         * \param operations Number of operations (e.g. exchanges) done
+         *        by one call of run.
+         *
+         * \param bytes Number of payload bytes transferred by one call
+         *        of run, 0 if meaningless.
+         *
+         * \param run Executes the operations once.
+         *
+         * \return false if run failed
+         */
+        bool measure(std::string caseName, uint32_t operations, uint64_t bytes, std::function<bool()> run);
+
+        /**
+         * \brief Sets the number of warmup runs and timed repetitions
+         *        of the following cases, unless overwritten by the
+         *        command line.
+         */
+        void setRepetitions(uint32_t warmup, uint32_t repetitions);
+
+    private:
+        struct Result {
+            std::string name;
+            uint32_t operations;
+            uint64_t bytes;
+            uint32_t repetitions;
+
+            /* durations of a repetition in ns */
+            int64_t minimum;
+            int64_t mean;
+            int64_t p50;
+            int64_t p90;
+            int64_t p99;
+            int64_t maximum;
+        };
+
+        bool parseArguments(int argc, char** argv);
+        bool writeResults(void);
+        bool compareWithBaseline(void);
+        static bool readBaseline(std::string fileName, std::map<std::string, int64_t>* medians);
+
+        uint32_t _warmup;
+        uint32_t _repetitions;
+        bool _fixedRepetitions;
+
+        std::string _outputFile;
+        std::string _baselineFile;
+        double _maximumRegression;
+
+        std::vector<Result> _results;
+};
+
+#endif  // SDK_UTILS_BENCHMARK_BENCHMARK_H_
@@ -26,6 +26,7 @@
 #include "utils/os/types.h"
 
 #include <cstdio> /* FILE*, stdout */
+#include <cstdlib> /* getenv(1) */
 #include <iostream>
 #include <list>
 #include <sstream>
@@ -51,10 +52,18 @@ ConfigurationFile::ConfigurationFile() :
     _TEMPLATES_DIRECTORY("/usr/local/share/easyfpga/templates"),
     _USB_DEVICE_PATH("/dev/"),
     _USB_DEVICE_IDENTIFIER("ttyUSB"),
+    _DEVICE_CACHE_FILE("~/.easyfpga_device_cache"),
+    _SECTOR_MANIFEST_FILE("~/.easyfpga_sector_manifest"),
     _MAX_RETRIES_ALLOWED("3"),
+    _MAX_ASYNC_REQUESTS_IN_FLIGHT("16"),
+    _SERIAL_RECEIVE_THREAD("off"),
     _LOG_OUTPUT_TARGET("STDOUT"),
     _currentLogOutputTarget(NULL),
     _LOG_MIN_OUTPUT_LEVEL("0"),
+    _LOG_ASYNC("off"),
+    _EXCHANGE_TRACE_FILE("off"),
+    _METRICS_FILE("off"),
+    _METRICS_DUMP_INTERVAL("1000"),
     _FRAMEWORK_OPERATION_MODE("sync")
 {
 }
@@ -125,9 +134,17 @@ bool ConfigurationFile::parseConfigurationFile(void)
         success &= this->parse(content, "TEMPLATES_DIRECTORY", _TEMPLATES_DIRECTORY);
         success &= this->parse(content, "USB_DEVICE_PATH", _USB_DEVICE_PATH);
         success &= this->parse(content, "USB_DEVICE_IDENTIFIER", _USB_DEVICE_IDENTIFIER);
+        success &= this->parse(content, "DEVICE_CACHE_FILE", _DEVICE_CACHE_FILE);
         success &= this->parse(content, "MAX_RETRIES_ALLOWED", _MAX_RETRIES_ALLOWED);
+        success &= this->parse(content, "MAX_ASYNC_REQUESTS_IN_FLIGHT", _MAX_ASYNC_REQUESTS_IN_FLIGHT);
+        success &= this->parse(content, "SERIAL_RECEIVE_THREAD", _SERIAL_RECEIVE_THREAD);
+        success &= this->parse(content, "SECTOR_MANIFEST_FILE", _SECTOR_MANIFEST_FILE);
         success &= this->parse(content, "LOG_OUTPUT_TARGET", _LOG_OUTPUT_TARGET);
         success &= this->parse(content, "MIN_LOG_LEVEL_OUTPUT", _LOG_MIN_OUTPUT_LEVEL);
+        success &= this->parse(content, "LOG_ASYNC", _LOG_ASYNC);
+        success &= this->parse(content, "EXCHANGE_TRACE_FILE", _EXCHANGE_TRACE_FILE);
+        success &= this->parse(content, "METRICS_FILE", _METRICS_FILE);
+        success &= this->parse(content, "METRICS_DUMP_INTERVAL", _METRICS_DUMP_INTERVAL);
         success &= this->parse(content, "FRAMEWORK_OPERATION_MODE", _FRAMEWORK_OPERATION_MODE);
 
         return success;
@@ -160,6 +177,23 @@ bool ConfigurationFile::parse(const std::string content, std::string paramName,
     return false;
 }
 
+std::string ConfigurationFile::toOptionalPath(std::string value)
+{
+    if (value.empty() || (value.compare("off") == 0)) {
+        return std::string();
+    }
+
+    if (value[0] == '~') {
+        const char* home = getenv("HOME");
+        if (home == NULL) {
+            return std::string();
+        }
+        return std::string(home) + value.substr(1);
+    }
+
+    return value;
+}
+
 std::string ConfigurationFile::getSocDirectory(void)
 {
     if (!configFileAlreadyParsed) {
@@ -220,6 +254,16 @@ std::string ConfigurationFile::getUsbDeviceIdentifier(void)
     return _USB_DEVICE_IDENTIFIER;
 }
 
+std::string ConfigurationFile::getDeviceCacheFile(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    return this->toOptionalPath(_DEVICE_CACHE_FILE);
+}
+
 retryval ConfigurationFile::getMaximumRetriesAllowed(void)
 {
     if (!configFileAlreadyParsed) {
@@ -230,6 +274,74 @@ retryval ConfigurationFile::getMaximumRetriesAllowed(void)
     return (retryval)std::stoi(_MAX_RETRIES_ALLOWED);
 }
 
+uint32_t ConfigurationFile::getMaximumRequestsInFlight(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    return (uint32_t)std::stoi(_MAX_ASYNC_REQUESTS_IN_FLIGHT);
+}
+
+std::string ConfigurationFile::getSectorManifestFile(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    return this->toOptionalPath(_SECTOR_MANIFEST_FILE);
+}
+
+std::string ConfigurationFile::getExchangeTraceFile(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    return this->toOptionalPath(_EXCHANGE_TRACE_FILE);
+}
+
+std::string ConfigurationFile::getMetricsFile(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    return this->toOptionalPath(_METRICS_FILE);
+}
+
+uint32_t ConfigurationFile::getMetricsDumpInterval(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    return (uint32_t)std::stoul(_METRICS_DUMP_INTERVAL);
+}
+
+bool ConfigurationFile::getSerialReceiveThread(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    if (_SERIAL_RECEIVE_THREAD.compare("on") == 0) {
+        return true;
+    } else if (_SERIAL_RECEIVE_THREAD.compare("off") == 0) {
+        return false;
+    }
+    else {
+        assert(false);
+        exit(-1);
+    }
+}
+
 FILE* ConfigurationFile::getLogOutputTarget(void)
 {
     if (!configFileAlreadyParsed) {
@@ -277,6 +389,24 @@ LogLevel ConfigurationFile::getMinimumLogOutputLevel(void)
     }
 }
 
+bool ConfigurationFile::getLogAsync(void)
+{
+    if (!configFileAlreadyParsed) {
+        this->parseConfigurationFile();
+        configFileAlreadyParsed = true;
+    }
+
+    if (_LOG_ASYNC.compare("on") == 0) {
+        return true;
+    } else if (_LOG_ASYNC.compare("off") == 0) {
+        return false;
+    }
+    else {
+        assert(false);
+        exit(-1);
+    }
+}
+
 OPERATION_MODE ConfigurationFile::getOperationMode(void)
 {
     if (!configFileAlreadyParsed) {
@@ -326,6 +456,12 @@ bool ConfigurationFile::createConfigurationFile(std::string path)
     ss << "USB_DEVICE_PATH=" << _USB_DEVICE_PATH << std::endl;
     ss << "# Special name pattern to find an device in the directory of USB_DEVICE_PATH" << std::endl;
     ss << "USB_DEVICE_IDENTIFIER=" << _USB_DEVICE_IDENTIFIER << std::endl;
+    ss << "# File remembering the device of every found easyFPGA by its serial." << std::endl;
+    ss << "# Connecting to a known serial needs only one probe instead of a scan." << std::endl;
+    ss << "# Possible values:" << std::endl;
+    ss << "# - off: always scan all devices" << std::endl;
+    ss << "# - /absolute/path/to/a/file (~ means the home directory)" << std::endl;
+    ss << "DEVICE_CACHE_FILE=" << _DEVICE_CACHE_FILE << std::endl;
     ss << std::endl;
     ss << std::endl;
     ss << "# COMMUNICATION SETTINGS" << std::endl;
@@ -333,6 +469,21 @@ bool ConfigurationFile::createConfigurationFile(std::string path)
     ss << "# errors or timeouts occurs)." << std::endl;
     ss << "# Values between 0 and 255 are possible." << std::endl;
     ss << "MAX_RETRIES_ALLOWED=" << _MAX_RETRIES_ALLOWED << std::endl;
+    ss << "# The maximum number of asynchronous requests sent to the easyFPGA" << std::endl;
+    ss << "# whose replies are still outstanding. Larger values keep the serial" << std::endl;
+    ss << "# line busy, smaller ones reduce the latency of single replies." << std::endl;
+    ss << "# Values between 1 and 255 are possible." << std::endl;
+    ss << "MAX_ASYNC_REQUESTS_IN_FLIGHT=" << _MAX_ASYNC_REQUESTS_IN_FLIGHT << std::endl;
+    ss << "# Decide whether a background thread reads all incoming bytes from" << std::endl;
+    ss << "# the serial device. This reduces the reply latency at a high load." << std::endl;
+    ss << "# Values of set {on, off} are possible." << std::endl;
+    ss << "SERIAL_RECEIVE_THREAD=" << _SERIAL_RECEIVE_THREAD << std::endl;
+    ss << "# File remembering the sector hashes of the binary uploaded to every" << std::endl;
+    ss << "# easyFPGA. Then only the changed sectors of a new binary are uploaded." << std::endl;
+    ss << "# Possible values:" << std::endl;
+    ss << "# - off: always upload all sectors" << std::endl;
+    ss << "# - /absolute/path/to/a/file (~ means the home directory)" << std::endl;
+    ss << "SECTOR_MANIFEST_FILE=" << _SECTOR_MANIFEST_FILE << std::endl;
     ss << "# Decide whether to use a synchronous or asynchronous operation mode." << std::endl;
     ss << "# Values of set {sync, async} are possible." << std::endl;
     ss << "FRAMEWORK_OPERATION_MODE=" << _FRAMEWORK_OPERATION_MODE << std::endl;
@@ -353,6 +504,25 @@ bool ConfigurationFile::createConfigurationFile(std::string path)
     ss << "# - 2: all warnings and errors" << std::endl;
     ss << "# - 3: only errors" << std::endl;
     ss << "MIN_LOG_LEVEL_OUTPUT=" << _LOG_MIN_OUTPUT_LEVEL << std::endl;
+    ss << "# Decide whether a background thread writes the log messages, so that" << std::endl;
+    ss << "# logging never waits for the terminal or the disk. If it can't keep" << std::endl;
+    ss << "# up, messages are dropped and the number of dropped ones is logged." << std::endl;
+    ss << "# Values of set {on, off} are possible." << std::endl;
+    ss << "LOG_ASYNC=" << _LOG_ASYNC << std::endl;
+    ss << "# File recording every exchange with the easyFPGA in a binary ring" << std::endl;
+    ss << "# buffer. Decode it with easyfpga-trace." << std::endl;
+    ss << "# Possible values:" << std::endl;
+    ss << "# - off: no recording" << std::endl;
+    ss << "# - /absolute/path/to/a/file (~ means the home directory)" << std::endl;
+    ss << "EXCHANGE_TRACE_FILE=" << _EXCHANGE_TRACE_FILE << std::endl;
+    ss << "# File into which the exchange counters and latency histograms are" << std::endl;
+    ss << "# written periodically in the Prometheus text format." << std::endl;
+    ss << "# Possible values:" << std::endl;
+    ss << "# - off: no metrics file" << std::endl;
+    ss << "# - /absolute/path/to/a/file (~ means the home directory)" << std::endl;
+    ss << "METRICS_FILE=" << _METRICS_FILE << std::endl;
+    ss << "# Milliseconds between two writes of the metrics file." << std::endl;
+    ss << "METRICS_DUMP_INTERVAL=" << _METRICS_DUMP_INTERVAL << std::endl;
     ss << "" << std::endl;
 
     return newConfigFile.createWithContent(ss.str());
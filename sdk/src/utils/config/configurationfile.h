@@ -77,12 +77,71 @@ class ConfigurationFile
          */
         std::string getUsbDeviceIdentifier(void);
 
+        /**
+         * \brief Returns the file which remembers the device paths of
+         *        already found easyFPGAs by their serial numbers.
+         *
+         * \return An absolute path (a leading ~ is replaced by the home
+         *         directory), or an empty string if the cache is
+         *         switched off.
+         */
+        std::string getDeviceCacheFile(void);
+
+        /**
+         * \brief Returns the file which remembers the sector hashes of
+         *        the binaries uploaded to the easyFPGAs.
+         *
+         * \return An absolute path (a leading ~ is replaced by the home
+         *         directory), or an empty string if only changed sectors
+         *         shouldn't be uploaded.
+         */
+        std::string getSectorManifestFile(void);
+
+        /**
+         * \brief Returns the file recording all exchanges with the
+         *        easyFPGAs.
+         *
+         * \return An absolute path (a leading ~ is replaced by the home
+         *         directory), or an empty string if the exchanges
+         *         shouldn't be recorded.
+         */
+        std::string getExchangeTraceFile(void);
+
+        /**
+         * \brief Returns the file into which the metrics are written
+         *        periodically in the Prometheus text format.
+         *
+         * \return An absolute path (a leading ~ is replaced by the home
+         *         directory), or an empty string if the metrics
+         *         shouldn't be written.
+         */
+        std::string getMetricsFile(void);
+
+        /**
+         * \brief Returns the milliseconds between two writes of the
+         *        metrics file.
+         */
+        uint32_t getMetricsDumpInterval(void);
+
         /**
          * \brief Returns a maximum number of operation retries if errors
          *        occur.
          */
         retryval getMaximumRetriesAllowed(void);
 
+        /**
+         * \brief Returns the maximum number of asynchronous requests
+         *        which may be sent to the easyFPGA without having
+         *        received their replies yet.
+         */
+        uint32_t getMaximumRequestsInFlight(void);
+
+        /**
+         * \brief Returns true if a background thread should read all
+         *        incoming bytes of the serial connection.
+         */
+        bool getSerialReceiveThread(void);
+
         /**
          * \brief Returns the log target set by the user.
          */
@@ -93,6 +152,12 @@ class ConfigurationFile
          */
         LogLevel getMinimumLogOutputLevel(void);
 
+        /**
+         * \brief Returns true if a background thread should write the
+         *        log messages.
+         */
+        bool getLogAsync(void);
+
         /**
          * \brief Returns the current operation mode of the framework.
          *        (If the framework executes all exchanges synchronous
@@ -127,6 +192,12 @@ class ConfigurationFile
         bool parseConfigurationFile(void);
         bool parse(std::string content, std::string paramName, std::string& paramValue);
 
+        /**
+         * Returns an empty string for "off", otherwise the path with a
+         * leading ~ replaced by the home directory.
+         */
+        std::string toOptionalPath(std::string value);
+
         std::string _SOC_DIRECTORY;
         std::string _LIBRARY_DIRECTORY;
         std::string _HEADER_DIRECTORY;
@@ -134,12 +205,20 @@ class ConfigurationFile
 
         std::string _USB_DEVICE_PATH;
         std::string _USB_DEVICE_IDENTIFIER;
+        std::string _DEVICE_CACHE_FILE;
+        std::string _SECTOR_MANIFEST_FILE;
 
         std::string _MAX_RETRIES_ALLOWED;
+        std::string _MAX_ASYNC_REQUESTS_IN_FLIGHT;
+        std::string _SERIAL_RECEIVE_THREAD;
 
         std::string _LOG_OUTPUT_TARGET;
         FILE* _currentLogOutputTarget;
         std::string _LOG_MIN_OUTPUT_LEVEL;
+        std::string _LOG_ASYNC;
+        std::string _EXCHANGE_TRACE_FILE;
+        std::string _METRICS_FILE;
+        std::string _METRICS_DUMP_INTERVAL;
 
         std::string _FRAMEWORK_OPERATION_MODE;
 };
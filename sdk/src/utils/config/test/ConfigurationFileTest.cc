@@ -65,6 +65,22 @@ class ConfigurationFileTest : public Tester
             return false;
         }
 
+        std::string cacheFile(file.getDeviceCacheFile());
+        if ((cacheFile.length() > 23) && (cacheFile.compare(cacheFile.length()-23, 23, "/.easyfpga_device_cache") == 0)) {
+            Log().Get(DEBUG) << "Device cache file: " << cacheFile;
+        }
+        else {
+            return false;
+        }
+
+        std::string manifestFile(file.getSectorManifestFile());
+        if ((manifestFile.length() > 26) && (manifestFile.compare(manifestFile.length()-26, 26, "/.easyfpga_sector_manifest") == 0)) {
+            Log().Get(DEBUG) << "Sector manifest file: " << manifestFile;
+        }
+        else {
+            return false;
+        }
+
         if (file.getMaximumRetriesAllowed() == 3) {
             Log().Get(DEBUG) << "Maximum retries allowed: " << file.getMaximumRetriesAllowed();
         }
@@ -72,6 +88,20 @@ class ConfigurationFileTest : public Tester
             return false;
         }
 
+        if (file.getMaximumRequestsInFlight() == 16) {
+            Log().Get(DEBUG) << "Maximum async requests in flight: " << file.getMaximumRequestsInFlight();
+        }
+        else {
+            return false;
+        }
+
+        if (!file.getSerialReceiveThread()) {
+            Log().Get(DEBUG) << "Serial receive thread disabled.";
+        }
+        else {
+            return false;
+        }
+
         if (file.getLogOutputTarget() != NULL) {
             Log().Get(DEBUG) << "Log output target (pointer): " << file.getLogOutputTarget();
         }
@@ -86,6 +116,34 @@ class ConfigurationFileTest : public Tester
             return false;
         }
 
+        if (!file.getLogAsync()) {
+            Log().Get(DEBUG) << "Asynchronous logging disabled.";
+        }
+        else {
+            return false;
+        }
+
+        if (file.getExchangeTraceFile().empty()) {
+            Log().Get(DEBUG) << "Exchange trace disabled.";
+        }
+        else {
+            return false;
+        }
+
+        if (file.getMetricsFile().empty()) {
+            Log().Get(DEBUG) << "Metrics file disabled.";
+        }
+        else {
+            return false;
+        }
+
+        if (file.getMetricsDumpInterval() == 1000) {
+            Log().Get(DEBUG) << "Metrics dump interval: " << file.getMetricsDumpInterval() << " ms";
+        }
+        else {
+            return false;
+        }
+
         switch (file.getOperationMode()) {
             case OPERATION_MODE::SYNC:
                 Log().Get(DEBUG) << "Setted operation mode: synchronous mode";
@@ -0,0 +1,148 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "configuration.h" /* assert() */
+#include "utils/latencyhistogram.h"
+
+#include <cmath> /* ceil() */
+
+uint64_t LatencyHistogramSnapshot::getPercentile(double percent) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)std::ceil(percent / 100.0 * (double)count);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i=0; i<buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = LatencyHistogram::getBucketUpperBound(i) - 1;
+            return (upper < max) ? upper : max;
+        }
+    }
+
+    return max;
+}
+
+uint64_t LatencyHistogramSnapshot::countBelowPowerOfTwo(uint32_t exponent) const
+{
+    /* a power of two always starts a bucket */
+    uint32_t end = (exponent >= LatencyHistogram::MAX_EXPONENT) ? buckets.size() :
+        LatencyHistogram::getBucket((uint64_t)1 << exponent);
+
+    uint64_t below = 0;
+    for (uint32_t i=0; (i<end) && (i<buckets.size()); i++) {
+        below += buckets[i];
+    }
+
+    return below;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    this->reset();
+}
+
+void LatencyHistogram::record(int64_t value)
+{
+    uint64_t v = (value > 0) ? (uint64_t)value : 0;
+
+    _buckets[getBucket(v)].fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(v, std::memory_order_relaxed);
+
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while ((v > max) && !_max.compare_exchange_weak(max, v, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogramSnapshot LatencyHistogram::getSnapshot(void) const
+{
+    LatencyHistogramSnapshot snapshot;
+    snapshot.buckets.resize(BUCKET_COUNT);
+
+    /* count is summed up from the buckets to keep the percentiles consistent */
+    snapshot.count = 0;
+    for (uint32_t i=0; i<BUCKET_COUNT; i++) {
+        snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+
+    snapshot.sum = _sum.load(std::memory_order_relaxed);
+    snapshot.max = _max.load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+void LatencyHistogram::reset(void)
+{
+    for (uint32_t i=0; i<BUCKET_COUNT; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::getBucket(uint64_t value)
+{
+    if (value < 8) {
+        return (uint32_t)value;
+    }
+
+    /* position of the highest set bit, at least 3 */
+    uint32_t exponent = 63 - __builtin_clzll(value);
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+
+    uint32_t subBucket = (value >> (exponent - 3)) & 0x07;
+    return (exponent - 2) * 8 + subBucket;
+}
+
+uint64_t LatencyHistogram::getBucketLowerBound(uint32_t bucket)
+{
+    assert(bucket < BUCKET_COUNT);
+
+    if (bucket < 8) {
+        return bucket;
+    }
+
+    uint32_t exponent = bucket / 8 + 2;
+    return (uint64_t)(8 + bucket % 8) << (exponent - 3);
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound(uint32_t bucket)
+{
+    assert(bucket < BUCKET_COUNT);
+
+    if (bucket < 8) {
+        return bucket + 1;
+    }
+
+    uint32_t exponent = bucket / 8 + 2;
+    return getBucketLowerBound(bucket) + ((uint64_t)1 << (exponent - 3));
+}
@@ -0,0 +1,128 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef SDK_UTILS_LATENCYHISTOGRAM_H_
+#define SDK_UTILS_LATENCYHISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Copy of a LatencyHistogram's buckets at a point in time
+ */
+struct LatencyHistogramSnapshot {
+    /** number of recorded values */
+    uint64_t count;
+
+    /** sum of all recorded values */
+    uint64_t sum;
+
+    /** largest recorded value */
+    uint64_t max;
+
+    /** number of values of every bucket, see LatencyHistogram */
+    std::vector<uint64_t> buckets;
+
+    /**
+     * \brief Returns the value below which the given percentage of the
+     *        recorded values lies, e.g. 99.0 for the 99th percentile.
+     *
+     * The result is the upper boundary of the bucket containing the
+     * percentile (but at most max), so it overestimates the exact
+     * percentile by less than 1/8. Returns 0 if nothing was recorded.
+     */
+    uint64_t getPercentile(double percent) const;
+
+    /**
+     * \brief Returns the number of values smaller than the given
+     *        power of two.
+     */
+    uint64_t countBelowPowerOfTwo(uint32_t exponent) const;
+};
+
+/**
+ * \brief Lock-free histogram of durations in nanoseconds
+ *
+ * The buckets are log-linear like those of a HdrHistogram with one
+ * significant octal digit: values below 8 get an own bucket, every
+ * further power of two is divided into 8 equally wide buckets. Thus the
+ * relative error of a bucket is below 12.5 % over the whole range of 1
+ * ns up to about an hour. Larger values are counted in the last bucket.
+ *
+ * record() consists of a few relaxed atomic operations, so any number
+ * of threads may record values while an other one takes snapshots. A
+ * snapshot isn't taken atomically as a whole: count and buckets may
+ * differ by the values recorded in the meantime.
+ */
+class LatencyHistogram
+{
+    public:
+        /** values up to 2^MAX_EXPONENT-1 get an exact bucket */
+        static const uint32_t MAX_EXPONENT = 42;
+
+        static const uint32_t BUCKET_COUNT = (MAX_EXPONENT - 2) * 8;
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        /**
+         * \brief Counts a value. Negative values are counted as 0.
+         */
+        void record(int64_t value);
+
+        /**
+         * \brief Returns a copy of all buckets.
+         */
+        LatencyHistogramSnapshot getSnapshot(void) const;
+
+        /**
+         * \brief Sets all buckets to zero. Values recorded at the same
+         *        time might get lost partially.
+         */
+        void reset(void);
+
+        /**
+         * \brief Returns the index of the bucket counting a value.
+         */
+        static uint32_t getBucket(uint64_t value);
+
+        /**
+         * \brief Returns the smallest value counted by a bucket.
+         */
+        static uint64_t getBucketLowerBound(uint32_t bucket);
+
+        /**
+         * \brief Returns the smallest value counted by the next bucket.
+         */
+        static uint64_t getBucketUpperBound(uint32_t bucket);
+
+    private:
+        std::atomic<uint64_t> _buckets[BUCKET_COUNT];
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _max;
+};
+
+#endif  // SDK_UTILS_LATENCYHISTOGRAM_H_
@@ -0,0 +1,173 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "utils/log/asynclogsink.h"
+#include "utils/log/log.h"
+#include "utils/os/time_helper.h" /* getTimeString() */
+
+#include <algorithm> /* min(2) */
+#include <chrono>
+#include <cstdio> /* fwrite(), fflush() */
+#include <cstring> /* memcpy(), strlen() */
+
+/* the writer sleeps at most this time if nobody wakes it up */
+static const std::chrono::milliseconds WRITER_WAKEUP_INTERVAL(10);
+
+/* trivially destructible, so it remains valid during the program exit */
+static std::atomic<bool> destroyed(false);
+
+AsyncLogSink& AsyncLogSink::getInstance(void)
+{
+    static AsyncLogSink _instance;
+
+    return _instance;
+}
+
+bool AsyncLogSink::isAvailable(void)
+{
+    return !destroyed.load(std::memory_order_acquire);
+}
+
+AsyncLogSink::AsyncLogSink() :
+    _queue(LOG_ASYNC_QUEUE_SIZE),
+    _pushedMessages(0),
+    _writtenMessages(0),
+    _droppedMessages(0),
+    _reportedDroppedMessages(0),
+    _running(true),
+    _writerWaiting(false)
+{
+    _thread = std::thread(&AsyncLogSink::run, this);
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    destroyed.store(true, std::memory_order_release);
+
+    _running = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _condition.notify_all();
+    }
+    _thread.join();
+}
+
+bool AsyncLogSink::push(LogLevel level, const struct timespec& time, const std::string& message)
+{
+    Record record;
+    record.level = level;
+    record.time = time;
+
+    size_t length = std::min(message.length(), (size_t)LOG_RECORD_TEXT_SIZE-1);
+    memcpy(record.text, message.data(), length);
+    record.text[length] = '\0';
+
+    if (!_queue.push(record)) {
+        _droppedMessages.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    _pushedMessages.fetch_add(1, std::memory_order_release);
+
+    /* a lost wake-up only delays the writer until its next interval */
+    if (_writerWaiting.load(std::memory_order_relaxed)) {
+        _condition.notify_one();
+    }
+
+    return true;
+}
+
+void AsyncLogSink::flush(void)
+{
+    uint64_t pushed = _pushedMessages.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.notify_all();
+    while (_writtenMessages.load(std::memory_order_acquire) < pushed) {
+        _condition.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+uint64_t AsyncLogSink::getNumberOfDroppedMessages(void)
+{
+    return _droppedMessages.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogSink::getNumberOfWrittenMessages(void)
+{
+    return _writtenMessages.load(std::memory_order_relaxed);
+}
+
+void AsyncLogSink::run(void)
+{
+    while (true) {
+        if (this->writeQueuedRecords()) {
+            continue;
+        }
+
+        if (!_running) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _writerWaiting = true;
+        _condition.wait_for(lock, WRITER_WAKEUP_INTERVAL);
+        _writerWaiting = false;
+    }
+}
+
+bool AsyncLogSink::writeQueuedRecords(void)
+{
+    std::string batch;
+    uint64_t count = 0;
+    Record record;
+
+    /* limit the batch, so that the dropped messages are reported in time */
+    while ((count < _queue.getCapacity()) && _queue.pop(&record)) {
+        batch += "+ ";
+        batch += getTimeString(record.time.tv_sec);
+        batch += "  ";
+        batch += Log::toString(record.level);
+        batch += "\t";
+        batch += record.text;
+        batch += "\n";
+        count++;
+    }
+
+    uint64_t dropped = _droppedMessages.load(std::memory_order_relaxed);
+    if (dropped != _reportedDroppedMessages) {
+        batch += "+ " + getCurrentTimeString() + "  " + Log::toString(WARNING) + "\t"
+            + std::to_string(dropped - _reportedDroppedMessages) + " log messages dropped because the queue was full!\n";
+        _reportedDroppedMessages = dropped;
+    }
+
+    if (batch.empty()) {
+        return false;
+    }
+
+    FILE* target = Log::getOutputTarget();
+    fwrite(batch.data(), 1, batch.size(), target);
+    fflush(target);
+
+    _writtenMessages.fetch_add(count, std::memory_order_release);
+    return true;
+}
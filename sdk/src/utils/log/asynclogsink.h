@@ -0,0 +1,128 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_UTILS_LOG_ASYNCLOGSINK_H_
+#define SDK_UTILS_LOG_ASYNCLOGSINK_H_
+
+#include "configuration.h" /* LOG_ASYNC_QUEUE_SIZE, LOG_RECORD_TEXT_SIZE */
+#include "utils/log/types.h"
+#include "utils/mpscringbuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <time.h> /* timespec */
+
+/**
+ * \brief Writes log messages in a background thread.
+ *
+ * If the option LOG_ASYNC is set in project.conf, the Log objects don't
+ * write their message themselves but push it into a lock-free queue,
+ * together with the level and the raw time. A background thread formats
+ * the records and writes them in batches with a single write and flush.
+ * So logging never waits for the terminal or the disk.
+ *
+ * If the queue is full, a message is dropped instead of waiting. The
+ * number of dropped messages will be logged as soon as the queue has
+ * space again.
+ */
+class AsyncLogSink
+{
+    public:
+        /**
+         * \brief Returns the sink, starting its thread on the first call.
+         */
+        static AsyncLogSink& getInstance(void);
+
+        /**
+         * \brief Returns false after the sink was destroyed at program
+         *        exit. Then messages have to be written directly.
+         */
+        static bool isAvailable(void);
+
+        /**
+         * \brief Writes all queued messages and stops the thread.
+         */
+        ~AsyncLogSink();
+
+        /**
+         * \brief Queues a message without blocking.
+         *
+         * \return true if the message was queued,<br>
+         *         false if it was dropped because the queue is full
+         */
+        bool push(LogLevel level, const struct timespec& time, const std::string& message);
+
+        /**
+         * \brief Waits until all messages queued so far are written.
+         */
+        void flush(void);
+
+        /**
+         * \brief Returns the number of messages dropped because the
+         *        queue was full.
+         */
+        uint64_t getNumberOfDroppedMessages(void);
+
+        /**
+         * \brief Returns the number of written messages.
+         */
+        uint64_t getNumberOfWrittenMessages(void);
+
+    private:
+        struct Record {
+            LogLevel level;
+            struct timespec time;
+            char text[LOG_RECORD_TEXT_SIZE];
+        };
+
+        AsyncLogSink();
+        AsyncLogSink(const AsyncLogSink&);
+        AsyncLogSink& operator=(const AsyncLogSink&);
+
+        void run(void);
+
+        /**
+         * Writes all queued records. Returns false if the queue was
+         * empty.
+         */
+        bool writeQueuedRecords(void);
+
+        MpscRingBuffer<Record> _queue;
+
+        std::atomic<uint64_t> _pushedMessages;
+        std::atomic<uint64_t> _writtenMessages;
+        std::atomic<uint64_t> _droppedMessages;
+        uint64_t _reportedDroppedMessages;
+
+        std::atomic<bool> _running;
+        std::atomic<bool> _writerWaiting;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::thread _thread;
+};
+
+#endif  // SDK_UTILS_LOG_ASYNCLOGSINK_H_
@@ -20,29 +20,76 @@
  */
 
 #include "utils/config/configurationfile.h"
+#include "utils/log/asynclogsink.h"
 #include "utils/log/log.h"
 #include "utils/os/time_helper.h" /* getCurrentTimeString() */
 
+#include <atomic>
+
+/*
+ * The configuration is cached, so that checking whether a message will
+ * be output doesn't query the configuration file.
+ */
+static std::atomic<int32_t>& minimumOutputLevel(void)
+{
+    static std::atomic<int32_t> level(ConfigurationFile::getInstance().getMinimumLogOutputLevel());
+    return level;
+}
+
+static std::atomic<FILE*>& outputTarget(void)
+{
+    static std::atomic<FILE*> target(ConfigurationFile::getInstance().getLogOutputTarget());
+    return target;
+}
+
+static std::atomic<bool>& asyncOutput(void)
+{
+    static std::atomic<bool> enabled(ConfigurationFile::getInstance().getLogAsync());
+    return enabled;
+}
+
 Log::Log() :
-    _LOG_OUTPUT_TARGET(ConfigurationFile::getInstance().getLogOutputTarget()),
-    _LOG_MIN_OUTPUT_LEVEL(ConfigurationFile::getInstance().getMinimumLogOutputLevel())
+    _messageLevel(DEBUG),
+    _async(false)
 {
 }
 
 Log::~Log()
 {
-    if (_messageLevel >= _LOG_MIN_OUTPUT_LEVEL) {
+    if (_messageLevel >= Log::getMinimumOutputLevel()) {
+        if (_async && AsyncLogSink::isAvailable()) {
+            AsyncLogSink::getInstance().push(_messageLevel, _time, _os.str());
+            return;
+        }
+
+        if (_async) {
+            _os.str("+ " + getTimeString(_time.tv_sec) + "  " + this->toString(_messageLevel) + "\t" + _os.str());
+            _os.seekp(0, std::ios_base::end);
+        }
+
         _os << std::endl;
 
-        fprintf(_LOG_OUTPUT_TARGET, "%s", _os.str().c_str());
-        fflush(_LOG_OUTPUT_TARGET);
+        FILE* target = Log::getOutputTarget();
+        fprintf(target, "%s", _os.str().c_str());
+        fflush(target);
     }
 }
 
 std::ostringstream& Log::Get(LogLevel level)
 {
-    _os << "+ " << getCurrentTimeString() << "  " << this->toString(level) << "\t";
     _messageLevel = level;
+
+    /* the time of a message which won't be output isn't needed */
+    if (level >= Log::getMinimumOutputLevel()) {
+        if (Log::isAsyncOutput()) {
+            /* the AsyncLogSink adds the header */
+            _async = (clock_gettime(CLOCK_REALTIME, &_time) == 0);
+        }
+        if (!_async) {
+            _os << "+ " << getCurrentTimeString() << "  " << this->toString(level) << "\t";
+        }
+    }
+
     return _os;
 }
 
@@ -51,3 +98,36 @@ std::string Log::toString(LogLevel level)
     static const char* const buffer[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
     return buffer[level];
 }
+
+LogLevel Log::getMinimumOutputLevel(void)
+{
+    return (LogLevel)minimumOutputLevel().load(std::memory_order_relaxed);
+}
+
+void Log::setMinimumOutputLevel(LogLevel level)
+{
+    minimumOutputLevel().store(level, std::memory_order_relaxed);
+}
+
+void Log::setOutputTarget(FILE* target)
+{
+    outputTarget().store(target);
+}
+
+FILE* Log::getOutputTarget(void)
+{
+    return outputTarget().load();
+}
+
+void Log::setAsyncOutput(bool enabled)
+{
+    if (!enabled && asyncOutput().load() && AsyncLogSink::isAvailable()) {
+        AsyncLogSink::getInstance().flush();
+    }
+    asyncOutput().store(enabled);
+}
+
+bool Log::isAsyncOutput(void)
+{
+    return asyncOutput().load(std::memory_order_relaxed);
+}
@@ -22,17 +22,35 @@
 #ifndef SDK_UTILS_LOG_LOG_H_
 #define SDK_UTILS_LOG_LOG_H_
 
+#include "configuration.h" /* LOG_COMPILED_MIN_LEVEL */
 #include "utils/log/types.h"
 
 #include <cstdio>
 #include <sstream>
 
+#include <time.h> /* timespec */
+
+/**
+ * \brief Writes a log message if its level is output.
+ *
+ * Unlike Log().Get(level), neither a Log object nor the message will be
+ * constructed if the level is filtered out. Levels below
+ * LOG_COMPILED_MIN_LEVEL (see configuration.h) are removed by the
+ * compiler. Usage:
+ * \code
+ * EASYFPGA_LOG(DEBUG) << "Received " << count << " bytes.";
+ * \endcode
+ */
+#define EASYFPGA_LOG(level) \
+    if (!Log::isEnabled(level)) {} else Log().Get(level)
+
 /**
  * \brief Defines a class which is constructed at every debugging output to
  *        standard in-/output.
  *
- * To set the outputted log level you have to modify the LogLevel constant
- * MIN_LOG_LEVEL_OUTPUT in your configuration.h.
+ * To set the outputted log level you have to modify the option
+ * MIN_LOG_LEVEL_OUTPUT in your project.conf. Prefer the macro
+ * EASYFPGA_LOG() for writing messages.
  */
 class Log {
     public:
@@ -59,6 +77,52 @@ class Log {
          */
         static std::string toString(LogLevel level);
 
+        /**
+         * \brief Returns true if messages of the given level are output.
+         */
+        static inline bool isEnabled(LogLevel level)
+        {
+            return (level >= LOG_COMPILED_MIN_LEVEL) && (level >= getMinimumOutputLevel());
+        }
+
+        /**
+         * \brief Returns the minimum level of output messages. It is
+         *        read from the configuration file once.
+         */
+        static LogLevel getMinimumOutputLevel(void);
+
+        /**
+         * \brief Overrides the minimum level of output messages from the
+         *        configuration file.
+         */
+        static void setMinimumOutputLevel(LogLevel level);
+
+        /**
+         * \brief Redirects the log messages, e.g. into a file.
+         *
+         * \param target An opened file which remains open as long as
+         *        log messages are written.
+         */
+        static void setOutputTarget(FILE* target);
+
+        /**
+         * \brief Returns the file the log messages are written to.
+         */
+        static FILE* getOutputTarget(void);
+
+        /**
+         * \brief Decides whether the messages are written by the
+         *        AsyncLogSink (overrides the option LOG_ASYNC from the
+         *        configuration file).
+         */
+        static void setAsyncOutput(bool enabled);
+
+        /**
+         * \brief Returns true if the messages are written by the
+         *        AsyncLogSink.
+         */
+        static bool isAsyncOutput(void);
+
     private:
         /**
          * A private copy constructor for access protection issues.
@@ -81,9 +145,12 @@ class Log {
          */
         LogLevel _messageLevel;
 
-        FILE* const _LOG_OUTPUT_TARGET;
-
-        const LogLevel _LOG_MIN_OUTPUT_LEVEL;
+        /**
+         * The time of the message if it is written asynchronously. The
+         * AsyncLogSink formats it.
+         */
+        struct timespec _time;
+        bool _async;
 };
 
 #endif  // SDK_UTILS_LOG_LOG_H_
@@ -0,0 +1,171 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/utils/log/asynclogsink.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <chrono>
+#include <cstdio> /* fopen(), fclose(), remove(1) */
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const std::string LOG_FILE("/tmp/easyfpga-async-log-test.log");
+
+static const uint32_t PRODUCER_THREADS = 4;
+static const uint32_t MESSAGES_PER_THREAD = 20000;
+
+/**
+ * \brief Tests the asynchronous log output
+ *
+ * Several threads log into a file at the same time, once synchronously
+ * and once by the AsyncLogSink. Every message has to be either written
+ * completely or counted as dropped, and the messages of one thread have
+ * to keep their order.
+ */
+class AsyncLogTest : public Tester
+{
+    std::string testName(void) {
+        return "async log test";
+    }
+
+    static void produce(uint32_t thread, double* nanoseconds) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i=0; i<MESSAGES_PER_THREAD; i++) {
+            EASYFPGA_LOG(INFO) << "thread " << thread << " message " << i;
+        }
+        *nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+            / MESSAGES_PER_THREAD;
+    }
+
+    /*
+     * Lets all threads log into the file and returns the average time
+     * of a log statement.
+     */
+    static double logConcurrently(bool async) {
+        FILE* file = fopen(LOG_FILE.c_str(), "w");
+        Log::setOutputTarget(file);
+        Log::setAsyncOutput(async);
+
+        std::vector<std::thread> threads;
+        std::vector<double> nanoseconds(PRODUCER_THREADS);
+        for (uint32_t t=0; t<PRODUCER_THREADS; t++) {
+            threads.push_back(std::thread(&AsyncLogTest::produce, t, &nanoseconds[t]));
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        /* flushes the sink */
+        Log::setAsyncOutput(false);
+        Log::setOutputTarget(stdout);
+        fclose(file);
+
+        double average = 0.0;
+        for (double value : nanoseconds) {
+            average += value / PRODUCER_THREADS;
+        }
+        return average;
+    }
+
+    /*
+     * Checks the order of the messages in the file and counts them.
+     */
+    static bool readLogFile(uint64_t* messages, bool* dropReported) {
+        std::vector<int64_t> lastMessage(PRODUCER_THREADS, -1);
+        *messages = 0;
+        *dropReported = false;
+
+        std::ifstream file(LOG_FILE);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.find("dropped") != std::string::npos) {
+                *dropReported = true;
+                continue;
+            }
+
+            uint32_t thread;
+            int64_t message;
+            size_t position = line.find("thread ");
+            if ((position == std::string::npos) ||
+                (sscanf(line.c_str() + position, "thread %u message %ld", &thread, &message) != 2) ||
+                (thread >= PRODUCER_THREADS) || (message <= lastMessage[thread])) {
+                Log().Get(ERROR) << "Unexpected line: " << line;
+                return false;
+            }
+
+            lastMessage[thread] = message;
+            (*messages)++;
+        }
+        return true;
+    }
+
+    bool testMethod(void) {
+        Log::setMinimumOutputLevel(DEBUG);
+        uint64_t total = PRODUCER_THREADS * MESSAGES_PER_THREAD;
+        uint64_t messages;
+        bool dropReported;
+
+        double synchronous = logConcurrently(false);
+        if (!readLogFile(&messages, &dropReported) || (messages != total)) {
+            Log().Get(ERROR) << "The synchronous output contains " << messages << " of " << total << " messages!";
+            return false;
+        }
+
+        AsyncLogSink& sink = AsyncLogSink::getInstance();
+        uint64_t droppedBefore = sink.getNumberOfDroppedMessages();
+        uint64_t writtenBefore = sink.getNumberOfWrittenMessages();
+
+        double asynchronous = logConcurrently(true);
+        uint64_t dropped = sink.getNumberOfDroppedMessages() - droppedBefore;
+        uint64_t written = sink.getNumberOfWrittenMessages() - writtenBefore;
+
+        Log().Get(INFO) << "synchronous: " << synchronous << " ns, asynchronous: " << asynchronous
+            << " ns per message (" << written << " written, " << dropped << " dropped)";
+
+        if (!readLogFile(&messages, &dropReported)) {
+            return false;
+        }
+
+        if ((messages != written) || (written + dropped != total)) {
+            Log().Get(ERROR) << "The asynchronous output contains " << messages << " messages, "
+                << written << " written and " << dropped << " dropped of " << total << "!";
+            return false;
+        }
+
+        if (dropReported != (dropped > 0)) {
+            Log().Get(ERROR) << "The dropped messages weren't reported correctly!";
+            return false;
+        }
+
+        std::remove(LOG_FILE.c_str());
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    AsyncLogTest test;
+    return (uint32_t)test.runTest();
+}
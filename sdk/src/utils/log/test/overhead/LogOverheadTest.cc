@@ -0,0 +1,132 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/communicator.h"
+#include "easyfpga/simulator/boardsimulator.h"
+#include "easyfpga/simulator/cores/simulatedregisterfile.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <chrono>
+#include <cstdio> /* fopen(), fclose() */
+#include <memory>
+#include <string>
+
+static const uint32_t FILTERED_MESSAGES = 1000000;
+static const uint32_t REGISTER_OPERATIONS = 2000;
+
+/**
+ * \brief Measures the costs of filtered log messages
+ *
+ * The test needs no easyFPGA. First, filtered debug messages are
+ * written with the EASYFPGA_LOG() macro and with a Log object. Second,
+ * register writes and reads are executed on a simulated soc while all
+ * debug messages are output (into /dev/null) and while they are
+ * filtered.
+ */
+class LogOverheadTest : public Tester
+{
+    std::string testName(void) {
+        return "log overhead test";
+    }
+
+    bool accessRegisters(Communicator& com, double* operationsPerSecond) {
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i=0; i<REGISTER_OPERATIONS; i+=2) {
+            byte value = 0x00;
+            if (!com.writeRegister((byte)i, 1, (byte)(i>>1)) || !com.readRegister(&value, 1, (byte)(i>>1)) || (value != (byte)i)) {
+                return false;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        *operationsPerSecond = REGISTER_OPERATIONS / seconds;
+        return true;
+    }
+
+    bool testMethod(void) {
+        LogLevel configuredLevel = Log::getMinimumOutputLevel();
+        Log::setMinimumOutputLevel(INFO);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i=0; i<FILTERED_MESSAGES; i++) {
+            EASYFPGA_LOG(DEBUG) << "Filtered message " << i;
+        }
+        double macroSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i=0; i<FILTERED_MESSAGES; i++) {
+            Log().Get(DEBUG) << "Filtered message " << i;
+        }
+        double objectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Log().Get(INFO) << "filtered message: " << macroSeconds * 1e9 / FILTERED_MESSAGES << " ns with EASYFPGA_LOG(), "
+            << objectSeconds * 1e9 / FILTERED_MESSAGES << " ns with Log().Get()";
+
+        bool success = (macroSeconds < objectSeconds);
+        if (!success) {
+            Log().Get(ERROR) << "Filtering by EASYFPGA_LOG() isn't faster!";
+        }
+
+        BoardSimulator board;
+        board.addCore(1, std::make_shared<SimulatedRegisterFile>());
+        board.startSoc();
+        if (!board.start()) {
+            return false;
+        }
+
+        Communicator com(nullptr);
+        if (!com.initWithDevice(board.getDevice())) {
+            Log().Get(ERROR) << "Couldn't connect to the simulated soc!";
+            Log::setMinimumOutputLevel(configuredLevel);
+            return false;
+        }
+
+        double loggingOn = 0.0;
+        double loggingOff = 0.0;
+
+        FILE* devNull = fopen("/dev/null", "w");
+        Log::setOutputTarget(devNull);
+        Log::setMinimumOutputLevel(DEBUG);
+        success &= this->accessRegisters(com, &loggingOn);
+        Log::setOutputTarget(stdout);
+        fclose(devNull);
+
+        Log::setMinimumOutputLevel(INFO);
+        success &= this->accessRegisters(com, &loggingOff);
+
+        Log().Get(INFO) << "register operations: " << (uint32_t)loggingOn << " ops/s with debug output, "
+            << (uint32_t)loggingOff << " ops/s without";
+
+        Log::setMinimumOutputLevel(configuredLevel);
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    LogOverheadTest test;
+    return (uint32_t)test.runTest();
+}
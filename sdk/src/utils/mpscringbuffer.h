@@ -0,0 +1,160 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef SDK_UTILS_MPSCRINGBUFFER_H_
+#define SDK_UTILS_MPSCRINGBUFFER_H_
+
+#include "configuration.h" /* assert() */
+
+#include <atomic>
+#include <cstddef> /* NULL */
+#include <cstdint> /* special ints and there min- and max-macros */
+
+/**
+ * \brief Bounded lock-free queue for any number of producer threads and
+ *        exactly one consumer thread.
+ *
+ * Every slot carries a sequence number telling whether it may be
+ * written or read in the current round (the algorithm of D. Vyukov's
+ * bounded queue). Producers reserve a slot by a compare-and-swap on the
+ * enqueue index, so push() never blocks: it fails if the queue is full.
+ *
+ * The capacity will be rounded up to the next power of two. T has to be
+ * trivially copyable.
+ */
+template <typename T>
+class MpscRingBuffer
+{
+    public:
+        /**
+         * \brief Creates a queue holding at least the given number of
+         *        elements.
+         */
+        MpscRingBuffer(uint32_t capacity) :
+            _capacity(1),
+            _enqueuePosition(0),
+            _dequeuePosition(0)
+        {
+            assert(capacity > 0);
+            while (_capacity < capacity) {
+                _capacity <<= 1;
+            }
+            _mask = _capacity - 1;
+            _slots = new Slot[_capacity];
+            for (uint32_t i=0; i<_capacity; i++) {
+                _slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~MpscRingBuffer()
+        {
+            delete[] _slots;
+            _slots = NULL;
+        }
+
+        MpscRingBuffer(const MpscRingBuffer&) = delete;
+        MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+        /**
+         * \brief Returns the maximum number of stored elements.
+         */
+        uint32_t getCapacity(void) const
+        {
+            return _capacity;
+        }
+
+        /**
+         * \brief Appends an element. (Any thread)
+         *
+         * \return true if the element was appended,<br>
+         *         false if the queue is full
+         */
+        bool push(const T& item)
+        {
+            uint32_t position = _enqueuePosition.load(std::memory_order_relaxed);
+            Slot* slot;
+
+            while (true) {
+                slot = &_slots[position & _mask];
+                uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+                int32_t difference = (int32_t)(sequence - position);
+
+                if (difference == 0) {
+                    if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = _enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->item = item;
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * \brief Takes the oldest element out of the queue.
+         *        (Consumer only)
+         *
+         * \return true if an element was copied to item,<br>
+         *         false if the queue is empty (or the oldest element
+         *         isn't completely written yet)
+         */
+        bool pop(T* item)
+        {
+            Slot* slot = &_slots[_dequeuePosition & _mask];
+            uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+            if (sequence != _dequeuePosition + 1) {
+                return false;
+            }
+
+            *item = slot->item;
+            slot->sequence.store(_dequeuePosition + _capacity, std::memory_order_release);
+            _dequeuePosition++;
+            return true;
+        }
+
+    private:
+        struct Slot {
+            std::atomic<uint32_t> sequence;
+            T item;
+        };
+
+        Slot* _slots;
+        uint32_t _capacity;
+        uint32_t _mask;
+
+        /* producer and consumer indices on separate cache lines */
+        char _padding1[64];
+        std::atomic<uint32_t> _enqueuePosition;
+        char _padding2[64 - sizeof(std::atomic<uint32_t>)];
+        uint32_t _dequeuePosition;
+};
+
+#endif  // SDK_UTILS_MPSCRINGBUFFER_H_
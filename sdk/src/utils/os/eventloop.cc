@@ -0,0 +1,209 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "configuration.h" /* assert() */
+#include "utils/log/log.h"
+#include "utils/os/eventloop.h"
+
+#include <cerrno>
+#include <cstring> /* strerror(1) */
+
+#include <sys/epoll.h> /* epoll_create1(), epoll_ctl(), epoll_wait() */
+#include <sys/eventfd.h> /* eventfd() */
+#include <unistd.h> /* read(), write(), close() */
+
+/* maximum number of events fetched by one epoll_wait() call */
+static const int32_t MAX_EVENTS_PER_WAIT = 16;
+
+EventLoop::EventLoop() :
+    _epollFd(epoll_create1(EPOLL_CLOEXEC)),
+    _wakeUpFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+    _stopRequested(false)
+{
+    if ((_epollFd < 0) || (_wakeUpFd < 0)) {
+        EASYFPGA_LOG(ERROR) << "Creating the event loop failed: " << strerror(errno);
+        return;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = _wakeUpFd;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeUpFd, &event) != 0) {
+        EASYFPGA_LOG(ERROR) << "Registering the wakeup descriptor failed: " << strerror(errno);
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    if (_wakeUpFd >= 0) {
+        close(_wakeUpFd);
+    }
+    if (_epollFd >= 0) {
+        close(_epollFd);
+    }
+}
+
+bool EventLoop::isValid(void)
+{
+    return ((_epollFd >= 0) && (_wakeUpFd >= 0));
+}
+
+bool EventLoop::add(int fd, Handler handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(_handlerMutex);
+        _handlers[fd] = handler;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        EASYFPGA_LOG(ERROR) << "Adding descriptor " << fd << " to the event loop failed: " << strerror(errno);
+
+        std::lock_guard<std::mutex> lock(_handlerMutex);
+        _handlers.erase(fd);
+        return false;
+    }
+
+    return true;
+}
+
+bool EventLoop::remove(int fd)
+{
+    /* locked, so that a concurrent resume() can't watch fd again */
+    std::lock_guard<std::mutex> lock(_handlerMutex);
+
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+    return (_handlers.erase(fd) > 0);
+}
+
+void EventLoop::suspend(int fd)
+{
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+bool EventLoop::resume(int fd)
+{
+    std::lock_guard<std::mutex> lock(_handlerMutex);
+    if (_handlers.find(fd) == _handlers.end()) {
+        return false;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        EASYFPGA_LOG(ERROR) << "Resuming descriptor " << fd << " in the event loop failed: " << strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+int EventLoop::getFileDescriptor(void)
+{
+    return _epollFd;
+}
+
+int32_t EventLoop::runOnce(int32_t timeoutus)
+{
+    std::unique_lock<std::mutex> runLock(_runMutex, std::try_to_lock);
+    if (!runLock.owns_lock()) {
+        return -1;
+    }
+
+    return this->dispatch(timeoutus);
+}
+
+void EventLoop::run(void)
+{
+    std::lock_guard<std::mutex> runLock(_runMutex);
+
+    while (!_stopRequested) {
+        if (this->dispatch(-1) < 0) {
+            break;
+        }
+    }
+
+    /* a following run() call starts again */
+    _stopRequested = false;
+}
+
+int32_t EventLoop::dispatch(int32_t timeoutus)
+{
+    /* epoll only knows ms: round up, so that short timeouts don't spin */
+    int timeoutms = (timeoutus < 0) ? -1 : (timeoutus + 999) / 1000;
+
+    epoll_event events[MAX_EVENTS_PER_WAIT];
+    returnval count = epoll_wait(_epollFd, events, MAX_EVENTS_PER_WAIT, timeoutms);
+
+    if (count < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        EASYFPGA_LOG(ERROR) << "Error while epoll_wait() call: " << strerror(errno);
+        return -1;
+    }
+
+    int32_t dispatched = 0;
+    for (returnval i=0; i<count; i++) {
+        int fd = events[i].data.fd;
+
+        if (fd == _wakeUpFd) {
+            uint64_t counter;
+            while (read(_wakeUpFd, &counter, sizeof(counter)) > 0) {}
+            continue;
+        }
+
+        Handler handler;
+        {
+            std::lock_guard<std::mutex> lock(_handlerMutex);
+            auto it = _handlers.find(fd);
+            if (it == _handlers.end()) {
+                continue;
+            }
+            handler = it->second;
+        }
+
+        handler(events[i].events);
+        dispatched++;
+    }
+
+    return dispatched;
+}
+
+void EventLoop::stop(void)
+{
+    _stopRequested = true;
+    this->wakeUp();
+}
+
+void EventLoop::wakeUp(void)
+{
+    uint64_t one = 1;
+    if (write(_wakeUpFd, &one, sizeof(one)) < 0) {
+        EASYFPGA_LOG(WARNING) << "Waking up the event loop failed: " << strerror(errno);
+    }
+}
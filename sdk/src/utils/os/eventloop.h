@@ -0,0 +1,167 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_UTILS_OS_EVENTLOOP_H_
+#define SDK_UTILS_OS_EVENTLOOP_H_
+
+#include "utils/os/types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+/**
+ * \brief Waits on several file descriptors at once and calls a handler
+ *        for each readable one (epoll backend).
+ *
+ * Each SerialConnection registers its device with an event loop. By
+ * default every connection owns a private loop, but several connections
+ * (e.g. to different boards) can share one loop, so that a single
+ * thread waits for all of them.
+ *
+ * The loop can be driven in three ways:
+ * - run() blocks until stop() is called (e.g. in a dedicated thread),
+ * - runOnce() waits once and dispatches all pending events, or
+ * - an application integrates the loop into its own poll loop: the
+ *   descriptor returned by getFileDescriptor() becomes readable as soon
+ *   as any registered descriptor is readable. Then runOnce(0) has to be
+ *   called.
+ *
+ * Only one thread can drive the loop at the same time. A concurrent
+ * call of runOnce() returns -1 immediately.
+ */
+class EventLoop
+{
+    public:
+        /**
+         * \brief Called with the epoll events (EPOLLIN, EPOLLERR, ...)
+         *        of a readable file descriptor.
+         */
+        typedef std::function<void(uint32_t events)> Handler;
+
+        EventLoop();
+        ~EventLoop();
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        /**
+         * \brief Checks whether the epoll and the wakeup descriptors
+         *        could be created.
+         */
+        bool isValid(void);
+
+        /**
+         * \brief Watches a file descriptor for readability.
+         *
+         * \param fd The descriptor to watch.
+         *
+         * \param handler Called by the thread driving the loop every
+         *        time fd becomes readable.
+         *
+         * \return true if the descriptor could be registered,<br>
+         *         false otherwise
+         */
+        bool add(int fd, Handler handler);
+
+        /**
+         * \brief Stops watching a file descriptor.
+         *
+         * \return true if the descriptor was registered,<br>
+         *         false otherwise
+         */
+        bool remove(int fd);
+
+        /**
+         * \brief Stops watching a registered file descriptor, but keeps
+         *        its handler for resume().
+         *
+         * A handler which can't consume the readable data, e.g. because
+         * its buffer is full, has to suspend its descriptor. Otherwise
+         * the level-triggered descriptor would be reported again
+         * immediately and the loop would spin.
+         */
+        void suspend(int fd);
+
+        /**
+         * \brief Watches a suspended file descriptor again.
+         *
+         * \return true if the descriptor is watched again,<br>
+         *         false if it was removed in the meantime or an error
+         *         occured
+         */
+        bool resume(int fd);
+
+        /**
+         * \brief Returns the epoll descriptor for integrating this loop
+         *        into an application's own poll loop.
+         */
+        int getFileDescriptor(void);
+
+        /**
+         * \brief Waits for events and dispatches them to their handlers.
+         *
+         * \param timeoutus Maximum waiting time in us. 0 returns
+         *        immediately, a negative value waits infinitely.
+         *
+         * \return The number of dispatched events (0 at timeout),<br>
+         *         -1 if another thread drives the loop or an error
+         *         occured
+         */
+        int32_t runOnce(int32_t timeoutus);
+
+        /**
+         * \brief Dispatches events until stop() will be called.
+         */
+        void run(void);
+
+        /**
+         * \brief Lets run() return. Can be called by any thread.
+         */
+        void stop(void);
+
+        /**
+         * \brief Interrupts a waiting runOnce() or run() call.
+         *        Can be called by any thread.
+         */
+        void wakeUp(void);
+
+    private:
+        /**
+         * Waits once and calls the handlers. The caller has to hold
+         * _runMutex.
+         */
+        int32_t dispatch(int32_t timeoutus);
+
+        returnval _epollFd;
+        returnval _wakeUpFd;
+
+        std::mutex _runMutex;
+        std::atomic<bool> _stopRequested;
+
+        std::mutex _handlerMutex;
+        std::map<int, Handler> _handlers;
+};
+
+#endif  // SDK_UTILS_OS_EVENTLOOP_H_
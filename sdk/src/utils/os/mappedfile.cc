@@ -0,0 +1,112 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "utils/log/log.h"
+#include "utils/os/mappedfile.h"
+
+#include <cerrno>
+#include <cstdlib> /* getenv(1) */
+#include <cstring> /* strerror(1) */
+
+#include <fcntl.h> /* open() */
+#include <sys/mman.h> /* mmap(), munmap(), madvise() */
+#include <sys/stat.h> /* fstat() */
+#include <unistd.h> /* close() */
+
+MappedFile::MappedFile(std::string fileName) :
+    _fileName(fileName),
+    _data(NULL),
+    _size(0)
+{
+    if (!_fileName.empty() && (_fileName[0] == '~')) {
+        const char* home = getenv("HOME");
+        if (home != NULL) {
+            _fileName = std::string(home) + _fileName.substr(1);
+        }
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    this->unmap();
+}
+
+bool MappedFile::map(void)
+{
+    this->unmap();
+
+    int fd = open(_fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        EASYFPGA_LOG(ERROR) << "Opening " << _fileName << " failed: " << strerror(errno);
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        EASYFPGA_LOG(ERROR) << "Determining the size of " << _fileName << " failed: " << strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    /* mmap() rejects a length of 0 */
+    if (fileStat.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    /* the mapping stays valid without the descriptor */
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        EASYFPGA_LOG(ERROR) << "Mapping " << _fileName << " failed: " << strerror(errno);
+        return false;
+    }
+
+    /* the file will be read from the beginning to the end */
+    madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+
+    _data = data;
+    _size = fileStat.st_size;
+
+    return true;
+}
+
+const byte* MappedFile::getData(void)
+{
+    return (const byte*)_data;
+}
+
+uint64_t MappedFile::getSize(void)
+{
+    return _size;
+}
+
+void MappedFile::unmap(void)
+{
+    if (_data != NULL) {
+        munmap(_data, _size);
+        _data = NULL;
+    }
+    _size = 0;
+}
@@ -0,0 +1,81 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_UTILS_OS_MAPPEDFILE_H_
+#define SDK_UTILS_OS_MAPPEDFILE_H_
+
+#include "utils/hardwaretypes.h"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief Read-only view of a file mapped into memory
+ *
+ * Large files (e.g. fpga binaries) can be processed without copying
+ * them onto the stack or the heap. The mapping will be removed when the
+ * object is destroyed.
+ */
+class MappedFile
+{
+    public:
+        /**
+         * \brief Create a mapping helper object. The file will be mapped
+         *        by map().
+         *
+         * \param fileName A relative or absolute path to a file.
+         *        (~ will be resolved to the home directory.)
+         */
+        MappedFile(std::string fileName);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * \brief Maps the whole file into memory.
+         *
+         * \return true if the file could be mapped or is empty,<br>
+         *         false otherwise (e.g. the file doesn't exist)
+         */
+        bool map(void);
+
+        /**
+         * \brief Returns the file's content or NULL if it isn't mapped
+         *        or empty.
+         */
+        const byte* getData(void);
+
+        /**
+         * \brief Returns the file size in bytes.
+         */
+        uint64_t getSize(void);
+
+    private:
+        void unmap(void);
+
+        std::string _fileName;
+        void* _data;
+        uint64_t _size;
+};
+
+#endif  // SDK_UTILS_OS_MAPPEDFILE_H_
@@ -0,0 +1,283 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "easyfpga/communication/serialconnection.h"
+#include "easyfpga/configuration.h"
+#include "easyfpga/utils/hardwaretypes.h"
+#include "easyfpga/utils/log/log.h"
+#include "easyfpga/utils/os/eventloop.h"
+#include "easyfpga/utils/os/time_helper.h"
+#include "easyfpga/utils/unittest/tester.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h> /* posix_openpt() */
+#include <poll.h> /* poll() */
+#include <stdlib.h> /* grantpt(), unlockpt(), ptsname() */
+#include <termios.h>
+#include <unistd.h> /* read(), write(), close() */
+
+/**
+ * \brief Tests the EventLoop and its use by SerialConnection
+ *
+ * The test needs no easyFPGA. Two pseudo terminals act as two boards,
+ * which answer every request byte b with the 4 byte reply
+ * {0x88, b, b, parity}. Both connections share one event loop, which is
+ * driven
+ * - by an application thread calling EventLoop::run(), as well as
+ * - by the connections themselves while they are receiving.
+ * Furthermore the exposed epoll descriptor has to become readable by
+ * EventLoop::wakeUp(), so that the loop can be embedded into a poll()
+ * based main loop. A connection whose receive ring is full mustn't keep
+ * the loop busy.
+ */
+class EventLoopTest : public Tester
+{
+    std::string testName(void) {
+        return "event loop test";
+    }
+
+    /**
+     * A pseudo terminal answering register read like requests.
+     */
+    struct PseudoBoard {
+        int master;
+        std::string device;
+        std::thread thread;
+    };
+
+    static void answerRequests(int master, std::atomic<bool>* running) {
+        byte requests[256];
+        byte replies[4*256];
+
+        while (*running) {
+            struct pollfd pfd;
+            pfd.fd = master;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if ((poll(&pfd, 1, 10) > 0) && (pfd.revents & POLLIN)) {
+                ssize_t count = read(master, requests, sizeof(requests));
+                for (ssize_t i=0; i<count; i++) {
+                    replies[4*i+0] = 0x88;
+                    replies[4*i+1] = requests[i];
+                    replies[4*i+2] = requests[i];
+                    replies[4*i+3] = 0x88;
+                }
+
+                ssize_t written = 0;
+                while (written < 4*count) {
+                    ssize_t n = write(master, replies+written, 4*count-written);
+                    if (n > 0) {
+                        written += n;
+                    }
+                }
+            }
+        }
+    }
+
+    bool startBoard(PseudoBoard* board, std::atomic<bool>* running) {
+        board->master = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((board->master < 0) || (grantpt(board->master) != 0) || (unlockpt(board->master) != 0)) {
+            Log().Get(ERROR) << "Couldn't create a pseudo terminal!";
+            return false;
+        }
+
+        struct termios tio;
+        tcgetattr(board->master, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(board->master, TCSANOW, &tio);
+
+        board->device = ptsname(board->master);
+        board->thread = std::thread(answerRequests, board->master, running);
+        return true;
+    }
+
+    bool isReadable(int fd) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        return ((poll(&pfd, 1, 0) > 0) && (pfd.revents & POLLIN));
+    }
+
+    bool testExposedDescriptor(EventLoop& loop) {
+        int fd = loop.getFileDescriptor();
+
+        if (this->isReadable(fd)) {
+            Log().Get(ERROR) << "An idle event loop mustn't be readable!";
+            return false;
+        }
+
+        loop.wakeUp();
+        if (!this->isReadable(fd)) {
+            Log().Get(ERROR) << "A woken up event loop has to be readable!";
+            return false;
+        }
+
+        /* the wakeup isn't a handler event and has to be consumed */
+        if ((loop.runOnce(0) != 0) || this->isReadable(fd)) {
+            Log().Get(ERROR) << "The wakeup event wasn't consumed!";
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Sends requests over both connections alternately and checks the
+     * replies.
+     */
+    bool exchange(SerialConnection* connections, uint32_t count) {
+        for (uint32_t i=0; i<count; i++) {
+            for (uint32_t c=0; c<2; c++) {
+                byte request = (byte)(i + c);
+                byte reply[4];
+
+                if (!connections[c].send(&request, 1) || !connections[c].receive(reply, 4, 1000000)) {
+                    return false;
+                }
+
+                if ((reply[0] != 0x88) || (reply[1] != request)) {
+                    Log().Get(ERROR) << "Unexpected reply from board " << c << "!";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Lets the replies overflow the receive ring of a connection while
+     * nobody receives: the loop has to become idle although the device
+     * is still readable, and receiving has to resume reading it.
+     */
+    bool testFullRing(EventLoop& loop, SerialConnection& connection) {
+        std::vector<byte> requests(SERIAL_RECEIVE_RING_SIZE/4 + 256);
+        for (uint32_t i=0; i<requests.size(); i++) {
+            requests[i] = (byte)i;
+        }
+
+        /* a driver is needed while sending, otherwise the board would block */
+        std::thread driver(&EventLoop::run, &loop);
+        bool sent = connection.send(requests.data(), requests.size());
+
+        timevalue timeout = getMonotonicTimeInNanos() + 2000000000;
+        while (sent && (connection.getReceiveQueueSize() < (int32_t)(4*requests.size())) &&
+               (getMonotonicTimeInNanos() < timeout)) {
+            usleep(1000);
+        }
+
+        loop.stop();
+        driver.join();
+
+        if (!sent || (connection.getReceiveQueueSize() < (int32_t)(4*requests.size()))) {
+            Log().Get(ERROR) << "The replies didn't arrive!";
+            return false;
+        }
+
+        /* the device is still readable, but mustn't be dispatched any more */
+        if (loop.runOnce(10000) != 0) {
+            Log().Get(ERROR) << "The loop keeps dispatching a device whose receive ring is full!";
+            return false;
+        }
+
+        std::vector<byte> replies(4*requests.size());
+        if (!connection.receive(replies.data(), replies.size(), 1000000)) {
+            Log().Get(ERROR) << "The device wasn't read again after the ring was full!";
+            return false;
+        }
+
+        for (uint32_t i=0; i<requests.size(); i++) {
+            if ((replies[4*i] != 0x88) || (replies[4*i+1] != requests[i])) {
+                Log().Get(ERROR) << "Unexpected reply " << i << " after the ring was full!";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool testMethod(void) {
+        std::atomic<bool> running(true);
+        PseudoBoard boards[2];
+
+        if (!this->startBoard(&boards[0], &running) || !this->startBoard(&boards[1], &running)) {
+            running = false;
+            return false;
+        }
+
+        eventloop_ptr loop = std::make_shared<EventLoop>();
+        bool success = loop->isValid() && this->testExposedDescriptor(*loop);
+
+        SerialConnection connections[2];
+        for (uint32_t c=0; c<2; c++) {
+            connections[c].setEventLoop(loop);
+            success &= connections[c].openDevice(boards[c].device);
+            success &= (connections[c].getEventLoop() == loop);
+        }
+
+        if (success) {
+            Log().Get(INFO) << "Connections drive the shared loop by themselves...";
+            success &= this->exchange(connections, 1000);
+        }
+
+        if (success) {
+            Log().Get(INFO) << "An application thread drives the shared loop...";
+            std::thread driver(&EventLoop::run, loop.get());
+            success &= this->exchange(connections, 1000);
+            loop->stop();
+            driver.join();
+        }
+
+        if (success) {
+            Log().Get(INFO) << "A full receive ring suspends the device...";
+            success &= this->testFullRing(*loop, connections[0]);
+        }
+
+        for (uint32_t c=0; c<2; c++) {
+            connections[c].closeDevice();
+        }
+
+        running = false;
+        for (uint32_t c=0; c<2; c++) {
+            if (boards[c].thread.joinable()) {
+                boards[c].thread.join();
+            }
+            close(boards[c].master);
+        }
+
+        return success;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    EventLoopTest test;
+    return (uint32_t)test.runTest();
+}
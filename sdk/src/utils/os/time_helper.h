@@ -55,27 +55,67 @@ inline timevalue getCurrentTimeInMillis(void) {
 }
 
 /**
- * \brief Return an formatted time string.
+ * \brief Determines the current unix timestamp in nanoseconds.
  *
- * \return A string with format "HH:MM:SS"
+ * \return A unix timestamp
  */
-inline std::string getCurrentTimeString(void) {
+inline timevalue getCurrentTimeInNanos(void) {
     struct timespec ts;
     if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
-        /*
-         * struct tm contains all possible time values
-         * (seconds, hour, day, year, timezone ...)
-         */
-        tm r;
+        return (timevalue)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+    else {
+        return -1;
+    }
+}
+
+/**
+ * \brief Determines a time in nanoseconds which isn't affected by
+ *        changes of the system time. Use it for measuring durations.
+ *
+ * \return Nanoseconds since an unspecified point in time
+ */
+inline timevalue getMonotonicTimeInNanos(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return (timevalue)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+    else {
+        return -1;
+    }
+}
 
-        /* mapping timestamp to tm */
-        localtime_r(&ts.tv_sec, &r);
+/**
+ * \brief Return an formatted time string of a unix timestamp.
+ *
+ * \return A string with format "HH:MM:SS"
+ */
+inline std::string getTimeString(time_t seconds) {
+    /*
+     * struct tm contains all possible time values
+     * (seconds, hour, day, year, timezone ...)
+     */
+    tm r;
+
+    /* mapping timestamp to tm */
+    localtime_r(&seconds, &r);
 
-        char buffer[50];
-        /* specifier "%X" correspond to time format "14:55:02" */
-        strftime(buffer, sizeof(buffer), "%X", &r);
+    char buffer[50];
+    /* specifier "%X" correspond to time format "14:55:02" */
+    strftime(buffer, sizeof(buffer), "%X", &r);
+
+    return buffer;
+}
 
-        return buffer;
+/**
+ * \brief Return an formatted time string.
+ *
+ * \return A string with format "HH:MM:SS"
+ */
+inline std::string getCurrentTimeString(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
+        return getTimeString(ts.tv_sec);
     }
     else {
         return "";
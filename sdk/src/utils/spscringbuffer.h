@@ -0,0 +1,202 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SDK_UTILS_SPSCRINGBUFFER_H_
+#define SDK_UTILS_SPSCRINGBUFFER_H_
+
+#include "configuration.h" /* assert() */
+
+#include <atomic>
+#include <cstdint> /* special ints and there min- and max-macros */
+#include <cstring> /* memcpy(3) */
+
+/**
+ * \brief Lock-free ring buffer for exactly one producer and one consumer
+ *        thread.
+ *
+ * The producer appends elements with push() (or writes them directly
+ * into the memory returned by getWriteRegion() and publishes them with
+ * commitWrite()). The consumer takes them out with pop(). Both sides
+ * only synchronize over the two atomic indices, so neither has to take
+ * a lock or to call the operating system.
+ *
+ * The capacity will be rounded up to the next power of two. T has to be
+ * trivially copyable.
+ */
+template <typename T>
+class SpscRingBuffer
+{
+    public:
+        /**
+         * \brief Creates a ring buffer holding at least the given number
+         *        of elements.
+         */
+        SpscRingBuffer(uint32_t capacity) :
+            _capacity(1),
+            _head(0),
+            _tail(0)
+        {
+            assert(capacity > 0);
+            while (_capacity < capacity) {
+                _capacity <<= 1;
+            }
+            _mask = _capacity - 1;
+            _buffer = new T[_capacity];
+        }
+
+        ~SpscRingBuffer()
+        {
+            delete[] _buffer;
+            _buffer = NULL;
+        }
+
+        SpscRingBuffer(const SpscRingBuffer&) = delete;
+        SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+        /**
+         * \brief Returns the maximum number of stored elements.
+         */
+        uint32_t getCapacity(void) const
+        {
+            return _capacity;
+        }
+
+        /**
+         * \brief Returns the number of elements which can be popped.
+         *        (Exact for the consumer, a lower bound for all others.)
+         */
+        uint32_t getSize(void) const
+        {
+            return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+        }
+
+        /**
+         * \brief Checks whether no element can be popped.
+         */
+        bool isEmpty(void) const
+        {
+            return (this->getSize() == 0);
+        }
+
+        /**
+         * \brief Appends up to count elements. (Producer only)
+         *
+         * \return The number of appended elements which is less than
+         *         count if the buffer became full
+         */
+        uint32_t push(const T* items, uint32_t count)
+        {
+            uint32_t written = 0;
+
+            while (written < count) {
+                uint32_t region = 0;
+                T* target = this->getWriteRegion(&region);
+                if (region == 0) {
+                    break;
+                }
+                if (region > count - written) {
+                    region = count - written;
+                }
+                memcpy(target, items + written, region * sizeof(T));
+                this->commitWrite(region);
+                written += region;
+            }
+
+            return written;
+        }
+
+        /**
+         * \brief Returns the largest contiguous free memory region.
+         *        (Producer only)
+         *
+         * \param count Location for the number of elements which can be
+         *        written to the returned address.
+         */
+        T* getWriteRegion(uint32_t* count)
+        {
+            uint32_t tail = _tail.load(std::memory_order_relaxed);
+            uint32_t head = _head.load(std::memory_order_acquire);
+            uint32_t free = _capacity - (tail - head);
+            uint32_t untilEnd = _capacity - (tail & _mask);
+
+            *count = (free < untilEnd) ? free : untilEnd;
+            return _buffer + (tail & _mask);
+        }
+
+        /**
+         * \brief Publishes count elements written into the region
+         *        returned by getWriteRegion(). (Producer only)
+         */
+        void commitWrite(uint32_t count)
+        {
+            _tail.store(_tail.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+        }
+
+        /**
+         * \brief Takes up to count elements out of the buffer.
+         *        (Consumer only)
+         *
+         * \return The number of elements copied to items
+         */
+        uint32_t pop(T* items, uint32_t count)
+        {
+            uint32_t head = _head.load(std::memory_order_relaxed);
+            uint32_t available = _tail.load(std::memory_order_acquire) - head;
+            if (count > available) {
+                count = available;
+            }
+
+            uint32_t offset = head & _mask;
+            uint32_t untilEnd = _capacity - offset;
+            if (count <= untilEnd) {
+                memcpy(items, _buffer + offset, count * sizeof(T));
+            }
+            else {
+                memcpy(items, _buffer + offset, untilEnd * sizeof(T));
+                memcpy(items + untilEnd, _buffer, (count - untilEnd) * sizeof(T));
+            }
+
+            _head.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * \brief Drops all elements which can be popped. (Consumer only)
+         */
+        void clear(void)
+        {
+            _head.store(_tail.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+    private:
+        T* _buffer;
+        uint32_t _capacity;
+        uint32_t _mask;
+
+        /* producer and consumer indices on separate cache lines */
+        char _padding1[64];
+        std::atomic<uint32_t> _head;
+        char _padding2[64 - sizeof(std::atomic<uint32_t>)];
+        std::atomic<uint32_t> _tail;
+};
+
+#endif // SDK_UTILS_SPSCRINGBUFFER_H_
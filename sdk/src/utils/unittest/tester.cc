@@ -25,19 +25,19 @@
 
 bool Tester::runTest(void)
 {
-    Log().Get(INFO) << "START " << this->testName();
+    EASYFPGA_LOG(INFO) << "START " << this->testName();
     timevalue start = getCurrentTimeInMillis();
 
     bool success = this->testMethod();
 
     timevalue end = getCurrentTimeInMillis();
     if (success) {
-        Log().Get(INFO) << "TEST SUCCESSFUL";
+        EASYFPGA_LOG(INFO) << "TEST SUCCESSFUL";
     }
     else {
-        Log().Get(INFO) << "TEST FAILED";
+        EASYFPGA_LOG(INFO) << "TEST FAILED";
     }
-    Log().Get(INFO) << "Test has taken " << std::dec << (int32_t)(end-start) << "ms.";
+    EASYFPGA_LOG(INFO) << "Test has taken " << std::dec << (int32_t)(end-start) << "ms.";
 
     return !success;
 }
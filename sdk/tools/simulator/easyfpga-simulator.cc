@@ -0,0 +1,126 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+/*
+ * easyfpga-simulator: runs a simulated easyFPGA board behind a pseudo
+ * terminal until it is interrupted
+ *
+ * Usage: easyfpga-simulator [--soc] [--latency <us>] [--baudrate <baud>] <core>...
+ *
+ * The cores get the indices 1, 2, 3, ... in the given order, like the
+ * easyCores added in EasyFpga::defineStructure(). Possible cores are
+ * gpio8, uart, spi, i2c, can, pwm8, pwm16 and registers. With --soc,
+ * the fpga is already configured and a host talks to the soc directly.
+ */
+
+#include "simulator/boardsimulator.h"
+#include "simulator/cores/simulatedcan.h"
+#include "simulator/cores/simulatedgpio8.h"
+#include "simulator/cores/simulatedi2c.h"
+#include "simulator/cores/simulatedpwm.h"
+#include "simulator/cores/simulatedregisterfile.h"
+#include "simulator/cores/simulatedspi.h"
+#include "simulator/cores/simulateduart.h"
+
+#include <csignal> /* signal() */
+#include <cstdio> /* printf() */
+#include <cstdlib> /* strtoul() */
+#include <cstring> /* strcmp() */
+#include <memory>
+#include <string>
+
+#include <unistd.h> /* pause() */
+
+static void stopSimulation(int signal)
+{
+}
+
+static simulatedcore_ptr createCore(const std::string& name)
+{
+    if (name == "gpio8") return std::make_shared<SimulatedGpio8>();
+    if (name == "uart") return std::make_shared<SimulatedUart>();
+    if (name == "spi") return std::make_shared<SimulatedSpi>();
+    if (name == "i2c") return std::make_shared<SimulatedI2C>();
+    if (name == "can") return std::make_shared<SimulatedCan>();
+    if (name == "pwm8") return std::make_shared<SimulatedPwm>(8);
+    if (name == "pwm16") return std::make_shared<SimulatedPwm>(16);
+    if (name == "registers") return std::make_shared<SimulatedRegisterFile>();
+    return nullptr;
+}
+
+static int usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [--soc] [--latency <us>] [--baudrate <baud>] <core>...\n", program);
+    fprintf(stderr, "Cores: gpio8, uart, spi, i2c, can, pwm8, pwm16, registers\n");
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    BoardSimulator board;
+    uint32_t latency = 0;
+    uint32_t baudrate = 0;
+    CoreIndex index = 1;
+
+    for (int i=1; i<argc; i++) {
+        if (strcmp(argv[i], "--soc") == 0) {
+            board.startSoc();
+        }
+        else if ((strcmp(argv[i], "--latency") == 0) && (i+1 < argc)) {
+            latency = strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "--baudrate") == 0) && (i+1 < argc)) {
+            baudrate = strtoul(argv[++i], NULL, 10);
+        }
+        else {
+            simulatedcore_ptr core = createCore(argv[i]);
+            if (core == nullptr) {
+                return usage(argv[0]);
+            }
+            printf("core %d: %s\n", index, core->getName().c_str());
+            board.addCore(index++, core);
+        }
+    }
+
+    board.setLatency(latency, baudrate);
+    if (!board.start()) {
+        return 1;
+    }
+
+    signal(SIGINT, stopSimulation);
+    signal(SIGTERM, stopSimulation);
+
+    printf("Simulated easyFPGA listening at %s\n", board.getDevice().c_str());
+    fflush(stdout);
+    pause();
+
+    board.stop();
+
+    BoardSimulator::Statistics statistics = board.getStatistics();
+    printf("%llu requests, %llu register reads, %llu register writes, %llu written sectors, %llu interrupts, %llu NACKs\n",
+        (unsigned long long)statistics.requests, (unsigned long long)statistics.registerReads,
+        (unsigned long long)statistics.registerWrites, (unsigned long long)statistics.writtenSectors,
+        (unsigned long long)statistics.interrupts, (unsigned long long)statistics.nacks);
+
+    return 0;
+}
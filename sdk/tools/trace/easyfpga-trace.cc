@@ -0,0 +1,276 @@
+/*
+ *  This file is part of easyFPGA.
+ *  Copyright 2013-2015 os-cillation GmbH
+ *
+ *  Author: Johannes Hein <support@os-cillation.de>
+ *
+ *  easyFPGA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  easyFPGA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with easyFPGA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/*
+ * easyfpga-trace: decodes an exchange trace file (option
+ * EXCHANGE_TRACE_FILE in project.conf)
+ *
+ * Usage: easyfpga-trace [--dump] <trace file>
+ *
+ * Without --dump, the connections and the reply latency histograms of
+ * all exchange types are printed. With --dump, every record is printed
+ * in a line, starting with the id of its connection.
+ */
+
+#include "communication/exchangetrace.h"
+#include "communication/task.h"
+
+#include <algorithm> /* sort() */
+#include <cstdio> /* printf() */
+#include <cstring> /* strcmp() */
+#include <ctime> /* localtime_r(), strftime() */
+#include <map>
+#include <string>
+#include <vector>
+
+/* latency buckets: [0,1us), [1us,2us), [2us,4us), ..., [2^(n-2)us, inf) */
+static const uint32_t HISTOGRAM_BUCKETS = 24;
+
+static const uint32_t HISTOGRAM_BAR_WIDTH = 50;
+
+struct ExchangeStatistics {
+    std::vector<uint32_t> latencies;
+    uint64_t requests;
+    uint64_t retries;
+    uint64_t failures;
+
+    ExchangeStatistics() : requests(0), retries(0), failures(0) {}
+};
+
+static std::string getStatusName(uint8_t status)
+{
+    switch (status) {
+        case Task::RECEIVE_STATE::RECEIVE_SUCCESS: return "ok";
+        case Task::RECEIVE_STATE::RECEIVE_FAILURE: return "nack";
+        case Task::RECEIVE_STATE::RECEIVE_CHECKSUM_ERROR: return "parity error";
+        case Task::RECEIVE_STATE::RECEIVE_UNEXPECTED_OPCODE_ERROR: return "unexpected opcode";
+        case Task::RECEIVE_STATE::RECEIVE_CONNECTION_ERROR: return "connection error";
+        default: return "-";
+    }
+}
+
+static std::string formatTimestamp(uint64_t timestamp)
+{
+    time_t seconds = (time_t)(timestamp / 1000000000);
+    struct tm local;
+    localtime_r(&seconds, &local);
+
+    char buffer[32];
+    size_t length = strftime(buffer, sizeof(buffer), "%H:%M:%S", &local);
+    snprintf(buffer + length, sizeof(buffer) - length, ".%06u", (uint32_t)((timestamp % 1000000000) / 1000));
+    return buffer;
+}
+
+static std::string getDevice(const ExchangeTraceRecord& record)
+{
+    return std::string((const char*)record.payload, record.payloadLength) + ((record.payloadLength < record.length) ? "..." : "");
+}
+
+static void dump(const std::vector<ExchangeTraceRecord>& records)
+{
+    for (const ExchangeTraceRecord& record : records) {
+        if (record.direction == ExchangeTrace::OPEN) {
+            printf("%10llu %s conn=%5u %-9s %s\n", (unsigned long long)record.sequence, formatTimestamp(record.timestamp).c_str(),
+                record.connection, ExchangeTrace::getDirectionName(record.direction).c_str(), getDevice(record).c_str());
+            continue;
+        }
+
+        printf("%10llu %s conn=%5u %-9s %-30s", (unsigned long long)record.sequence, formatTimestamp(record.timestamp).c_str(),
+            record.connection, ExchangeTrace::getDirectionName(record.direction).c_str(), ExchangeTrace::getExchangeName(record.opcode).c_str());
+
+        if (record.flags & ExchangeTrace::HAS_REGISTER) {
+            printf(" id=%3u core=%3u reg=%3u", record.id, record.core, record.address);
+        }
+        else if (record.flags & ExchangeTrace::HAS_ID) {
+            printf(" id=%3u                 ", record.id);
+        }
+        else {
+            printf("                        ");
+        }
+
+        printf(" len=%5u", record.length);
+
+        if (record.direction == ExchangeTrace::REPLY) {
+            printf(" %9.1fus %s", record.latency / 1000.0, getStatusName(record.status).c_str());
+        }
+        if (record.retry > 0) {
+            printf(" retry %u", record.retry);
+        }
+
+        printf(" |");
+        for (uint32_t i=0; i<record.payloadLength; i++) {
+            printf(" %02x", record.payload[i]);
+        }
+        if (record.payloadLength < record.length) {
+            printf(" ...");
+        }
+        printf("\n");
+    }
+}
+
+static void printHistogram(const std::string& name, ExchangeStatistics& statistics)
+{
+    std::vector<uint32_t>& latencies = statistics.latencies;
+    printf("%s: %llu requests, %zu replies, %llu retries, %llu failed\n", name.c_str(),
+        (unsigned long long)statistics.requests, latencies.size(),
+        (unsigned long long)statistics.retries, (unsigned long long)statistics.failures);
+
+    if (latencies.empty()) {
+        printf("\n");
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (uint32_t latency : latencies) {
+        sum += latency;
+    }
+
+    printf("  latency: min %.1fus, avg %.1fus, p50 %.1fus, p99 %.1fus, max %.1fus\n",
+        latencies.front() / 1000.0, sum / latencies.size() / 1000.0,
+        latencies[latencies.size() / 2] / 1000.0, latencies[(latencies.size() * 99) / 100] / 1000.0,
+        latencies.back() / 1000.0);
+
+    std::vector<uint64_t> buckets(HISTOGRAM_BUCKETS, 0);
+    for (uint32_t latency : latencies) {
+        uint32_t bucket = 0;
+        for (uint32_t micros = latency / 1000; (micros > 0) && (bucket < HISTOGRAM_BUCKETS-1); micros >>= 1) {
+            bucket++;
+        }
+        buckets[bucket]++;
+    }
+
+    uint64_t maximum = *std::max_element(buckets.begin(), buckets.end());
+    uint32_t first = 0;
+    uint32_t last = HISTOGRAM_BUCKETS-1;
+    while (buckets[first] == 0) first++;
+    while (buckets[last] == 0) last--;
+
+    for (uint32_t bucket=first; bucket<=last; bucket++) {
+        uint64_t lower = (bucket == 0) ? 0 : (1ull << (bucket-1));
+        std::string bar((size_t)((buckets[bucket] * HISTOGRAM_BAR_WIDTH + maximum - 1) / maximum), '#');
+        if (bucket == HISTOGRAM_BUCKETS-1) {
+            printf("  %8lluus -          : %8llu %s\n", (unsigned long long)lower, (unsigned long long)buckets[bucket], bar.c_str());
+        }
+        else {
+            printf("  %8lluus - %8lluus: %8llu %s\n", (unsigned long long)lower, (unsigned long long)(1ull << bucket),
+                (unsigned long long)buckets[bucket], bar.c_str());
+        }
+    }
+    printf("\n");
+}
+
+static void summarize(const std::vector<ExchangeTraceRecord>& records)
+{
+    std::map<byte, ExchangeStatistics> exchanges;
+    std::map<uint16_t, uint64_t> connectionRequests;
+    std::map<uint16_t, std::string> devices;
+    uint64_t writes = 0;
+    uint64_t writtenBytes = 0;
+    uint64_t timeouts = 0;
+    uint64_t interrupts = 0;
+
+    for (const ExchangeTraceRecord& record : records) {
+        switch (record.direction) {
+            case ExchangeTrace::REQUEST:
+                connectionRequests[record.connection]++;
+                exchanges[record.opcode].requests++;
+                if (record.retry > 0) {
+                    exchanges[record.opcode].retries++;
+                }
+                break;
+
+            case ExchangeTrace::REPLY:
+                exchanges[record.opcode].latencies.push_back(record.latency);
+                if (record.status != Task::RECEIVE_STATE::RECEIVE_SUCCESS) {
+                    exchanges[record.opcode].failures++;
+                }
+                break;
+
+            case ExchangeTrace::INTERRUPT:
+                interrupts++;
+                break;
+
+            case ExchangeTrace::WRITE:
+                writes++;
+                writtenBytes += record.length;
+                break;
+
+            case ExchangeTrace::TIMEOUT:
+                timeouts++;
+                break;
+
+            case ExchangeTrace::OPEN:
+                connectionRequests.insert(std::make_pair(record.connection, (uint64_t)0));
+                devices[record.connection] = getDevice(record);
+                break;
+        }
+    }
+
+    printf("%zu records from %s to %s\n", records.size(), formatTimestamp(records.front().timestamp).c_str(),
+        formatTimestamp(records.back().timestamp).c_str());
+    printf("%llu write() calls with %llu bytes, %llu interrupts, %llu receive timeouts\n\n",
+        (unsigned long long)writes, (unsigned long long)writtenBytes, (unsigned long long)interrupts, (unsigned long long)timeouts);
+
+    /* the device is unknown if the connection was opened before the trace or its record was overwritten */
+    for (auto& connection : connectionRequests) {
+        auto device = devices.find(connection.first);
+        printf("connection %u (%s): %llu requests\n", connection.first,
+            (device != devices.end()) ? device->second.c_str() : "device unknown", (unsigned long long)connection.second);
+    }
+    printf("\n");
+
+    for (auto& exchange : exchanges) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s (0x%02x)", ExchangeTrace::getExchangeName(exchange.first).c_str(), exchange.first);
+        printHistogram(name, exchange.second);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool dumpRecords = (argc == 3) && (strcmp(argv[1], "--dump") == 0);
+
+    if ((argc != 2) && !dumpRecords) {
+        fprintf(stderr, "Usage: %s [--dump] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<ExchangeTraceRecord> records;
+    if (!ExchangeTrace::readRecords(argv[argc-1], &records)) {
+        return 1;
+    }
+
+    if (records.empty()) {
+        printf("The trace is empty.\n");
+        return 0;
+    }
+
+    if (dumpRecords) {
+        dump(records);
+    }
+    else {
+        summarize(records);
+    }
+
+    return 0;
+}